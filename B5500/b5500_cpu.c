@@ -121,32 +121,39 @@ uint8 rank[64] = {
 
 int                 cpu_index;                  /* Current running cpu */
 t_uint64            M[MAXMEMSIZE] = { 0 };      /* memory */
-t_uint64            a_reg[2];                   /* A register */
-t_uint64            b_reg[2];                   /* B register */
-t_uint64            x_reg[2];                   /* extension to B */
-t_uint64            y_reg[2];                   /* extension to A not original */
-uint8               arof_reg[2];                /* True if A full */
-uint8               brof_reg[2];                /* True if B full */
-uint8               gh_reg[2];                  /* G & H source char selectors */
-uint8               kv_reg[2];                  /* K & V dest char selectors */
-uint16              ma_reg[2];                  /* M memory address regiser */
-uint16              s_reg[2];                   /* S Stack pointer */
-uint16              f_reg[2];                   /* F MCSV pointer */
-uint16              r_reg[2];                   /* R PRT pointer */
-t_uint64            p_reg[2];                   /* P insruction buffer */
-uint8               prof_reg[2];                /* True if P valid */
-uint16              t_reg[2];                   /* T current instruction */
-uint8               trof_reg[2];                /* True if T valid */
-uint16              c_reg[2];                   /* C program counter */
-uint16              l_reg[2];                   /* L current syllable pointer */
-uint8               ncsf_reg[2];                /* True if normal state */
-uint8               salf_reg[2];                /* True if subrogram mode */
-uint8               cwmf_reg[2];                /* True if character mode */
-uint8               hltf[2];                    /* True if processor halted */
-uint8               msff_reg[2];                /* Mark stack flag Word mode */
+/* Per processor register state */
+struct cpu_regs
+{
+        t_uint64        a;                      /* A register */
+        t_uint64        b;                      /* B register */
+        t_uint64        x;                      /* extension to B */
+        t_uint64        y;                      /* extension to A not original */
+        t_uint64        p;                      /* P insruction buffer */
+        uint16          c;                      /* C program counter */
+        uint16          l;                      /* L current syllable pointer */
+        uint16          ma;                     /* M memory address regiser */
+        uint16          s;                      /* S Stack pointer */
+        uint16          f;                      /* F MCSV pointer */
+        uint16          r;                      /* R PRT pointer */
+        uint16          t;                      /* T current instruction */
+        uint8           q;                      /* Holds error code */
+        uint8           gh;                     /* G & H source char selectors */
+        uint8           kv;                     /* K & V dest char selectors */
+        uint8           arof;                   /* True if A full */
+        uint8           brof;                   /* True if B full */
+        uint8           prof;                   /* True if P valid */
+        uint8           trof;                   /* True if T valid */
+        uint8           ncsf;                   /* True if normal state */
+        uint8           salf;                   /* True if subrogram mode */
+        uint8           cwmf;                   /* True if character mode */
+        uint8           msff;                   /* Mark stack flag Word mode */
+        uint8           varf;                   /* Variant Flag */
+        uint8           hltf;                   /* True if processor halted */
+};
+
+struct cpu_regs     cpu_regs[2];                /* Register state of P1 and P2 */
+struct cpu_regs     *cur = &cpu_regs[0];        /* Registers of running cpu */
 #define TFFF MSFF                               /* True state in Char mode */
-uint8               varf_reg[2];                /* Variant Flag */
-uint8               q_reg[2];                   /* Holds error code */
 uint16              IAR;                        /* Interrupt register */
 uint32              iostatus;                   /* Hold status of devices */
 uint8               RTC;                        /* Real time clock counter */
@@ -156,6 +163,26 @@ uint8               P1_run;                     /* Run flag for P1 */
 uint8               P2_run;                     /* Run flag for P2 */
 uint16              idle_addr = 0;              /* Address of idle loop */
 
+/* Idle loop signatures, syllables following the ITI */
+#define IDLE_SIGS       8                       /* Max signatures */
+#define IDLE_LEN        16                      /* Max syllables per signature */
+
+struct idle_sig
+{
+        int             len;
+        uint16          data[IDLE_LEN];
+        uint16          mask[IDLE_LEN];
+};
+
+struct idle_sig     idle_sig[IDLE_SIGS] = {
+    /* Standard MCP idle loop, always present */
+    { 7, { WMOP_TUS, WMOP_OPDC, WMOP_LOR, WMOP_OPDC,
+           WMOP_NEQ, WMOP_LITC, WMOP_BBC },
+         { 07777,    00003,     07777,     00003,
+           07777,    07733,     05777 } },
+};
+int                 idle_nsig = 1;              /* Signatures in use */
+
 
 struct InstHistory
 {
@@ -203,6 +230,14 @@ t_stat              cpu_show_hist(FILE * st, UNIT * uptr, int32 val,
                                   CONST void *desc);
 t_stat              cpu_set_hist(UNIT * uptr, int32 val, CONST char *cptr,
                                  void *desc);
+t_stat              cpu_show_histfile(FILE * st, UNIT * uptr, int32 val,
+                                  CONST void *desc);
+t_stat              cpu_set_histfile(UNIT * uptr, int32 val, CONST char *cptr,
+                                 void *desc);
+t_stat              cpu_set_idle(UNIT * uptr, int32 val, CONST char *cptr,
+                                 void *desc);
+t_stat              cpu_show_idle(FILE * st, UNIT * uptr, int32 val,
+                                  CONST void *desc);
 t_stat              cpu_help(FILE *, DEVICE *, UNIT *, int32, const char *);
 /* Interval timer */
 t_stat              rtc_srv(UNIT * uptr);
@@ -223,30 +258,39 @@ UNIT                cpu_unit[] =
     { UDATA(0, UNIT_DISABLE|UNIT_DIS, 0 ), 0 }};
 
 REG                 cpu_reg[] = {
-    {BRDATAD(C, c_reg, 8,15,2,   "Instruction pointer"), REG_FIT},
-    {BRDATAD(L, l_reg, 8,2,2,    "Sylable pointer")},
-    {BRDATA(A, a_reg, 8,48,2), REG_FIT},
-    {BRDATA(B, b_reg, 8,48,2), REG_FIT},
-    {BRDATA(X, x_reg, 8,39,2), REG_FIT},
-    {BRDATA(GH, gh_reg, 8,6,2)},
-    {BRDATA(KV, kv_reg, 8,6,2)},
-    {BRDATAD(MA, ma_reg, 8,15,2, "Memory address")},
-    {BRDATAD(S, s_reg, 8,15,2,   "Stack pointer")},
-    {BRDATAD(F, f_reg, 8,15,2,   "Frame pointer")},
-    {BRDATAD(R, r_reg, 8,15,2,   "PRT pointer/Tally")},
-    {BRDATAD(P, p_reg, 8,48,2,   "Last code word cache")},
-    {BRDATAD(T, t_reg, 8,12,2,   "Current instruction")},
-    {BRDATAD(Q, q_reg, 8,9,2,    "Error condition")},
-    {BRDATA(AROF, arof_reg, 2,1,2)},
-    {BRDATA(BROF, brof_reg, 2,1,2)},
-    {BRDATA(PROF, prof_reg, 2,1,2)},
-    {BRDATA(TROF, trof_reg, 2,1,2)},
-    {BRDATA(NCSF, ncsf_reg, 2,1,2)},
-    {BRDATA(SALF, salf_reg, 2,1,2)},
-    {BRDATA(CWMF, cwmf_reg, 2,1,2)},
-    {BRDATA(MSFF, msff_reg, 2,1,2)},
-    {BRDATA(VARF, varf_reg, 2,1,2)},
-    {BRDATA(HLTF, hltf, 2,1,2)},
+    {STRDATAD(C, cpu_regs[0].c, 8, 15, 0, 2, sizeof(struct cpu_regs), REG_FIT,
+              "Instruction pointer")},
+    {STRDATAD(L, cpu_regs[0].l, 8, 2, 0, 2, sizeof(struct cpu_regs), 0,
+              "Sylable pointer")},
+    {STRDATA(A, cpu_regs[0].a, 8, 48, 0, 2, sizeof(struct cpu_regs), REG_FIT)},
+    {STRDATA(B, cpu_regs[0].b, 8, 48, 0, 2, sizeof(struct cpu_regs), REG_FIT)},
+    {STRDATA(X, cpu_regs[0].x, 8, 39, 0, 2, sizeof(struct cpu_regs), REG_FIT)},
+    {STRDATA(GH, cpu_regs[0].gh, 8, 6, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(KV, cpu_regs[0].kv, 8, 6, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATAD(MA, cpu_regs[0].ma, 8, 15, 0, 2, sizeof(struct cpu_regs), 0,
+              "Memory address")},
+    {STRDATAD(S, cpu_regs[0].s, 8, 15, 0, 2, sizeof(struct cpu_regs), 0,
+              "Stack pointer")},
+    {STRDATAD(F, cpu_regs[0].f, 8, 15, 0, 2, sizeof(struct cpu_regs), 0,
+              "Frame pointer")},
+    {STRDATAD(R, cpu_regs[0].r, 8, 15, 0, 2, sizeof(struct cpu_regs), 0,
+              "PRT pointer/Tally")},
+    {STRDATAD(P, cpu_regs[0].p, 8, 48, 0, 2, sizeof(struct cpu_regs), 0,
+              "Last code word cache")},
+    {STRDATAD(T, cpu_regs[0].t, 8, 12, 0, 2, sizeof(struct cpu_regs), 0,
+              "Current instruction")},
+    {STRDATAD(Q, cpu_regs[0].q, 8, 8, 0, 2, sizeof(struct cpu_regs), 0,
+              "Error condition")},
+    {STRDATA(AROF, cpu_regs[0].arof, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(BROF, cpu_regs[0].brof, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(PROF, cpu_regs[0].prof, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(TROF, cpu_regs[0].trof, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(NCSF, cpu_regs[0].ncsf, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(SALF, cpu_regs[0].salf, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(CWMF, cpu_regs[0].cwmf, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(MSFF, cpu_regs[0].msff, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(VARF, cpu_regs[0].varf, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
+    {STRDATA(HLTF, cpu_regs[0].hltf, 2, 1, 0, 2, sizeof(struct cpu_regs), 0)},
     {ORDATAD(IAR, IAR, 15,      "Interrupt pending")},
     {ORDATAD(TUS, iostatus, 32, "Perpherial ready status")},
     {FLDATA(HALT, HALT, 0)},
@@ -263,10 +307,21 @@ MTAB                cpu_mod[] = {
     {UNIT_MSIZE|MTAB_VDV, MEMAMOUNT(6), NULL, "28K", &cpu_set_size},
     {UNIT_MSIZE|MTAB_VDV, MEMAMOUNT(7), NULL, "32K", &cpu_set_size},
     {MTAB_VDV, 0, "MEMORY", NULL, NULL, &cpu_show_size},
-    {MTAB_XTD|MTAB_VDV, 0, "IDLE", "IDLE", &sim_set_idle, &sim_show_idle },
+    {MTAB_XTD|MTAB_VDV|MTAB_VALO|MTAB_NC, 0, "IDLE", "IDLE", &cpu_set_idle,
+     &cpu_show_idle, NULL, "Enable idling, IDLE=AUTO or IDLE=file of loop signatures"},
     {MTAB_XTD|MTAB_VDV, 0, NULL, "NOIDLE", &sim_clr_idle, NULL },
     {MTAB_XTD | MTAB_VDV | MTAB_NMO | MTAB_SHP, 0, "HISTORY", "HISTORY",
      &cpu_set_hist, &cpu_show_hist},
+    {MTAB_XTD | MTAB_VDV | MTAB_NMO | MTAB_SHP | MTAB_VALR | MTAB_NC, 1,
+     "HISTFILE", "HISTFILE", &cpu_set_histfile, &cpu_show_histfile, NULL,
+     "Stream instruction history to a file, or decode a file with SHOW"},
+    {MTAB_XTD | MTAB_VDV, 0, NULL, "NOHISTFILE", &cpu_set_histfile, NULL,
+     NULL, "Close the instruction history file"},
+    {MTAB_XTD | MTAB_VDV | MTAB_NMO | MTAB_SHP | MTAB_VALO, 0, "PROFILE",
+     "PROFILE", &sim_set_profile, &sim_show_profile, NULL,
+     "Sample every n'th instruction address, SHOW lists the top n"},
+    {MTAB_XTD | MTAB_VDV, 0, NULL, "NOPROFILE", &sim_clr_profile, NULL,
+     NULL, "Stop profiling"},
     {0}
 };
 
@@ -281,31 +336,34 @@ DEVICE              cpu_dev = {
 
 
 /* Define registers */
-#define A       a_reg[cpu_index]
-#define B       b_reg[cpu_index]
-#define C       c_reg[cpu_index]
-#define L       l_reg[cpu_index]
-#define X       x_reg[cpu_index]
-#define Y       y_reg[cpu_index]
-#define Q       q_reg[cpu_index]
-#define GH      gh_reg[cpu_index]
-#define KV      kv_reg[cpu_index]
-#define Ma      ma_reg[cpu_index]
-#define S       s_reg[cpu_index]
-#define F       f_reg[cpu_index]
-#define R       r_reg[cpu_index]
-#define P       p_reg[cpu_index]
-#define T       t_reg[cpu_index]
-#define AROF    arof_reg[cpu_index]
-#define BROF    brof_reg[cpu_index]
-#define PROF    prof_reg[cpu_index]
-#define TROF    trof_reg[cpu_index]
-#define NCSF    ncsf_reg[cpu_index]
-#define SALF    salf_reg[cpu_index]
-#define CWMF    cwmf_reg[cpu_index]
-#define MSFF    msff_reg[cpu_index]
-#define VARF    varf_reg[cpu_index]
-#define HLTF    hltf[cpu_index]
+#define A       (cur->a)
+#define B       (cur->b)
+#define C       (cur->c)
+#define L       (cur->l)
+#define X       (cur->x)
+#define Y       (cur->y)
+#define Q       (cur->q)
+#define GH      (cur->gh)
+#define KV      (cur->kv)
+#define Ma      (cur->ma)
+#define S       (cur->s)
+#define F       (cur->f)
+#define R       (cur->r)
+#define P       (cur->p)
+#define T       (cur->t)
+#define AROF    (cur->arof)
+#define BROF    (cur->brof)
+#define PROF    (cur->prof)
+#define TROF    (cur->trof)
+#define NCSF    (cur->ncsf)
+#define SALF    (cur->salf)
+#define CWMF    (cur->cwmf)
+#define MSFF    (cur->msff)
+#define VARF    (cur->varf)
+#define HLTF    (cur->hltf)
+
+/* Switch the running processor */
+#define SET_CPU(n)  cur = &cpu_regs[cpu_index = (n)]
 
 /* Definitions to help extract fields */
 #define FF(x)    (uint16)(((x) & FFIELD) >> FFIELD_V)
@@ -380,6 +438,7 @@ int memory_cycle(uint8 E) {
             return 0;
         }
         if (E & 010) {
+            sim_idle_writes++;
             if (E & 1) 
                 M[addr] = B;
             else
@@ -803,6 +862,20 @@ void fill_src() {
     }
 }
 
+/* Check if source and destination are both at the start of a word with
+   nothing loaded, and a whole word of the field is left. Then the next
+   eight characters can be handled a word at a time, as long as memory_cycle
+   would not flag either address. */
+int word_aligned(int field) {
+    if (field < 8 || GH != 0 || KV != 0 || AROF || BROF)
+        return 0;
+    if (Ma > MEMSIZE || S > MEMSIZE)
+        return 0;
+    if (NCSF && (Ma < 01000 || S < 01000))
+        return 0;
+    return 1;
+}
+
 
 /* Helper routines for managing processor */
 
@@ -930,8 +1003,8 @@ void storeInterrupt(int forced, int test) {
     } else if (forced) {
         if (cpu_index) {
            P2_run = 0;          /* Clear halt flag */
-           hltf[1] = 0;
-           cpu_index = 0;
+           cpu_regs[1].hltf = 0;
+           SET_CPU(0);
         } else {
            T = WMOP_ITI;
            TROF = 1;
@@ -952,20 +1025,17 @@ void storeInterrupt(int forced, int test) {
   +5   LITC  010          LITC 1         0040   0004
   +6   BBC                LBC            0131   2131
 
+   Other MCP releases can add signatures with SET CPU IDLE=file.
 */
 
 int check_idle() {
-    static uint16  loop_data[7] = {
-          WMOP_TUS, WMOP_OPDC, WMOP_LOR, WMOP_OPDC, 
-          WMOP_NEQ, WMOP_LITC, WMOP_BBC };
-    static uint16  loop_mask[7] = {
-          07777,    00003,     07777,     00003,
-          07777,    07733,     05777};
+    struct idle_sig *sig;
     t_uint64     data;
     uint16       addr = C;
-    int          l = (3 - L) * 12;
+    int          l;
     uint16       word;
     int          i;
+    int          n;
 
     /* Quick check to see if not correct location */
     if (idle_addr != 0 && idle_addr != addr) 
@@ -975,21 +1045,92 @@ int check_idle() {
        return 1;
 
     /* Not set, see if this could be loop */
-    data = M[addr];
-    for (i = 0; i < 7; i++) {
-        word = (uint16)(data >> l) & 07777;
-        if ((word & loop_mask[i]) != loop_data[i])
-            return 0;
-        if (l == 0) {
-            addr++; 
-            l = 3 * 12;
-            data = M[addr];
-        } else {
-            l -= 12;
+    for (n = 0; n < idle_nsig; n++) {
+        sig = &idle_sig[n];
+        addr = C;
+        l = (3 - L) * 12;
+        data = M[addr];
+        for (i = 0; i < sig->len; i++) {
+            word = (uint16)(data >> l) & 07777;
+            if ((word & sig->mask[i]) != sig->data[i])
+                break;
+            if (l == 0) {
+                addr++; 
+                l = 3 * 12;
+                data = M[addr];
+            } else {
+                l -= 12;
+            }
+        }
+        if (i == sig->len) {
+            idle_addr = C;
+            return 1;
         }
     }
-    idle_addr = C;
-    return 1;
+    return 0;
+}
+
+/* Load idle loop signatures from a file. Each line holds the syllables
+   following the ITI, in octal, each optionally followed by /mask.
+   Text after a ; or # is ignored.  The table is only replaced once the
+   whole file has been read without error. */
+t_stat load_idle(CONST char *name) {
+    FILE        *f;
+    char        line[CBUFSIZE];
+    char        gbuf[CBUFSIZE];
+    CONST char  *cptr;
+    char        *p;
+    char        *sl;
+    struct idle_sig *sig;
+    struct idle_sig new_sig[IDLE_SIGS];
+    int         n = 1;
+    t_stat      r = SCPE_OK;
+
+    f = sim_fopen(name, "r");
+    if (f == NULL)
+        return sim_messagef(SCPE_OPENERR, "Can't open %s\n", name);
+    new_sig[0] = idle_sig[0];                   /* Standard loop stays */
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if ((p = strpbrk(line, ";#\r\n")) != NULL)
+            *p = 0;
+        for (cptr = line; sim_isspace(*cptr); cptr++);
+        sig = &new_sig[n];
+        sig->len = 0;
+        while (*cptr != 0) {
+            cptr = get_glyph_nc(cptr, gbuf, 0);
+            if (gbuf[0] == 0)
+                continue;
+            if (sig->len == IDLE_LEN) {
+                fclose(f);
+                return sim_messagef(SCPE_ARG, "Idle signature too long\n");
+            }
+            sig->mask[sig->len] = 07777;
+            if ((sl = strchr(gbuf, '/')) != NULL) {
+                *sl++ = 0;
+                sig->mask[sig->len] = (uint16)get_uint(sl, 8, 07777, &r);
+                if (r != SCPE_OK)
+                    break;
+            }
+            sig->data[sig->len] = (uint16)get_uint(gbuf, 8, 07777, &r);
+            if (r != SCPE_OK)
+                break;
+            sig->data[sig->len] &= sig->mask[sig->len];
+            sig->len++;
+        }
+        if (r != SCPE_OK) {
+            fclose(f);
+            return sim_messagef(SCPE_ARG, "Invalid syllable %s\n", gbuf);
+        }
+        if (sig->len == 0)
+            continue;
+        if (++n == IDLE_SIGS)
+            break;
+    }
+    fclose(f);
+    memcpy(idle_sig, new_sig, n * sizeof(new_sig[0]));
+    idle_nsig = n;
+    idle_addr = 0;
+    return SCPE_OK;
 }
 
 
@@ -1198,6 +1339,13 @@ void add(int opcode) {
  * Perform a 40 bit multiply on A and B, result into B,X 
  */
 void mult_step(t_uint64 a, t_uint64 *b, t_uint64 *x) {
+#if defined(__SIZEOF_INT128__)
+    /* Same 128 bit product, done by the host in one multiply */
+    unsigned __int128   p = (unsigned __int128)a * *b;
+
+    *b = (t_uint64)(p >> EXPO_V);
+    *x = (t_uint64)p & MANT;
+#else
     t_uint64  u0,u1,v0,v1,t,w1,w2,w3,k;
 
     /* Split into 32 bit and 8 bit */
@@ -1222,6 +1370,7 @@ void mult_step(t_uint64 a, t_uint64 *b, t_uint64 *x) {
     *b <<= 25;
     *b |= (*x >> EXPO_V);
     *x &= MANT;
+#endif
 }
 
 /* Do multiply instruction */
@@ -1919,8 +2068,8 @@ sim_instr(void)
     int                 j;
 
     reason = 0;
-    hltf[0] = 0;
-    hltf[1] = 0;
+    cpu_regs[0].hltf = 0;
+    cpu_regs[1].hltf = 0;
     P1_run = 1;
 
     while (reason == 0) {       /* loop until halted */
@@ -1946,13 +2095,13 @@ sim_instr(void)
                 break;
             }
 
-            if (sim_brk_test((c_reg[0] << 3) | l_reg[0],
+            if (sim_brk_test((cpu_regs[0].c << 3) | cpu_regs[0].l,
                          SWMASK('A'))) {
                 reason = SCPE_STOP;
                 break;
             }
 
-            if (sim_brk_test((c_reg[1] << 3) | l_reg[1],
+            if (sim_brk_test((cpu_regs[1].c << 3) | cpu_regs[1].l,
                          SWMASK('B'))) {
                 reason = SCPE_STOP;
                 break;
@@ -1961,13 +2110,13 @@ sim_instr(void)
 
         /* Toggle between two CPU's. */
         if (cpu_index == 0 && P2_run == 1) {
-            cpu_index = 1;
+            SET_CPU(1);
             /* Check if interrupt pending. */
             if (TROF == 0 && NCSF && ((Q != 0) || HLTF)) 
                 /* Force a SFI */
                 storeInterrupt(1,0);
         } else {
-            cpu_index = 0;
+            SET_CPU(0);
 
             /* Check if interrupt pending. */
             if (TROF == 0 && NCSF && ((Q != 0) ||
@@ -1984,6 +2133,8 @@ crf_loop:
         field = (T >> 6) & 077;
         TROF = 0;
 
+        sim_prof_sample(C);
+        sim_idle_auto_fetch((C << 2) | L);
         if (hst_lnt) {  /* history enabled? */
             /* Ignore idle loop when recording history */
                 /* DCMCP XIII */
@@ -1992,6 +2143,8 @@ crf_loop:
             /* if ((C & 077774) != 01254) { */
                 /* TSMCP XV */
             /* if ((C & 077774) != 01324) { */
+            if (sim_hist_file && (hst[hst_p].c & HIST_PC))
+                sim_hist_write(&hst[hst_p]);
             hst_p = (hst_p + 1);        /* next entry */
             if (hst_p >= hst_lnt) {
                     hst_p = 0;
@@ -2625,6 +2778,18 @@ crf_loop:
                 TFFF = 1;       /* flag to show greater */
                 f = 1;          /* Still comparaing */
                 while(field > 0) {
+                    /* Equal words, or past the first difference, only
+                       need their memory cycles. */
+                    if (word_aligned(field) && (f == 0 || M[Ma] == M[S])) {
+                        sim_interval -= 3;
+                        A = M[Ma];
+                        B = M[S];
+                        sim_idle_writes++;      /* B written back */
+                        next_addr(Ma);
+                        next_addr(S);
+                        field -= 8;
+                        continue;
+                    }
                     fill_src();
                     fill_dest();
                     if (f) {    
@@ -2798,6 +2963,18 @@ crf_loop:
                 adjust_source();
                 adjust_dest();
                 while(field > 0) {
+                   /* Whole words of source characters just copy */
+                   if (opcode == CMOP_TRS && word_aligned(field)) {
+                        sim_interval -= 3;
+                        A = M[Ma];
+                        B = A;
+                        sim_idle_writes++;
+                        M[S] = B;
+                        next_addr(Ma);
+                        next_addr(S);
+                        field -= 8;
+                        continue;
+                   }
                    fill_dest();
                    fill_src();
                    i = (int)(A >> bit_number[GH | 07]);
@@ -2972,12 +3149,12 @@ control:
                         if (NCSF)       /* Nop in normal state */
                             break;
 
-                        if (q_reg[0] & MEM_PARITY) {
+                        if (cpu_regs[0].q & MEM_PARITY) {
                             C = PARITY_ERR;
-                            q_reg[0] &= ~MEM_PARITY;
-                        } else if (q_reg[0] & INVALID_ADDR) {
+                            cpu_regs[0].q &= ~MEM_PARITY;
+                        } else if (cpu_regs[0].q & INVALID_ADDR) {
                             C = INVADR_ERR;
-                            q_reg[0] &= ~INVALID_ADDR;
+                            cpu_regs[0].q &= ~INVALID_ADDR;
                         } else if (IAR) {
                             uint16  x;
                             C = INTER_TIME;
@@ -2987,25 +3164,25 @@ control:
                             if (C >= IO1_FINISH && C <= IO4_FINISH) 
                                 chan_release(C - IO1_FINISH);
                             IAR &= ~x;
-                        } else if ((q_reg[0] & 0170) != 0) {
-                            C = 060 + (q_reg[0] >> 3);
-                            q_reg[0] &= 07;
-                        } else if (q_reg[0] & STK_OVERFL) {
+                        } else if ((cpu_regs[0].q & 0170) != 0) {
+                            C = 060 + (cpu_regs[0].q >> 3);
+                            cpu_regs[0].q &= 07;
+                        } else if (cpu_regs[0].q & STK_OVERFL) {
                             C = STK_OVR_LOC;
-                            q_reg[0] &= ~STK_OVERFL;
-                        } else if (P2_run == 0 && q_reg[1] != 0) {
-                            if (q_reg[1] & MEM_PARITY) {
+                            cpu_regs[0].q &= ~STK_OVERFL;
+                        } else if (P2_run == 0 && cpu_regs[1].q != 0) {
+                            if (cpu_regs[1].q & MEM_PARITY) {
                                 C = PARITY_ERR2;
-                                q_reg[1] &= ~MEM_PARITY;
-                            } else if (q_reg[1] & INVALID_ADDR) {
+                                cpu_regs[1].q &= ~MEM_PARITY;
+                            } else if (cpu_regs[1].q & INVALID_ADDR) {
                                 C = INVADR_ERR2;
-                                q_reg[1] &= ~INVALID_ADDR;
-                            } else if ((q_reg[1] & 0170) != 0) {
-                                C = 040 + (q_reg[1] >> 3);
-                                q_reg[1] &= 07;
-                            } else if (q_reg[1] & STK_OVERFL) {
+                                cpu_regs[1].q &= ~INVALID_ADDR;
+                            } else if ((cpu_regs[1].q & 0170) != 0) {
+                                C = 040 + (cpu_regs[1].q >> 3);
+                                cpu_regs[1].q &= 07;
+                            } else if (cpu_regs[1].q & STK_OVERFL) {
                                 C = STK_OVR_LOC2;
-                                q_reg[1] &= ~STK_OVERFL;
+                                cpu_regs[1].q &= ~STK_OVERFL;
                             }
                         } else {
                              /* Could be an idle loop, if P2 running, continue */
@@ -3082,7 +3259,7 @@ control:
                            break;
                         if (!HALT)
                            break;
-                        hltf[0] = 1;
+                        cpu_regs[0].hltf = 1;
                         P1_run = 0;
                         break;
 
@@ -3096,7 +3273,7 @@ control:
                         }
                         sim_debug(DEBUG_DETAIL, &cpu_dev, "HALT P2\n\r");
                         /* Flag P2 to stop */
-                        hltf[1] = 1;
+                        cpu_regs[1].hltf = 1;
                         TROF = 1;       /* Reissue until CPU2 stopped */
                         break;
 
@@ -3120,9 +3297,9 @@ control:
                         }
                         /* Ok we are going to initiate B.
                            load the initiate word from 010. */
-                        hltf[1] = 0;
+                        cpu_regs[1].hltf = 0;
                         P2_run = 1;
-                        cpu_index = 1;  /* To CPU 2 */
+                        SET_CPU(1);  /* To CPU 2 */
                         Ma = 010;
                         memory_cycle(4);
                         sim_debug(DEBUG_DETAIL, &cpu_dev, "INIT P2\n\r");
@@ -3761,24 +3938,24 @@ t_stat
 cpu_reset(DEVICE * dptr)
 {
     /* Reset CPU 2 first */
-    cpu_index = 1;
+    SET_CPU(1);
     C = 020; 
     S = F = R = T = 0;
     L = 0;
     A = B = X = P = 0;
     AROF = BROF = TROF = PROF = NCSF = SALF = CWMF = MSFF = VARF = 0;
     GH = KV = Q = 0;
-    hltf[1] = 0;
+    cpu_regs[1].hltf = 0;
     P2_run = 0;
     /* Reset CPU 1 now */
-    cpu_index = 0;
+    SET_CPU(0);
     C = 020; 
     S = F = R = T = IAR = 0;
     L = 0;
     A = B = X = P = 0;
     AROF = BROF = TROF = PROF = NCSF = SALF = CWMF = MSFF = VARF = 0;
     GH = KV = Q = 0;
-    hltf[0] = 0;
+    cpu_regs[0].hltf = 0;
     P1_run = 0;
 
     idle_addr = 0;
@@ -3882,6 +4059,59 @@ cpu_set_hist(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
     return SCPE_OK;
 }
 
+/* Print one history entry */
+
+static void
+cpu_print_hist(FILE * st, const void *rec)
+{
+    const struct InstHistory *h = (const struct InstHistory *) rec;
+    int                 i;
+    t_value             sim_eval;
+    extern void         print_opcode(FILE * ofile, t_value val, t_opcode *);
+    extern t_opcode     word_ops[1], char_ops[1];
+    char                flags[] = "ABCNSMV";
+
+    fprintf(st, "%o %05o%o ", h->cpu, h->c & 077777, h->l);
+    sim_eval = (t_value)h->a_reg;
+    fprint_sym(st, 0, &sim_eval, &cpu_unit[0], SWMASK('B'));
+    fputc((h->flags & F_AROF) ? '^': ' ', st);
+    fputc(' ', st);
+    sim_eval = (t_value)h->b_reg;
+    fprint_sym(st, 0, &sim_eval, &cpu_unit[0], SWMASK('B'));
+    fputc((h->flags & F_BROF) ? '^': ' ', st);
+    fputc(' ', st);
+    fprint_val(st, (t_value)h->x_reg, 8, 39, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->s, 8, 15, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->f, 8, 15, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->r, 8, 15, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->ma, 8, 15, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->gh, 8, 6, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->kv, 8, 6, PV_RZRO);
+    fputc(' ', st);
+    for(i = 2; i < 8; i++) {
+        fputc (((1 << i) & h->flags) ? flags[i] : ' ', st);
+    }
+    fprint_val(st, h->q, 8, 9, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->op, 8, 12, PV_RZRO);
+    fputc(' ', st);
+    print_opcode(st, h->op, 
+        ((h->flags & F_CWMF) ? char_ops : word_ops));
+    fputc(' ', st);
+    fprint_val(st, h->iar, 8, 16, PV_RZRO);
+    fputc('\n', st);    /* end line */
+}
+
+#define HIST_TITLE "P    CL                 A                               B   " \
+                   "                       X     S     F     R      M  GH KV Flags" \
+                   "  Q Intruction     IAR\n\n"
+
 /* Show history */
 
 t_stat
@@ -3890,11 +4120,7 @@ cpu_show_hist(FILE * st, UNIT * uptr, int32 val, CONST void *desc)
     int32               k, di, lnt;
     const char          *cptr = (const char *) desc;
     t_stat              r;
-    t_value             sim_eval;
     struct InstHistory *h;
-    extern void         print_opcode(FILE * ofile, t_value val, t_opcode *);
-    extern t_opcode     word_ops[1], char_ops[1];
-    char                flags[] = "ABCNSMV";
 
     if (hst_lnt == 0)
         return SCPE_NOFNC;      /* enabled? */
@@ -3907,53 +4133,84 @@ cpu_show_hist(FILE * st, UNIT * uptr, int32 val, CONST void *desc)
     di = hst_p - lnt;           /* work forward */
     if (di < 0)
         di = di + hst_lnt;
-    fprintf(st, "P    CL                 A                               B   "
-                "                       X     S     F     R      M  GH KV Flags"
-                "  Q Intruction     IAR\n\n");
+    fprintf(st, HIST_TITLE);
     for (k = 0; k < lnt; k++) { /* print specified */
         h = &hst[(++di) % hst_lnt];     /* entry pointer */
-        if (h->c & HIST_PC) {   /* instruction? */
-            int i;
-            fprintf(st, "%o %05o%o ", h->cpu, h->c & 077777, h->l);
-            sim_eval = (t_value)h->a_reg;
-            fprint_sym(st, 0, &sim_eval, &cpu_unit[0], SWMASK('B'));
-            fputc((h->flags & F_AROF) ? '^': ' ', st);
-            fputc(' ', st);
-            sim_eval = (t_value)h->b_reg;
-            fprint_sym(st, 0, &sim_eval, &cpu_unit[0], SWMASK('B'));
-            fputc((h->flags & F_BROF) ? '^': ' ', st);
-            fputc(' ', st);
-            fprint_val(st, (t_value)h->x_reg, 8, 39, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->s, 8, 15, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->f, 8, 15, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->r, 8, 15, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->ma, 8, 15, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->gh, 8, 6, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->kv, 8, 6, PV_RZRO);
-            fputc(' ', st);
-            for(i = 2; i < 8; i++) {
-                fputc (((1 << i) & h->flags) ? flags[i] : ' ', st);
-            }
-            fprint_val(st, h->q, 8, 9, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->op, 8, 12, PV_RZRO);
-            fputc(' ', st);
-            print_opcode(st, h->op, 
-                ((h->flags & F_CWMF) ? char_ops : word_ops));
-            fputc(' ', st);
-            fprint_val(st, h->iar, 8, 16, PV_RZRO);
-            fputc('\n', st);    /* end line */
-        }                       /* end else instruction */
+        if (h->c & HIST_PC)     /* instruction? */
+            cpu_print_hist(st, h);
     }                           /* end for */
     return SCPE_OK;
 }
 
+/* Set history file, entries are streamed as each one is completed */
+
+t_stat
+cpu_set_histfile(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
+{
+    int32               i;
+    t_stat              r;
+
+    if (val == 0) {
+        if (sim_hist_file && hst_lnt && (hst[hst_p].c & HIST_PC))
+            sim_hist_write(&hst[hst_p]);        /* last entry */
+        sim_hist_close();
+        return SCPE_OK;
+    }
+    if ((cptr == NULL) || (*cptr == 0))
+        return SCPE_MISVAL;
+    if (hst_lnt == 0) {         /* need a buffer */
+        r = cpu_set_hist(uptr, 0, "64", NULL);
+        if (r != SCPE_OK)
+            return r;
+    }
+    for (i = 0; i < hst_lnt; i++)       /* start clean */
+        hst[i].c = 0;
+    return sim_hist_open(cptr, sizeof(struct InstHistory));
+}
+
+/* Show history file, or decode one */
+
+t_stat
+cpu_show_histfile(FILE * st, UNIT * uptr, int32 val, CONST void *desc)
+{
+    const char          *cptr = (const char *) desc;
+
+    if ((cptr == NULL) || (*cptr == 0)) {
+        sim_hist_show(st);
+        fputc('\n', st);
+        return SCPE_OK;
+    }
+    return sim_hist_decode(st, cptr, sizeof(struct InstHistory), HIST_TITLE,
+                           &cpu_print_hist);
+}
+
+t_stat
+cpu_set_idle(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
+{
+    t_stat      r;
+
+    /* Anything other than AUTO or a stability count names a file */
+    if (cptr != NULL && sim_strncasecmp(cptr, "AUTO", 5) == 0) {
+        cptr = "AUTO";
+    } else if (cptr != NULL && *cptr != 0 && !sim_isdigit(*cptr)) {
+        r = load_idle(cptr);
+        if (r != SCPE_OK)
+            return r;
+        cptr = NULL;
+    }
+    return sim_set_idle(uptr, val, cptr, desc);
+}
+
+t_stat
+cpu_show_idle(FILE * st, UNIT * uptr, int32 val, CONST void *desc)
+{
+    sim_show_idle(st, uptr, val, desc);
+    if (sim_idle_enab && !sim_idle_auto)
+        fprintf(st, ", %d loop signature%s", idle_nsig,
+                     (idle_nsig == 1) ? "" : "s");
+    return SCPE_OK;
+}
+
 
 t_stat              cpu_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr) 
 {
@@ -3963,6 +4220,11 @@ t_stat              cpu_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, con
     fprintf(st, "       sim> SET CPU1 ENABLE                enable second CPU\n");
     fprintf(st, "The primary CPU can't be disabled. Memory is shared between the two\n");
     fprintf(st, "CPU's. Memory can be configured in 4K increments up to 32K total.\n");
+    fprintf(st, "\nSET CPU IDLE sleeps when the MCP runs its known idle loop. Loops\n");
+    fprintf(st, "of other MCP releases can be added with SET CPU IDLE=file, where\n");
+    fprintf(st, "each line of the file lists the octal syllables following the ITI,\n");
+    fprintf(st, "each optionally followed by /mask. SET CPU IDLE=AUTO instead sleeps\n");
+    fprintf(st, "in any short loop that runs without writing memory.\n");
     fprint_set_help(st, dptr);
     fprint_show_help(st, dptr);
     return SCPE_OK;
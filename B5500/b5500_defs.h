@@ -118,6 +118,10 @@ int chan_read_char(int, uint8 *, int) ;
 int chan_read_disk(int, uint8 *, int) ;
 int chan_write_drum(int, uint8 *, int) ;
 int chan_read_drum(int, uint8 *, int) ;
+int chan_write_block(int, uint8 *, int, int *) ;
+int chan_read_block(int, uint8 *, int, int *) ;
+int chan_write_drum_block(int, uint8 *, int, int *) ;
+int chan_read_drum_block(int, uint8 *, int, int *) ;
 
 extern uint8       parity_table[64];
 extern uint8       mem_to_ascii[64];
@@ -22,6 +22,7 @@
 */
 
 #include "b5500_defs.h"
+#include "sim_disk.h"
 
 #if (NUM_DEVS_DSK > 0) 
 
@@ -53,10 +54,13 @@
 #define DK_SEC_SIZE     240     /* Sector size  */
 #define DK_MAXSEGS      200000  /* Max segments for MOD I  ESU */
 #define DK_MAXSEGS2     400000  /* Max segments for MOD IB ESU */
+#define DK_MAXRUN       64      /* Max segments read in one request */
 #define DFX_V           (UNIT_V_UF + 1)
-#define MODIB_V         (UNIT_V_UF + 2)
+#define MODIB_V         (DKUF_V_UF + 0)
+#define BURST_V         (DKUF_V_UF + 1)
 #define DFX             (1 << DFX_V)
 #define MODIB           (1 << MODIB_V)
+#define BURST           (1 << BURST_V)
 
 t_stat              dsk_cmd(uint16, uint16, uint8, uint16 *);
 t_stat              dsk_srv(UNIT *);
@@ -69,7 +73,18 @@ t_stat              esu_detach(UNIT *);
 t_stat              esu_help (FILE *, DEVICE *, UNIT *, int32, const char *);
 const char         *esu_description (DEVICE *);
 
-uint8               dsk_buffer[NUM_DEVS_DSK][DK_SEC_SIZE];
+void                esu_io_done(UNIT *, t_stat);
+
+/* Each controller has one buffer, which holds a run of segments for reads */
+uint8               dsk_buffer[NUM_DEVS_DSK][DK_MAXRUN * DK_SEC_SIZE];
+UNIT               *dsk_pend[NUM_DEVS_DSK];   /* Unit with request on buffer */
+int                 dsk_run[NUM_DEVS_DSK];    /* Segments in buffer */
+t_seccnt            dsk_sread[NUM_DEVS_DSK];  /* Segments read from file */
+t_lba               dsk_rlba[NUM_DEVS_DSK];   /* First segment in buffer */
+uint8               dsk_err[NUM_DEVS_DSK];    /* Request failed */
+/* A file that ends part way through a segment, sim_disk reads zeros there */
+t_lba               esu_tseg[20];             /* Partial last segment */
+int                 esu_tlen[20];             /* Characters in it, 0 none */
 t_stat              set_mod(UNIT *uptr, int32 val, CONST char *cptr, 
                         void *desc);
 
@@ -104,6 +119,13 @@ MTAB                esu_mod[] = {
            "Sets ESU to Fast Mod I drive"},
     {MODIB, MODIB, "MODIB", "MODIB", &set_mod, NULL, NULL,
            "Sets ESU to Slow Mod IB drive"},
+    {BURST, 0, NULL, "NOBURST", NULL, NULL, NULL,
+           "Move one segment per event (default)"},
+    {BURST, BURST, "BURST", "BURST", NULL, NULL, NULL,
+           "Move all segments of a transfer per event"},
+    {MTAB_XTD|MTAB_VUN|MTAB_VALR, 0, "CACHE", "CACHE=size",
+           &sim_disk_set_cache, &sim_disk_show_cache, NULL,
+           "Set size of segment cache in K/M bytes, 0 disables"},
     {0}
 };
 
@@ -113,7 +135,7 @@ DEVICE              esu_dev = {
     20, 8, 15, 1, 8, 8,
     NULL, NULL, NULL, NULL, &esu_attach, &esu_detach,
     NULL, DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &esu_help, NULL, NULL, &esu_description
+    NULL, NULL, &esu_help, &sim_disk_attach_help, NULL, &esu_description
 };
 
 MTAB                dsk_mod[] = {
@@ -275,6 +297,8 @@ t_stat dsk_srv(UNIT * uptr)
             eptr->u3 = (uptr->u5 & DK_WR) ? 0 : DK_SEC_SIZE;
             eptr->u4 = uptr->u4;        /* Disk address */
             eptr->u5 = uptr->u5;        /* Command */
+            eptr->u6 = 0;               /* Segment in buffer */
+            dsk_run[uptr - dsk_unit] = 0;
             if (uptr->u5 & DK_RDCK) {
                 uptr->u5 = 0;
                 chan_set_end(chan);
@@ -302,6 +326,31 @@ void esu_set_end(UNIT *uptr, int err) {
         chan_set_end(chan);
 }
         
+/* Completion of a sim_disk request on the controller buffer.  Called
+   directly for synchronous units, else before the unit is next serviced. */
+void esu_io_done(UNIT *uptr, t_stat r) {
+        int             dsk = ((uptr->u5 & DK_CTRL) != 0);
+        int             u = uptr - esu_unit;
+        int             i;
+
+        if (dsk_pend[dsk] != uptr)
+            return;
+        dsk_pend[dsk] = NULL;
+        if (r != SCPE_OK) {
+            dsk_err[dsk] = 1;
+            return;
+        }
+        /* Segments beyond the end of the file read as blanks */
+        if (uptr->u5 & DK_RD) {
+            i = dsk_sread[dsk] * DK_SEC_SIZE;
+            if (esu_tlen[u] != 0 && esu_tseg[u] >= dsk_rlba[dsk] &&
+                esu_tseg[u] < dsk_rlba[dsk] + dsk_sread[dsk])
+                i = (esu_tseg[u] - dsk_rlba[dsk]) * DK_SEC_SIZE + esu_tlen[u];
+            for (; i < dsk_run[dsk] * DK_SEC_SIZE; i++)
+                dsk_buffer[dsk][i] = (uptr->u5 & DK_BIN) ? 0 :020;
+        }
+}
+        
 /* Handle processing esu controller commands */
 t_stat esu_srv(UNIT * uptr)
 {
@@ -309,50 +358,93 @@ t_stat esu_srv(UNIT * uptr)
     DEVICE              *dptr = find_dev_from_unit(uptr);
     int                 u = uptr - esu_unit;
     int                 dsk = ((uptr->u5 & DK_CTRL) != 0);
-    int                 wc;
+    uint8               *buf;
+    int                 n;
+    int                 cnt;
+    int                 seg;
+    int                 delay = (uptr->flags & MODIB) ? 200 :100;
     
+    /* A completion can wake the unit after the transfer has ended */
+    if ((uptr->u5 & (DK_RDCK|DK_RD|DK_WR)) == 0)
+        return SCPE_OK;
+
+    /* Wait for the request on the buffer, its completion wakes us */
+    if (dsk_pend[dsk] == uptr)
+        return SCPE_OK;
+    if (dsk_err[dsk]) {
+        dsk_err[dsk] = 0;
+        esu_set_end(uptr, 1);
+        return SCPE_OK;
+    }
  
     /* Process for each unit */
     if (uptr->u5 & DK_RD) {
-        /* Check if at start of segment */
-        if (uptr->u3 >= DK_SEC_SIZE) {
-            int         da = (uptr->u4 * DK_SEC_SIZE);
-
-            /* Check if end of operation */
-            if ((uptr->u5 & (DK_SECMASK)) == 0) {
-                esu_set_end(uptr, 0);
-                return SCPE_OK;
+        n = 0;
+        do {
+            /* Check if at start of segment */
+            if (uptr->u3 >= DK_SEC_SIZE) {
+                /* Check if end of operation, once the characters
+                   already moved have had their time */
+                if ((uptr->u5 & (DK_SECMASK)) == 0) {
+                    if (n != 0)
+                        break;
+                    esu_set_end(uptr, 0);
+                    return SCPE_OK;
+                }
+
+                /* Check if over end of disk */
+                if (uptr->u4 >= uptr->wait) {
+                    if (n != 0)
+                        break;
+                    sim_debug(DEBUG_DETAIL, dptr, "Disk read over %d %d %o\n\r",
+                                     uptr->u3, uptr->u4, uptr->u5);
+                    chan_set_eof(chan);
+                    esu_set_end(uptr, 0);
+                    return SCPE_OK;
+                }
+                sim_debug(DEBUG_DETAIL, dptr, "Disk read %d %d %d %o\n\r",
+                                     u, uptr->u3, uptr->u4, uptr->u5);
+        
+                /* Take the next segment from the buffer, reading all
+                   the segments left in the command when it runs out */
+                if (++uptr->u6 >= dsk_run[dsk]) {
+                    seg = (uptr->u5 & DK_SECMASK) / DK_SECT;
+                    if (seg > uptr->wait - uptr->u4)
+                        seg = uptr->wait - uptr->u4;
+                    uptr->u6 = 0;
+                    dsk_run[dsk] = seg;
+                    dsk_sread[dsk] = 0;
+                    dsk_pend[dsk] = uptr;
+                    dsk_rlba[dsk] = uptr->u4;
+                    (void)sim_disk_rdsect_a(uptr, uptr->u4, &dsk_buffer[dsk][0],
+                                      &dsk_sread[dsk], seg, &esu_io_done);
+                }
+                uptr->u3 = 0;
+                uptr->u4++; /* Advance disk address */
+                uptr->u5 -= DK_SECT;
+                if (dsk_pend[dsk] == uptr || dsk_err[dsk])
+                    break;
             }
 
-            /* Check if over end of disk */
-            if (uptr->u4 >= uptr->wait) {
-                sim_debug(DEBUG_DETAIL, dptr, "Disk read over %d %d %o\n\r",
-                                 uptr->u3, uptr->u4, uptr->u5);
-                chan_set_eof(chan);
-                esu_set_end(uptr, 0);
-                return SCPE_OK;
-            }
-            sim_debug(DEBUG_DETAIL, dptr, "Disk read %d %d %d %o %d\n\r",
-                                 u,uptr->u3, uptr->u4, uptr->u5, da);
-        
-            if (sim_fseek(uptr->fileref, da, SEEK_SET) < 0) {
-                esu_set_end(uptr, 1);
-                return SCPE_OK;
+            /* Transfer rest of segment, taking as long as it would a
+               character at a time */
+            buf = &dsk_buffer[dsk][uptr->u6 * DK_SEC_SIZE];
+            if (chan_write_block(chan, &buf[uptr->u3],
+                                 DK_SEC_SIZE - uptr->u3, &cnt)) {
+                uptr->u3 += cnt;
+                n += cnt;
+                if (n == 0) {
+                    esu_set_end(uptr, 0);
+                    return SCPE_OK;
+                }
+                break;
             }
-            wc = sim_fread(&dsk_buffer[dsk][0], 1, DK_SEC_SIZE,
-                                 uptr->fileref);
-            for (; wc < DK_SEC_SIZE; wc++) 
-                dsk_buffer[dsk][wc] = (uptr->u5 & DK_BIN) ? 0 :020;
-            uptr->u3 = 0;
-            uptr->u4++; /* Advance disk address */
-            uptr->u5 -= DK_SECT;
-        }
-        /* Transfer one Character */
-        if (chan_write_char(chan, &dsk_buffer[dsk][uptr->u3], 0)) {
-                esu_set_end(uptr, 0);
-                return SCPE_OK;
-        }
-        uptr->u3++;
+            uptr->u3 += cnt;
+            n += cnt;
+        } while (uptr->flags & BURST);
+        if (n != 0 || dsk_pend[dsk] != uptr)
+            sim_activate(uptr, (n ? n : 1) * delay);
+        return SCPE_OK;
     }
 
     if (uptr->u5 & DK_RDCK) {
@@ -380,59 +472,63 @@ t_stat esu_srv(UNIT * uptr)
                 return SCPE_OK;
             }
         }
-        /* Check if at end of segment */
-        uptr->u3++;
+        /* Skip over the segment */
+        n = DK_SEC_SIZE - uptr->u3;
+        uptr->u3 = DK_SEC_SIZE;
+        sim_activate(uptr, n * delay);
+        return SCPE_OK;
     }
 
     /* Process for each unit */
     if (uptr->u5 & DK_WR) {
-        /* Check if end of operation */
-        if ((uptr->u5 & (DK_SECMASK)) == 0) {
-            esu_set_end(uptr, 0);
-            return SCPE_OK;
-        }
-
-        /* Transfer one Character */
-        if (chan_read_char(chan, &dsk_buffer[dsk][uptr->u3], 0)) {
-            if (uptr->u3 != 0) {
-                while (uptr->u3 < DK_SEC_SIZE) 
-                    dsk_buffer[dsk][uptr->u3++] = (uptr->u5 & DK_BIN) ? 0 :020;
+        n = 0;
+        buf = &dsk_buffer[dsk][0];
+        do {
+            /* Check if end of operation */
+            if ((uptr->u5 & (DK_SECMASK)) == 0) {
+                if (n != 0)
+                    break;
+                esu_set_end(uptr, 0);
+                return SCPE_OK;
             }
-        } 
-        uptr->u3++;
 
-        /* Check if at end of segment */
-        if (uptr->u3 >= DK_SEC_SIZE) {
-           int  da = (uptr->u4 * DK_SEC_SIZE);
-
-           /* Check if over end of disk */
-           if (uptr->u4 >= uptr->wait) {
-               sim_debug(DEBUG_DETAIL, dptr, "Disk write over %d %d %o\n\r", 
-                           uptr->u3, uptr->u4, uptr->u5);
-               chan_set_eof(chan);
-               esu_set_end(uptr, 0);
-               return SCPE_OK;
-           }
-        
-           sim_debug(DEBUG_DETAIL, dptr, "Disk write %d %d %d %o %d\n\r",
-                            u, uptr->u3, uptr->u4, uptr->u5, da);
-           if (sim_fseek(uptr->fileref, da, SEEK_SET) < 0) {
-               esu_set_end(uptr, 1);
-               return SCPE_OK;
-           }
+            /* Fill the segment, padding it out once the channel ends */
+            if (chan_read_block(chan, &buf[uptr->u3], DK_SEC_SIZE - uptr->u3,
+                                &cnt)) {
+                uptr->u3 += cnt;
+                if (uptr->u3 != 0) {
+                    while (uptr->u3 < DK_SEC_SIZE) 
+                        buf[uptr->u3++] = (uptr->u5 & DK_BIN) ? 0 :020;
+                }
+            } else 
+                uptr->u3 += cnt;
+            n += cnt;
+
+            /* Check if over end of disk */
+            if (uptr->u4 >= uptr->wait) {
+                sim_debug(DEBUG_DETAIL, dptr, "Disk write over %d %d %o\n\r", 
+                            uptr->u3, uptr->u4, uptr->u5);
+                chan_set_eof(chan);
+                esu_set_end(uptr, 0);
+                return SCPE_OK;
+            }
         
-           wc = sim_fwrite(&dsk_buffer[dsk][0], 1, DK_SEC_SIZE, 
-                                   uptr->fileref);
-           if (wc != DK_SEC_SIZE) {
-               esu_set_end(uptr, 1);
-               return SCPE_OK;
-           }
-           uptr->u3 = 0;
-           uptr->u4++;  /* Advance disk address */
-           uptr->u5 -= DK_SECT;
-        } 
+            sim_debug(DEBUG_DETAIL, dptr, "Disk write %d %d %d %o\n\r",
+                             u, uptr->u3, uptr->u4, uptr->u5);
+            /* The buffer is not touched again until the write completes */
+            /* Writing at or past the partial segment fills it out */
+            if (uptr->u4 >= esu_tseg[u])
+                esu_tlen[u] = 0;
+            dsk_pend[dsk] = uptr;
+            (void)sim_disk_wrsect_a(uptr, uptr->u4, buf, NULL, 1, &esu_io_done);
+            uptr->u3 = 0;
+            uptr->u4++;  /* Advance disk address */
+            uptr->u5 -= DK_SECT;
+        } while ((uptr->flags & BURST) && dsk_pend[dsk] != uptr &&
+                 dsk_err[dsk] == 0);
+        sim_activate(uptr, (n ? n : 1) * delay);
+        return SCPE_OK;
     }
-    sim_activate(uptr, (uptr->flags & MODIB) ? 200 :100);
     return SCPE_OK;
 }
                 
@@ -470,8 +566,16 @@ esu_attach(UNIT * uptr, CONST char *file)
     t_stat              r;
     int                 u = uptr-esu_unit;
 
-    if ((r = attach_unit(uptr, file)) != SCPE_OK)
+    if ((r = sim_disk_attach(uptr, file, DK_SEC_SIZE, 1, TRUE, 0, "ESU",
+                             0, 0)) != SCPE_OK)
         return r;
+    esu_tlen[u] = 0;
+    if (DK_GET_FMT (uptr) == DKUF_F_STD) {
+        t_offset        size = sim_fsize_ex(uptr->fileref);
+
+        esu_tseg[u] = (t_lba)(size / DK_SEC_SIZE);
+        esu_tlen[u] = (int)(size % DK_SEC_SIZE);
+    }
     if (u < 10) {
         iostatus |= DSK1_FLAG;
     }
@@ -488,7 +592,12 @@ esu_detach(UNIT * uptr)
     int                 u = uptr-esu_unit;
     int                 i, mask, lim;
 
-    if ((r = detach_unit(uptr)) != SCPE_OK)
+    sim_cancel(uptr);
+    if (dsk_pend[0] == uptr)
+        dsk_pend[0] = NULL;
+    if (dsk_pend[1] == uptr)
+        dsk_pend[1] = NULL;
+    if ((r = sim_disk_detach(uptr)) != SCPE_OK)
         return r;
     /* Determine which controller */
     if (u < 10) {
@@ -563,6 +672,13 @@ esu_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
   fprintf (st, "     sim> SET ESUn MODIB       before the unit is attached\n");
   fprintf (st, "To use smaller faster drives do (default):\n");
   fprintf (st, "     sim> SET ESUn MODI        before the unit is attached\n\n");
+  fprintf (st, "Normally each segment takes an event of its own.  With\n");
+  fprintf (st, "     sim> SET ESUn BURST\n");
+  fprintf (st, "a whole transfer is moved in one event and the end of the transfer\n");
+  fprintf (st, "is still posted after the time the segments would have taken.\n");
+  fprintf (st, "Reads fetch all the segments of a transfer in one request, and with\n");
+  fprintf (st, "SET ESUn CACHE=size recently used segments are kept in memory.  Host\n");
+  fprintf (st, "I/O is done in the background if SET ASYNCH is given.\n\n");
   fprint_set_help (st, dptr) ;
   fprint_show_help (st, dptr) ;
   return SCPE_OK;
@@ -26,7 +26,7 @@
 #if (NUM_DEVS_DR > 0) 
 
 #define UNIT_DR         UNIT_ATTABLE | UNIT_DISABLE | UNIT_FIX | \
-                        UNIT_BUFABLE | UNIT_MUSTBUF
+                        UNIT_BUFABLE | UNIT_MUSTBUF | UNIT_ROABLE
 
 
 /* in u3 is device address */
@@ -38,6 +38,7 @@
 #define DR_RDY          000040  /* Device Ready */
 
 #define AUXMEM          (1 << UNIT_V_UF)
+#define MAPPED          (1 << (UNIT_V_UF + 1))  /* filebuf maps the file */
 
 t_stat              drm_srv(UNIT *);
 t_stat              drm_boot(int32, DEVICE *);
@@ -93,6 +94,12 @@ t_stat drm_cmd(uint16 cmd, uint16 dev, uint8 chan, uint16 *wc, uint8 rd_flg)
         return SCPE_UNATT;
     }
 
+    /* A read only drum can't be written */
+    if (rd_flg == 0 && (uptr->flags & UNIT_RO)) {
+        sim_debug(DEBUG_CMD, &drm_dev, "Drum write locked\n\r");
+        return SCPE_UNATT;
+    }
+
     /* Check if drive is ready to recieve a command */
     if ((uptr->u5 & DR_RDY) == 0) 
         return SCPE_BUSY;
@@ -115,10 +122,28 @@ t_stat drm_srv(UNIT * uptr)
 {
     int                 chan = uptr->u5 & DR_CHAN;
     uint8               *ch = &(((uint8 *)uptr->filebuf)[uptr->u4]);
+    int                 len = ((int32)uptr->capac << 3) - uptr->u4;
+    int                 n;
     
  
     /* Process for each unit */
     if (uptr->u5 & DR_RD) {
+        /* Move as much as will go, taking as long as it would a
+           character at a time */
+        (void)chan_write_drum_block(chan, ch, len, &n);
+        if (n != 0) {
+            uptr->u4 += n;
+            sim_activate(uptr, n * 40);
+            return SCPE_OK;
+        }
+        /* Check before touching the character past the end */
+        if (len <= 0) {
+                sim_debug(DEBUG_CMD, &drm_dev, "Drum overrun\n\r");
+                uptr->u5 = DR_RDY;
+                chan_set_error(chan);
+                chan_set_end(chan);
+                return SCPE_OK;
+        }
         /* Transfer one Character */
         if (chan_write_drum(chan, ch, 0)) {
                 uptr->u5 = DR_RDY;
@@ -138,6 +163,19 @@ t_stat drm_srv(UNIT * uptr)
 
     /* Process for each unit */
     if (uptr->u5 & DR_WR) {
+        (void)chan_read_drum_block(chan, ch, len, &n);
+        if (n != 0) {
+            uptr->u4 += n;
+            sim_activate(uptr, n * 40);
+            return SCPE_OK;
+        }
+        if (len <= 0) {
+                sim_debug(DEBUG_CMD, &drm_dev, "Drum overrun\n\r");
+                uptr->u5 = DR_RDY;
+                chan_set_error(chan);
+                chan_set_end(chan);
+                return SCPE_OK;
+        }
         /* Transfer one Character */
         if (chan_read_drum(chan, ch, 0)) {
                 uptr->u5 = DR_RDY;
@@ -175,8 +213,34 @@ drm_attach(UNIT * uptr, CONST char *file)
 {
     t_stat              r;
     int                 u = uptr - drm_unit;
-
-    if ((r = attach_unit(uptr, file)) != SCPE_OK)
+    size_t              size = (size_t)uptr->capac * 8;
+    void                *base;
+
+    /* ATTACH -P maps the file instead of reading it into a buffer */
+    if (sim_switches & SWMASK('P')) {
+        uptr->flags &= ~(UNIT_BUFABLE | UNIT_MUSTBUF);
+        r = attach_unit(uptr, file);
+        uptr->flags |= UNIT_BUFABLE | UNIT_MUSTBUF;
+        if (r != SCPE_OK)
+            return r;
+        if ((uptr->flags & UNIT_RO) == 0 &&
+            sim_fsize_ex(uptr->fileref) < (t_offset)size)
+            sim_set_fsize(uptr->fileref, (t_addr)size);
+        if (sim_fsize_ex(uptr->fileref) >= (t_offset)size &&
+            sim_fmap_file(uptr->fileref, size, (uptr->flags & UNIT_RO) == 0,
+                          &base) == SCPE_OK) {
+            uptr->filebuf = base;
+            uptr->flags |= UNIT_BUF | MAPPED;
+        } else {
+            /* Can't map it, so buffer it as usual */
+            detach_unit(uptr);
+            sim_messagef(SCPE_OK, "%s: can't map %s, buffering it\n",
+                         sim_uname(uptr), file);
+            sim_switches &= ~SWMASK('P');
+            if ((r = attach_unit(uptr, file)) != SCPE_OK)
+                return r;
+        }
+    } else if ((r = attach_unit(uptr, file)) != SCPE_OK)
         return r;
     uptr->u5 |= DR_RDY; 
     uptr->hwmark = uptr->capac;
@@ -192,6 +256,13 @@ drm_detach(UNIT * uptr)
 {
     t_stat              r;
     int                 u = uptr - drm_unit;
+
+    /* The file already holds everything, so just drop the mapping */
+    if (uptr->flags & MAPPED) {
+        sim_fmap_unmap(uptr->filebuf, (size_t)uptr->capac * 8);
+        uptr->filebuf = NULL;
+        uptr->flags &= ~(UNIT_BUF | MAPPED);
+    }
     if ((r = detach_unit(uptr)) != SCPE_OK)
         return r;
     uptr->u5 = 0;
@@ -219,7 +290,7 @@ set_auxmem(UNIT * uptr, int32 val, CONST char *cptr, void *desc) {
     if (uptr->flags & AUXMEM)
         return SCPE_OK;
     if (uptr->flags & UNIT_ATT) 
-        detach_unit(uptr);
+        drm_detach(uptr);
     uptr->flags &= ~UNIT_ATTABLE;
     if (uptr->filebuf == 0) {
         uptr->filebuf = calloc(uptr->capac, 8);
@@ -245,6 +316,12 @@ drm_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
   fprintf (st, "to DRUM it must be attached to a file which it will buffer until\n");
   fprintf (st, "the unit is detached, or the sim exits. MCP must be configured to\n");
   fprintf (st, "the drum\n\n");
+  fprintf (st, "Attaching with -P maps the file into memory instead:\n\n");
+  fprintf (st, "     sim> ATTACH -P DR0 drum0.dr\n\n");
+  fprintf (st, "Drum writes go straight to the file, so nothing is lost if the sim\n");
+  fprintf (st, "stops unexpectedly, and detach has nothing to write back. With -R\n");
+  fprintf (st, "as well several sims can share one drum image, which they can only\n");
+  fprintf (st, "read.\n\n");
   fprint_set_help (st, dptr) ;
   fprint_show_help (st, dptr) ;
   return SCPE_OK;
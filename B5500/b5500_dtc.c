@@ -164,6 +164,7 @@ uint8               dtc_lstatus[DTC_MLINES];                    /* Line status *
 uint16              dtc_bufptr[DTC_MLINES];                     /* Buffer pointer */
 uint16              dtc_bsize[DTC_MLINES];                      /* Buffer size */
 uint16              dtc_blimit[DTC_MLINES];                     /* Buffer size */
+uint32              dtc_active;                                 /* Lines to poll */
 int                 dtc_bufsize = DTC_BUFSIZ;
 
 
@@ -506,32 +507,43 @@ t_stat dtc_srv(UNIT * uptr)
 
 /* Unit service - receive side
 
-   Poll all active lines for input
-   Poll for new connections */
+   Poll for new connections
+   Poll lines that are connected or still winding down a disconnect,
+   only those are in dtc_active.  Any number of line events in one
+   poll post a single interrupt. */
 
 t_stat
 dtco_srv(UNIT * uptr)
 {
     int                 c, ln, t, c1;
+    int                 irq = 0;
+    uint32              m;
 
     sim_clock_coschedule(uptr, tmxr_poll);
     ln = tmxr_poll_conn(&dtc_desc);     /* look for connect */
     if (ln >= 0) {              /* got one? */
         dtc_blimit[ln] = dtc_bufsize-1;
         dtc_lstatus[ln] = BufIRQ|BufAbnormal|BufWriteRdy;
-        IAR |= IRQ_12;
+        dtc_active |= (uint32)1 << ln;
+        irq = 1;
         sim_debug(DEBUG_DETAIL, &dtc_dev, "Datacomm connect %d\n", ln);
     } 
 
+    /* Nothing to do until someone connects */
+    if (dtc_active == 0)
+        return SCPE_OK;
+
     /* For each line that is in idle state enable recieve */
-    for (ln = 0; ln < dtc_desc.lines; ln++) {
-        if (dtc_ldsc[ln].conn &&
+    for (ln = 0, m = dtc_active; m != 0; ln++, m >>= 1) {
+        if ((m & 1) && dtc_ldsc[ln].conn &&
                 (dtc_lstatus[ln] & BufSMASK) == BufIdle) {
            dtc_ldsc[ln].rcve = 1;
         }
     }
     tmxr_poll_rx(&dtc_desc);    /* poll for input */
-    for (ln = 0; ln < DTC_MLINES; ln++) {       /* loop thru mux */
+    for (ln = 0, m = dtc_active; m != 0; ln++, m >>= 1) { /* loop thru mux */
+        if ((m & 1) == 0)
+            continue;
         /* Check for disconnect */
         if (dtc_ldsc[ln].conn == 0) {   /* connected? */
              switch(dtc_lstatus[ln] & BufSMASK) {
@@ -542,12 +554,15 @@ dtco_srv(UNIT * uptr)
                   dtc_buf[ln][dtc_bufptr[ln]++] = 017;
                   dtc_bsize[ln] = dtc_bufptr[ln];
                   dtc_lstatus[ln] = BufIRQ|BufAbnormal|BufReadRdy;
-                  IAR |= IRQ_12;
+                  irq = 1;
                   break;
              case BufOutBusy:           /* Terminate Output */
                   dtc_lstatus[ln] = BufIRQ|BufIdle;
                   dtc_bsize[ln] = 0;
-                  IAR |= IRQ_12;
+                  irq = 1;
+                  break;
+             case BufNotReady:          /* All done, stop polling it */
+                  dtc_active &= ~((uint32)1 << ln);
                   break;
              default:                   /* Other cases, ignore until 
                                            in better state */
@@ -576,7 +591,7 @@ dtco_srv(UNIT * uptr)
                  case '\005':   /* ^E ENQ who-are-you */
                        dtc_lstatus[ln] &= ~(BufSMASK);
                        dtc_lstatus[ln] |= BufIRQ|BufAbnormal|BufWriteRdy;
-                       IAR |= IRQ_12;
+                       irq = 1;
                        sim_debug(DEBUG_DETAIL, &dtc_dev, 
                                         "Datacomm recieve ENQ %d\n", ln);
                        t = 0;
@@ -588,7 +603,7 @@ dtco_srv(UNIT * uptr)
                        dtc_buf[ln][1] = 017;
                        dtc_buf[ln][2] = 077;
                        dtc_bsize[ln] = 1;
-                       IAR |= IRQ_12;
+                       irq = 1;
                        t = 0;
                        break;
                  case '}':
@@ -604,7 +619,7 @@ dtco_srv(UNIT * uptr)
                         /* Force at least one character for GM */
                        dtc_buf[ln][dtc_bufptr[ln]++] = 077;
                        dtc_bsize[ln] = dtc_bufptr[ln];
-                       IAR |= IRQ_12;
+                       irq = 1;
                        t = 0;
                        c1 = 0;
                        sim_debug(DEBUG_DETAIL, &dtc_dev,
@@ -617,9 +632,7 @@ dtco_srv(UNIT * uptr)
                  case '\b':
                  case 0x7f:
                        if (dtc_bufptr[ln] > 0) {
-                          tmxr_putc_ln(&dtc_ldsc[ln], '\b');
-                          tmxr_putc_ln(&dtc_ldsc[ln], ' ');
-                          tmxr_putc_ln(&dtc_ldsc[ln], '\b');
+                          tmxr_put_buf_ln(&dtc_ldsc[ln], (const uint8 *)"\b \b", 3, NULL);
                           dtc_bufptr[ln]--;
                        } else {
                           tmxr_putc_ln(&dtc_ldsc[ln], '\007');
@@ -650,7 +663,7 @@ dtco_srv(UNIT * uptr)
                        dtc_lstatus[ln] &= ~(BufSMASK);
                        dtc_lstatus[ln] |= BufGM|BufIRQ|BufReadRdy;
                        dtc_bsize[ln] = dtc_bufptr[ln];
-                       IAR |= IRQ_12;
+                       irq = 1;
                        t = 0;
                        break;
                  }
@@ -701,7 +714,7 @@ dtco_srv(UNIT * uptr)
                          ln);
                    dtc_lstatus[ln] = BufIRQ|BufWriteRdy;
                 }
-                IAR |= IRQ_12;
+                irq = 1;
              }
              break;
         default:
@@ -710,6 +723,8 @@ dtco_srv(UNIT * uptr)
         }
     }                           /* end for */
     tmxr_poll_tx(&dtc_desc);    /* poll xmt */
+    if (irq)
+        IAR |= IRQ_12;
 
     return SCPE_OK;
 }
@@ -741,6 +756,7 @@ dtc_attach(UNIT * uptr, CONST char *cptr)
     for (i = 0; i < DTC_MLINES; i++) {
         dtc_lstatus[i] = BufNotReady;   /* Device not connected */
     }
+    dtc_active = 0;
     uptr->u5 = DTC_RDY;
     iostatus |= DTC_FLAG;
     return SCPE_OK;
@@ -27,6 +27,8 @@
 #define USEGM           2
 
 t_stat              chan_reset(DEVICE * dptr);
+static uint8        xlat_bcl_bcd(uint8 c);
+static uint8        xlat_bcd_bcl(uint8 c);
 
 /* Channel data structures
 
@@ -41,6 +43,8 @@ uint8               CC[NUM_CHAN];               /* Channel character count */
 t_uint64            W[NUM_CHAN];                /* Assembly register */
 uint8               status[NUM_CHAN];           /* Channel status */
 uint8               cstatus;                    /* Active status */
+uint8               bcl_bcd[64];                /* BCL to BCD translation */
+uint8               bcd_bcl[64];                /* BCD to BCL translation */
 
 #define WC(x)       (uint16)(((x) & DEV_WC) >> DEV_WC_V)
 #define toWC(x)     (((t_uint64)(x) << DEV_WC_V) & DEV_WC)
@@ -89,6 +93,11 @@ chan_reset(DEVICE * dptr)
     int                 i;
     int                 j = 1;
 
+    for (i = 0; i < 64; i++) {
+        bcl_bcd[i] = xlat_bcl_bcd((uint8)i);
+        bcd_bcl[i] = xlat_bcd_bcl((uint8)i);
+    }
+
     cstatus = 0;
     /* Clear channel assignment */
     for (i = 0; i < NUM_CHAN; i++) {
@@ -371,6 +380,95 @@ chan_set_wc(int chan, uint16 wc) {
 }
 
 
+/* Translate one BCL character to BCD */
+static uint8
+xlat_bcl_bcd(uint8 c) {
+        uint8   cx = c & 060;
+
+        c &= 017;
+        switch(c) {
+        case 0:
+                /* 11-0 -> 01 C */
+                /* 10-0 -> 10 C */
+                /* 01-0 -> 11 0 */
+                /* 00-0 -> 00 C */
+                if (cx != 020)
+                    c = 0xc;
+                break;
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+        case 5:
+        case 6:
+        case 7:
+        case 8:
+        case 9:
+        case 0xd:
+        case 0xe:
+        case 0xf:
+                break;
+        case 0xa:
+                /* 11-A -> 01 0 */
+                /* 10-A -> 10 0 */
+                /* 01-A -> 11 C */
+                /* 00-A -> 00 0 */
+                if (cx == 020)
+                    c = 0xc;
+                else
+                    c = 0;
+                break;
+        case 0xb:
+                c = 0xa;
+                break;
+        case 0xc:
+                c = 0xb;
+                break;
+        }
+        c |= cx ^ ((cx & 020)<<1);
+        return c;
+}
+
+/* Translate one BCD character to BCL */
+static uint8
+xlat_bcd_bcl(uint8 c) {
+        uint8   cx = c & 060;
+        c &= 017;
+        switch(c) {
+        case 0:
+                if (cx != 060)
+                    c = 0xa;
+                break;
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+        case 5:
+        case 6:
+        case 7:
+        case 8:
+        case 9:
+        case 0xd:
+        case 0xe:
+        case 0xf:
+                break;
+        case 0xa:
+                c = 0xb;
+                break;
+        case 0xb:
+                c = 0xc;
+                break;
+        case 0xc:
+                if (cx == 060)
+                   c = 0xa;
+                else
+                   c = 0;
+                break;
+        }
+        c |= cx ^ ((cx & 020)<<1);
+        return c;
+}
+
 /*
         Internal        BCD
         00 0000         00 1010  0000 -> 1010
@@ -466,52 +564,8 @@ int chan_write_char(int chan, uint8 *ch, int flags) {
         }
 
         c = *ch & 077;
-        if ((D[chan] & DEV_BIN) == 0) {
-                /* Translate BCL to BCD */
-                uint8   cx = c & 060;
-        
-                c &= 017;
-                switch(c) {
-                case 0:
-                        /* 11-0 -> 01 C */
-                        /* 10-0 -> 10 C */
-                        /* 01-0 -> 11 0 */
-                        /* 00-0 -> 00 C */
-                        if (cx != 020)
-                            c = 0xc;
-                        break;
-                case 1:
-                case 2:
-                case 3:
-                case 4:
-                case 5:
-                case 6:
-                case 7:
-                case 8:
-                case 9:
-                case 0xd:
-                case 0xe:
-                case 0xf:
-                        break;
-                case 0xa:
-                        /* 11-A -> 01 0 */
-                        /* 10-A -> 10 0 */
-                        /* 01-A -> 11 C */
-                        /* 00-A -> 00 0 */
-                        if (cx == 020)
-                            c = 0xc;
-                        else
-                            c = 0;
-                        break;
-                case 0xb:
-                        c = 0xa;
-                        break;
-                case 0xc:
-                        c = 0xb;
-                        break;
-                }
-                c |= cx ^ ((cx & 020)<<1);
-        }
+        if ((D[chan] & DEV_BIN) == 0)
+                c = bcl_bcd[c];         /* Translate BCL to BCD */
 
         if (D[chan] & DEV_BACK) 
             W[chan] |= ((t_uint64)c) << ((CC[chan]) * 6);
@@ -597,43 +651,8 @@ int chan_read_char(int chan, uint8 *ch, int flags) {
         if (CC[chan] == 8) {
             CC[chan] = 0;
         }
-        if ((D[chan] & DEV_BIN) == 0) {
-                /* Translate BCD to BCL */
-                uint8   cx = c & 060;
-                c &= 017;
-                switch(c) {
-                case 0:
-                        if (cx != 060)
-                            c = 0xa;
-                        break;
-                case 1:
-                case 2:
-                case 3:
-                case 4:
-                case 5:
-                case 6:
-                case 7:
-                case 8:
-                case 9:
-                case 0xd:
-                case 0xe:
-                case 0xf:
-                        break;
-                case 0xa:
-                        c = 0xb;
-                        break;
-                case 0xb:
-                        c = 0xc;
-                        break;
-                case 0xc:
-                        if (cx == 060)
-                           c = 0xa;
-                        else
-                           c = 0;
-                        break;
-                }
-                c |= cx ^ ((cx & 020)<<1);
-        }
+        if ((D[chan] & DEV_BIN) == 0)
+                c = bcd_bcl[c];         /* Translate BCD to BCL */
         *ch = c;
         if ((status[chan] & USEGM) != 0 && (D[chan] & DEV_WCFLG) == 0 && gm) {
             status[chan] |= EOR;
@@ -645,6 +664,100 @@ int chan_read_char(int chan, uint8 *ch, int flags) {
         return 0;
 }
 
+/* Move up to len characters from a device buffer to memory, exactly as
+   that many calls to chan_write_char without flags would. Whole words
+   are packed straight into memory when the channel is on a word boundary.
+   *cnt returns the number of characters taken, a return of 1 indicates
+   the channel refused buf[*cnt].
+*/
+int chan_write_block(int chan, uint8 *buf, int len, int *cnt) {
+        t_uint64        w;
+        uint16          addr;
+        int             i = 0;
+        int             j;
+
+        while (i < len) {
+            if (CC[chan] == 0 && (len - i) >= 8 && (status[chan] & EOR) == 0 &&
+                (D[chan] & (DEV_INHTRF|DEV_BACK)) == 0 &&
+                ((D[chan] & DEV_WCFLG) == 0 || WC(D[chan]) != 0)) {
+                w = 0;
+                if (D[chan] & DEV_BIN) {
+                    for (j = 0; j < 8; j++)
+                        w = (w << 6) | (buf[i + j] & 077);
+                } else {
+                    for (j = 0; j < 8; j++)
+                        w = (w << 6) | bcl_bcd[buf[i + j] & 077];
+                }
+                addr = (uint16)(D[chan] & CORE);
+                M[addr] = W[chan] = w;
+                sim_debug(DEBUG_DATA, &chan_dev, "write(%d, %05o, %016llo)\n", 
+                            chan, addr, w);   
+                i += 8;
+                CC[chan] = 8;
+                if (chan_advance(chan)) {
+                    *cnt = i - 1;
+                    return 1;
+                }
+                W[chan] = 0;
+                continue;
+            }
+            if (chan_write_char(chan, &buf[i], 0)) {
+                *cnt = i;
+                return 1;
+            }
+            i++;
+        }
+        *cnt = len;
+        return 0;
+}
+
+/* Move up to len characters from memory to a device buffer, exactly as
+   that many calls to chan_read_char without flags would. Whole words are
+   unpacked at once when the channel is on a word boundary. *cnt returns
+   the number of characters stored, a return of 1 indicates the channel
+   ended, buf[*cnt] holds the group mark that ended it if any.
+*/
+int chan_read_block(int chan, uint8 *buf, int len, int *cnt) {
+        t_uint64        w;
+        uint16          addr;
+        uint8           c;
+        int             i = 0;
+        int             j;
+
+        while (i < len) {
+            if (CC[chan] == 0 && (len - i) >= 8 && (status[chan] & EOR) == 0 &&
+                (D[chan] & (DEV_INHTRF|DEV_BACK)) == 0) {
+                addr = (uint16)(D[chan] & CORE);
+                if (chan_advance(chan)) {
+                    *cnt = i;
+                    return 1;
+                }
+                sim_debug(DEBUG_DATA, &chan_dev, "read(%d, %05o, %016llo)\n",
+                     chan, addr, W[chan]);   
+                w = W[chan];
+                for (j = 0; j < 8; j++, i++) {
+                    c = 077 & (w >> ((7 - j) * 6));
+                    buf[i] = (D[chan] & DEV_BIN) ? c : bcd_bcl[c];
+                    if (c == 037 && (status[chan] & USEGM) != 0 &&
+                        (D[chan] & DEV_WCFLG) == 0) {
+                        CC[chan] = (j + 1) & 7;
+                        status[chan] |= EOR;
+                        *cnt = i;
+                        return 1;
+                    }
+                }
+                continue;
+            }
+            if (chan_read_char(chan, &buf[i], 0)) {
+                *cnt = i;
+                return 1;
+            }
+            i++;
+        }
+        *cnt = len;
+        return 0;
+}
+
 /* Same as chan_read_char, however we do not check word count 
    nor do we advance it. 
 */
@@ -745,6 +858,39 @@ int chan_write_drum(int chan, uint8 *ch, int flags) {
         return 0;
 }
 
+/* Drum version of chan_write_block */
+int chan_write_drum_block(int chan, uint8 *buf, int len, int *cnt) {
+        t_uint64        w;
+        uint16          addr;
+        int             i = 0;
+        int             j;
+
+        while (i < len) {
+            if (CC[chan] == 0 && (len - i) >= 8 && (status[chan] & EOR) == 0 &&
+                WC(D[chan]) != 0) {
+                w = 0;
+                for (j = 0; j < 8; j++)
+                    w = (w << 6) | (buf[i + j] & 077);
+                addr = (uint16)(D[chan] & CORE);
+                M[addr] = W[chan] = w;
+                i += 8;
+                CC[chan] = 8;
+                if (chan_advance_drum(chan)) {
+                    *cnt = i - 1;
+                    return 1;
+                }
+                continue;
+            }
+            if (chan_write_drum(chan, &buf[i], 0)) {
+                *cnt = i;
+                return 1;
+            }
+            i++;
+        }
+        *cnt = len;
+        return 0;
+}
+
 /* Returns 1 on last character. If it returns 1, the
    character in ch is not valid. If flag is set to 1, then
    this is the last character the device will request.
@@ -773,3 +919,29 @@ int chan_read_drum(int chan, uint8 *ch, int flags) {
         return 0;
 }
 
+/* Drum version of chan_read_block */
+int chan_read_drum_block(int chan, uint8 *buf, int len, int *cnt) {
+        t_uint64        w;
+        int             i = 0;
+        int             j;
+
+        while (i < len) {
+            if (CC[chan] == 0 && (len - i) >= 8 && (status[chan] & EOR) == 0) {
+                if (chan_advance_drum(chan)) {
+                    *cnt = i;
+                    return 1;
+                }
+                w = W[chan];
+                for (j = 0; j < 8; j++)
+                    buf[i++] = 077 & (w >> ((7 - j) * 6));
+                continue;
+            }
+            if (chan_read_drum(chan, &buf[i], 0)) {
+                *cnt = i;
+                return 1;
+            }
+            i++;
+        }
+        *cnt = len;
+        return 0;
+}
@@ -278,6 +278,8 @@ t_stat mt_srv(UNIT * uptr)
     uint8               ch;
     int                 mode;
     t_mtrlnt            loc;
+    int                 n;
+    int                 i;
 
 
     /* Simulate tape load delay */
@@ -357,6 +359,19 @@ t_stat mt_srv(UNIT * uptr)
                 }
             }
         }
+        /* Pass on the characters up to the next 00 or the last one of
+           the record at once, taking as long as one at a time would */
+        for (loc = uptr->u6; (loc + 1) < uptr->hwmark &&
+                             (mt_buffer[chan][loc] & 0177) != 0; loc++);
+        if (loc > (t_mtrlnt)uptr->u6) {
+            (void)chan_write_block(chan, &mt_buffer[chan][uptr->u6],
+                                   loc - uptr->u6, &n);
+            if (n != 0) {
+                uptr->u6 += n;
+                sim_activate(uptr, n * HT);
+                return SCPE_OK;
+            }
+        }
         ch = mt_buffer[chan][uptr->u6++] & 0177;
         /* 00 characters are not transfered in BCD mode */
         if (ch == 0) {
@@ -452,6 +467,26 @@ t_stat mt_srv(UNIT * uptr)
             sim_activate(uptr, 100);
             return mt_error(uptr, chan, MTSE_WRP, dptr);
         }
+        /* Fetch as many characters as the buffer holds at once */
+        (void)chan_read_block(chan, &mt_buffer[chan][uptr->u6],
+                              BUFFSIZE - uptr->u6, &n);
+        if (n != 0) {
+            loc = uptr->u6;
+            for (i = 0; i < n; i++) {
+                ch = mt_buffer[chan][loc + i] & 077;
+                ch |= parity_table[ch];
+                if ((uptr->u5 & MT_BIN)) 
+                    ch ^= 0100;
+                /* Don't write out even parity zeros */
+                if (ch != 0) 
+                    mt_buffer[chan][uptr->u6++] = ch;
+            }
+            sim_debug(DEBUG_DATA, dptr, "Write data unit=%d %d chars\n",
+                      unit, n);
+            uptr->hwmark = uptr->u6;
+            sim_activate(uptr, n * HT);
+            return SCPE_OK;
+        }
         if (chan_read_char(chan, &ch,
                           (uptr->u6 > BUFFSIZE) ? 1 : 0)) {
             reclen = uptr->u6;
@@ -61,6 +61,7 @@
 #define URCSTA_INPUT    0200    /* Console fill buffer from keyboard */
 #define URCSTA_FILL     010000  /* Fill unit buffer */
 #define URCSTA_CMD_V    16
+#define UREC_IOBUF      65536   /* Host buffer for printer and punch files */
 
 #define URCSTA_SKIP     000017  /* Skip mask */
 #define URCSTA_DOUBLE   000020  /* Double space skip */
@@ -97,12 +98,15 @@ t_stat              cdp_attach(UNIT *, CONST char *);
 t_stat              cdp_detach(UNIT *);
 t_stat              cdp_help(FILE *, DEVICE *, UNIT *, int32, const char *);
 const char         *cdp_description(DEVICE *dptr);
+
+char                cdp_iobuf[NUM_DEVS_CDP][UREC_IOBUF];
 #endif
 
 #if NUM_DEVS_LPR  > 0
 struct _lpr_data
 {
     uint8               lbuff[145];     /* Output line buffer */
+    char                iobuf[UREC_IOBUF];      /* Output file buffer */
 }
 lpr_data[NUM_DEVS_LPR];
 
@@ -529,6 +533,8 @@ cdp_attach(UNIT * uptr, CONST char *file)
 
     if ((r = sim_card_attach(uptr, file)) != SCPE_OK)
         return r;
+    /* Let cards collect in a large buffer before they go to the host */
+    setvbuf(uptr->fileref, cdp_iobuf[uptr - cdp_unit], _IOFBF, UREC_IOBUF);
     uptr->u5 = 0;
     iostatus |= PUNCH_FLAG;
     return SCPE_OK;
@@ -655,16 +661,14 @@ print_line(UNIT * uptr, int unit)
 
     case 3:     /* Even lines */
         if ((uptr->u4 & 1) == 1) {
-            sim_fwrite("\r", 1, 1, uptr->fileref);
-            sim_fwrite("\n", 1, 1, uptr->fileref);
+            sim_fwrite("\r\n", 1, 2, uptr->fileref);
             uptr->u4++;
             uptr->u5 &= ~URCSTA_EOF;
         }
         break;
     case 4:     /* Odd lines */
         if ((uptr->u4 & 1) == 0) {
-            sim_fwrite("\r", 1, 1, uptr->fileref);
-            sim_fwrite("\n", 1, 1, uptr->fileref);
+            sim_fwrite("\r\n", 1, 2, uptr->fileref);
             uptr->u4++;
             uptr->u5 &= ~URCSTA_EOF;
         }
@@ -672,8 +676,7 @@ print_line(UNIT * uptr, int unit)
     case 5:     /* Half page */
         while((uptr->u4 != (uptr->capac/2)) ||
               (uptr->u4 != (uptr->capac))) {
-            sim_fwrite("\r", 1, 1, uptr->fileref);
-            sim_fwrite("\n", 1, 1, uptr->fileref);
+            sim_fwrite("\r\n", 1, 2, uptr->fileref);
             uptr->u4++;
             if (((uint32)uptr->u4) > uptr->capac) {
                 uptr->u4 = 1;
@@ -687,8 +690,7 @@ print_line(UNIT * uptr, int unit)
               (uptr->u4 != (uptr->capac/2)) ||
               (uptr->u4 != (uptr->capac/2+uptr->capac/4)) ||
               (uptr->u4 != (uptr->capac))) {
-            sim_fwrite("\r", 1, 1, uptr->fileref);
-            sim_fwrite("\n", 1, 1, uptr->fileref);
+            sim_fwrite("\r\n", 1, 2, uptr->fileref);
             uptr->u4++;
             if (((uint32)uptr->u4) > uptr->capac) {
                 uptr->u4 = 1;
@@ -702,8 +704,7 @@ print_line(UNIT * uptr, int unit)
     case 9:
     case 10:
     case 11:
-        sim_fwrite("\r", 1, 1, uptr->fileref);
-        sim_fwrite("\n", 1, 1, uptr->fileref);
+        sim_fwrite("\r\n", 1, 2, uptr->fileref);
         uptr->u4++;
         break;
     }
@@ -798,6 +799,8 @@ lpr_attach(UNIT * uptr, CONST char *file)
 
     if ((r = attach_unit(uptr, file)) != SCPE_OK)
         return r;
+    /* Lines are written out a page at a time */
+    setvbuf(uptr->fileref, lpr_data[u].iobuf, _IOFBF, UREC_IOBUF);
     uptr->u5 = 0;
     uptr->u4 = 0;
     uptr->u3 = 0;
@@ -471,3 +471,50 @@ chan9_set_attn(int chan, int sel)
     chan9_set_error(chan, mask);
 }
 
+/* ATTACH -P maps the file shared and uses the mapping as the buffer of a
+   UNIT_MUSTBUF unit, instead of reading it in on attach and writing it
+   back on detach.  Writes land in the file as they happen.  A short file
+   is extended to size first.  If the file can't be mapped the unit is
+   buffered as usual. */
+t_stat
+chan_attach_map(UNIT * uptr, CONST char *file, size_t size)
+{
+    t_stat              r;
+    void                *base;
+
+    if ((sim_switches & SWMASK('P')) == 0)
+        return attach_unit(uptr, file);
+    uptr->flags &= ~(UNIT_BUFABLE | UNIT_MUSTBUF);
+    r = attach_unit(uptr, file);
+    uptr->flags |= UNIT_BUFABLE | UNIT_MUSTBUF;
+    if (r != SCPE_OK)
+        return r;
+    if (sim_fsize_ex(uptr->fileref) < (t_offset)size)
+        sim_set_fsize(uptr->fileref, (t_addr)size);
+    if (sim_fsize_ex(uptr->fileref) >= (t_offset)size &&
+        sim_fmap_file(uptr->fileref, size, TRUE, &base) == SCPE_OK) {
+        uptr->filebuf = base;
+        uptr->hwmark = uptr->capac;
+        uptr->flags |= UNIT_BUF | UNIT_MAPPED;
+        return SCPE_OK;
+    }
+    /* Can't map it, so buffer it as usual */
+    detach_unit(uptr);
+    sim_messagef(SCPE_OK, "%s: can't map %s, buffering it\n",
+                 sim_uname(uptr), file);
+    sim_switches &= ~SWMASK('P');
+    return attach_unit(uptr, file);
+}
+
+t_stat
+chan_detach_map(UNIT * uptr, size_t size)
+{
+    /* The file already holds everything, so just drop the mapping */
+    if (uptr->flags & UNIT_MAPPED) {
+        sim_fmap_unmap(uptr->filebuf, size);
+        uptr->filebuf = NULL;
+        uptr->flags &= ~(UNIT_BUF | UNIT_MAPPED);
+    }
+    return detach_unit(uptr);
+}
+
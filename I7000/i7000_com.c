@@ -163,6 +163,7 @@ int             in_head;
 int             in_tail;
 int             in_count;    /* Number of entries in queue */
 int             in_delay = 5000;
+#define COM_INDELAY     5       /* Polls to wait after input before posting */
 
 
 typedef struct 
@@ -693,6 +694,7 @@ t_stat
 comi_svc(UNIT * uptr)
 {
     int32               c, ln, t;
+    int                 got = 0;
     t_stat              r;
 
     if ((uptr->flags & UNIT_ATT) == 0)
@@ -724,6 +726,7 @@ comi_svc(UNIT * uptr)
                 r = com_queue_in(ln, c);
                 if (r != SCPE_OK)
                     return r;   /* queue char, err? */
+                got = 1;
                 if (coml_unit[ln].ECHO && com_ldsc[ln].xmte) {  /* output enabled? */
                     if (coml_unit[ln].flags & UNIT_K35) {       /* KSR-35? */
                         if (islower(c))
@@ -742,6 +745,10 @@ comi_svc(UNIT * uptr)
                 return STOP_NOIFREE;
         }
     }                           /* end for */
+    /* Post new input within a few polls rather than waiting out the
+       full interval, but not during the hold after enable */
+    if (got && in_delay > COM_INDELAY && in_delay <= 50)
+        in_delay = COM_INDELAY;
     tmxr_poll_tx(&com_desc);    /* poll xmt */
     return SCPE_OK;
 }
@@ -896,17 +903,10 @@ com_queue_out(uint32 ln, uint16 * c1)
             com_out_inesc[ln] &= 3;
             switch (c) {
             case '\043':                /* Red */
-               tmxr_putc_ln(&com_ldsc[ln], '\033');     
-               tmxr_putc_ln(&com_ldsc[ln], '[');        
-               tmxr_putc_ln(&com_ldsc[ln], '3');        
-               tmxr_putc_ln(&com_ldsc[ln], '1');        
-               tmxr_putc_ln(&com_ldsc[ln], 'm');        
+               tmxr_put_buf_ln(&com_ldsc[ln], (const uint8 *)"\033[31m", 5, NULL);
                return 0;
             case '\023':                /* Black */
-               tmxr_putc_ln(&com_ldsc[ln], '\033');     
-               tmxr_putc_ln(&com_ldsc[ln], '[');        
-               tmxr_putc_ln(&com_ldsc[ln], '0');        
-               tmxr_putc_ln(&com_ldsc[ln], 'm');        
+               tmxr_put_buf_ln(&com_ldsc[ln], (const uint8 *)"\033[0m", 4, NULL);
                return 0;
             }
             *c1 = c;
@@ -930,17 +930,10 @@ com_queue_out(uint32 ln, uint16 * c1)
         com_out_inesc[ln] = 0;
         switch (c) {
         case '3':               /* Red */
-               tmxr_putc_ln(&com_ldsc[ln], '\033');     
-               tmxr_putc_ln(&com_ldsc[ln], '[');        
-               tmxr_putc_ln(&com_ldsc[ln], '3');        
-               tmxr_putc_ln(&com_ldsc[ln], '1');        
-               tmxr_putc_ln(&com_ldsc[ln], 'm');        
+               tmxr_put_buf_ln(&com_ldsc[ln], (const uint8 *)"\033[31m", 5, NULL);
                return 0;
         case '4':               /* Black */
-               tmxr_putc_ln(&com_ldsc[ln], '\033');     
-               tmxr_putc_ln(&com_ldsc[ln], '[');        
-               tmxr_putc_ln(&com_ldsc[ln], '0');        
-               tmxr_putc_ln(&com_ldsc[ln], 'm');        
+               tmxr_put_buf_ln(&com_ldsc[ln], (const uint8 *)"\033[0m", 4, NULL);
                return 0;
         case ':':               /* Poff */
                coml_unit[ln].ECHO = FALSE;
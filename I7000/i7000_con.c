@@ -271,7 +271,8 @@ con_srv(UNIT *uptr) {
             }
         }
     }
-    sim_activate(uptr, 500);
+    /* Nothing in progress, so the keyboard only needs a look once a tick */
+    sim_clock_coschedule(uptr, 500);
     return SCPE_OK;
 }
 
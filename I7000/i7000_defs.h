@@ -257,6 +257,7 @@ extern DEBTAB crd_debug[];
 #define DEV_BUF_NUM(x)  (((x) & 07) << DEV_V_UF)
 #define GET_DEV_BUF(x)  (((x) >> DEV_V_UF) & 07)
 #define UNIT_V_MODE     (UNIT_V_LOCAL + 1)           /* 1 */
+#define UNIT_MAPPED     (1 << (UNIT_V_LOCAL + 8))    /* filebuf maps file */
 
 /* Specific to channel devices */
 #define UNIT_V_MODEL    (UNIT_V_UF + 0)
@@ -374,6 +375,13 @@ void chan9_clear_error(int chan, int sel);
 void chan9_set_attn(int chan, int sel);
 void chan9_set_error(int chan, uint32 mask);
 
+/* Check if a 7909 can take or give another character right away */
+int chan_burst(int chan);
+
+/* Attach or detach a unit whose buffer is a mapping of the file */
+t_stat chan_attach_map(UNIT *uptr, CONST char *file, size_t size);
+t_stat chan_detach_map(UNIT *uptr, size_t size);
+
 void chan_proc();
 
 #ifdef I7010
@@ -482,6 +490,7 @@ extern DEVICE      coml_dev;
 #ifdef NUM_DEVS_DR      
 extern uint32      drm_cmd(UNIT *, uint16, uint16);
 extern void        drm_ini(UNIT *, t_bool);
+extern void        drm_seek(void);
 extern DIB         drm_dib; 
 extern DEVICE      drm_dev; 
 #endif
@@ -496,6 +505,7 @@ extern DEVICE      dsk_dev;
 #ifdef NUM_DEVS_HD
 extern uint32      hsdrm_cmd(UNIT *, uint16, uint16);
 extern void        hsdrm_ini(UNIT *, t_bool);
+extern void        hsdrm_seek(void);
 extern DIB         hsdrm_dib;
 extern DEVICE      hsdrm_dev; 
 #endif
@@ -51,6 +51,10 @@
 #define FORMAT_OK       (1 << (UNIT_V_LOCAL+0))
 #define HA2_OK          (1 << (UNIT_V_LOCAL+1))
 #define CTSS_BOOT       (1 << (UNIT_V_MODE))
+#define BURST           (1 << (UNIT_V_LOCAL+2))
+#define DSK_MAXBURST    256             /* Most chars moved in one event */
+#define CACHE           (1 << (UNIT_V_LOCAL+3))
+#define DSK_PAGE        4096            /* Size of cache dirty page */
 
 /* Device status information stored in u5 */
 #define DSKSTA_CMD      0x0000100       /* Unit has recieved a cmd */
@@ -115,6 +119,10 @@ t_stat              dsk_set_type(UNIT * uptr, int32 val, CONST char *cptr,
                                  void *desc);
 t_stat              dsk_get_type(FILE * st, UNIT * uptr, int32 v,
                                  CONST void *desc);
+t_stat              dsk_set_cache(UNIT * uptr, int32 val, CONST char *cptr,
+                                 void *desc);
+t_stat              dsk_attach(UNIT *, CONST char *);
+t_stat              dsk_detach(UNIT *);
 t_stat              dsk_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
                         const char *cptr);
 const char          *dsk_description (DEVICE *dptr);
@@ -130,6 +138,8 @@ int                 disk_read(UNIT * uptr, uint8 * data, int chan);
 int                 disk_format(UNIT * uptr, FILE * f, int cyl,
                                 UNIT * base);
 int                 bcd_to_track(uint32 addr);
+int                 disk_io(UNIT * base, t_addr pos, uint8 *buf,
+                                int len, int wr);
 
 /* Data buffer for track */
 uint8               dbuffer[NUM_DEVS_DSK * 4][MAXTRACK];
@@ -145,6 +155,12 @@ uint16              dtrack[NUM_DEVS_DSK * 4];
 
 /* Arm position */
 uint16              arm_cyl[NUM_DEVS_DSK * 4];
+
+/* In memory copy of each pack, with one dirty flag per page */
+uint8               *dsk_cache[NUM_DEVS_DSK];
+uint8               *dsk_dirty[NUM_DEVS_DSK];
+t_addr              dsk_csize[NUM_DEVS_DSK];    /* Size of cache */
+t_addr              dsk_flen[NUM_DEVS_DSK];     /* Length of file in cache */
 uint32              sense[NUM_CHAN * 2];
 uint32              sense_unit[NUM_CHAN * 2];
 uint8               cmd_buffer[NUM_CHAN];       /* Command buffer per channel */
@@ -273,6 +289,16 @@ MTAB                dsk_mod[] = {
 #ifdef I7090
     {CTSS_BOOT, 0, 0, "IBSYS", NULL, NULL, NULL, "IBSYS Boot Card"},
     {CTSS_BOOT, CTSS_BOOT, "CTSS", "CTSS", NULL, NULL, NULL, "CTSS Boot Card"},
+#endif
+    {CACHE, 0, 0, "NOCACHE", &dsk_set_cache, NULL, NULL,
+            "Access pack through host file"},
+    {CACHE, CACHE, "CACHE", "CACHE", &dsk_set_cache, NULL, NULL,
+            "Keep pack in memory while attached"},
+#ifdef I7090
+    {BURST, 0, 0, "NOBURST", NULL, NULL, NULL,
+            "One character per event"},
+    {BURST, BURST, "BURST", "BURST", NULL, NULL, NULL,
+            "Move data as fast as the channel takes it"},
 #endif
     {MTAB_XTD | MTAB_VUN | MTAB_VALR, 0, "TYPE", "TYPE",
      &dsk_set_type, &dsk_get_type, NULL, "Type of disk"},
@@ -290,7 +316,7 @@ MTAB                dsk_mod[] = {
 DEVICE              dsk_dev = {
     "DK", dsk_unit, NULL /* Registers */ , dsk_mod,
     NUM_DEVS_DSK, 8, 15, 1, 8, 8,
-    NULL, NULL, &dsk_reset, &dsk_boot, NULL, NULL,
+    NULL, NULL, &dsk_reset, &dsk_boot, &dsk_attach, &dsk_detach,
     &dsk_dib, DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
     NULL, NULL, &dsk_help, NULL, NULL, &dsk_description
 };
@@ -339,6 +365,7 @@ t_stat dsk_srv(UNIT * uptr)
     UNIT               *base = &dsk_unit[u];
     uint8               ch = 0;
     int                 eor = 0;
+    int                 burst = 1;
 
     chan = UNIT_G_CHAN(base->flags);
     sel = (base->flags & UNIT_SELECT) ? 1 : 0;
@@ -434,6 +461,9 @@ t_stat dsk_srv(UNIT * uptr)
             return SCPE_OK;
         }
         uptr->u5 |= DSKSTA_WRITE;       /* Flag as write */
+#ifdef I7090
+wrnext:
+#endif
         switch(chan_read_char(chan, &ch, 0)) {
         case TIME_ERROR:
             disk_posterr(uptr, DATA_RESPONSE);
@@ -462,7 +492,21 @@ t_stat dsk_srv(UNIT * uptr)
                 uptr->u5 &= ~(DSKSTA_SCAN | DSKSTA_XFER);
                 chan_set(chan, DEV_REOR|CTL_END);
             } 
-            sim_activate(uptr, us_to_ticks(dsk->datarate));
+#ifdef I7090
+            /* chan_burst runs chan_proc from inside this service routine.
+               dsk_srv already does the same at its top, so the state it
+               can leave behind is nothing new here.  The loop only goes
+               round again while a copy is still active with no end of
+               record, end or sense pending; anything chan_proc started
+               is handled at the next event as it would be without the
+               burst. */
+            if (eor == 0 && (base->flags & BURST) && burst < DSK_MAXBURST &&
+                chan_burst(chan)) {
+                burst++;
+                goto wrnext;
+            }
+#endif
+            sim_activate(uptr, us_to_ticks(burst * dsk->datarate));
             return SCPE_OK;
         }
     }
@@ -477,6 +521,9 @@ t_stat dsk_srv(UNIT * uptr)
             sim_activate(uptr, us_to_ticks(100));
             return SCPE_OK;
         }
+#ifdef I7090
+rdnext:
+#endif
         eor = disk_read(uptr, &ch, chan);
         /* Check if we got error during read */
         if (eor == -1) {
@@ -500,9 +547,16 @@ t_stat dsk_srv(UNIT * uptr)
              break;
         case DATA_OK:
              uptr->u5 |= DSKSTA_DATA;
+#ifdef I7090
+             if (eor == 0 && (base->flags & BURST) && burst < DSK_MAXBURST &&
+                 chan_burst(chan)) {
+                 burst++;
+                 goto rdnext;
+             }
+#endif
              break;
         }
-        sim_activate(uptr, us_to_ticks(dsk->datarate));
+        sim_activate(uptr, us_to_ticks(burst * dsk->datarate));
         return SCPE_OK;
     }
 
@@ -835,7 +889,7 @@ clear_drive:
     /* Do command */
     switch (cmd_buffer[chan]) {
     case DSAI:          /* Set Access Inoperative */
-        detach_unit(base);
+        dsk_detach(base);
         disk_cmderr(up, 0);
         return 1;
     
@@ -1002,7 +1056,6 @@ disk_rblock(UNIT * uptr, int trk)
     int                 u = uptr - dsk_unit;
     struct disk_t      *dsk = &disk_type[uptr->u4];
     UNIT               *base = &dsk_unit[(uptr->u3 >> 8) & 0xf];
-    FILE               *f = base->fileref;
     int                 offset = 0;
     int                 fbase = 0;
 
@@ -1017,8 +1070,8 @@ disk_rblock(UNIT * uptr, int trk)
     }
 
     if (arm_cyl[u] != fmt_cyl[u]) {
-        sim_fseek(f, fbase + arm_cyl[u] * dsk->fbpt, SEEK_SET);
-        sim_fread(fbuffer[u], 1, dsk->fbpt, f);
+        disk_io(base, fbase + arm_cyl[u] * dsk->fbpt, fbuffer[u],
+                dsk->fbpt, 0);
         fmt_cyl[u] = arm_cyl[u];
         print_format(uptr); 
     }
@@ -1026,8 +1079,8 @@ disk_rblock(UNIT * uptr, int trk)
     if (dtrack[u] != trk) {
         sim_debug(DEBUG_DETAIL, &dsk_dev, "unit=%d Read track %d\n", u,
                   trk);
-        sim_fseek(f, offset + trk * dsk->bpt, SEEK_SET);
-        if (sim_fread(dbuffer[u], 1, dsk->bpt, f) != dsk->bpt)
+        if (disk_io(base, offset + trk * dsk->bpt, dbuffer[u], dsk->bpt, 0)
+                 != (int)dsk->bpt)
             memset(dbuffer[u], 0, dsk->bpt);
         dtrack[u] = trk;
     }
@@ -1077,8 +1130,7 @@ disk_wblock(UNIT * uptr)
     sim_debug(DEBUG_DETAIL, &dsk_dev, "unit=%d Write track %d\n",
               u, dtrack[u]);
     /* Write in actualy track data */
-    sim_fseek(f, offset + dtrack[u] * dsk->bpt, SEEK_SET);
-    sim_fwrite(dbuffer[u], 1, dsk->bpt, f);
+    disk_io(base, offset + dtrack[u] * dsk->bpt, dbuffer[u], dsk->bpt, 1);
     uptr->u5 &= ~DSKSTA_DIRTY;
     return 1;
 }
@@ -1213,8 +1265,7 @@ disk_format(UNIT * uptr, FILE * f, int cyl, UNIT * base)
     fbuffer[u][dsk->fbpt-1] = (FMT_END<<6)|(FMT_END<<4)|(FMT_END<<2)|FMT_END;
 
     /* Now write the buffer to the file */
-    sim_fseek(f, offset + cyl * dsk->fbpt, SEEK_SET);
-    sim_fwrite(fbuffer[u], 1, dsk->fbpt, f);
+    disk_io(base, offset + cyl * dsk->fbpt, fbuffer[u], dsk->fbpt, 1);
 
     /* Make sure we did not pass size of track */
     if (out > (int)dsk->bpt)
@@ -1222,6 +1273,37 @@ disk_format(UNIT * uptr, FILE * f, int cyl, UNIT * base)
     return 0;
 }
 
+/* Move data between a buffer and the pack, through the cache if there
+   is one. Returns the number of bytes moved. */
+int
+disk_io(UNIT * base, t_addr pos, uint8 *buf, int len, int wr)
+{
+    int                 u = base - dsk_unit;
+    t_addr              p;
+
+    if (dsk_cache[u] == NULL || pos + len > dsk_csize[u]) {
+        sim_fseek(base->fileref, pos, SEEK_SET);
+        if (wr)
+            return sim_fwrite(buf, 1, len, base->fileref);
+        return sim_fread(buf, 1, len, base->fileref);
+    }
+    if (wr) {
+        memcpy(&dsk_cache[u][pos], buf, len);
+        for (p = pos / DSK_PAGE; p <= (pos + len - 1) / DSK_PAGE; p++)
+            dsk_dirty[u][p] = 1;
+        if (pos + len > dsk_flen[u])
+            dsk_flen[u] = pos + len;
+        return len;
+    }
+    /* Nothing past the end of the file, as a file read would do */
+    if (pos >= dsk_flen[u])
+        return 0;
+    if (pos + len > dsk_flen[u])
+        len = dsk_flen[u] - pos;
+    memcpy(buf, &dsk_cache[u][pos], len);
+    return len;
+}
+
 /* Handle writing of one character to disk */
 int
 disk_write(UNIT * uptr, uint8 data, int chan, int eor)
@@ -1748,8 +1830,84 @@ dsk_reset(DEVICE * dptr)
     return SCPE_OK;
 }
 
+/* Attach a pack, loading it into memory if caching is on */
+t_stat
+dsk_attach(UNIT * uptr, CONST char *file)
+{
+    int                 u = uptr - dsk_unit;
+    struct disk_t      *dsk = &disk_type[uptr->u4];
+    int                 n = 1;
+    t_addr              len;
+    t_stat              r;
+
+    if ((r = attach_unit(uptr, file)) != SCPE_OK)
+        return r;
+    if ((uptr->flags & CACHE) == 0)
+        return SCPE_OK;
+    /* Format area, then data for each arm and module in use */
+    if (dsk->arms > 1)
+        n = 2;
+    if (dsk->mods > 1)
+        n += 2;
+    dsk_csize[u] = (t_addr)dsk->fmtsz * dsk->mods * dsk->arms +
+                   (t_addr)n * dsk->cyl * dsk->track * dsk->bpt;
+    dsk_cache[u] = (uint8 *)calloc(dsk_csize[u], 1);
+    dsk_dirty[u] = (uint8 *)calloc(dsk_csize[u] / DSK_PAGE + 1, 1);
+    if (dsk_cache[u] == NULL || dsk_dirty[u] == NULL) {
+        free(dsk_cache[u]);
+        free(dsk_dirty[u]);
+        dsk_cache[u] = dsk_dirty[u] = NULL;
+        sim_messagef(SCPE_OK, "%s: no memory for cache, using file\n",
+                     sim_uname(uptr));
+        return SCPE_OK;
+    }
+    len = sim_fsize_ex(uptr->fileref);
+    if (len > dsk_csize[u])
+        len = dsk_csize[u];
+    sim_fseek(uptr->fileref, 0, SEEK_SET);
+    dsk_flen[u] = sim_fread(dsk_cache[u], 1, len, uptr->fileref);
+    return SCPE_OK;
+}
+
+/* Write back the pages of the cache that changed, then detach */
+t_stat
+dsk_detach(UNIT * uptr)
+{
+    int                 u = uptr - dsk_unit;
+    t_addr              p, pos, len;
+
+    if (dsk_cache[u] != NULL) {
+        if ((uptr->flags & UNIT_RO) == 0) {
+            for (p = 0; p <= dsk_csize[u] / DSK_PAGE; p++) {
+                if (dsk_dirty[u][p] == 0)
+                    continue;
+                pos = p * DSK_PAGE;
+                len = dsk_flen[u] - pos;
+                if (len > DSK_PAGE)
+                    len = DSK_PAGE;
+                sim_fseek(uptr->fileref, pos, SEEK_SET);
+                sim_fwrite(&dsk_cache[u][pos], 1, len, uptr->fileref);
+            }
+        }
+        free(dsk_cache[u]);
+        free(dsk_dirty[u]);
+        dsk_cache[u] = dsk_dirty[u] = NULL;
+    }
+    return detach_unit(uptr);
+}
+
 /* Disk option setting commands */
 
+t_stat
+dsk_set_cache(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
+{
+    if (uptr == NULL)
+        return SCPE_IERR;
+    if (uptr->flags & UNIT_ATT)
+        return SCPE_ALATT;
+    return SCPE_OK;
+}
+
 t_stat
 dsk_set_type(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
 {
@@ -1873,6 +2031,17 @@ fprintf (st, "\nTo do this:\n");
 fprintf (st, "     sim> SET DKn FORMAT HA2\n");
 fprintf (st, "To prevent accidental formating of the drive use:\n");
 fprintf (st, "     sim> SET DKn NOFORMAT NOHA2\n");
+fprintf (st, "\nA pack can be held in memory while attached, so track reads ");
+fprintf (st, "and writes do\nnot go to the host file. Changed parts are ");
+fprintf (st, "written back on detach. To do\nthis, before attaching:\n");
+fprintf (st, "     sim> SET DKn CACHE\n");
+#ifdef I7090
+fprintf (st, "\nOn a 7909 channel a drive can move data as fast as the ");
+fprintf (st, "channel will take it,\nrather than one character per event. ");
+fprintf (st, "Simulated time still passes at the\ndrive's data rate. ");
+fprintf (st, "To do this:\n");
+fprintf (st, "     sim> SET DKn BURST\n");
+#endif
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 return SCPE_OK;
@@ -59,6 +59,8 @@
 #undef HTSIZE
 #endif
 #define HTSIZE          31731000
+#define HT_MAXWAIT      100000          /* Most wait ms run as one event */
+#define HT_WAITSTEP(w)  (((w) > HT_MAXWAIT) ? HT_MAXWAIT : (w))
 
 /* in u3 is device address */
 /* in u4 is current buffer position */
@@ -332,9 +334,9 @@ t_stat ht_srv(UNIT * uptr)
     sel = (uptr->flags & UNIT_SELECT) ? 1 : 0;
     schan = (chan * 2) + sel;
 
-    /* Handle seeking */
+    /* Handle seeking, the wait is counted in ms and run as one event */
     if (uptr->wait > 0) {
-        uptr->wait--;
+        uptr->wait -= HT_WAITSTEP(uptr->wait);
         if (uptr->wait == 0) {
             if (uptr->u5 & HT_PEND) {
                 chan_set(chan, DEV_REOR|CTL_END);
@@ -347,7 +349,7 @@ t_stat ht_srv(UNIT * uptr)
             uptr->u5 &= ~(HT_PEND | HT_NOTRDY | HT_CMDMSK);
             sim_debug(DEBUG_DETAIL, dptr, "%d Seek done\n", unit);
         } else
-            sim_activate(uptr, us_to_ticks(1000));
+            sim_activate(uptr, us_to_ticks(1000 * HT_WAITSTEP(uptr->wait)));
         return SCPE_OK;
     }
 
@@ -873,7 +875,7 @@ ht_tape_cmd(DEVICE * dptr, UNIT * uptr)
         uptr->u5 &= ~HT_NOTRDY;
         up->wait = 0;
     } else if (up->u5 & HT_CMDMSK) {
-        sim_activate(up, us_to_ticks(1000));
+        sim_activate(up, us_to_ticks(1000 * HT_WAITSTEP(up->wait)));
     } else {
         chan9_set_attn(chan, sel);
     }
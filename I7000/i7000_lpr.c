@@ -73,9 +73,12 @@
 #define URCSTA_LOAD     01000   /* Load flag for 7070 card reader */
 
 
+#define LPR_IOBUF       65536           /* Host buffer for output file */
+
 struct _lpr_data
 {
     uint8               lbuff[145];     /* Output line buffer */
+    char                iobuf[LPR_IOBUF];       /* Output file buffer */
 }
 lpr_data[NUM_DEVS_LPR];
 
@@ -477,6 +480,8 @@ lpr_attach(UNIT * uptr, CONST char *file)
 
     if ((r = attach_unit(uptr, file)) != SCPE_OK)
         return r;
+    setvbuf(uptr->fileref, lpr_data[uptr - lpr_unit].iobuf, _IOFBF,
+            LPR_IOBUF);
     uptr->u5 = 0;
     uptr->u4 = 0;
     return SCPE_OK;
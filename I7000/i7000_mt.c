@@ -50,6 +50,7 @@
 #define MTUF_ONLINE     (1 << UNIT_V_UF_31)
 #define LT              66      /* Time per char low density */
 #define HT              16      /* Time per char high density */
+#define MT_MAXSPACE     10000000 /* Most us of spacing done in one event */
 
 /* in u3 is device address */
 /* in u4 is current buffer position */
@@ -1127,9 +1128,22 @@ t_stat mt_srv(UNIT * uptr)
         chan_clear(chan, STA_TWAIT);
 #endif
         } else {
-            sim_activate(uptr, 
-                 us_to_ticks(((uptr->flags & MTUF_LDN) ?4250:2500) +
-                       (reclen * ((uptr->flags & MTUF_LDN) ?LT:HT))));
+            /* Space back over the rest of the file now, and charge for
+               the whole distance in one event. The mark is stepped back
+               over, so the next event finds it and ends the command.
+               r keeps the status of the first record, the I7010 end of
+               command check below must not see the mark early. */
+            int     t = 0;
+            t_stat  st = r;
+
+            do {
+                t += ((uptr->flags & MTUF_LDN) ?4250:2500) +
+                       (reclen * ((uptr->flags & MTUF_LDN) ?LT:HT));
+            } while (st == MTSE_OK && t < MT_MAXSPACE &&
+                        (st = sim_tape_sprecr(uptr, &reclen)) == MTSE_OK);
+            if (st == MTSE_TMK)
+                (void)sim_tape_sprecf(uptr, &reclen);
+            sim_activate(uptr, us_to_ticks(t));
         }
 #ifdef I7010
         break;
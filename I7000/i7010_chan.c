@@ -367,8 +367,11 @@ chan_proc()
                     sim_debug(DEBUG_EXP, &chan_dev, "chan %d EOR\n",
                               chan);
              if (chan_flags[chan] & DEV_WRITE) {
-                 if ((cmd[chan] & (CHAN_LOAD|CHAN_WM)) == (CHAN_WM|CHAN_LOAD))
-                    M[caddr[chan]++] = 035;
+                 if ((cmd[chan] & (CHAN_LOAD|CHAN_WM)) == (CHAN_WM|CHAN_LOAD)) {
+                    M[caddr[chan]] = 035;
+                    WM_UPDATE(caddr[chan]);
+                    caddr[chan]++;
+                 }
                  caddr[chan]++;
              }
              chan_flags[chan] &= ~(CHS_ATTN|STA_ACTIVE|STA_WAIT|DEV_WRITE|DEV_REOR);
@@ -549,7 +552,9 @@ chan_write_char(int chan, uint8 * data, int flags)
         cmd[chan] &= ~CHAN_WM;
         if ((cmd[chan] & CHAN_LOAD) == 0) 
             ch |= M[caddr[chan]] & WM;
-        M[caddr[chan]++] = ch;
+        M[caddr[chan]] = ch;
+        WM_UPDATE(caddr[chan]);
+        caddr[chan]++;
     }
 
     /* If device gave us an end, terminate transfer */
@@ -559,8 +564,11 @@ chan_write_char(int chan, uint8 * data, int flags)
             chan_flags[chan] |= DEV_DISCO;
         chan_io_status[chan] |= 0100;
         chan_flags[chan] &= ~(DEV_WRITE|STA_ACTIVE);
-        if ((cmd[chan] & (CHAN_LOAD|CHAN_WM)) == (CHAN_WM|CHAN_LOAD))
-           M[caddr[chan]++] = 035;
+        if ((cmd[chan] & (CHAN_LOAD|CHAN_WM)) == (CHAN_WM|CHAN_LOAD)) {
+           M[caddr[chan]] = 035;
+           WM_UPDATE(caddr[chan]);
+           caddr[chan]++;
+        }
         caddr[chan]++;
         return END_RECORD;
         /* If over size of memory, terminate */
@@ -112,6 +112,7 @@ t_stat              rtc_reset(DEVICE * dptr);
 
 /* General registers */
 uint8               M[MAXMEMSIZE] = { 0 };      /* memory */
+t_uint64            wm_map[(MAXMEMSIZE + 63) / 64]; /* word marks of M */
 int32               IAR;                        /* program counter */
 int32               AAR;                        /* A Address Register */
 int32               BAR;                        /* B Address Register */
@@ -422,6 +423,7 @@ void WriteP(uint32 MA, uint8 v) {
         return;
       }
       M[MAR] = v;
+      WM_UPDATE(MAR);
 }
 
 void ReplaceMask(uint32 MA, uint8 v, uint8 mask) {
@@ -457,6 +459,7 @@ void ReplaceMask(uint32 MA, uint8 v, uint8 mask) {
       }
       M[MAR] &= ~mask;
       M[MAR] |= v;
+      WM_UPDATE(MAR);
 }
 
 
@@ -492,6 +495,7 @@ void SetBit(uint32 MA, uint8 v) {
         return;
       }
       M[MAR] |= v;
+      WM_UPDATE(MAR);
 }
 
 void ClrBit(uint32 MA, uint8 v) {
@@ -526,6 +530,7 @@ void ClrBit(uint32 MA, uint8 v) {
         return;
       }
       M[MAR] &= ~v;
+      WM_UPDATE(MAR);
 }
 
 #define UpReg(reg) reg++; if ((reg & AMASK) == MEMSIZE) { \
@@ -542,6 +547,66 @@ void ClrBit(uint32 MA, uint8 v) {
                     reason = STOP_INVADDR; break; \
                 }
 
+/* Bit number of the highest set bit in a non-zero word */
+static int
+wm_high(t_uint64 bits)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(bits);
+#else
+    int         n = 0;
+
+    while (bits >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+/* Find the first word mark at or below a, looking at no more than lim
+   characters. Returns the field length, or 0 if there is none. */
+int
+wm_find(uint32 a, uint32 lim)
+{
+    uint32      low;
+    uint32      w = a >> 6;
+    t_uint64    bits;
+
+    if (lim == 0)
+        return 0;
+    low = a - lim + 1;
+    bits = wm_map[w] & (~((t_uint64)0) >> (63 - (a & 63)));
+    while (bits == 0) {
+        if ((w << 6) <= low)
+            return 0;
+        bits = wm_map[--w];
+    }
+    w = (w << 6) + wm_high(bits);
+    return (w >= low) ? a - w + 1 : 0;
+}
+
+/* Find the length of a move down from a and b that stops on a word mark
+   in the A field (020), the B field (040) or either (060). Returns 0 if
+   no mark turns up before address 0. */
+int
+mov_len(uint32 a, uint32 b, int mode)
+{
+    uint32      lim = (a < b) ? a : b;
+    int         n = 0;
+    int         nb;
+
+    if (mode & 020) {
+        n = wm_find(a, lim);
+        if (n != 0)
+            lim = n;
+    }
+    if (mode & 040) {
+        nb = wm_find(b, lim);
+        if (nb != 0)
+            n = nb;
+    }
+    return n;
+}
+
 t_stat
 sim_instr(void)
 {
@@ -1581,6 +1646,38 @@ sim_instr(void)
                 break;
 
             case OP_MOV:
+                /* A move down to a word mark in unrelocated memory can be
+                   done in one pass, as long as no A character is read
+                   after it has been moved. */
+                if ((op_mod & 010) == 0 && (op_mod & 060) != 0 &&
+                    reloc == 0 && prot_enb == 0 && fault == 0 &&
+                    (uint32)(AAR & AMASK) < MEMSIZE &&
+                    (uint32)(BAR & AMASK) < MEMSIZE) {
+                    uint32      a = AAR & AMASK;
+                    uint32      b = BAR & AMASK;
+                    uint8       cm = 0;
+                    int         n = mov_len(a, b, op_mod & 060);
+
+                    if (n != 0 && (a <= b || a - b >= (uint32)n)) {
+                        if (op_mod & 001)
+                            cm |= 0xf;
+                        if (op_mod & 002)
+                            cm |= 0x30;
+                        if (op_mod & 004)
+                            cm |= WM;
+                        ar = M[a - n + 1];
+                        br = M[b - n + 1];
+                        for (i = 0; i < n; i++) {
+                            M[b - i] = (M[b - i] & ~cm) | (M[a - i] & cm);
+                            WM_UPDATE(b - i);
+                        }
+                        sim_interval -= 4 * n;
+                        STAR = BAR - n + 1;
+                        AAR -= n;
+                        BAR -= n;
+                        break;
+                    }
+                }
 
                 /* Set terminate to false */
                 sign = 1;
@@ -3734,6 +3831,7 @@ cpu_reset(DEVICE * dptr)
     timer_enable = 0;
     cind = 2;
     zind = oind = dind = euind = eoind = 0;
+    sim_register_clock_unit(&cpu_unit);   /* pollers coschedule on the tick */
     return SCPE_OK;
 }
 
@@ -3757,6 +3855,7 @@ cpu_dep(t_value val, t_addr addr, UNIT * uptr, int32 sw)
     if (addr >= MEMSIZE)
         return SCPE_NXM;
     M[addr] = val & (077 | WM);
+    WM_UPDATE(addr);
     return SCPE_OK;
 }
 
@@ -3778,8 +3877,10 @@ cpu_set_size(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
     if ((mc != 0) && (!get_yn("Really truncate memory [N]?", FALSE)))
         return SCPE_OK;
     cpu_unit.capac = val;
-    for (i = MEMSIZE; i < MAXMEMSIZE; i++)
+    for (i = MEMSIZE; i < MAXMEMSIZE; i++) {
         M[i] = 0;
+        WM_UPDATE(i);
+    }
     return SCPE_OK;
 }
 
@@ -32,6 +32,14 @@
 extern uint8            M[MAXMEMSIZE];
 #define WM      0200    /* Word mark in memory */
 
+/* Copy of the word mark bits of M, 64 characters to a word. Anything
+   that stores into M must call WM_UPDATE after the store. */
+extern t_uint64         wm_map[(MAXMEMSIZE + 63) / 64];
+#define WM_UPDATE(a)    { if (M[a] & WM) \
+                              wm_map[(a) >> 6] |= ((t_uint64)1) << ((a) & 63); \
+                          else \
+                              wm_map[(a) >> 6] &= ~(((t_uint64)1) << ((a) & 63)); }
+
 /* Issue a command to a channel */
 int chan_cmd(uint16 dev, uint16 cmd, uint32 addr);
 
@@ -644,6 +644,7 @@ store:
             case 29:            /* SET DR */
                 if (chan_test(0, DEV_SEL)) {
                     drum_addr = (uint32)MA;
+                    drm_seek();
                     chan_clear(0, DEV_FULL);    /* Incase something got
                                                   read while waiting */
                 } else
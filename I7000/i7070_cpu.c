@@ -196,6 +196,20 @@ uint32  dscale[4][16] = {
                                                                    0,0,0,0,0,0}
 };
 
+/* Product of two digits in BCD */
+uint8   dprod[10][10] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09},
+    {0x00, 0x02, 0x04, 0x06, 0x08, 0x10, 0x12, 0x14, 0x16, 0x18},
+    {0x00, 0x03, 0x06, 0x09, 0x12, 0x15, 0x18, 0x21, 0x24, 0x27},
+    {0x00, 0x04, 0x08, 0x12, 0x16, 0x20, 0x24, 0x28, 0x32, 0x36},
+    {0x00, 0x05, 0x10, 0x15, 0x20, 0x25, 0x30, 0x35, 0x40, 0x45},
+    {0x00, 0x06, 0x12, 0x18, 0x24, 0x30, 0x36, 0x42, 0x48, 0x54},
+    {0x00, 0x07, 0x14, 0x21, 0x28, 0x35, 0x42, 0x49, 0x56, 0x63},
+    {0x00, 0x08, 0x16, 0x24, 0x32, 0x40, 0x48, 0x56, 0x64, 0x72},
+    {0x00, 0x09, 0x18, 0x27, 0x36, 0x45, 0x54, 0x63, 0x72, 0x81},
+};
+
 t_uint64 fdmask[11] = {
     0x0000000000LL,
     0xF000000000LL, 0xFF00000000LL, 0xFFF0000000LL, 0xFFFF000000LL, 
@@ -2486,11 +2500,33 @@ int dec_cmp(t_uint64 a, t_uint64 b) {
   return -1;
 }
 
+/* Check that the low 12 digits of a word are all decimal */
+int dec_valid(t_uint64 a) {
+  if (a >> 48)
+      return 0;
+  return (((a + 0x666666666666LL) ^ a ^ 0x666666666666LL)
+                & 0x1111111111110LL) == 0;
+}
+
 /* Do a multiply step */
 void mul_step(t_uint64 *a, t_uint64 b, int c) {
   t_uint64      prod;
+  t_uint64      lo, hi;
   int           i;
 
+  /* With good digits, gather the low and high digits of the ten
+     products into two words and add each once. */
+  if (c <= 9 && dec_valid(*a) && dec_valid(b & DMASK)) {
+      lo = hi = 0;
+      for(i = 0; i < 40; i+=4) {
+          prod = dprod[(b >> i) & 0xf][c];
+          lo |= (prod & 0xf) << i;
+          hi |= (prod >> 4) << (i + 4);
+      }
+      dec_add_noov(a, lo);
+      dec_add_noov(a, hi);
+      return;
+  }
   for(i = 0; i < 40; i+=4) {
       /* Multiply each digit */
       prod = ((b >> i) & 0xf) * c;
@@ -2774,6 +2810,7 @@ cpu_reset(DEVICE * dptr)
     inds = PSIGN;
     pri_enb = 1;
     sim_brk_types = sim_brk_dflt = SWMASK('E');
+    sim_register_clock_unit(&cpu_unit);   /* pollers coschedule on the tick */
     return SCPE_OK;
 }
 
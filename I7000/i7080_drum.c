@@ -51,6 +51,8 @@ uint32              drm_cmd(UNIT *, uint16, uint16);
 t_stat              drm_srv(UNIT *);
 t_stat              drm_boot(int32, DEVICE *);
 void                drm_ini(UNIT *, t_bool);
+t_stat              drm_attach(UNIT * uptr, CONST char *file);
+t_stat              drm_detach(UNIT * uptr);
 t_stat              drm_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
                         const char *cptr);
 const char          *drm_description (DEVICE *dptr);
@@ -63,7 +65,7 @@ UNIT                drm_unit[] = {
 DEVICE              drm_dev = {
     "DR", drm_unit, NULL /* Registers */ , NULL,
     1, 8, 15, 1, 8, 8,
-    NULL, NULL, NULL, &drm_boot, NULL, NULL,
+    NULL, NULL, NULL, &drm_boot, &drm_attach, &drm_detach,
     &drm_dib, DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
     NULL, NULL, &drm_help, NULL, NULL, &drm_description
 };
@@ -175,8 +177,25 @@ drm_ini(UNIT *uptr, t_bool f) {
     uptr->u5 = 0;
 }
 
+t_stat
+drm_attach(UNIT * uptr, CONST char *file)
+{
+    return chan_attach_map(uptr, file, (size_t)uptr->capac);
+}
+
+t_stat
+drm_detach(UNIT * uptr)
+{
+    sim_cancel(uptr);
+    return chan_detach_map(uptr, (size_t)uptr->capac);
+}
+
 t_stat
 drm_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr) {
+   fprintf (st, "The drum is held in memory while it is attached. Attaching with\n");
+   fprintf (st, "-P maps the file instead, so writes go straight to it and nothing\n");
+   fprintf (st, "is lost if the sim stops unexpectedly:\n\n");
+   fprintf (st, "     sim> ATTACH -P DR drum.dr\n\n");
    return SCPE_OK;
 }
 
@@ -242,30 +242,14 @@ sim_load(FILE * fileref, CONST char *cptr, CONST char *fnam, int flag)
     char                buffer[160];
     int                 i, j;
 
-    if (match_ext(fnam, "crd")) {
+    if (match_ext(fnam, "crd") || match_ext(fnam, "cbn")) {
         uint8               image[80];
 
         while (sim_fread(buffer, 1, 160, fileref) == 160) {
             /* Convert bits into image */
-            for (j = i = 0; j < 80; j++) {
+            for (j = i = 0; j < 80; j++, i += 2) {
                 uint16  x;
-                x = buffer[i++];
-                x |= buffer[i++] << 8;
-                image[j] = sim_hol_to_bcd(x);
-            }
-            if (load_rec(image))
-                return SCPE_OK;
-        }
-        return SCPE_OK;
-    } else if (match_ext(fnam, "cbn")) {
-        uint8               image[80];
-
-        while (sim_fread(buffer, 1, 160, fileref) == 160) {
-            /* Convert bits into image */
-            for (j = i = 0; j < 80; j++) {
-                uint16  x;
-                x = buffer[i++];
-                x |= buffer[i++] << 8;
+                x = (uint8)buffer[i] | ((uint8)buffer[i+1] << 8);
                 image[j] = sim_hol_to_bcd(x);
             }
             if (load_rec(image))
@@ -279,7 +263,7 @@ sim_load(FILE * fileref, CONST char *cptr, CONST char *fnam, int flag)
             /* Convert bits into image */
             memset(image, 0, sizeof(image));
             for (j = 0; j < 80; j++) {
-                image[j] = sim_ascii_to_six[buffer[j]];
+                image[j] = sim_ascii_to_six[buffer[j] & 0177];
             }
             if (load_rec(image))
                 return SCPE_OK;
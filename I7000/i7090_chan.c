@@ -332,6 +332,11 @@ chan_proc()
 
     /* Scan channels looking for work */
     for (chan = 0; chan < NUM_CHAN; chan++) {
+        /* Nothing to do for an idle channel with no interrupt pending */
+        if (chan_flags[chan] == 0 && chan_irq[chan] == 0 &&
+                chan_info[chan] == 0)
+            continue;
+
         /* Skip if channel is disabled */
         if (chan_unit[chan].flags & UNIT_DIS)
             continue;
@@ -360,6 +365,7 @@ chan_proc()
             if ((chan_info[chan] & (CHAINF_RUN | CHAINF_START)) ==
                 CHAINF_START) {
                 hsdrm_addr = (int)M[location[chan] - 1];
+                hsdrm_seek();
                 chan_info[chan] |= CHAINF_RUN;
                 if (chan_dev.dctrl & cmask)
                     sim_debug(DEBUG_DETAIL, &chan_dev, "chan %d HDaddr %06o\n",
@@ -1646,6 +1652,43 @@ chan_read_char(int chan, uint8 * data, int flags)
     return DATA_OK;
 }
 
+/*
+ * Let a 7909 move the assembly register to or from memory, so a device
+ * can transfer its next character in the same event. Returns 1 only if
+ * a copy command is in progress and the next character can go without
+ * any command chaining, 0 if the device should wait for its next event.
+ */
+int
+chan_burst(int chan)
+{
+    if (CHAN_G_TYPE(chan_unit[chan].flags) != CHAN_7909)
+        return 0;
+    chan_proc();
+    if (chan_flags[chan] & (DEV_WEOR|DEV_REOR|DEV_DISCO|CHS_ATTN|STA_WAIT|
+                            CTL_END|CTL_SNS))
+        return 0;
+    if ((chan_flags[chan] & STA_ACTIVE) == 0)
+        return 0;
+    switch (cmd[chan]) {
+    case CPYD:
+    case CPYDX:
+    case CPYP:
+    case CPYP2:
+    case CPYP3:
+    case CPYP4:
+        break;
+    default:
+        return 0;
+    }
+    /* Reads need an empty register and more words to fill */
+    if (chan_flags[chan] & CTL_READ)
+        return (chan_flags[chan] & DEV_FULL) == 0 && wcount[chan] != 0;
+    /* Writes need the next word loaded */
+    if (chan_flags[chan] & CTL_WRITE)
+        return (chan_flags[chan] & DEV_FULL) != 0;
+    return 0;
+}
+
 void
 chan9_seqcheck(int chan)
 {
@@ -162,6 +162,7 @@
 
 #define UNIT_V_MSIZE    (UNIT_V_UF + 0)
 #define UNIT_MSIZE      (7 << UNIT_V_MSIZE)
+#define OPTION_TRUECLK  (1 << (UNIT_V_UF + 3))
 #define UNIT_V_CPUMODEL (UNIT_V_UF + 4)
 #define UNIT_MODEL      (0x3 << UNIT_V_CPUMODEL)
 #define CPU_MODEL       ((cpu_unit.flags >> UNIT_V_CPUMODEL) & 0x3)
@@ -214,6 +215,10 @@ t_stat              cpu_show_hist(FILE * st, UNIT * uptr, int32 val,
                                   CONST void *desc);
 t_stat              cpu_set_hist(UNIT * uptr, int32 val, CONST char *cptr,
                                  void *desc);
+t_stat              cpu_show_histfile(FILE * st, UNIT * uptr, int32 val,
+                                  CONST void *desc);
+t_stat              cpu_set_histfile(UNIT * uptr, int32 val, CONST char *cptr,
+                                 void *desc);
 uint32              cpu_cmd(UNIT * uptr, uint16 cmd, uint16 dev);
 t_stat              cpu_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
                         const char *cptr);
@@ -253,6 +258,7 @@ uint8               relo_mode;                  /* Relocation mode */
 uint8               relo_pend;                  /* Relocation mode pending */
 uint8               hltinst;                    /* Executed halt instruction */
 uint8               iowait;                     /* Waiting on io */
+uint8               chwait;                     /* TCOx * waiting on chan */
 uint16              relocaddr = 0;              /* Relocation. */
 uint16              baseaddr = 0;               /* Base Address. */
 uint16              limitaddr = 077777;         /* High limit */
@@ -368,11 +374,21 @@ MTAB                cpu_mod[] = {
     {OPTION_FPSM, OPTION_FPSM, "FPSM", "FPSM", NULL, NULL, NULL, "Signfigance mode"},
     {OPTION_TIMER, 0, NULL, "NOCLOCK", NULL, NULL, NULL},
     {OPTION_TIMER, OPTION_TIMER, "CLOCK", "CLOCK", NULL, NULL, NULL},
+    {OPTION_TRUECLK, 0, NULL, "FASTCLOCK", NULL, NULL, NULL,
+       "Update the clock once per tick"},
+    {OPTION_TRUECLK, OPTION_TRUECLK, "TRUECLOCK", "TRUECLOCK", NULL, NULL, NULL,
+       "Poll the clock every 10000 instructions"},
     {UNIT_DUALCORE, 0, NULL, "STANDARD", NULL, NULL, NULL},
     {UNIT_DUALCORE, UNIT_DUALCORE, "CTSS", "CTSS", NULL, NULL, NULL, "CTSS support"},
 #endif
     {MTAB_XTD | MTAB_VDV | MTAB_NMO | MTAB_SHP, 0, "HISTORY", "HISTORY",
      &cpu_set_hist, &cpu_show_hist},
+    {MTAB_XTD | MTAB_VDV | MTAB_NMO | MTAB_SHP | MTAB_VALR | MTAB_NC, 1,
+     "HISTFILE", "HISTFILE", &cpu_set_histfile, &cpu_show_histfile},
+    {MTAB_XTD | MTAB_VDV, 0, NULL, "NOHISTFILE", &cpu_set_histfile, NULL},
+    {MTAB_XTD | MTAB_VDV | MTAB_NMO | MTAB_SHP | MTAB_VALO, 0, "PROFILE",
+     "PROFILE", &sim_set_profile, &sim_show_profile},
+    {MTAB_XTD | MTAB_VDV, 0, NULL, "NOPROFILE", &sim_clr_profile, NULL},
     {0}
 };
 
@@ -751,8 +767,27 @@ sim_instr(void)
    hltloop:
 #endif
 /* If doing fast I/O don't sit in idle loop */
-        if (iowait && (cpu_unit.flags & UNIT_FASTIO))
+        if (iowait && (cpu_unit.flags & UNIT_FASTIO)) {
             sim_interval = 0;
+            /* TCOx * would only branch to itself again until the channel
+               stops, so just run the events and the channels till then */
+            while (chwait && chan_active(chwait) && ihold == 0 &&
+                   relo_pend == 0 && prot_pend == 0 &&
+                   sim_clock_queue != QUEUE_LIST_END) {
+                reason = sim_process_event();
+                if (reason != SCPE_OK)
+                    break;
+                chan_proc();
+                sim_interval = 0;
+            }
+            chwait = 0;
+            if (reason != SCPE_OK) {
+                if (reason == SCPE_STEP)
+                    stopnext = 1;
+                else
+                    break;      /* process */
+            }
+        }
         if (iowait == 0 && stopnext)
             return SCPE_STEP;
 
@@ -819,6 +854,8 @@ sim_instr(void)
                           "Doing trap chan %c %o >%012llo loc %o %012llo\n",
                                   shiftcnt + 'A' - 1, f, SR, MA, temp);
                         if (hst_lnt) {  /* history enabled? */
+                            if (sim_hist_file && (hst[hst_p].ic & HIST_PC))
+                                sim_hist_write(&hst[hst_p]);
                             hst_p = (hst_p + 1);        /* next entry */
                             if (hst_p >= hst_lnt)
                                 hst_p = 0;
@@ -863,6 +900,8 @@ sim_instr(void)
                           "Doing timer trap >%012llo loc %o %012llo\n", SR,
                           MA, temp);
                 if (hst_lnt) {  /* history enabled? */
+                    if (sim_hist_file && (hst[hst_p].ic & HIST_PC))
+                        sim_hist_write(&hst[hst_p]);
                     hst_p = (hst_p + 1);        /* next entry */
                     if (hst_p >= hst_lnt)
                         hst_p = 0;
@@ -923,7 +962,10 @@ sim_instr(void)
             MA = IC;
             ReadMem(1, SR);
             temp = SR;
+            sim_prof_sample(MA);
             if (hst_lnt) {      /* history enabled? */
+                if (sim_hist_file && (hst[hst_p].ic & HIST_PC))
+                    sim_hist_write(&hst[hst_p]);
                 hst_p = (hst_p + 1);    /* next entry */
                 if (hst_p >= hst_lnt)
                     hst_p = 0;
@@ -3215,6 +3257,7 @@ prottrap:
                 if (chan_select(0)) {
                     extern DEVICE drm_dev;
                     drum_addr = (uint32)(MQ = SR);
+                    drm_seek();
                     sim_debug(DEBUG_DETAIL, &drm_dev,
                                  "set address %06o\n", drum_addr);
                     MQ <<= 1;
@@ -3486,8 +3529,11 @@ prottrap:
             case OP_TCOH:
                 f = chan_active((opcode & 017) + 1);
                 /* Check if TCOx * */
-                if ((cpu_unit.flags & UNIT_FASTIO) && f && MA == (IC - 1))
+                if ((cpu_unit.flags & UNIT_FASTIO) && f && MA == (IC - 1)) {
                     iowait = 1;
+                    if (TM == 0)
+                        chwait = (opcode & 017) + 1;
+                }
                 goto branch;
             case OP_TCNA:       /* Transfer on channel not in operation */
             case OP_TCNB:
@@ -4168,7 +4214,7 @@ rtc_srv(UNIT * uptr)
             milli_time = 0;
             last_sec = nt;
         }
-        while (diff > 16) {
+        while (diff >= 16) {
             /* Stop updating it over 60 in this second */
             if (milli_time > 60) {
                 last_ms = ms;
@@ -4179,10 +4225,14 @@ rtc_srv(UNIT * uptr)
             if (M[5] & MSIGN)
                 interval_irq = 1;
             diff -= 16;
-            last_ms = ms;
+            last_ms += 16;      /* Carry the rest into the next poll */
             milli_time += 1;
         }
-        sim_activate(&cpu_unit, 10000);
+        /* Nothing can change before the next tick is due */
+        if (cpu_unit.flags & OPTION_TRUECLK)
+            sim_activate(&cpu_unit, 10000);
+        else
+            sim_activate_after(&cpu_unit, 1000000/60);
     }
     return SCPE_OK;
 }
@@ -4270,6 +4320,74 @@ cpu_set_hist(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
     return SCPE_OK;
 }
 
+/* Print one history entry */
+
+static void
+cpu_print_hist(FILE * st, const void *rec)
+{
+    const struct InstHistory *h = (const struct InstHistory *) rec;
+    t_value             sim_eval;
+
+    fprintf(st, "%06o%c", h->ic & 077777, ((h->ic>>19)&1)?'b':' ');
+    switch ((h->ac & (AMSIGN | AQSIGN | APSIGN)) >> 35L) {
+    case (AMSIGN | AQSIGN | APSIGN) >> 35L:
+        fprintf(st, "-QP");
+        break;
+    case (AMSIGN | AQSIGN) >> 35L:
+        fprintf(st, " -Q");
+        break;
+    case (AMSIGN | APSIGN) >> 35L:
+        fprintf(st, " -P");
+        break;
+    case (AMSIGN) >> 35L:
+        fprintf(st, "  -");
+        break;
+    case (AQSIGN | APSIGN) >> 35L:
+        fprintf(st, " QP");
+        break;
+    case (AQSIGN) >> 35L:
+        fprintf(st, "  Q");
+        break;
+    case (APSIGN) >> 35L:
+        fprintf(st, "  P");
+        break;
+    case 0:
+        fprintf(st, "   ");
+        break;
+    }
+    fprint_val(st, h->ac & PMASK, 8, 35, PV_RZRO);
+    fputc(' ', st);
+    if (h->mq & MSIGN)
+        fputc('-', st);
+    else
+        fputc(' ', st);
+    fprint_val(st, h->mq & PMASK, 8, 35, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->ea, 8, 16, PV_RZRO);
+    fputc(((h->ic>>18)&1)?'b':' ', st);
+    if (h->sr & MSIGN)
+        fputc('-', st);
+    else
+        fputc(' ', st);
+    fprint_val(st, h->sr & PMASK, 8, 35, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->xr1, 8, 15, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->xr2, 8, 15, PV_RZRO);
+    fputc(' ', st);
+    fprint_val(st, h->xr4, 8, 15, PV_RZRO);
+    fputc(' ', st);
+    sim_eval = h->op;
+    if (
+        (fprint_sym
+         (st, h->ic & AMASK, &sim_eval, &cpu_unit,
+          SWMASK('M'))) > 0) fprintf(st, "(undefined) %012llo", h->op);
+    fputc('\n', st);    /* end line */
+}
+
+#define HIST_TITLE \
+"IC      AC            MQ            EA      SR             XR1    XR2   XR4\n\n"
+
 /* Show history */
 
 t_stat
@@ -4278,7 +4396,6 @@ cpu_show_hist(FILE * st, UNIT * uptr, int32 val, CONST void *desc)
     int32               k, di, lnt;
     char               *cptr = (char *) desc;
     t_stat              r;
-    t_value             sim_eval;
     struct InstHistory *h;
 
     if (hst_lnt == 0)
@@ -4292,71 +4409,57 @@ cpu_show_hist(FILE * st, UNIT * uptr, int32 val, CONST void *desc)
     di = hst_p - lnt;           /* work forward */
     if (di < 0)
         di = di + hst_lnt;
-    fprintf(st,
-"IC      AC            MQ            EA      SR             XR1    XR2   XR4\n\n");
+    fprintf(st, HIST_TITLE);
     for (k = 0; k < lnt; k++) { /* print specified */
         h = &hst[(++di) % hst_lnt];     /* entry pointer */
-        if (h->ic & HIST_PC) {  /* instruction? */
-            fprintf(st, "%06o%c", h->ic & 077777, ((h->ic>>19)&1)?'b':' ');
-            switch ((h->ac & (AMSIGN | AQSIGN | APSIGN)) >> 35L) {
-            case (AMSIGN | AQSIGN | APSIGN) >> 35L:
-                fprintf(st, "-QP");
-                break;
-            case (AMSIGN | AQSIGN) >> 35L:
-                fprintf(st, " -Q");
-                break;
-            case (AMSIGN | APSIGN) >> 35L:
-                fprintf(st, " -P");
-                break;
-            case (AMSIGN) >> 35L:
-                fprintf(st, "  -");
-                break;
-            case (AQSIGN | APSIGN) >> 35L:
-                fprintf(st, " QP");
-                break;
-            case (AQSIGN) >> 35L:
-                fprintf(st, "  Q");
-                break;
-            case (APSIGN) >> 35L:
-                fprintf(st, "  P");
-                break;
-            case 0:
-                fprintf(st, "   ");
-                break;
-            }
-            fprint_val(st, h->ac & PMASK, 8, 35, PV_RZRO);
-            fputc(' ', st);
-            if (h->mq & MSIGN)
-                fputc('-', st);
-            else
-                fputc(' ', st);
-            fprint_val(st, h->mq & PMASK, 8, 35, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->ea, 8, 16, PV_RZRO);
-            fputc(((h->ic>>18)&1)?'b':' ', st);
-            if (h->sr & MSIGN)
-                fputc('-', st);
-            else
-                fputc(' ', st);
-            fprint_val(st, h->sr & PMASK, 8, 35, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->xr1, 8, 15, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->xr2, 8, 15, PV_RZRO);
-            fputc(' ', st);
-            fprint_val(st, h->xr4, 8, 15, PV_RZRO);
-            fputc(' ', st);
-            sim_eval = h->op;
-            if (
-                (fprint_sym
-                 (st, h->ic & AMASK, &sim_eval, &cpu_unit,
-                  SWMASK('M'))) > 0) fprintf(st, "(undefined) %012llo", h->op);
-            fputc('\n', st);    /* end line */
-        }                       /* end else instruction */
+        if (h->ic & HIST_PC)    /* instruction? */
+            cpu_print_hist(st, h);
     }                           /* end for */
     return SCPE_OK;
 }
 
+/* Set history file, entries are streamed as each one is completed */
+
+t_stat
+cpu_set_histfile(UNIT * uptr, int32 val, CONST char *cptr, void *desc)
+{
+    int32               i;
+    t_stat              r;
+
+    if (val == 0) {
+        if (sim_hist_file && hst_lnt && (hst[hst_p].ic & HIST_PC))
+            sim_hist_write(&hst[hst_p]);        /* last entry */
+        sim_hist_close();
+        return SCPE_OK;
+    }
+    if ((cptr == NULL) || (*cptr == 0))
+        return SCPE_MISVAL;
+    if (hst_lnt == 0) {         /* need a buffer */
+        r = cpu_set_hist(uptr, 0, "64", NULL);
+        if (r != SCPE_OK)
+            return r;
+    }
+    for (i = 0; i < hst_lnt; i++)       /* start clean */
+        hst[i].ic = 0;
+    return sim_hist_open(cptr, sizeof(struct InstHistory));
+}
+
+/* Show history file, or decode one */
+
+t_stat
+cpu_show_histfile(FILE * st, UNIT * uptr, int32 val, CONST void *desc)
+{
+    char               *cptr = (char *) desc;
+
+    if ((cptr == NULL) || (*cptr == 0)) {
+        sim_hist_show(st);
+        fputc('\n', st);
+        return SCPE_OK;
+    }
+    return sim_hist_decode(st, cptr, sizeof(struct InstHistory), HIST_TITLE,
+                           &cpu_print_hist);
+}
+
 const char *
 cpu_description (DEVICE *dptr) 
 {
@@ -4397,6 +4500,9 @@ fprintf (st, "   sim> SET CPU FPSM     enables significance mode Floating Point\
 fprintf (st, "   sim> SET CPU NOFPSM   disables significance mode Floating Point\n\n");
 fprintf (st, "   sim> SET CPU CLOCK    enables clock in memory location 5\n");
 fprintf (st, "   sim> SET CPU NOCLOCK  disables the clock in memory location 5\n\n");
+fprintf (st, "By default the clock is brought up to date once per 1/60 second tick.\n");
+fprintf (st, "   sim> SET CPU TRUECLOCK  checks it every 10000 instructions instead\n");
+fprintf (st, "   sim> SET CPU FASTCLOCK  updates it once per tick (default)\n\n");
 fprintf (st, "   sim> SET CPU STANDARD sets generic IBM 709x CPU\n");
 fprintf (st, "   sim> SET CPU CTSS     enables RPQ options, DUAL Core and extended memory for\n");
 fprintf (st, "                         CTSS support\n\n");
@@ -4409,6 +4515,13 @@ fprintf (st, "   sim> SET CPU HISTORY                 clear history buffer\n");
 fprintf (st, "   sim> SET CPU HISTORY=0               disable history\n");
 fprintf (st, "   sim> SET CPU HISTORY=n{:file}        enable history, length = n\n");
 fprintf (st, "   sim> SHOW CPU HISTORY                print CPU history\n");
+fprintf (st, "   sim> SET CPU HISTFILE=file           stream history to a file\n");
+fprintf (st, "   sim> SET CPU NOHISTFILE              close the history file\n");
+fprintf (st, "   sim> SHOW CPU HISTFILE=file          print a history file\n");
+fprintf (st, "\nThe CPU can also count how often each address is executed:\n\n");
+fprintf (st, "   sim> SET CPU PROFILE{=n}             sample every n'th instruction\n");
+fprintf (st, "   sim> SET CPU NOPROFILE               stop profiling\n");
+fprintf (st, "   sim> SHOW CPU PROFILE{=n}            list the n busiest addresses\n");
 return SCPE_OK;
 }
 
@@ -47,10 +47,13 @@ void                drm_ini(UNIT *, t_bool);
 t_stat              drm_reset(DEVICE *);
 extern t_stat       chan_boot(int32, DEVICE *);
 uint32              drum_addr;  /* Read/write drum address */
+double              drm_skip_time; /* When the drum started its skip */
+int                 drm_skip_pos = -1; /* Where the skip started, -1 if none */
 t_stat              set_units(UNIT * uptr, int32 val, CONST char *cptr,
                               void *desc);
 t_stat              drm_attach(UNIT * uptr, CONST char *file);
 t_stat              drm_detach(UNIT * uptr);
+int                 drm_turn(int p, int q);
 
 t_stat              get_units(FILE * st, UNIT * uptr, int32 v, CONST void *desc);
 t_stat              drm_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
@@ -109,6 +112,7 @@ uint32 drm_cmd(UNIT * uptr, uint16 cmd, uint16 dev)
         /* Choose which part to use */
         uptr->u5 |= u << DRMSTA_UNITSHIFT;
         drum_addr = 0;          /* Set drum address */
+        drm_seek();
         chan_clear(chan, CHS_ATTN);     /* Clear attentions */
         /* Make sure drum is spinning */
         sim_activate(uptr, us_to_ticks(100));
@@ -123,6 +127,7 @@ t_stat drm_srv(UNIT * uptr)
     t_uint64           *buf = (t_uint64*)uptr->filebuf;
     t_stat              r;
 
+    drm_skip_pos = -1;
     uptr->u6++;                 /* Adjust rotation */
     uptr->u6 &= DRMMASK;
     /* Channel has disconnected, abort current read. */
@@ -132,6 +137,23 @@ t_stat drm_srv(UNIT * uptr)
         sim_debug(DEBUG_CHAN, &drm_dev, "Disconnect\n");
     }
 
+    /* Nothing to do until the address comes round, so go straight to
+       the word before it rather than taking an event for each word.  An
+       idle drum just skips a turn at a time. */
+    if (uptr->u5 == 0 ||
+        ((chan_flags[chan] & (STA_ACTIVE | DEV_SEL | DEV_DISCO))
+                 == (STA_ACTIVE | DEV_SEL)
+         && (uptr->u5 & (DRMSTA_READ | DRMSTA_WRITE))
+         && (uint32)uptr->u6 != (drum_addr & DRMMASK))) {
+        int             to = (uptr->u5 == 0) ? uptr->u6 - 1 : (int)drum_addr;
+
+        drm_skip_pos = uptr->u6;
+        drm_skip_time = sim_gtime();
+        sim_activate(uptr, us_to_ticks(drm_turn(uptr->u6, to)));
+        uptr->u6 = (to - 1) & DRMMASK;
+        return SCPE_OK;
+    }
+
     /* Check if we have a address match */
     if ((chan_flags[chan] & (STA_ACTIVE | DEV_SEL)) == (STA_ACTIVE | DEV_SEL)
          && (uptr->u5 & (DRMSTA_READ | DRMSTA_WRITE))
@@ -174,6 +196,40 @@ t_stat drm_srv(UNIT * uptr)
     return SCPE_OK;
 }
 
+/* Time in us for the drum to turn from word p to word q, which allows
+   for the index gap after word 0. */
+int
+drm_turn(int p, int q)
+{
+    int                 n = (q - p) & DRMMASK;
+    int                 t = n * 96;
+
+    if (n != 0 && (p == 0 || (p > (q & DRMMASK) && (q & DRMMASK) != 0)))
+        t += 200 - 96;
+    return t;
+}
+
+/* Drum address has changed.  If the drum is skipping to the old address,
+   work out where it has got to and skip from there instead. */
+void
+drm_seek(void)
+{
+    UNIT               *uptr = &drm_unit[0];
+    int                 us;
+    int                 n;
+
+    if (drm_skip_pos < 0 || !sim_is_active(uptr))
+        return;
+    us = (int)(((sim_gtime() - drm_skip_time) * cycle_time) / 10);
+    for (n = 1; n < DRMSIZE && drm_turn(drm_skip_pos, drm_skip_pos + n) <= us;
+         n++);
+    uptr->u6 = (drm_skip_pos + n - 1) & DRMMASK;
+    us = drm_turn(drm_skip_pos, drm_skip_pos + n) - us;
+    drm_skip_pos = -1;
+    sim_cancel(uptr);
+    sim_activate(uptr, us_to_ticks(us));
+}
+
 /* Boot from given device */
 t_stat
 drm_boot(int32 unit_num, DEVICE * dptr)
@@ -246,7 +302,8 @@ drm_attach(UNIT * uptr, CONST char *file)
 {
     t_stat              r;
 
-    if ((r = attach_unit(uptr, file)) != SCPE_OK)
+    if ((r = chan_attach_map(uptr, file,
+                   (size_t)uptr->capac * sizeof(t_uint64))) != SCPE_OK)
         return r;
 //  sim_activate(uptr, DRMWORDTIME);
     return SCPE_OK;
@@ -256,12 +313,19 @@ t_stat
 drm_detach(UNIT * uptr)
 {
     sim_cancel(uptr);
-    return detach_unit(uptr);
+    drm_skip_pos = -1;
+    return chan_detach_map(uptr, (size_t)uptr->capac * sizeof(t_uint64));
 }
 
 t_stat
 drm_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
 {
+   fprintf (st, "The drum is held in memory while it is attached. Attaching with\n");
+   fprintf (st, "-P maps the file instead, so writes go straight to it and nothing\n");
+   fprintf (st, "is lost if the sim stops unexpectedly:\n\n");
+   fprintf (st, "     sim> ATTACH -P DR0 drum.dr\n\n");
+   fprint_set_help (st, dptr) ;
+   fprint_show_help (st, dptr) ;
    return SCPE_OK;
 }
 
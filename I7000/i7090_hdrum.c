@@ -42,6 +42,8 @@ t_stat              hsdrm_srv(UNIT *);
 void                hsdrm_ini(UNIT *, t_bool);
 t_stat              hsdrm_reset(DEVICE *);
 uint32              hsdrm_addr; /* Read/write drum address */
+double              hsdrm_skip_time; /* When the drum started its skip */
+int                 hsdrm_skip_pos = -1; /* Where it started, -1 if none */
 t_stat              set_hunits(UNIT * uptr, int32 val, CONST char *cptr, void *desc);
 t_stat              get_hunits(FILE * st, UNIT * uptr, int32 v, CONST void *desc);
 t_stat              hsdrm_attach(UNIT * uptr, CONST char *file);
@@ -101,6 +103,7 @@ uint32 hsdrm_cmd(UNIT * uptr, uint16 cmd, uint16 dev)
             return SCPE_IOERR;
         }
         hsdrm_addr = 0;         /* Set drum address */
+        hsdrm_seek();
         if (!sim_is_active(uptr))
             sim_activate(uptr, us_to_ticks(100));
         return SCPE_OK;
@@ -122,9 +125,26 @@ t_stat hsdrm_srv(UNIT * uptr)
         sim_activate(uptr, us_to_ticks(50));
     }
 
+    hsdrm_skip_pos = -1;
     uptr->u6++;                 /* Adjust rotation */
     uptr->u6 &= 007777;
 
+    /* Go straight to the word before the address, or skip a whole turn
+       if the drum is idle, rather than taking an event for each word. */
+    if (uptr->u5 == 0 ||
+        ((chan_flags[chan] & (STA_ACTIVE | DEV_SEL | DEV_DISCO))
+                 == (STA_ACTIVE | DEV_SEL)
+         && uptr->u5 & (DRMSTA_READ | DRMSTA_WRITE)
+         && (uint32)uptr->u6 != (hsdrm_addr & 007777))) {
+        int             to = (uptr->u5 == 0) ? uptr->u6 - 1 : (int)hsdrm_addr;
+
+        hsdrm_skip_pos = uptr->u6;
+        hsdrm_skip_time = sim_gtime();
+        sim_activate(uptr, us_to_ticks(((to - uptr->u6) & 007777) * 20));
+        uptr->u6 = (to - 1) & 007777;
+        return SCPE_OK;
+    }
+
     /* Check if we have a address match */
     if ((chan_flags[chan] & (STA_ACTIVE | DEV_SEL)) == (STA_ACTIVE | DEV_SEL)
         && uptr->u5 & (DRMSTA_READ | DRMSTA_WRITE)
@@ -166,6 +186,23 @@ t_stat hsdrm_srv(UNIT * uptr)
     return SCPE_OK;
 }
 
+/* Drum address has changed.  If the drum is skipping to the old address,
+   work out where it has got to and skip from there instead. */
+void
+hsdrm_seek(void)
+{
+    UNIT               *uptr = &hsdrm_unit[0];
+    int                 us;
+
+    if (hsdrm_skip_pos < 0 || !sim_is_active(uptr))
+        return;
+    us = (int)(((sim_gtime() - hsdrm_skip_time) * cycle_time) / 10);
+    uptr->u6 = (hsdrm_skip_pos + us / 20) & 007777;
+    hsdrm_skip_pos = -1;
+    sim_cancel(uptr);
+    sim_activate(uptr, us_to_ticks(20 - (us % 20)));
+}
+
 void
 hsdrm_ini(UNIT * uptr, t_bool f)
 {
@@ -217,7 +254,8 @@ hsdrm_attach(UNIT * uptr, CONST char *file)
 {
     t_stat              r;
 
-    if ((r = attach_unit(uptr, file)) != SCPE_OK)
+    if ((r = chan_attach_map(uptr, file,
+                   (size_t)uptr->capac * sizeof(t_uint64))) != SCPE_OK)
         return r;
     sim_activate(uptr, us_to_ticks(100));
     return SCPE_OK;
@@ -227,12 +265,19 @@ t_stat
 hsdrm_detach(UNIT * uptr)
 {
     sim_cancel(uptr);
-    return detach_unit(uptr);
+    hsdrm_skip_pos = -1;
+    return chan_detach_map(uptr, (size_t)uptr->capac * sizeof(t_uint64));
 }
 
 t_stat
 hsdrm_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
 {
+   fprintf (st, "The drum is held in memory while it is attached. Attaching with\n");
+   fprintf (st, "-P maps the file instead, so writes go straight to it and nothing\n");
+   fprintf (st, "is lost if the sim stops unexpectedly:\n\n");
+   fprintf (st, "     sim> ATTACH -P HD0 ctss.hd\n\n");
+   fprint_set_help (st, dptr) ;
+   fprint_show_help (st, dptr) ;
    return SCPE_OK;
 }
 
@@ -68,10 +68,13 @@
 #define LPRSTA_COLMASK  0xff000000      /* Mask to last column printed */
 #define LPRSTA_COLSHIFT 24
 
+#define LPR_IOBUF       65536           /* Host buffer for output file */
+
 struct _lpr_data
 {
     t_uint64            wbuff[24];      /* Line buffer */
     char                lbuff[144];     /* Output line buffer */
+    char                iobuf[LPR_IOBUF];       /* Output file buffer */
 }
 lpr_data[NUM_DEVS_LPR];
 
@@ -141,15 +144,15 @@ print_line(UNIT * uptr, int chan, int unit)
     /* Bit flip into temp buffer */
     for (i = 0; i < 24; i++) {
         int                 bit = 1 << (i / 2);
-        t_uint64            mask = 1;
         t_uint64            wd = 0;
         int                 b = 36 * (i & 1);
         int                 col;
 
-        wd = lpr_data[unit].wbuff[i];
-        for (col = 35; col >= 0; mask <<= 1, col--) {
-            if (wd & mask)
-                buff[col + b] |= bit;
+        /* Stop once no punches are left in the row word */
+        wd = lpr_data[unit].wbuff[i] & 0777777777777LL;
+        for (col = 35 + b; wd != 0; wd >>= 1, col--) {
+            if (wd & 1)
+                buff[col] |= bit;
         }
         lpr_data[unit].wbuff[i] = 0;
     }
@@ -584,6 +587,8 @@ lpr_attach(UNIT * uptr, CONST char *file)
 
     if ((r = attach_unit(uptr, file)) != SCPE_OK)
         return r;
+    setvbuf(uptr->fileref, lpr_data[uptr - lpr_unit].iobuf, _IOFBF,
+            LPR_IOBUF);
     uptr->u5 = 0;
     return SCPE_OK;
 }
@@ -214,13 +214,34 @@ const char          ascii_to_mem[128] = {
 };
 
 
+/* Bit flip the 72 used columns of a card into the 24 words a row binary
+   read gives, row 9 left half first.  Only punched holes are visited. */
+static void
+card_to_words(uint16 *image, t_uint64 *lbuff)
+{
+    int                 col;
+    int                 row;
+    uint16              holes;
+
+    memset(lbuff, 0, 24 * sizeof(t_uint64));
+    for (col = 0; col < 72; col++) {
+        t_uint64        bit = 1LL << (35 - (col % 36));
+        int             half = col / 36;
+
+        for (holes = image[col] & 07777, row = 0; holes != 0;
+             holes >>= 1, row++) {
+            if (holes & 1)
+                lbuff[2 * row + half] |= bit;
+        }
+    }
+}
+
 /* Load a card image file into memory.  */
 
 t_stat
 sim_load(FILE * fileref, CONST char *cptr, CONST char *fnam, int flag)
 {
     t_uint64            wd;
-    t_uint64            mask;
     uint8               buffer[160];
     int                 addr = 0;
     int                 dlen = 0;
@@ -240,19 +261,7 @@ sim_load(FILE * fileref, CONST char *cptr, CONST char *fnam, int flag)
             }
 
             /* Bit flip into read buffer */
-            for (i = 0; i < 24; i++) {
-                int                 bit = 1 << (i / 2);
-                int                 b = 36 * (i & 1);
-                int                 col;
-
-                mask = 1;
-                wd = 0;
-                for (col = 35; col >= 0; mask <<= 1) {
-                    if (image[col-- + b] & bit)
-                        wd |= mask;
-                }
-                lbuff[i] = wd;
-            }
+            card_to_words(image, lbuff);
             if (firstcard) {
                 addr = 0;
                 dlen = 3 + (int)((lbuff[0] >> 18) & AMASK);
@@ -282,19 +291,7 @@ sim_load(FILE * fileref, CONST char *cptr, CONST char *fnam, int flag)
             }
 
             /* Bit flip into read buffer */
-            for (i = 0; i < 24; i++) {
-                int                 bit = 1 << (i / 2);
-                int                 b = 36 * (i & 1);
-                int                 col;
-
-                mask = 1;
-                wd = 0;
-                for (col = 35; col >= 0; mask <<= 1) {
-                    if (image[col-- + b] & bit)
-                        wd |= mask;
-                }
-                lbuff[i] = wd;
-            }
+            card_to_words(image, lbuff);
             if (firstcard) {
                 addr = 0;
                 dlen = 3 + (int)((lbuff[0] >> 18) & AMASK);
@@ -35,6 +35,8 @@
 #if (NUM_DEVS_CP > 0)
 
 #define UNIT_CDP        UNIT_ATTABLE | UNIT_DISABLE | MODE_029
+#define UNIT_V_FASTIO   (UNIT_V_UF + 7)
+#define UNIT_FASTIO     (1 << UNIT_V_FASTIO)
 
 #define CP_DEVNUM        0110
 
@@ -93,6 +95,10 @@ UNIT                cp_unit = {UDATA(cp_srv, UNIT_CDP, 0), 600 };
 MTAB                cp_mod[] = {
     {MTAB_XTD | MTAB_VUN, 0, "FORMAT", "FORMAT",
                &sim_card_set_fmt, &sim_card_show_fmt, NULL},    
+    {UNIT_FASTIO, 0, NULL, "TRUEIO", NULL, NULL, NULL,
+       "Punch columns at the modelled rate"},
+    {UNIT_FASTIO, UNIT_FASTIO, "FASTIO", "FASTIO", NULL, NULL, NULL,
+       "Punch each column as soon as it is output"},
     {0}
 };
 
@@ -107,6 +113,17 @@ DEVICE              cp_dev = {
 
 
 
+/* Kick the punch.  In FASTIO mode it runs on the spot and never waits
+   on a timer, it only moves when the program does something. */
+static void
+cp_start(UNIT *uptr)
+{
+    if ((uptr->flags & (UNIT_FASTIO|UNIT_ATT)) == (UNIT_FASTIO|UNIT_ATT))
+        cp_srv(uptr);
+    else
+        sim_activate(uptr, uptr->wait);
+}
+
 /* Card punch routine
 */
 
@@ -147,7 +164,7 @@ t_stat cp_devio(uint32 dev, uint64 *data) {
          if (*data & EJECT && uptr->u3 & CARD_IN_PUNCH) {
              uptr->u4 = 80;
              uptr->u3 &= ~DATA_REQ;
-             sim_activate(uptr, uptr->wait);
+             cp_start(uptr);
          }
          if ((uptr->u3 & (TROUBLE|TROUBLE_EN)) == (TROUBLE|TROUBLE_EN))
              set_interrupt(CP_DEVNUM, uptr->u3);
@@ -155,7 +172,7 @@ t_stat cp_devio(uint32 dev, uint64 *data) {
              set_interrupt(CP_DEVNUM, uptr->u3);
          if (*data & PUNCH_ON) {
              uptr->u3 |= PUNCH_ON;
-             sim_activate(uptr, uptr->wait);
+             cp_start(uptr);
          }
          break;
      case DATAI:
@@ -168,7 +185,7 @@ t_stat cp_devio(uint32 dev, uint64 *data) {
          clr_interrupt(dev);
          sim_debug(DEBUG_DATAIO, &cp_dev, "CP: DATAO %012llo %d\n", *data,
                  uptr->u4);
-         sim_activate(uptr, uptr->wait);
+         cp_start(uptr);
          break;
     }
     return SCPE_OK;
@@ -177,11 +194,13 @@ t_stat cp_devio(uint32 dev, uint64 *data) {
 /* Handle transfer of data for card punch */
 t_stat
 cp_srv(UNIT *uptr) {
+    int    fast = (uptr->flags & UNIT_FASTIO) != 0;
 
     if (uptr->u3 & PUNCH_ON) {
        uptr->u3 |= CARD_IN_PUNCH;
        if (uptr->u3 & DATA_REQ) {
-           sim_activate(uptr, uptr->wait);
+           if (!fast)
+               sim_activate(uptr, uptr->wait);
            return SCPE_OK;
        }
        if (uptr->u4 < 80) {
@@ -189,7 +208,8 @@ cp_srv(UNIT *uptr) {
                uptr->u3 |= DATA_REQ;
                set_interrupt(CP_DEVNUM, uptr->u3);
            }
-           sim_activate(uptr, uptr->wait);
+           if (!fast)
+               sim_activate(uptr, uptr->wait);
            return SCPE_OK;
         } 
         uptr->u4 = 0;
@@ -241,6 +261,7 @@ t_stat
 cp_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
 {
    fprintf (st, "Card Punch\n\n");
+   fprintf (st, "SET CP FASTIO punches each column as soon as it is output.\n");
    fprint_set_help(st, dptr);
    fprint_show_help(st, dptr);
    return SCPE_OK;
@@ -97,6 +97,9 @@
 #include "ka10_defs.h"
 #include "sim_timer.h"
 #include <time.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 #define HIST_PC         0x40000000
 #define HIST_PC2        0x80000000
@@ -114,7 +117,15 @@
 #define UNIT_TWOSEG     (1 << UNIT_V_TWOSEG)
 
 
+/* Ask for huge pages for memory where the host has them.  Guest access
+   is scattered over the whole array, so 4K pages cost TLB misses. */
+#if defined(MADV_HUGEPAGE) && defined(__GNUC__)
+#define MEM_HUGE        (2 * 1024 * 1024)
+uint64  M[MAXMEMSIZE] __attribute__ ((aligned (MEM_HUGE))); /* Memory */
+#else
 uint64  M[MAXMEMSIZE];                        /* Memory */
+#endif
+uint32  M_dirty[SIM_DIRTY_MAPSIZE(MAXMEMSIZE)]; /* Pages changed since SAVE */
 #if KI
 uint64  FM[64];                               /* Fast memory register */
 #else
@@ -139,10 +150,17 @@ int     SCAD;                                 /* Shift count extension */
 int     FE;                                   /* Exponent */
 #if KA | PDP6
 int     Pl, Ph, Rl, Rh, Pflag;                /* Protection registers */
+/* Relocation derived from the protection registers and the ONESEG/TWOSEG
+   setting by set_relocation(), so page_lookup only compares and adds */
+static int lo_limit, lo_reloc;                /* Low segment */
+static int hi_limit, hi_reloc;                /* High segment, limit -1 if none */
+static int hi_wprot;                          /* High segment write protected */
+static void set_relocation (void);
 char    push_ovf;                             /* Push stack overflow */
 char    mem_prot;                             /* Memory protection flag */
 #endif
 char    nxm_flag;                             /* Non-existant memory flag */
+char    watch_hit;                            /* Store hit a W breakpoint */
 char    clk_flg;                              /* Clock flag */
 char    ov_irq;                               /* Trap overflow */
 char    fov_irq;                              /* Trap floating overflow */
@@ -184,9 +202,46 @@ uint64  fault_data;                           /* Fault data from last fault */
 int32   apr_serial = -1;                      /* CPU Serial number */
 int     trap_flag;                            /* Last instruction was trapped */
 int     last_page;                            /* Last page mapped */
+
+/* Software TLB: the page table half-words last fetched by page_lookup.
+   User pages are indexed by page number, executive pages by twice their
+   offset into the page table, so pages 340-377 (mapped through the UBR)
+   land at 1000-1037 and 400-777 (through the EBR) at 400-777.  Entries
+   are dropped by DATAO PAG, by stores into either page table, and
+   whenever the simulator is restarted. */
+#define TLB_VALID       0x80000000
+static uint32 tlb_user[01000];
+static uint32 tlb_exec[01040];
+
+static void tlb_flush (void)
+{
+    memset (tlb_user, 0, sizeof (tlb_user));
+    memset (tlb_exec, 0, sizeof (tlb_exec));
+}
+
+/* A store to addr; drop any entry read from that page table word */
+#define TLB_STORE(addr)  if (page_enable) tlb_store (addr)
+
+static void tlb_store (uint32 addr)
+{
+    uint32 off;
+
+    off = addr - ub_ptr;
+    if (off < 0400) {
+        tlb_user[off << 1] = tlb_user[(off << 1) + 1] = 0;
+    } else if (off < 0420) {
+        tlb_exec[off << 1] = tlb_exec[(off << 1) + 1] = 0;
+    }
+    off = addr - eb_ptr;
+    if (off >= 0200 && off < 0400) {
+        tlb_exec[off << 1] = tlb_exec[(off << 1) + 1] = 0;
+    }
+}
 #endif
 
 char    dev_irq[128];                         /* Pending irq by device */
+int     dev_irq_cnt[8];                       /* Devices requesting each level */
+int     dev_irq_lvl;                          /* Levels with a device request */
 t_stat  (*dev_tab[128])(uint32 dev, uint64 *data);
 t_stat  rtc_srv(UNIT * uptr);
 int32   rtc_tps = 60;
@@ -202,6 +257,48 @@ typedef struct {
     uint64      fmb;
     } InstHistory;
 
+uint32  pc_lights[18];                                  /* console light intensities */
+uint32  mb_lights[36];
+uint32  ac_lights[4];
+
+#if KA
+/* Decoded instruction cache.  Entries are tagged with the virtual address,
+   the addressing context and a generation which is bumped whenever the
+   relocation registers may have changed.  A hit still compares the cached
+   word with memory, so stores from any path (including device DMA and
+   DEPOSIT) simply miss rather than needing explicit invalidation. */
+#define DCACHE_SIZE     4096                            /* must be a power of 2 */
+#define DCACHE_MASK     (DCACHE_SIZE - 1)
+
+struct dcache_ent {
+    uint64      word;                                   /* instruction word */
+    uint32      va;                                     /* address fetched from */
+    uint32      pa;                                     /* physical address */
+    uint32      key;                                    /* context/generation tag */
+    int         flags;                                  /* opflags[IR] */
+    uint16      ir;
+    uint8       ac;
+    };
+
+static struct dcache_ent *dcache = NULL;
+static uint32 dcache_gen = 0;                           /* current generation (tag >> 1) */
+static t_uint64 dcache_hits = 0;
+static t_uint64 dcache_misses = 0;
+static int    mem_pa;                                   /* physical address of last Mem_read */
+
+/* User mode fetches are relocated, executive mode ones are not */
+#define DCACHE_KEY(flag)    ((dcache_gen << 1) | ((!(flag) && (FLAGS & USER)) ? 1 : 0))
+
+static void dcache_flush (void)
+{
+if (++dcache_gen >= 0x7FFFFFFF) {                       /* wrapped, tags could alias */
+    dcache_gen = 1;
+    if (dcache != NULL)
+        memset (dcache, 0, DCACHE_SIZE * sizeof (*dcache));
+    }
+}
+#endif
+
 int32 hst_p = 0;                                        /* history pointer */
 int32 hst_lnt = 0;                                      /* history length */
 InstHistory *hst = NULL;                                /* instruction history */
@@ -214,6 +311,12 @@ t_stat cpu_reset (DEVICE *dptr);
 t_stat cpu_set_size (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_set_hist (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+t_stat cpu_set_histfile (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_histfile (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+#if KA
+t_stat cpu_set_dcache (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat cpu_show_dcache (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+#endif
 #if KI
 t_stat cpu_set_serial (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat cpu_show_serial (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
@@ -231,9 +334,10 @@ t_bool build_dev_tab (void);
    cpu_unit     CPU unit
    cpu_reg      CPU register list
    cpu_mod      CPU modifier list
+   cpu_mem      CPU memory descriptor
 */
 
-UNIT cpu_unit = { UDATA (&rtc_srv, UNIT_FIX|UNIT_BINK|UNIT_TWOSEG, MAXMEMSIZE) };
+UNIT cpu_unit = { UDATA (&rtc_srv, UNIT_IDLE|UNIT_FIX|UNIT_BINK|UNIT_TWOSEG, MAXMEMSIZE) };
 
 REG cpu_reg[] = {
     { ORDATA (PC, PC, 18) },
@@ -257,11 +361,14 @@ REG cpu_reg[] = {
     { ORDATA (PIENB, pi_enable, 7) },
     { BRDATA (REG, FM, 8, 36, 017) },
     { ORDATAD(SW, SW, 36, "Console SW Register"), REG_FIT},
+    { BRDATAD(PCLIGHTS, pc_lights, 10, 32, 18, "PC light intensities"), REG_RO },
+    { BRDATAD(MBLIGHTS, mb_lights, 10, 32, 36, "MB light intensities"), REG_RO },
+    { BRDATAD(ACLIGHTS, ac_lights, 10, 32, 4, "AC light intensities"), REG_RO },
     { NULL }
     };
 
 MTAB cpu_mod[] = {
-    { MTAB_XTD|MTAB_VDV, 0, "IDLE", "IDLE", &sim_set_idle, &sim_show_idle },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALO, 0, "IDLE", "IDLE", &sim_set_idle, &sim_show_idle },
     { MTAB_XTD|MTAB_VDV, 0, NULL, "NOIDLE", &sim_clr_idle, NULL },
     { UNIT_MSIZE, 1, "16K", "16K", &cpu_set_size },
     { UNIT_MSIZE, 2, "32K", "32K", &cpu_set_size },
@@ -285,6 +392,27 @@ MTAB cpu_mod[] = {
 #endif
     { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP, 0, "HISTORY", "HISTORY",
       &cpu_set_hist, &cpu_show_hist },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP|MTAB_VALR|MTAB_NC, 1, "HISTFILE", "HISTFILE",
+      &cpu_set_histfile, &cpu_show_histfile, NULL,
+      "Stream instruction history to a file, or decode a file with SHOW" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOHISTFILE",
+      &cpu_set_histfile, NULL, NULL, "Close the instruction history file" },
+    { MTAB_XTD|MTAB_VDV|MTAB_NMO|MTAB_SHP|MTAB_VALO, 0, "PROFILE", "PROFILE",
+      &sim_set_profile, &sim_show_profile, NULL,
+      "Sample every n'th instruction address, SHOW lists the top n" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOPROFILE",
+      &sim_clr_profile, NULL, NULL, "Stop profiling" },
+    { MTAB_XTD|MTAB_VDV|MTAB_VALO, 0, "LIGHTS", "LIGHTS",
+      &sim_set_lights, &sim_show_lights, NULL,
+      "Sample console lights every n'th instruction, publish every m samples (n:m)" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NOLIGHTS",
+      &sim_clr_lights, NULL, NULL, "Stop sampling console lights" },
+#if KA
+    { MTAB_XTD|MTAB_VDV, 1, "DCACHE", "DCACHE",
+      &cpu_set_dcache, &cpu_show_dcache, NULL, "Cache decoded instructions" },
+    { MTAB_XTD|MTAB_VDV, 0, NULL, "NODCACHE",
+      &cpu_set_dcache, NULL, NULL, "Decode every instruction as it is fetched" },
+#endif
     { 0 }
     };
 
@@ -297,12 +425,14 @@ DEBTAB              cpu_debug[] = {
     {0, 0}
 };
 
+MEMDESC cpu_mem = { 0, M, sizeof (M[0]), MAXMEMSIZE, 020 };  /* 0-17 examine as FM */
+
 DEVICE cpu_dev = {
     "CPU", &cpu_unit, cpu_reg, cpu_mod,
     1, 8, 22, 1, 8, 36,
     &cpu_ex, &cpu_dep, &cpu_reset,
     NULL, NULL, NULL, NULL, DEV_DEBUG, 0, cpu_debug,
-    NULL, NULL, &cpu_help, NULL, NULL, &cpu_description
+    NULL, NULL, &cpu_help, NULL, NULL, &cpu_description, &cpu_mem
     };
 
 /* Data arrays */
@@ -602,10 +732,38 @@ int opflags[] = {
  * Set device to interrupt on a given level 1-7
  * Level 0 means that device interrupt is not enabled 
  */
+/* Highest priority level (1-7) set in a 7 bit PI mask, 0 if none */
+static const uint8 pi_lvl_tab[128] = {
+    0, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+};
+
+/*
+ * Change the request of a device, keeping the per level counts and
+ * dev_irq_lvl in step so nothing has to scan the devices.
+ */
+static void set_dev_irq(int dev, int bit) {
+    int old = dev_irq[dev];
+
+    if (old == bit)
+        return;
+    if (old != 0 && --dev_irq_cnt[pi_lvl_tab[old]] == 0)
+        dev_irq_lvl &= ~old;
+    if (bit != 0 && dev_irq_cnt[pi_lvl_tab[bit]]++ == 0)
+        dev_irq_lvl |= bit;
+    dev_irq[dev] = bit;
+}
+
 void set_interrupt(int dev, int lvl) {
     lvl &= 07;
     if (lvl) {
-       dev_irq[dev>>2] = 0200 >> lvl;
+       set_dev_irq(dev>>2, 0200 >> lvl);
        pi_pending = 1;
        sim_debug(DEBUG_IRQ, &cpu_dev, "set irq %o %o\n", dev & 0774, lvl);
     }
@@ -615,7 +773,7 @@ void set_interrupt(int dev, int lvl) {
  * Clear the interrupt flag for a device
  */
 void clr_interrupt(int dev) {
-    dev_irq[dev>>2] = 0;
+    set_dev_irq(dev>>2, 0);
     sim_debug(DEBUG_IRQ, &cpu_dev, "clear irq %o\n", dev & 0774);
 }
 
@@ -624,43 +782,20 @@ void clr_interrupt(int dev) {
  * else set pi_enc to highest level and return 1.
  */
 int check_irq_level() {
-     int i, lvl;
-     int pi_ok, pi_t;
+     int lvl;
 
-     /* Scan all devices */
-     for(i = lvl = 0; i < 128; i++)
-        lvl |= dev_irq[i];
-     if (lvl == 0) 
+     if (dev_irq_lvl == 0) 
         pi_pending = 0;
-     PIR |= (lvl & PIE);
-     /* Handle held interrupt requests */
-     pi_t = (~PIR & ~PIH) >> 1;
-     pi_ok = 0100 & (PIR & ~PIH);
-     /* Still have a valid interrupt? */
-     if (!pi_ok) {
-        /* None at level 1, check for lower level */
-         lvl = 0040;
-         for(i = 2; i <= 7; i++) {
-            if (lvl & pi_t) {
-                pi_ok |= lvl;
-                lvl >>= 1;
-            } else {
-                break;
-            }
-         }
-     }
-     /* We have 1 bit for each non held interrupt. */
-     pi_req = PIR & ~PIH & pi_ok;
-     if (pi_req) {
-        int pi_r = pi_req;
-        for(lvl = i = 1; i<=7; i++, lvl++) {
-           if (pi_r & 0100)
-              break;
-           pi_r <<= 1;
-        }
+     PIR |= (dev_irq_lvl & PIE);
+     /* The highest level requesting or held wins, a held level
+        blocks all the ones below it */
+     lvl = pi_lvl_tab[(PIR | PIH) & 0177];
+     if (lvl != 0 && (PIH & (0200 >> lvl)) == 0) {
+        pi_req = 0200 >> lvl;
         pi_enc = lvl;
         return 1;
      }
+     pi_req = 0;
      return 0;
 }
 
@@ -668,20 +803,15 @@ int check_irq_level() {
  * Recover from held interrupt.
  */
 void restore_pi_hold() {
-     int i, lvl;
+     int lvl;
 
      if (!pi_enable)
         return;
-     /* Compute mask for pi_ok */
-     lvl = 0100;
      /* Clear HOLD flag for highest interrupt */
-     for(i = 1; i <= 7; i++) {
-        if (lvl & PIH) {
-            PIR &= ~lvl;
-            PIH &= ~lvl;
-            break;
-         }
-         lvl >>= 1;
+     lvl = pi_lvl_tab[PIH & 0177];
+     if (lvl != 0) {
+        PIR &= ~(0200 >> lvl);
+        PIH &= ~(0200 >> lvl);
      }
      pi_pending = 1;
 }
@@ -731,6 +861,7 @@ t_stat dev_pag(uint32 dev, uint64 *data) {
             fm_sel = (uint8)(res >> 29) & 060;
        }
        pag_reload = 0;
+       tlb_flush();
        sim_debug(DEBUG_DATAIO, &cpu_dev, 
                     "DATAO PAG %012llo ebr=%06o ubr=%06o\n", 
                     *data, eb_ptr, ub_ptr);
@@ -907,6 +1038,10 @@ t_stat dev_apr(uint32 dev, uint64 *data) {
         Pflag = 01 & (*data >> 18);
         Ph = 0377 & (*data >> 19);
         Pl = 0377 & (*data >> 28);
+        set_relocation();
+#if KA
+        dcache_flush();
+#endif
         sim_debug(DEBUG_DATAIO, &cpu_dev, "DATAO APR %012llo\n", *data);
         break;
 
@@ -974,6 +1109,18 @@ t_stat dev_pi(uint32 dev, uint64 *data) {
     return SCPE_OK;
 }
 
+/*
+ * Do I/O function f on device d.  Absent devices read as zero without
+ * going through the dispatch table.
+ */
+#define DEV_IO(d, f, data) \
+    do { \
+        if (dev_tab[d] != &null_dev) \
+            dev_tab[d]((f)|((d)<<2), data); \
+        else if ((f) == CONI || (f) == DATAI) \
+            *(data) = 0; \
+    } while (0)
+
 /*
  * Non existent device
 */
@@ -991,12 +1138,31 @@ t_stat null_dev(uint32 dev, uint64 *data) {
     return SCPE_OK;
 }
 
+/*
+ * Write watchpoints.  With no W breakpoint set a store only tests
+ * sim_brk_summ; with one set, sim_brk_test's page bitmap turns away
+ * stores to unwatched pages.  A hit stops the CPU once the instruction
+ * is done.  They get their own breakpoint space so a hit is not
+ * mistaken for the one just reported, every store to the word counts.
+ */
+#define WATCH_SPC       1
+#define MEM_WATCH(a)    ((sim_brk_summ & SWMASK ('W')) ? mem_watch (a) : (void)0)
+
+static void mem_watch (t_addr a)
+{
+    if (sim_brk_test (a, SWMASK ('W') | (WATCH_SPC << SIM_BKPT_V_SPC))) {
+        watch_hit = 1;
+        sim_brk_clrspc (WATCH_SPC);
+    }
+}
+
 #if KI
 /* 
  * Handle page lookup on KI10
  */
 int page_lookup(int addr, int flag, int *loc, int wr, int cur_context) {
     uint64   data;
+    uint32  *tlb;
     int      base = ub_ptr;
     int      page = (RMASK & addr) >> 9;
     int      uf = (FLAGS & USER) != 0;
@@ -1057,11 +1223,17 @@ int page_lookup(int addr, int flag, int *loc, int wr, int cur_context) {
         }
     }
     /* Map the page */
-    data = M[base + (page >> 1)];
-    /* Even in left half, Odd in right half. */
-    if ((page & 1) == 0)
-       data >>= 18;
-    data &= RMASK;
+    tlb = uf ? &tlb_user[page] : &tlb_exec[page];
+    if (*tlb & TLB_VALID) {
+        data = *tlb & RMASK;
+    } else {
+        data = M[base + (page >> 1)];
+        /* Even in left half, Odd in right half. */
+        if ((page & 1) == 0)
+           data >>= 18;
+        data &= RMASK;
+        *tlb = (uint32)data | TLB_VALID;
+    }
     *loc = ((data & 017777) << 9) + (addr & 0777);
     /* Access check logic */
     if (!flag && ((FLAGS & PUBLIC) != 0) && ((data & 0200000) == 0)) {
@@ -1100,6 +1272,8 @@ uint64 get_reg(int reg) {
 }
 
 void   set_reg(int reg, uint64 value) {
+    MEM_DIRTY(0);                        /* FM is examined as page 0 */
+    MEM_WATCH(reg & 017);
     if (FLAGS & USER) 
         FM[fm_sel|(reg & 017)] = value;
     else 
@@ -1135,6 +1309,8 @@ int Mem_write_nopage() {
 
     if (AB < 020) {
         FM[AB] = MB;
+        MEM_DIRTY(0);
+        MEM_WATCH(AB);
     } else {
         sim_interval--;
         if (AB >= (int)MEMSIZE) {
@@ -1143,6 +1319,9 @@ int Mem_write_nopage() {
             return 1;
         }
         M[AB] = MB;
+        MEM_DIRTY(AB);
+        MEM_WATCH(AB);
+        TLB_STORE(AB);
     }
     return 0;
 }
@@ -1150,18 +1329,32 @@ int Mem_write_nopage() {
 
 #else
 
+/*
+ * Recompute the relocation limits after the protection registers or
+ * the ONESEG/TWOSEG setting change.
+ */
+static void set_relocation (void) {
+      lo_limit = (Pl << 10) + 01777;
+      lo_reloc = Rl << 10;
+      hi_reloc = Rh << 10;
+      hi_wprot = Pflag;
+      if (cpu_unit.flags & UNIT_TWOSEG)
+          hi_limit = (Ph << 10) + 01777;
+      else
+          hi_limit = -1;
+}
+
 /*
  * Translation logic for KA10
  */
 int page_lookup(int addr, int flag, int *loc, int wr, int cur_context) {
       if (!flag && (FLAGS & USER) != 0) {
-          if (addr <= ((Pl << 10) + 01777))
-             *loc = (AB + (Rl << 10)) & RMASK;
-          else if (cpu_unit.flags & UNIT_TWOSEG &&
-                    (!Pflag & wr) == wr &&
-                    (AB & 0400000) != 0 &&
-                    (addr <= ((Ph << 10) + 01777)))
-             *loc = (AB + (Rh << 10)) & RMASK;
+          if (addr <= lo_limit)
+             *loc = (AB + lo_reloc) & RMASK;
+          else if ((AB & 0400000) != 0 &&
+                    addr <= hi_limit &&
+                    (hi_wprot & wr) == 0)
+             *loc = (AB + hi_reloc) & RMASK;
           else {
             mem_prot = 1;
             set_interrupt(0, apr_irq);
@@ -1174,7 +1367,8 @@ int page_lookup(int addr, int flag, int *loc, int wr, int cur_context) {
 }
 
 #define get_reg(reg)                 FM[(reg) & 017]
-#define set_reg(reg, value)          FM[(reg) & 017] = value
+#define set_reg(reg, value)          (MEM_DIRTY(0), MEM_WATCH((reg) & 017), \
+                                      FM[(reg) & 017] = value)
 #endif
 
 /*
@@ -1217,6 +1411,9 @@ read:
             return 1;
         }
         MB = M[addr];
+#if KA
+        mem_pa = addr;
+#endif
     }
     return 0;
 }
@@ -1245,6 +1442,9 @@ int Mem_write(int flag, int cur_context) {
                       FM[fm_sel|AB] = MB;
                 } else {
                    M[ub_ptr + ac_stack + AB] = MB;
+                   MEM_DIRTY(ub_ptr + ac_stack + AB);
+                   MEM_WATCH(ub_ptr + ac_stack + AB);
+                   TLB_STORE(ub_ptr + ac_stack + AB);
                 }
                 return 0;
             }
@@ -1268,6 +1468,11 @@ write:
             return 1;
         }
         M[addr] = MB;
+        MEM_DIRTY(addr);
+        MEM_WATCH(addr);
+#if KI
+        TLB_STORE(addr);
+#endif
     }
     return 0;
 }
@@ -1287,8 +1492,29 @@ int nlzero(uint64 w) {
     return n;
 }
 
+/* Opcode dispatch.  Built with USE_COMPUTED_GOTO on compilers which support
+   label addresses, every opcode case is also a label and sim_instr jumps
+   through a table of them, skipping the switch's range check.  The
+   switch itself is kept so both builds share all of the case bodies. */
+#if defined(USE_COMPUTED_GOTO) && defined(__GNUC__)
+#define OPCODE(n)       case n: op_##n
+#define OPS8(n)         &&op_##n##0, &&op_##n##1, &&op_##n##2, &&op_##n##3, \
+                        &&op_##n##4, &&op_##n##5, &&op_##n##6, &&op_##n##7
+#define OPS64(n)        OPS8(n##0), OPS8(n##1), OPS8(n##2), OPS8(n##3), \
+                        OPS8(n##4), OPS8(n##5), OPS8(n##6), OPS8(n##7)
+#else
+#undef USE_COMPUTED_GOTO
+#define OPCODE(n)       case n
+#endif
+
 t_stat sim_instr (void)
 {
+#if defined(USE_COMPUTED_GOTO)
+static void *const op_dispatch[01000] = {
+    OPS64(00), OPS64(01), OPS64(02), OPS64(03),
+    OPS64(04), OPS64(05), OPS64(06), OPS64(07)
+    };
+#endif
 t_stat reason;
 int     i_flags;                 /* Instruction mode flags */
 int     pi_rq;                   /* Interrupt request */
@@ -1305,10 +1531,23 @@ int     f;                       /* Temporary variables */
 int     flag1;
 int     flag3;
 uint32  IA;
+#if KA
+struct dcache_ent *dc;           /* Decode cache entry to fill */
+uint32  dc_key = 0;
+#endif
 
 /* Build device table */
 if ((reason = build_dev_tab ()) != SCPE_OK)            /* build, chk dib_tab */
     return reason;
+#if KA | PDP6
+set_relocation ();                                     /* SET ONESEG/TWOSEG may have changed */
+#endif
+#if KA
+dcache_flush ();                                       /* SET commands may have changed relocation */
+#endif
+#if KI
+tlb_flush ();                                          /* DEPOSIT may have changed page tables */
+#endif
 
 
 /* Main instruction fetch/decode loop: check clock queue, intr, trap, bkpt */
@@ -1320,6 +1559,7 @@ if ((reason = build_dev_tab ()) != SCPE_OK)            /* build, chk dib_tab */
    pi_rq = 0;
    pi_ov = 0;
    BYF5 = 0;
+   watch_hit = 0;
 #if KI | KL
    private_page = 0;
    page_fault = 0;
@@ -1333,9 +1573,16 @@ if ((reason = build_dev_tab ()) != SCPE_OK)            /* build, chk dib_tab */
           }
      }
 
-     if (sim_brk_summ && sim_brk_test(PC, SWMASK('E'))) {
-         reason = STOP_IBKPT;
-         break;
+     if (sim_brk_summ) {
+         if (watch_hit) {
+             watch_hit = 0;
+             reason = STOP_WBKPT;
+             break;
+         }
+         if (sim_brk_test(PC, SWMASK('E'))) {
+             reason = STOP_IBKPT;
+             break;
+         }
     }
 
 
@@ -1353,6 +1600,24 @@ if ((reason = build_dev_tab ()) != SCPE_OK)            /* build, chk dib_tab */
     if (f_inst_fetch) {
 #if !(KI | KL)
 fetch:
+#endif
+#if KA
+       dc = NULL;
+       if (dcache != NULL && AB >= 020) {
+           dc = &dcache[AB & DCACHE_MASK];
+           dc_key = DCACHE_KEY(pi_cycle | uuo_cycle);
+           if (dc->va == AB && dc->key == dc_key && M[dc->pa] == dc->word) {
+               sim_interval--;
+               MB = AD = dc->word;
+               IR = dc->ir;
+               AC = dc->ac;
+               IA = AB;
+               i_flags = dc->flags;
+               BYF5 = 0;
+               dcache_hits++;
+               goto decoded;
+           }
+       }
 #endif
        if (Mem_read(pi_cycle | uuo_cycle, 1))
            goto last;
@@ -1366,6 +1631,20 @@ no_fetch:
 
        i_flags = opflags[IR];
        BYF5 = 0;
+#if KA
+       if (dc != NULL) {
+           dcache_misses++;
+           dc->word = MB;
+           dc->va = AB;
+           dc->pa = mem_pa;
+           dc->key = dc_key;
+           dc->flags = i_flags;
+           dc->ir = IR;
+           dc->ac = AC;
+       }
+decoded:
+       ;
+#endif
     }
 
     /* Second half of byte instruction */
@@ -1456,6 +1735,17 @@ no_fetch:
 #endif
     }
 
+    if (!BYF5) {
+        sim_prof_sample (IA);
+        sim_idle_auto_fetch (IA);
+        if (sim_lights_due ()) {
+            sim_lights_value (0, IA);
+            sim_lights_value (1, MB);
+            sim_lights_value (2, AC);
+            sim_lights_end_sample ();
+        }
+    }
+
     /* Update history */
 #if KI
 //    if (hst_lnt && PC > 020 && (FLAGS & USER) != 0) {
@@ -1465,6 +1755,8 @@ no_fetch:
     if (hst_lnt && PC > 020 && (PC & 0777774) != 0472174 && 
             (PC & 0777700) != 023700 && (PC != 0527154)) {
 #endif
+            if (sim_hist_file && (hst[hst_p].pc & HIST_PC))
+                sim_hist_write (&hst[hst_p]);
             hst_p = hst_p + 1;
             if (hst_p >= hst_lnt) {
                     hst_p = 0;
@@ -1533,25 +1825,28 @@ fetch_opr:
     }
 
     /* Process the instruction */
+#if defined(USE_COMPUTED_GOTO)
+    goto *op_dispatch[IR & 0777];
+#endif
     switch (IR) {
 muuo:
-    case 0000: /* UUO */
-    case 0040: case 0041: case 0042: case 0043: 
-    case 0044: case 0045: case 0046: case 0047:
-    case 0050: case 0051: case 0052: case 0053:
-    case 0054: case 0055: case 0056: case 0057:
-    case 0060: case 0061: case 0062: case 0063:
-    case 0064: case 0065: case 0066: case 0067:
-    case 0070: case 0071: case 0072: case 0073:
-    case 0074: case 0075: case 0076: case 0077:
+    OPCODE(0000): /* UUO */
+    OPCODE(0040): OPCODE(0041): OPCODE(0042): OPCODE(0043): 
+    OPCODE(0044): OPCODE(0045): OPCODE(0046): OPCODE(0047):
+    OPCODE(0050): OPCODE(0051): OPCODE(0052): OPCODE(0053):
+    OPCODE(0054): OPCODE(0055): OPCODE(0056): OPCODE(0057):
+    OPCODE(0060): OPCODE(0061): OPCODE(0062): OPCODE(0063):
+    OPCODE(0064): OPCODE(0065): OPCODE(0066): OPCODE(0067):
+    OPCODE(0070): OPCODE(0071): OPCODE(0072): OPCODE(0073):
+    OPCODE(0074): OPCODE(0075): OPCODE(0076): OPCODE(0077):
 
               /* MUUO */
 
 #if KI | KL
-    case 0100: case 0101: case 0102: case 0103:
-    case 0104: case 0105: case 0106: case 0107:
-    case 0123: 
-    case 0247: /* UUO  */
+    OPCODE(0100): OPCODE(0101): OPCODE(0102): OPCODE(0103):
+    OPCODE(0104): OPCODE(0105): OPCODE(0106): OPCODE(0107):
+    OPCODE(0123): 
+    OPCODE(0247): /* UUO  */
 unasign: 
               MB = ((uint64)(IR) << 27) | ((uint64)(AC) << 23) | (uint64)(AB);
               AB = ub_ptr | 0424;
@@ -1584,14 +1879,14 @@ unasign:
 #endif
 
               /* LUUO */
-    case 0001: case 0002: case 0003:
-    case 0004: case 0005: case 0006: case 0007:
-    case 0010: case 0011: case 0012: case 0013:
-    case 0014: case 0015: case 0016: case 0017:
-    case 0020: case 0021: case 0022: case 0023:
-    case 0024: case 0025: case 0026: case 0027:
-    case 0030: case 0031: case 0032: case 0033:
-    case 0034: case 0035: case 0036: case 0037:
+    OPCODE(0001): OPCODE(0002): OPCODE(0003):
+    OPCODE(0004): OPCODE(0005): OPCODE(0006): OPCODE(0007):
+    OPCODE(0010): OPCODE(0011): OPCODE(0012): OPCODE(0013):
+    OPCODE(0014): OPCODE(0015): OPCODE(0016): OPCODE(0017):
+    OPCODE(0020): OPCODE(0021): OPCODE(0022): OPCODE(0023):
+    OPCODE(0024): OPCODE(0025): OPCODE(0026): OPCODE(0027):
+    OPCODE(0030): OPCODE(0031): OPCODE(0032): OPCODE(0033):
+    OPCODE(0034): OPCODE(0035): OPCODE(0036): OPCODE(0037):
               MB = ((uint64)(IR) << 27) | ((uint64)(AC) << 23) | (uint64)(AB);
 #if KI | KL
               if ((FLAGS & USER) == 0) {
@@ -1612,8 +1907,8 @@ unasign:
 
 #if KI | KL
 
-    case 0110:       /* DFAD */
-    case 0111:       /* DFSB */
+    OPCODE(0110):       /* DFAD */
+    OPCODE(0111):       /* DFSB */
               /* On Load AR,MQ has memory operand */
               /* AR,MQ = AC  BR,MB  = mem */
                     /* AR High */
@@ -1642,10 +1937,15 @@ unasign:
                   SCAD = SC - FE;
               }
               if (SCAD > 0) {
-                  while (SCAD > 0) {
-                     AR = (AR & (DSMASK|DNMASK)) | (AR >> 1);
-                     SCAD--;
-                  }
+                  /* Top two bits hold their value and smear down into
+                     the vacated bits, same as shifting one at a time */
+                  int  n = (SCAD > 63) ? 63 : SCAD;
+                  AD = AR >> n;
+                  if (AR & DSMASK)
+                      AD |= DFMASK << (63 - n);
+                  if (AR & DNMASK)
+                      AD |= (DCMASK << (62 - ((n > 62) ? 62 : n))) & DCMASK;
+                  AR = AD;
               }
               AD = (AR + BR);
               flag1 = 0;
@@ -1699,7 +1999,7 @@ dpnorm:
               MQ = ARX;
               break;
 
-    case 0112: /* DFMP */
+    OPCODE(0112): /* DFMP */
               /* On Load AR,MQ has memory operand */
               /* AR,MQ = AC  BR,MB  = mem */
                     /* AR High */
@@ -1736,7 +2036,7 @@ dpnorm:
               }
               goto dpnorm;
 
-    case 0113: /* DFDV */
+    OPCODE(0113): /* DFDV */
               /* On Load AR,MQ has memory operand */
               /* AR,MQ = AC  BR,MB  = mem */
                     /* AR High */
@@ -1779,6 +2079,10 @@ dpnorm:
               }
               if (SC < 0)
                   fxu_hold_set = 1;
+#if defined(__SIZEOF_INT128__)
+              /* BR <= AR < 2*BR, so the 62 quotient bits are AR*2^61/BR */
+              AD = (uint64)(((unsigned __int128)AR << 61) / BR);
+#else
               AD = 0;
               for (FE = 0; FE < 62; FE++) {
                   AD <<= 1;
@@ -1788,16 +2092,17 @@ dpnorm:
                   }
                   AR <<= 1;
               }
+#endif
               AR = AD;
               goto dpnorm;
 
-    case 0114: /* DADD */
-    case 0115: /* DSUB */
-    case 0116: /* DMUL */
-    case 0117: /* DDIV */
+    OPCODE(0114): /* DADD */
+    OPCODE(0115): /* DSUB */
+    OPCODE(0116): /* DMUL */
+    OPCODE(0117): /* DDIV */
               goto unasign;
 
-    case 0120: /* DMOVE */
+    OPCODE(0120): /* DMOVE */
               AB = (AB + 1) & RMASK;
               modify = 0;
               if (Mem_read(0, 0))
@@ -1805,7 +2110,7 @@ dpnorm:
               MQ = MB;
               break;
 
-    case 0121: /* DMOVN */
+    OPCODE(0121): /* DMOVN */
               AB = (AB + 1) & RMASK;
               modify = 0;
               if (Mem_read(0, 0))
@@ -1816,7 +2121,7 @@ dpnorm:
               MQ &= CMASK;
               break;
 
-    case 0124: /* DMOVEM */
+    OPCODE(0124): /* DMOVEM */
               /* Handle each half as seperate instruction */
               if ((FLAGS & BYTI) == 0) {
                   MB = AR;
@@ -1837,7 +2142,7 @@ dpnorm:
               }
               break;
 
-    case 0125: /* DMOVNM */
+    OPCODE(0125): /* DMOVNM */
               /* Handle each half as seperate instruction */
               if ((FLAGS & BYTI) == 0) {
                   BR = AR = CM(AR);
@@ -1865,8 +2170,8 @@ dpnorm:
               }
               break;
 
-    case 0122: /* FIX */
-    case 0126: /* FIXR */
+    OPCODE(0122): /* FIX */
+    OPCODE(0126): /* FIXR */
               MQ = 0;
               SC = ((((AR & SMASK) ? 0377 : 0 )
                       ^ ((AR >> 27) & 0377)) + 0600) & 0777;
@@ -1900,7 +2205,7 @@ dpnorm:
                  AR = (CM(AR) + 1) & FMASK;
               break;
 
-    case 0127: /* FLTR */
+    OPCODE(0127): /* FLTR */
               if (AR & SMASK) {
                   flag1 = 1;
                   AR = (CM(AR) + 1) & CMASK;
@@ -1911,14 +2216,13 @@ dpnorm:
               goto fnorm;
 #else
               /* MUUO */
-    case 0100: case 0101: case 0102: case 0103:
-    case 0104: case 0105: case 0106: case 0107: 
-    case 0110: case 0111: case 0112: case 0113:
-    case 0114: case 0115: case 0116: case 0117:
-    case 0120: case 0121: case 0122: case 0123:
-    case 0124: case 0125: case 0126: case 0127:
-    case 0247: /* UUO  */
-unasign:
+    OPCODE(0100): OPCODE(0101): OPCODE(0102): OPCODE(0103):
+    OPCODE(0104): OPCODE(0105): OPCODE(0106): OPCODE(0107): 
+    OPCODE(0110): OPCODE(0111): OPCODE(0112): OPCODE(0113):
+    OPCODE(0114): OPCODE(0115): OPCODE(0116): OPCODE(0117):
+    OPCODE(0120): OPCODE(0121): OPCODE(0122): OPCODE(0123):
+    OPCODE(0124): OPCODE(0125): OPCODE(0126): OPCODE(0127):
+    OPCODE(0247): /* UUO  */
               MB = ((uint64)(IR) << 27) | ((uint64)(AC) << 23) | (uint64)(AB);
               AB = 060;
               uuo_cycle = 1;
@@ -1929,9 +2233,9 @@ unasign:
               break;
 #endif
 
-    case 0133: /* IBP/ADJBP */
-    case 0134: /* ILDB */
-    case 0136: /* IDPB */
+    OPCODE(0133): /* IBP/ADJBP */
+    OPCODE(0134): /* ILDB */
+    OPCODE(0136): /* IDPB */
               if ((FLAGS & BYTI) == 0) {      /* BYF6 */
 #if KI | KL
                   modify = 1;
@@ -1959,8 +2263,8 @@ unasign:
                       break;
               }
 
-    case 0135:/* LDB */
-    case 0137:/* DPB */
+    OPCODE(0135):/* LDB */
+    OPCODE(0137):/* DPB */
               if (((FLAGS & BYTI) == 0) | !BYF5) {
                   if (Mem_read(0, 1)) 
                       goto last;
@@ -2003,7 +2307,7 @@ unasign:
               break;
 
 #if !PDP6
-    case 0131:/* DFN */
+    OPCODE(0131):/* DFN */
               AD = (CM(BR) + 1) & FMASK;
               SC = (BR >> 27) & 0777;
               BR = AR;
@@ -2019,7 +2323,7 @@ unasign:
               break;
 #endif
 
-    case 0132:/* FSC */
+    OPCODE(0132):/* FSC */
               SC = ((AB & LSIGN) ? 0400 : 0) | (AB & 0377);
               SCAD = GET_EXPO(AR);
               SC = (SCAD + SC) & 0777;
@@ -2058,27 +2362,27 @@ unasign:
               break;
 
 
-    case 0150:      /* FSB */
-    case 0151:      /* FSBL */
-    case 0152:      /* FSBM */
-    case 0153:      /* FSBB */
-    case 0154:      /* FSBR */
-    case 0155:      /* FSBRI */
-    case 0156:      /* FSBRM */
-    case 0157:      /* FSBRB */
+    OPCODE(0150):      /* FSB */
+    OPCODE(0151):      /* FSBL */
+    OPCODE(0152):      /* FSBM */
+    OPCODE(0153):      /* FSBB */
+    OPCODE(0154):      /* FSBR */
+    OPCODE(0155):      /* FSBRI */
+    OPCODE(0156):      /* FSBRM */
+    OPCODE(0157):      /* FSBRB */
               AD = (CM(AR) + 1) & FMASK;
               AR = BR;
               BR = AD;
 
-    case 0130:      /* UFA */
-    case 0140:      /* FAD */
-    case 0141:      /* FADL */
-    case 0142:      /* FADM */
-    case 0143:      /* FADB */
-    case 0144:      /* FADR */
-    case 0145:      /* FADRI */
-    case 0146:      /* FADRM */
-    case 0147:      /* FADRB */
+    OPCODE(0130):      /* UFA */
+    OPCODE(0140):      /* FAD */
+    OPCODE(0141):      /* FADL */
+    OPCODE(0142):      /* FADM */
+    OPCODE(0143):      /* FADB */
+    OPCODE(0144):      /* FADR */
+    OPCODE(0145):      /* FADRI */
+    OPCODE(0146):      /* FADRM */
+    OPCODE(0147):      /* FADRB */
               SC = ((BR >> 27) & 0777);
               if ((BR & SMASK) == (AR & SMASK)) {
                   SCAD = SC + (((AR >> 27) & 0777) ^ 0777) + 1;
@@ -2192,14 +2496,14 @@ fxnorm:
               }
               break;
 
-    case 0160:      /* FMP */
-    case 0161:      /* FMPL */
-    case 0162:      /* FMPM */
-    case 0163:      /* FMPB */
-    case 0164:      /* FMPR */
-    case 0165:      /* FMPRI */
-    case 0166:      /* FMPRM */
-    case 0167:      /* FMPRB */
+    OPCODE(0160):      /* FMP */
+    OPCODE(0161):      /* FMPL */
+    OPCODE(0162):      /* FMPM */
+    OPCODE(0163):      /* FMPB */
+    OPCODE(0164):      /* FMPR */
+    OPCODE(0165):      /* FMPRI */
+    OPCODE(0166):      /* FMPRM */
+    OPCODE(0167):      /* FMPRB */
               /* Compute exponent */
               SC = (((BR & SMASK) ? 0777 : 0) ^ (BR >> 27)) & 0777;
               SC += (((AR & SMASK) ? 0777 : 0) ^ (AR >> 27)) & 0777;
@@ -2220,13 +2524,13 @@ fxnorm:
               AR = (AR * BR);
               goto fnorm;
 
-    case 0170:      /* FDV */
-    case 0172:      /* FDVM */
-    case 0173:      /* FDVB */
-    case 0174:      /* FDVR */
-    case 0175:      /* FDVRI */
-    case 0176:      /* FDVRM */
-    case 0177:      /* FDVRB */
+    OPCODE(0170):      /* FDV */
+    OPCODE(0172):      /* FDVM */
+    OPCODE(0173):      /* FDVB */
+    OPCODE(0174):      /* FDVR */
+    OPCODE(0175):      /* FDVRI */
+    OPCODE(0176):      /* FDVRM */
+    OPCODE(0177):      /* FDVRB */
               flag1 = 0;
               SC = (int)((((BR & SMASK) ? 0777 : 0) ^ (BR >> 27)) & 0777);
               SC += (int)((((AR & SMASK) ? 0 : 0777) ^ (AR >> 27)) & 0777);
@@ -2286,7 +2590,7 @@ fxnorm:
               AR |= ((uint64)(SCAD & 0377)) << 27;
               break;
 
-    case 0171:      /* FDVL */
+    OPCODE(0171):      /* FDVL */
               flag1 = 0;
               SC = (int)((((BR & SMASK) ? 0777 : 0) ^ (BR >> 27)) & 0777);
               SC += (int)((((AR & SMASK) ? 0 : 0777) ^ (AR >> 27)) & 0777);
@@ -2374,27 +2678,27 @@ fxnorm:
               break;
 
                    /* FWT */
-    case 0200:     /* MOVE */
-    case 0201:     /* MOVEI */
-    case 0202:     /* MOVEM */
-    case 0203:     /* MOVES */
-    case 0204:     /* MOVS */
-    case 0205:     /* MOVSI */
-    case 0206:     /* MOVSM */
-    case 0207:     /* MOVSS */
-              break;
-
-    case 0214:     /* MOVM */
-    case 0215:     /* MOVMI */
-    case 0216:     /* MOVMM */
-    case 0217:     /* MOVMS */
+    OPCODE(0200):     /* MOVE */
+    OPCODE(0201):     /* MOVEI */
+    OPCODE(0202):     /* MOVEM */
+    OPCODE(0203):     /* MOVES */
+    OPCODE(0204):     /* MOVS */
+    OPCODE(0205):     /* MOVSI */
+    OPCODE(0206):     /* MOVSM */
+    OPCODE(0207):     /* MOVSS */
+              break;
+
+    OPCODE(0214):     /* MOVM */
+    OPCODE(0215):     /* MOVMI */
+    OPCODE(0216):     /* MOVMM */
+    OPCODE(0217):     /* MOVMS */
               if ((AR & SMASK) == 0)
                   break;
 
-    case 0210:     /* MOVN */
-    case 0211:     /* MOVNI */
-    case 0212:     /* MOVNM */
-    case 0213:     /* MOVNS */
+    OPCODE(0210):     /* MOVN */
+    OPCODE(0211):     /* MOVNI */
+    OPCODE(0212):     /* MOVNM */
+    OPCODE(0213):     /* MOVNS */
               flag1 = flag3 = 0;
               FLAGS &= 01777;
               if ((((AR & CMASK) ^ CMASK) + 1) & SMASK) {
@@ -2417,14 +2721,14 @@ fxnorm:
               AR = AD & FMASK;
               break;
 
-    case 0220:      /* IMUL */
-    case 0221:      /* IMULI */
-    case 0222:      /* IMULM */
-    case 0223:      /* IMULB */
-    case 0224:      /* MUL */
-    case 0225:      /* MULI */
-    case 0226:      /* MULM */
-    case 0227:      /* MULB */
+    OPCODE(0220):      /* IMUL */
+    OPCODE(0221):      /* IMULI */
+    OPCODE(0222):      /* IMULM */
+    OPCODE(0223):      /* IMULB */
+    OPCODE(0224):      /* MUL */
+    OPCODE(0225):      /* MULI */
+    OPCODE(0226):      /* MULM */
+    OPCODE(0227):      /* MULB */
               flag3 = 0;
               if (AR & SMASK) {
                  AR = (CM(AR) + 1) & FMASK;
@@ -2479,10 +2783,10 @@ fxnorm:
               MQ = (MQ & ~SMASK) | (AR & SMASK);
               break;
 
-    case 0230:       /* IDIV */
-    case 0231:       /* IDIVI */
-    case 0232:       /* IDIVM */
-    case 0233:       /* IDIVB */
+    OPCODE(0230):       /* IDIV */
+    OPCODE(0231):       /* IDIVI */
+    OPCODE(0232):       /* IDIVM */
+    OPCODE(0233):       /* IDIVB */
               flag1 = 0;
               flag3 = 0;
               if (BR & SMASK) {
@@ -2511,10 +2815,10 @@ fxnorm:
                  MQ = (CM(MQ) + 1) & FMASK;
               break;
 
-    case 0234:       /* DIV */
-    case 0235:       /* DIVI */
-    case 0236:       /* DIVM */
-    case 0237:       /* DIVB */
+    OPCODE(0234):       /* DIV */
+    OPCODE(0235):       /* DIVI */
+    OPCODE(0236):       /* DIVM */
+    OPCODE(0237):       /* DIVB */
               flag1 = 0;
               flag3 = 0;
               if (AR & SMASK) {
@@ -2583,7 +2887,7 @@ fxnorm:
               break;
 
                /* Shift */
-    case 0240: /* ASH */
+    OPCODE(0240): /* ASH */
               SC = ((AB & LSIGN) ? (0377 ^ AB) + 1 : AB) & 0377;
               if (SC == 0)
                   break;
@@ -2602,7 +2906,7 @@ fxnorm:
               }
               break;
 
-    case 0241: /* ROT */
+    OPCODE(0241): /* ROT */
 #if KI | KL
               SC = (AB & LSIGN) ? 
                       ((AB & 0377) ? (((0377 ^ AB) + 1) & 0377) : 0400) : (AB & 0377);
@@ -2617,7 +2921,7 @@ fxnorm:
               AR = ((AR << SC) | (AR >> (36 - SC))) & FMASK;
               break;
 
-    case 0242: /* LSH */
+    OPCODE(0242): /* LSH */
               SC = ((AB & LSIGN) ? (0377 ^ AB) + 1 : AB) & 0777;
               if (SC == 0)
                   break;
@@ -2628,7 +2932,7 @@ fxnorm:
               }
               break;
 
-    case 0243:  /* JFFO */
+    OPCODE(0243):  /* JFFO */
 #if !PDP6
               SC = 0;
               if (AR != 0) {
@@ -2640,7 +2944,7 @@ fxnorm:
 #endif
               break;
 
-    case 0244: /* ASHC */
+    OPCODE(0244): /* ASHC */
               SC = ((AB & LSIGN) ? (0377 ^ AB) + 1 : AB) & 0377;
               if (SC == 0)
                   break;
@@ -2679,7 +2983,7 @@ fxnorm:
               }
               break;
 
-    case 0245: /* ROTC */
+    OPCODE(0245): /* ROTC */
 #if KI | KL
               SC = (AB & LSIGN) ? 
                       ((AB & 0377) ? (((0377 ^ AB) + 1) & 0377) : 0400) : (AB & 0377);
@@ -2702,7 +3006,7 @@ fxnorm:
               AR = AD;
               break;
 
-    case 0246: /* LSHC */
+    OPCODE(0246): /* LSHC */
               SC = ((AB & LSIGN) ? (0377 ^ AB) + 1 : AB) & 0377;
               if (SC == 0)
                   break;
@@ -2731,11 +3035,11 @@ fxnorm:
               break;
 
           /* Branch */
-    case 0250:  /* EXCH */
+    OPCODE(0250):  /* EXCH */
               set_reg(AC, BR);
               break;
 
-    case 0251: /* BLT */
+    OPCODE(0251): /* BLT */
               BR = AB;
               do {
                   if (sim_interval <= 0) {
@@ -2769,7 +3073,7 @@ fxnorm:
               } while ((AD & C1) == 0);
               break;
 
-    case 0252: /* AOBJP */
+    OPCODE(0252): /* AOBJP */
               AR = AOB(AR);
               if ((AR & SMASK) == 0) {
                   PC = AB;
@@ -2778,7 +3082,7 @@ fxnorm:
               AR &= FMASK;
               break;
 
-    case 0253: /* AOBJN */
+    OPCODE(0253): /* AOBJN */
               AR = AOB(AR);
               if ((AR & SMASK) != 0) {
                   PC = AB;
@@ -2787,7 +3091,7 @@ fxnorm:
               AR &= FMASK;
               break;
 
-    case 0254: /* JRST */      /* AR Frm PC */
+    OPCODE(0254): /* JRST */      /* AR Frm PC */
               if (uuo_cycle | pi_cycle) {
                  FLAGS &= ~USER; /* Clear USER */
               }
@@ -2844,7 +3148,7 @@ fxnorm:
               f_pc_inh = 1;
               break;
 
-    case 0255: /* JFCL */
+    OPCODE(0255): /* JFCL */
               if ((FLAGS >> 9) & AC) {
                   PC = AR & RMASK;
                   f_pc_inh = 1;
@@ -2852,7 +3156,7 @@ fxnorm:
               FLAGS &=  017777 ^ (AC << 9);
               break;
 
-    case 0256: /* XCT */
+    OPCODE(0256): /* XCT */
               f_load_pc = 0;
               f_pc_inh = 1;
 #if KI | KL
@@ -2861,7 +3165,7 @@ fxnorm:
 #endif
               break;
 
-    case 0257:  /* MAP */
+    OPCODE(0257):  /* MAP */
 #if KI | KL
               f = AB >> 9;
               last_page = ((f ^ 0777) << 1); 
@@ -2910,7 +3214,7 @@ fxnorm:
               break;
 
               /* Stack, JUMP */
-    case 0260:  /* PUSHJ */     /* AR Frm PC */
+    OPCODE(0260):  /* PUSHJ */     /* AR Frm PC */
               MB = ((uint64)(FLAGS) << 23) | ((PC + !pi_cycle) & RMASK);
               BR = AB;
               AR = AOB(AR);
@@ -2935,7 +3239,7 @@ fxnorm:
               f_pc_inh = 1;
               break;
 
-    case 0261: /* PUSH */
+    OPCODE(0261): /* PUSH */
               AR = AOB(AR);
               AB = AR & RMASK;
               if (AR & C1) {
@@ -2953,7 +3257,7 @@ fxnorm:
                  goto last;
               break;
 
-    case 0262: /* POP */
+    OPCODE(0262): /* POP */
               AB = AR & RMASK;
               if (Mem_read(0, 0))
                   goto last;
@@ -2973,7 +3277,7 @@ fxnorm:
               AR &= FMASK;
               break;
 
-    case 0263: /* POPJ */
+    OPCODE(0263): /* POPJ */
               AB = AR & RMASK;
               if (Mem_read(0, 0))
                   goto last;
@@ -2992,7 +3296,7 @@ fxnorm:
               f_pc_inh = 1;
               break;
 
-    case 0264: /* JSR */       /* AR Frm PC */
+    OPCODE(0264): /* JSR */       /* AR Frm PC */
               MB = ((uint64)(FLAGS) << 23) |
                       ((PC + !pi_cycle) & RMASK);
               if (uuo_cycle | pi_cycle) {
@@ -3005,7 +3309,7 @@ fxnorm:
               f_pc_inh = 1;
               break;
 
-    case 0265: /* JSP */       /* AR Frm PC */
+    OPCODE(0265): /* JSP */       /* AR Frm PC */
               AD = ((uint64)(FLAGS) << 23) |
                       ((PC + !pi_cycle) & RMASK);
               FLAGS &= ~ (BYTI|ADRFLT|TRP1|TRP2);
@@ -3017,7 +3321,7 @@ fxnorm:
               f_pc_inh = 1;
               break;
 
-    case 0266: /* JSA */       /* AR Frm PC */
+    OPCODE(0266): /* JSA */       /* AR Frm PC */
               set_reg(AC, (AR << 18) | ((PC + 1) & RMASK));
               if (uuo_cycle | pi_cycle) {
                  FLAGS &= ~(USER|PUBLIC); /* Clear USER */
@@ -3026,7 +3330,7 @@ fxnorm:
               AR = BR;
               break;
 
-    case 0267: /* JRA */
+    OPCODE(0267): /* JRA */
               AD = AB;   
               AB = (get_reg(AC) >> 18) & RMASK;
               if (Mem_read(uuo_cycle | pi_cycle, 0))
@@ -3036,10 +3340,10 @@ fxnorm:
               f_pc_inh = 1;
               break;
 
-    case 0270: /* ADD */
-    case 0271: /* ADDI */
-    case 0272: /* ADDM */
-    case 0273: /* ADDB */
+    OPCODE(0270): /* ADD */
+    OPCODE(0271): /* ADDI */
+    OPCODE(0272): /* ADDM */
+    OPCODE(0273): /* ADDB */
               flag1 = flag3 = 0;
               FLAGS &= 01777;
               if (((AR & CMASK) + (BR & CMASK)) & SMASK) {
@@ -3060,10 +3364,10 @@ fxnorm:
               AR = BR;
               break;
 
-    case 0274: /* SUB */
-    case 0275: /* SUBI */
-    case 0276: /* SUBM */
-    case 0277: /* SUBB */
+    OPCODE(0274): /* SUB */
+    OPCODE(0275): /* SUBI */
+    OPCODE(0276): /* SUBM */
+    OPCODE(0277): /* SUBB */
               flag1 = flag3 = 0;
               FLAGS &= 01777;
               if ((((AR & CMASK) ^ CMASK) + (BR & CMASK) + 1) & SMASK) {
@@ -3085,22 +3389,22 @@ fxnorm:
               break;
 
                /* SKIP */
-    case 0300:    /* CAI */
-    case 0301:    /* CAIL */
-    case 0302:    /* CAIE */
-    case 0303:    /* CAILE */
-    case 0304:    /* CAIA */
-    case 0305:    /* CAIGE */
-    case 0306:    /* CAIN */
-    case 0307:    /* CAIG */
-    case 0310:    /* CAM */
-    case 0311:    /* CAML */
-    case 0312:    /* CAME */
-    case 0313:    /* CAMLE */
-    case 0314:    /* CAMA */
-    case 0315:    /* CAMGE */
-    case 0316:    /* CAMN */
-    case 0317:    /* CAMG */
+    OPCODE(0300):    /* CAI */
+    OPCODE(0301):    /* CAIL */
+    OPCODE(0302):    /* CAIE */
+    OPCODE(0303):    /* CAILE */
+    OPCODE(0304):    /* CAIA */
+    OPCODE(0305):    /* CAIGE */
+    OPCODE(0306):    /* CAIN */
+    OPCODE(0307):    /* CAIG */
+    OPCODE(0310):    /* CAM */
+    OPCODE(0311):    /* CAML */
+    OPCODE(0312):    /* CAME */
+    OPCODE(0313):    /* CAMLE */
+    OPCODE(0314):    /* CAMA */
+    OPCODE(0315):    /* CAMGE */
+    OPCODE(0316):    /* CAMN */
+    OPCODE(0317):    /* CAMG */
               f = 0;
               AD = (CM(AR) + BR) + 1;
               if (((BR & SMASK) != 0) && (AR & SMASK) == 0)
@@ -3110,46 +3414,46 @@ fxnorm:
                  f = 1;
               goto skip_op;
 
-    case 0320: /* JUMP */
-    case 0321: /* JUMPL */
-    case 0322: /* JUMPE */
-    case 0323: /* JUMPLE */
-    case 0324: /* JUMPA */
-    case 0325: /* JUMPGE */
-    case 0326: /* JUMPN */
-    case 0327: /* JUMPG */
+    OPCODE(0320): /* JUMP */
+    OPCODE(0321): /* JUMPL */
+    OPCODE(0322): /* JUMPE */
+    OPCODE(0323): /* JUMPLE */
+    OPCODE(0324): /* JUMPA */
+    OPCODE(0325): /* JUMPGE */
+    OPCODE(0326): /* JUMPN */
+    OPCODE(0327): /* JUMPG */
               AD = AR;
               f = ((AD & SMASK) != 0);
               goto jump_op;                   /* JUMP, SKIP */
 
-    case 0330: /* SKIP */
-    case 0331: /* SKIPL */
-    case 0332: /* SKIPE */
-    case 0333: /* SKIPLE */
-    case 0334: /* SKIPA */
-    case 0335: /* SKIPGE */
-    case 0336: /* SKIPN */
-    case 0337: /* SKIPG */
+    OPCODE(0330): /* SKIP */
+    OPCODE(0331): /* SKIPL */
+    OPCODE(0332): /* SKIPE */
+    OPCODE(0333): /* SKIPLE */
+    OPCODE(0334): /* SKIPA */
+    OPCODE(0335): /* SKIPGE */
+    OPCODE(0336): /* SKIPN */
+    OPCODE(0337): /* SKIPG */
               AD = AR;
               f = ((AD & SMASK) != 0);
               goto skip_op;                   /* JUMP, SKIP */
 
-    case 0340: /* AOJ */
-    case 0341: /* AOJL */
-    case 0342: /* AOJE */
-    case 0343: /* AOJLE */
-    case 0344: /* AOJA */
-    case 0345: /* AOJGE */
-    case 0346: /* AOJN */
-    case 0347: /* AOJG */
-    case 0360: /* SOJ */
-    case 0361: /* SOJL */
-    case 0362: /* SOJE */
-    case 0363: /* SOJLE */
-    case 0364: /* SOJA */
-    case 0365: /* SOJGE */
-    case 0366: /* SOJN */
-    case 0367: /* SOJG */
+    OPCODE(0340): /* AOJ */
+    OPCODE(0341): /* AOJL */
+    OPCODE(0342): /* AOJE */
+    OPCODE(0343): /* AOJLE */
+    OPCODE(0344): /* AOJA */
+    OPCODE(0345): /* AOJGE */
+    OPCODE(0346): /* AOJN */
+    OPCODE(0347): /* AOJG */
+    OPCODE(0360): /* SOJ */
+    OPCODE(0361): /* SOJL */
+    OPCODE(0362): /* SOJE */
+    OPCODE(0363): /* SOJLE */
+    OPCODE(0364): /* SOJA */
+    OPCODE(0365): /* SOJGE */
+    OPCODE(0366): /* SOJN */
+    OPCODE(0367): /* SOJG */
               flag1 = flag3 = 0;
               FLAGS &= 01777;
               AD = (IR & 020) ? FMASK : 1;
@@ -3179,22 +3483,22 @@ jump_op:
               }
               break;
 
-    case 0350: /* AOS */
-    case 0351: /* AOSL */
-    case 0352: /* AOSE */
-    case 0353: /* AOSLE */
-    case 0354: /* AOSA */
-    case 0355: /* AOSGE */
-    case 0356: /* AOSN */
-    case 0357: /* AOSG */
-    case 0370: /* SOS */
-    case 0371: /* SOSL */
-    case 0372: /* SOSE */
-    case 0373: /* SOSLE */
-    case 0374: /* SOSA */
-    case 0375: /* SOSGE */
-    case 0376: /* SOSN */
-    case 0377: /* SOSG */
+    OPCODE(0350): /* AOS */
+    OPCODE(0351): /* AOSL */
+    OPCODE(0352): /* AOSE */
+    OPCODE(0353): /* AOSLE */
+    OPCODE(0354): /* AOSA */
+    OPCODE(0355): /* AOSGE */
+    OPCODE(0356): /* AOSN */
+    OPCODE(0357): /* AOSG */
+    OPCODE(0370): /* SOS */
+    OPCODE(0371): /* SOSL */
+    OPCODE(0372): /* SOSE */
+    OPCODE(0373): /* SOSLE */
+    OPCODE(0374): /* SOSA */
+    OPCODE(0375): /* SOSGE */
+    OPCODE(0376): /* SOSN */
+    OPCODE(0377): /* SOSG */
               flag1 = flag3 = 0;
               FLAGS &= 01777;
               AD = (IR & 020) ? FMASK : 1;
@@ -3229,281 +3533,281 @@ skip_op:
               break;
 
               /* Bool */
-    case 0400:    /* SETZ */
-    case 0401:    /* SETZI */
-    case 0402:    /* SETZM */
-    case 0403:    /* SETZB */
+    OPCODE(0400):    /* SETZ */
+    OPCODE(0401):    /* SETZI */
+    OPCODE(0402):    /* SETZM */
+    OPCODE(0403):    /* SETZB */
               AR = 0;                   /* SETZ */
               break;
 
-    case 0404:    /* AND */
-    case 0405:    /* ANDI */
-    case 0406:    /* ANDM */
-    case 0407:    /* ANDB */
+    OPCODE(0404):    /* AND */
+    OPCODE(0405):    /* ANDI */
+    OPCODE(0406):    /* ANDM */
+    OPCODE(0407):    /* ANDB */
               AR = AR & BR;             /* AND */
               break;
 
-    case 0410:    /* ANDCA */
-    case 0411:    /* ANDCAI */
-    case 0412:    /* ANDCAM */
-    case 0413:    /* ANDCAB */
+    OPCODE(0410):    /* ANDCA */
+    OPCODE(0411):    /* ANDCAI */
+    OPCODE(0412):    /* ANDCAM */
+    OPCODE(0413):    /* ANDCAB */
               AR = AR & CM(BR);         /* ANDCA */
               break;
 
-    case 0414:    /* SETM */
-    case 0415:    /* SETMI */
-    case 0416:    /* SETMM */
-    case 0417:    /* SETMB */
+    OPCODE(0414):    /* SETM */
+    OPCODE(0415):    /* SETMI */
+    OPCODE(0416):    /* SETMM */
+    OPCODE(0417):    /* SETMB */
                                          /* SETM */
               break;
 
-    case 0420:    /* ANDCM */
-    case 0421:    /* ANDCMI */
-    case 0422:    /* ANDCMM */
-    case 0423:    /* ANDCMB */
+    OPCODE(0420):    /* ANDCM */
+    OPCODE(0421):    /* ANDCMI */
+    OPCODE(0422):    /* ANDCMM */
+    OPCODE(0423):    /* ANDCMB */
               AR = CM(AR) & BR;         /* ANDCM */
               break;
 
-    case 0424:    /* SETA */
-    case 0425:    /* SETAI */
-    case 0426:    /* SETAM */
-    case 0427:    /* SETAB */
+    OPCODE(0424):    /* SETA */
+    OPCODE(0425):    /* SETAI */
+    OPCODE(0426):    /* SETAM */
+    OPCODE(0427):    /* SETAB */
               AR = BR;                  /* SETA */
               break;
 
-    case 0430:    /* XOR */
-    case 0431:    /* XORI */
-    case 0432:    /* XORM */
-    case 0433:    /* XORB */
+    OPCODE(0430):    /* XOR */
+    OPCODE(0431):    /* XORI */
+    OPCODE(0432):    /* XORM */
+    OPCODE(0433):    /* XORB */
               AR = AR ^ BR;             /* XOR */
               break;
 
-    case 0434:    /* IOR */
-    case 0435:    /* IORI */
-    case 0436:    /* IORM */
-    case 0437:    /* IORB */
+    OPCODE(0434):    /* IOR */
+    OPCODE(0435):    /* IORI */
+    OPCODE(0436):    /* IORM */
+    OPCODE(0437):    /* IORB */
               AR = CM(CM(AR) & CM(BR)); /* IOR */
               break;
 
-    case 0440:    /* ANDCB */
-    case 0441:    /* ANDCBI */
-    case 0442:    /* ANDCBM */
-    case 0443:    /* ANDCBB */
+    OPCODE(0440):    /* ANDCB */
+    OPCODE(0441):    /* ANDCBI */
+    OPCODE(0442):    /* ANDCBM */
+    OPCODE(0443):    /* ANDCBB */
               AR = CM(AR) & CM(BR);     /* ANDCB */
               break;
 
-    case 0444:    /* EQV */
-    case 0445:    /* EQVI */
-    case 0446:    /* EQVM */
-    case 0447:    /* EQVB */
+    OPCODE(0444):    /* EQV */
+    OPCODE(0445):    /* EQVI */
+    OPCODE(0446):    /* EQVM */
+    OPCODE(0447):    /* EQVB */
               AR = CM(AR ^ BR);         /* EQV */
               break;
 
-    case 0450:    /* SETCA */
-    case 0451:    /* SETCAI */
-    case 0452:    /* SETCAM */
-    case 0453:    /* SETCAB */
+    OPCODE(0450):    /* SETCA */
+    OPCODE(0451):    /* SETCAI */
+    OPCODE(0452):    /* SETCAM */
+    OPCODE(0453):    /* SETCAB */
               AR = CM(BR);              /* SETCA */
               break;
 
-    case 0454:    /* ORCA */
-    case 0455:    /* ORCAI */
-    case 0456:    /* ORCAM */
-    case 0457:    /* ORCAB */
+    OPCODE(0454):    /* ORCA */
+    OPCODE(0455):    /* ORCAI */
+    OPCODE(0456):    /* ORCAM */
+    OPCODE(0457):    /* ORCAB */
               AR = CM(CM(AR) & BR);     /* ORCA */
               break;
 
-    case 0460:    /* SETCM */
-    case 0461:    /* SETCMI */
-    case 0462:    /* SETCMM */
-    case 0463:    /* SETCMB */
+    OPCODE(0460):    /* SETCM */
+    OPCODE(0461):    /* SETCMI */
+    OPCODE(0462):    /* SETCMM */
+    OPCODE(0463):    /* SETCMB */
               AR = CM(AR);              /* SETCM */
               break;
 
-    case 0464:    /* ORCM */
-    case 0465:    /* ORCMI */
-    case 0466:    /* ORCMM */
-    case 0467:    /* ORCMB */
+    OPCODE(0464):    /* ORCM */
+    OPCODE(0465):    /* ORCMI */
+    OPCODE(0466):    /* ORCMM */
+    OPCODE(0467):    /* ORCMB */
               AR = CM(AR & CM(BR));     /* ORCM */
               break;
 
-    case 0470:    /* ORCB */
-    case 0471:    /* ORCBI */
-    case 0472:    /* ORCBM */
-    case 0473:    /* ORCBB */
+    OPCODE(0470):    /* ORCB */
+    OPCODE(0471):    /* ORCBI */
+    OPCODE(0472):    /* ORCBM */
+    OPCODE(0473):    /* ORCBB */
               AR = CM(AR & BR);         /* ORCB */
               break;
 
-    case 0474:    /* SETO */
-    case 0475:    /* SETOI */
-    case 0476:    /* SETOM */
-    case 0477:    /* SETOB */
+    OPCODE(0474):    /* SETO */
+    OPCODE(0475):    /* SETOI */
+    OPCODE(0476):    /* SETOM */
+    OPCODE(0477):    /* SETOB */
               AR = FMASK;               /* SETO */
               break;
 
-    case 0500: /* HLL */
-    case 0501: /* HLLI */
-    case 0502: /* HLLM */
-    case 0503: /* HLLS */
-    case 0504: /* HRL */
-    case 0505: /* HRLI */
-    case 0506: /* HRLM */
-    case 0507: /* HRLS */
+    OPCODE(0500): /* HLL */
+    OPCODE(0501): /* HLLI */
+    OPCODE(0502): /* HLLM */
+    OPCODE(0503): /* HLLS */
+    OPCODE(0504): /* HRL */
+    OPCODE(0505): /* HRLI */
+    OPCODE(0506): /* HRLM */
+    OPCODE(0507): /* HRLS */
               AR = (AR & LMASK) | (BR & RMASK);
               break;
 
-    case 0510: /* HLLZ */
-    case 0511: /* HLLZI */
-    case 0512: /* HLLZM */
-    case 0513: /* HLLZS */
-    case 0514: /* HRLZ */
-    case 0515: /* HRLZI */
-    case 0516: /* HRLZM */
-    case 0517: /* HRLZS */
+    OPCODE(0510): /* HLLZ */
+    OPCODE(0511): /* HLLZI */
+    OPCODE(0512): /* HLLZM */
+    OPCODE(0513): /* HLLZS */
+    OPCODE(0514): /* HRLZ */
+    OPCODE(0515): /* HRLZI */
+    OPCODE(0516): /* HRLZM */
+    OPCODE(0517): /* HRLZS */
               AR = (AR & LMASK);
               break;
 
-    case 0520: /* HLLO */
-    case 0521: /* HLLOI */
-    case 0522: /* HLLOM */
-    case 0523: /* HLLOS */
-    case 0524: /* HRLO */
-    case 0525: /* HRLOI */
-    case 0526: /* HRLOM */
-    case 0527: /* HRLOS */
+    OPCODE(0520): /* HLLO */
+    OPCODE(0521): /* HLLOI */
+    OPCODE(0522): /* HLLOM */
+    OPCODE(0523): /* HLLOS */
+    OPCODE(0524): /* HRLO */
+    OPCODE(0525): /* HRLOI */
+    OPCODE(0526): /* HRLOM */
+    OPCODE(0527): /* HRLOS */
               AR = (AR & LMASK) | RMASK;
               break;
 
-    case 0530: /* HLLE */
-    case 0531: /* HLLEI */
-    case 0532: /* HLLEM */
-    case 0533: /* HLLES */
-    case 0534: /* HRLE */
-    case 0535: /* HRLEI */
-    case 0536: /* HRLEM */
-    case 0537: /* HRLES */
+    OPCODE(0530): /* HLLE */
+    OPCODE(0531): /* HLLEI */
+    OPCODE(0532): /* HLLEM */
+    OPCODE(0533): /* HLLES */
+    OPCODE(0534): /* HRLE */
+    OPCODE(0535): /* HRLEI */
+    OPCODE(0536): /* HRLEM */
+    OPCODE(0537): /* HRLES */
               AD = ((AR & SMASK) != 0) ? RMASK : 0;
               AR = (AR & LMASK) | AD;
               break;
 
-    case 0540: /* HRR */
-    case 0541: /* HRRI */
-    case 0542: /* HRRM */
-    case 0543: /* HRRS */
-    case 0544: /* HLR */
-    case 0545: /* HLRI */
-    case 0546: /* HLRM */
-    case 0547: /* HLRS */
+    OPCODE(0540): /* HRR */
+    OPCODE(0541): /* HRRI */
+    OPCODE(0542): /* HRRM */
+    OPCODE(0543): /* HRRS */
+    OPCODE(0544): /* HLR */
+    OPCODE(0545): /* HLRI */
+    OPCODE(0546): /* HLRM */
+    OPCODE(0547): /* HLRS */
               AR = (BR & LMASK) | (AR & RMASK);
               break;
 
-    case 0550: /* HRRZ */
-    case 0551: /* HRRZI */
-    case 0552: /* HRRZM */
-    case 0553: /* HRRZS */
-    case 0554: /* HLRZ */
-    case 0555: /* HLRZI */
-    case 0556: /* HLRZM */
-    case 0557: /* HLRZS */
+    OPCODE(0550): /* HRRZ */
+    OPCODE(0551): /* HRRZI */
+    OPCODE(0552): /* HRRZM */
+    OPCODE(0553): /* HRRZS */
+    OPCODE(0554): /* HLRZ */
+    OPCODE(0555): /* HLRZI */
+    OPCODE(0556): /* HLRZM */
+    OPCODE(0557): /* HLRZS */
               AR = (AR & RMASK);
               break;
 
-    case 0560: /* HRRO */
-    case 0561: /* HRROI */
-    case 0562: /* HRROM */
-    case 0563: /* HRROS */
-    case 0564: /* HLRO */
-    case 0565: /* HLROI */
-    case 0566: /* HLROM */
-    case 0567: /* HLROS */
+    OPCODE(0560): /* HRRO */
+    OPCODE(0561): /* HRROI */
+    OPCODE(0562): /* HRROM */
+    OPCODE(0563): /* HRROS */
+    OPCODE(0564): /* HLRO */
+    OPCODE(0565): /* HLROI */
+    OPCODE(0566): /* HLROM */
+    OPCODE(0567): /* HLROS */
               AR = LMASK | (AR & RMASK);
               break;
 
-    case 0570: /* HRRE */
-    case 0571: /* HRREI */
-    case 0572: /* HRREM */
-    case 0573: /* HRRES */
-    case 0574: /* HLRE */
-    case 0575: /* HLREI */
-    case 0576: /* HLREM */
-    case 0577: /* HLRES */
+    OPCODE(0570): /* HRRE */
+    OPCODE(0571): /* HRREI */
+    OPCODE(0572): /* HRREM */
+    OPCODE(0573): /* HRRES */
+    OPCODE(0574): /* HLRE */
+    OPCODE(0575): /* HLREI */
+    OPCODE(0576): /* HLREM */
+    OPCODE(0577): /* HLRES */
               AD = ((AR & LSIGN) != 0) ? LMASK: 0;
               AR = AD | (AR & RMASK);
               break;
 
-    case 0600: /* TxN */
-    case 0601: /* TxN */
-    case 0602: /* TxN */
-    case 0603: /* TxN */
-    case 0604: /* TxN */
-    case 0605: /* TxN */
-    case 0606: /* TxN */
-    case 0607: /* TxN */
-    case 0610:
-    case 0611:
-    case 0612:
-    case 0613:
-    case 0614:
-    case 0615:
-    case 0616:
-    case 0617:
+    OPCODE(0600): /* TxN */
+    OPCODE(0601): /* TxN */
+    OPCODE(0602): /* TxN */
+    OPCODE(0603): /* TxN */
+    OPCODE(0604): /* TxN */
+    OPCODE(0605): /* TxN */
+    OPCODE(0606): /* TxN */
+    OPCODE(0607): /* TxN */
+    OPCODE(0610):
+    OPCODE(0611):
+    OPCODE(0612):
+    OPCODE(0613):
+    OPCODE(0614):
+    OPCODE(0615):
+    OPCODE(0616):
+    OPCODE(0617):
               MQ = AR;            /* N */
               goto test_op;
 
-    case 0620: /* TxZ */
-    case 0621: /* TxZ */
-    case 0622: /* TxZ */
-    case 0623: /* TxZ */
-    case 0624: /* TxZ */
-    case 0625: /* TxZ */
-    case 0626: /* TxZ */
-    case 0627: /* TxZ */
-    case 0630:
-    case 0631:
-    case 0632:
-    case 0633:
-    case 0634:
-    case 0635:
-    case 0636:
-    case 0637:
+    OPCODE(0620): /* TxZ */
+    OPCODE(0621): /* TxZ */
+    OPCODE(0622): /* TxZ */
+    OPCODE(0623): /* TxZ */
+    OPCODE(0624): /* TxZ */
+    OPCODE(0625): /* TxZ */
+    OPCODE(0626): /* TxZ */
+    OPCODE(0627): /* TxZ */
+    OPCODE(0630):
+    OPCODE(0631):
+    OPCODE(0632):
+    OPCODE(0633):
+    OPCODE(0634):
+    OPCODE(0635):
+    OPCODE(0636):
+    OPCODE(0637):
               MQ = CM(AR) & BR;   /* Z */
               goto test_op;
 
-    case 0640: /* TxC */
-    case 0641: /* TxC */
-    case 0642: /* TxC */
-    case 0643: /* TxC */
-    case 0644: /* TxC */
-    case 0645: /* TxC */
-    case 0646: /* TxC */
-    case 0647: /* TxC */
-    case 0650:
-    case 0651:
-    case 0652:
-    case 0653:
-    case 0654:
-    case 0655:
-    case 0656:
-    case 0657:
+    OPCODE(0640): /* TxC */
+    OPCODE(0641): /* TxC */
+    OPCODE(0642): /* TxC */
+    OPCODE(0643): /* TxC */
+    OPCODE(0644): /* TxC */
+    OPCODE(0645): /* TxC */
+    OPCODE(0646): /* TxC */
+    OPCODE(0647): /* TxC */
+    OPCODE(0650):
+    OPCODE(0651):
+    OPCODE(0652):
+    OPCODE(0653):
+    OPCODE(0654):
+    OPCODE(0655):
+    OPCODE(0656):
+    OPCODE(0657):
               MQ = AR ^ BR;       /* C */
               goto test_op;
 
-    case 0660: /* TxO */
-    case 0661: /* TxO */
-    case 0662: /* TxO */
-    case 0663: /* TxO */
-    case 0664: /* TxO */
-    case 0665: /* TxO */
-    case 0666: /* TxO */
-    case 0667: /* TxO */
-    case 0670:
-    case 0671:
-    case 0672:
-    case 0673:
-    case 0674:
-    case 0675:
-    case 0676:
-    case 0677:
+    OPCODE(0660): /* TxO */
+    OPCODE(0661): /* TxO */
+    OPCODE(0662): /* TxO */
+    OPCODE(0663): /* TxO */
+    OPCODE(0664): /* TxO */
+    OPCODE(0665): /* TxO */
+    OPCODE(0666): /* TxO */
+    OPCODE(0667): /* TxO */
+    OPCODE(0670):
+    OPCODE(0671):
+    OPCODE(0672):
+    OPCODE(0673):
+    OPCODE(0674):
+    OPCODE(0675):
+    OPCODE(0676):
+    OPCODE(0677):
               MQ = AR | BR;       /* O */
 test_op:
               AR &= BR;
@@ -3514,22 +3818,22 @@ test_op:
               break;
 
             /* IOT */
-    case 0700: case 0701: case 0702: case 0703:
-    case 0704: case 0705: case 0706: case 0707:
-    case 0710: case 0711: case 0712: case 0713:
-    case 0714: case 0715: case 0716: case 0717:
-    case 0720: case 0721: case 0722: case 0723:
-    case 0724: case 0725: case 0726: case 0727:
-    case 0730: case 0731: case 0732: case 0733:
-    case 0734: case 0735: case 0736: case 0737:
-    case 0740: case 0741: case 0742: case 0743:
-    case 0744: case 0745: case 0746: case 0747:
-    case 0750: case 0751: case 0752: case 0753:
-    case 0754: case 0755: case 0756: case 0757:
-    case 0760: case 0761: case 0762: case 0763:
-    case 0764: case 0765: case 0766: case 0767:
-    case 0770: case 0771: case 0772: case 0773:
-    case 0774: case 0775: case 0776: case 0777:
+    OPCODE(0700): OPCODE(0701): OPCODE(0702): OPCODE(0703):
+    OPCODE(0704): OPCODE(0705): OPCODE(0706): OPCODE(0707):
+    OPCODE(0710): OPCODE(0711): OPCODE(0712): OPCODE(0713):
+    OPCODE(0714): OPCODE(0715): OPCODE(0716): OPCODE(0717):
+    OPCODE(0720): OPCODE(0721): OPCODE(0722): OPCODE(0723):
+    OPCODE(0724): OPCODE(0725): OPCODE(0726): OPCODE(0727):
+    OPCODE(0730): OPCODE(0731): OPCODE(0732): OPCODE(0733):
+    OPCODE(0734): OPCODE(0735): OPCODE(0736): OPCODE(0737):
+    OPCODE(0740): OPCODE(0741): OPCODE(0742): OPCODE(0743):
+    OPCODE(0744): OPCODE(0745): OPCODE(0746): OPCODE(0747):
+    OPCODE(0750): OPCODE(0751): OPCODE(0752): OPCODE(0753):
+    OPCODE(0754): OPCODE(0755): OPCODE(0756): OPCODE(0757):
+    OPCODE(0760): OPCODE(0761): OPCODE(0762): OPCODE(0763):
+    OPCODE(0764): OPCODE(0765): OPCODE(0766): OPCODE(0767):
+    OPCODE(0770): OPCODE(0771): OPCODE(0772): OPCODE(0773):
+    OPCODE(0774): OPCODE(0775): OPCODE(0776): OPCODE(0777):
 #if KI
               if (!pi_cycle && ((FLAGS & (USER|USERIO)) == USER) && 
                     (IR & 040) == 0 || ((FLAGS & (USER|PUBLIC)) == PUBLIC)) { 
@@ -3567,7 +3871,7 @@ test_op:
                           goto fetch_opr;
                           break;
                   case 1:     /* 04 DATAI */
-                          dev_tab[d](DATAI|(d<<2), &AR);
+                          DEV_IO(d, DATAI, &AR);
                           MB = AR;
                           Mem_write(pi_cycle, 0);
                           break;
@@ -3575,24 +3879,24 @@ test_op:
                           if (Mem_read(pi_cycle, 0))
                              break;
                           AR = MB;
-                          dev_tab[d](DATAO|(d<<2), &AR);
+                          DEV_IO(d, DATAO, &AR);
                           break;
                   case 4:     /* 20 CONO */
-                          dev_tab[d](CONO|(d<<2), &AR);
+                          DEV_IO(d, CONO, &AR);
                           break;
                   case 5:     /* 24 CONI */
-                          dev_tab[d](CONI|(d<<2), &AR);
+                          DEV_IO(d, CONI, &AR);
                           MB = AR;
                           Mem_write(pi_cycle, 0);
                           break;
                   case 6:     /* 30 CONSZ */
-                          dev_tab[d](CONI|(d<<2), &AR);
+                          DEV_IO(d, CONI, &AR);
                           AR &= AB;
                           if (AR == 0)
                               PC = (PC + 1) & RMASK;
                           break;
                   case 7:     /* 34 CONSO */
-                          dev_tab[d](CONI|(d<<2), &AR);
+                          DEV_IO(d, CONI, &AR);
                           AR &= AB;
                           if (AR != 0)
                               PC = (PC + 1) & RMASK;
@@ -3714,10 +4018,19 @@ rtc_srv(UNIT * uptr)
 t_stat cpu_reset (DEVICE *dptr)
 {
 int     i;
+#if defined(MEM_HUGE)
+static  int advised = 0;
+
+if (!advised) {                               /* only a hint, so ignore errors */
+    madvise (M, sizeof (M), MADV_HUGEPAGE);
+    advised = 1;
+    }
+#endif
 BYF5 = uuo_cycle = 0;
 #if KA | PDP6
 Pl = Ph = Rl = Rh = Pflag = 0;
 push_ovf = mem_prot = 0;
+set_relocation ();
 #endif
 nxm_flag = clk_flg = 0;
 PIR = PIH = PIE = pi_enable = parity_irq = 0;
@@ -3730,7 +4043,16 @@ pag_reload = ac_stack = 0;
 fm_sel = small_user = user_addr_cmp = page_enable = 0;
 #endif
 for(i=0; i < 128; dev_irq[i++] = 0);
-sim_brk_types = sim_brk_dflt = SWMASK ('E');
+for(i=0; i < 8; dev_irq_cnt[i++] = 0);
+dev_irq_lvl = 0;
+sim_brk_types = SWMASK ('E') | SWMASK ('W');
+sim_brk_dflt = SWMASK ('E');
+watch_hit = 0;
+sim_dirty_register (&cpu_unit, M_dirty, MAXMEMSIZE);
+sim_lights_define (0, 18, pc_lights);
+sim_lights_define (1, 36, mb_lights);
+sim_lights_define (2, 4, ac_lights);
+sim_register_clock_unit (&cpu_unit);        /* pollers coschedule on the tick */
 sim_rtcn_init (cpu_unit.wait, TMR_RTC);
 sim_activate(&cpu_unit, cpu_unit.wait);
 return SCPE_OK;
@@ -3771,6 +4093,7 @@ else {
         return SCPE_NXM;
     M[ea] = val & FMASK;
     }
+MEM_DIRTY(ea);
 return SCPE_OK;
 }
 
@@ -3790,8 +4113,10 @@ if (val < MEMSIZE) {
     if ((mc != 0) && (!get_yn ("Really truncate memory [N]?", FALSE)))
         return SCPE_OK;
 }
-for (i = MEMSIZE; i < val; i++)
+for (i = MEMSIZE; i < val; i++) {
     M[i] = 0;
+    MEM_DIRTY(i);
+    }
 MEMSIZE = val;
 return SCPE_OK;
 }
@@ -3891,13 +4216,42 @@ if (lnt) {
 return SCPE_OK;
 }
 
+/* Print one history entry */
+static void cpu_print_hist (FILE *st, const void *rec)
+{
+const InstHistory *h = (const InstHistory *) rec;
+t_value sim_eval;
+
+fprintf (st, "%06o  ", (uint32)(h->pc & RMASK));
+fprint_val (st, h->ac, 8, 36, PV_RZRO);
+fputs ("  ", st);
+fprintf (st, "%06o  ", h->ea);
+fputs ("  ", st);
+fprint_val (st, h->mb, 8, 36, PV_RZRO);
+fputs ("  ", st);
+fprint_val (st, h->fmb, 8, 36, PV_RZRO);
+fputs ("  ", st);
+fprintf (st, "%06o  ", h->flags);
+if ((h->pc & HIST_PC2) == 0) {
+    sim_eval = h->ir;
+    fprint_val (st, sim_eval, 8, 36, PV_RZRO);
+    fputs ("  ", st);
+    if ((fprint_sym (st, h->pc & RMASK, &sim_eval, &cpu_unit, SWMASK ('M'))) > 0) {
+        fputs ("(undefined) ", st);
+        fprint_val (st, h->ir, 8, 36, PV_RZRO);
+    }
+}
+fputc ('\n', st);                                       /* end line */
+}
+
+#define HIST_TITLE "PC      AC            EA        AR            RES           FLAGS IR\n\n"
+
 /* Show history */
 t_stat cpu_show_hist (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
 {
 int32 k, di, lnt;
 char *cptr = (char *) desc;
 t_stat r;
-t_value sim_eval;
 InstHistory *h;
 
 if (hst_lnt == 0)                                       /* enabled? */
@@ -3911,35 +4265,85 @@ else lnt = hst_lnt;
 di = hst_p - lnt;                                       /* work forward */
 if (di < 0)
     di = di + hst_lnt;
-fprintf (st, "PC      AC            EA        AR            RES           FLAGS IR\n\n");
+fprintf (st, HIST_TITLE);
 for (k = 0; k < lnt; k++) {                             /* print specified */
     h = &hst[(++di) % hst_lnt];                         /* entry pointer */
-    if (h->pc & HIST_PC) {                              /* instruction? */
-        fprintf (st, "%06o  ", (uint32)(h->pc & RMASK));
-        fprint_val (st, h->ac, 8, 36, PV_RZRO);
-        fputs ("  ", st);
-        fprintf (st, "%06o  ", h->ea);
-        fputs ("  ", st);
-        fprint_val (st, h->mb, 8, 36, PV_RZRO);
-        fputs ("  ", st);
-        fprint_val (st, h->fmb, 8, 36, PV_RZRO);
-        fputs ("  ", st);
-        fprintf (st, "%06o  ", h->flags);
-        if ((h->pc & HIST_PC2) == 0) {
-            sim_eval = h->ir;
-            fprint_val (st, sim_eval, 8, 36, PV_RZRO);
-            fputs ("  ", st);
-            if ((fprint_sym (st, h->pc & RMASK, &sim_eval, &cpu_unit, SWMASK ('M'))) > 0) {
-                fputs ("(undefined) ", st);
-                fprint_val (st, h->ir, 8, 36, PV_RZRO);
-            }
-        }
-        fputc ('\n', st);                               /* end line */
-        }                                               /* end else instruction */
+    if (h->pc & HIST_PC)                                /* instruction? */
+        cpu_print_hist (st, h);
     }                                                   /* end for */
 return SCPE_OK;
 }
 
+/* Set history file, records are streamed as each entry is completed */
+t_stat cpu_set_histfile (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+int32 i;
+t_stat r;
+
+if (val == 0) {
+    if (sim_hist_file && hst_lnt && (hst[hst_p].pc & HIST_PC))
+        sim_hist_write (&hst[hst_p]);                   /* last entry */
+    sim_hist_close ();
+    return SCPE_OK;
+    }
+if ((cptr == NULL) || (*cptr == 0))
+    return SCPE_MISVAL;
+if ((hst_lnt == 0) &&                                   /* need a buffer */
+    ((r = cpu_set_hist (uptr, 0, "64", NULL)) != SCPE_OK))
+    return r;
+for (i = 0; i < hst_lnt; i++)                           /* start clean */
+    hst[i].pc = 0;
+return sim_hist_open (cptr, sizeof (InstHistory));
+}
+
+/* Show history file, or decode one */
+t_stat cpu_show_histfile (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+char *cptr = (char *) desc;
+
+if ((cptr == NULL) || (*cptr == 0)) {
+    sim_hist_show (st);
+    fputc ('\n', st);
+    return SCPE_OK;
+    }
+return sim_hist_decode (st, cptr, sizeof (InstHistory), HIST_TITLE, &cpu_print_hist);
+}
+
+#if KA
+t_stat cpu_set_dcache (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+if (cptr)
+    return SCPE_ARG;
+if (val == 0) {
+    free (dcache);
+    dcache = NULL;
+    return SCPE_OK;
+    }
+if (dcache == NULL) {
+    dcache = (struct dcache_ent *) calloc (DCACHE_SIZE, sizeof (*dcache));
+    if (dcache == NULL)
+        return SCPE_MEM;
+    }
+dcache_hits = dcache_misses = 0;
+dcache_flush ();
+return SCPE_OK;
+}
+
+t_stat cpu_show_dcache (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+if (dcache == NULL) {
+    fprintf (st, "decode cache disabled");
+    return SCPE_OK;
+    }
+fprintf (st, "decode cache %d entries, %" LL_FMT "u hits, %" LL_FMT "u misses", DCACHE_SIZE,
+         dcache_hits, dcache_misses);
+if (dcache_hits + dcache_misses != 0)
+    fprintf (st, " (%.1f%% hit rate)",
+             (100.0 * dcache_hits) / ((double)dcache_hits + dcache_misses));
+return SCPE_OK;
+}
+#endif
+
 t_stat
 cpu_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
 {
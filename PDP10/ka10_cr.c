@@ -36,6 +36,8 @@
 
 #define UNIT_CDR        UNIT_ATTABLE | UNIT_RO | UNIT_DISABLE | \
                          UNIT_ROABLE | MODE_029
+#define UNIT_V_FASTIO   (UNIT_V_UF + 7)
+#define UNIT_FASTIO     (1 << UNIT_V_FASTIO)
 
 #define CR_DEVNUM        0150
 
@@ -93,6 +95,10 @@ UNIT                cr_unit = {
 MTAB                cr_mod[] = {
     {MTAB_XTD | MTAB_VUN, 0, "FORMAT", "FORMAT",
                &sim_card_set_fmt, &sim_card_show_fmt, NULL},    
+    {UNIT_FASTIO, 0, NULL, "TRUEIO", NULL, NULL, NULL,
+       "Read columns at the modelled rate"},
+    {UNIT_FASTIO, UNIT_FASTIO, "FASTIO", "FASTIO", NULL, NULL, NULL,
+       "Read each column as soon as the last one is taken"},
     {0}
 };
 
@@ -140,7 +146,10 @@ t_stat cr_devio(uint32 dev, uint64 *data) {
              uptr->u3 |= READING;
              uptr->u3 &= ~(CARD_IN_READ|RDY_READ|DATA_RDY);
              uptr->u4 = 0;
-             sim_activate(uptr, uptr->wait);
+             if ((uptr->flags & (UNIT_FASTIO|UNIT_ATT)) == (UNIT_FASTIO|UNIT_ATT))
+                 cr_srv(uptr);
+             else
+                 sim_activate(uptr, uptr->wait);
          }
          if (uptr->flags & UNIT_ATT && 
                 (uptr->u3 & (READING|CARD_IN_READ|END_CARD)) == 0)
@@ -158,6 +167,9 @@ t_stat cr_devio(uint32 dev, uint64 *data) {
              *data = uptr->u5;
              sim_debug(DEBUG_DATAIO, &cr_dev, "CR: DATAI %012llo\n", *data);
              uptr->u3 &= ~DATA_RDY;
+             /* In FASTIO the next column is waiting for this one */
+             if (uptr->flags & UNIT_FASTIO && uptr->u3 & CARD_IN_READ)
+                 cr_srv(uptr);
          } else 
              *data = 0;
          break;
@@ -167,10 +179,13 @@ t_stat cr_devio(uint32 dev, uint64 *data) {
     return SCPE_OK;
 }
 
-/* Handle transfer of data for card reader */
+/* Handle transfer of data for card reader.
+   In FASTIO mode nothing is scheduled once the card is in; each
+   DATAI calls back here for the next column. */
 t_stat
 cr_srv(UNIT *uptr) {
     struct _card_data   *data;
+    int                 fast = (uptr->flags & UNIT_FASTIO) != 0;
 
     data = (struct _card_data *)uptr->up7;
 
@@ -194,8 +209,10 @@ cr_srv(UNIT *uptr) {
              break;
         }
         uptr->u4 = 0;
-        sim_activate(uptr, uptr->wait);
-        return SCPE_OK;
+        if (!fast) {
+            sim_activate(uptr, uptr->wait);
+            return SCPE_OK;
+        }
     }
 
     /* Copy next column over */
@@ -204,7 +221,8 @@ cr_srv(UNIT *uptr) {
              uptr->u3 &= ~(CARD_IN_READ|READING);
              uptr->u3 |= END_CARD;
              set_interrupt(CR_DEVNUM, uptr->u3);
-             sim_activate(uptr, uptr->wait);
+             if (!fast)
+                 sim_activate(uptr, uptr->wait);
              return SCPE_OK;
         }
         uptr->u5 = data->image[uptr->u4++];
@@ -214,7 +232,8 @@ cr_srv(UNIT *uptr) {
         uptr->u3 |= DATA_RDY;
         sim_debug(DEBUG_DATA, &cr_dev, "CR Char > %d %03x\n", uptr->u4, uptr->u5);
         set_interrupt(CR_DEVNUM, uptr->u3);
-        sim_activate(uptr, uptr->wait);
+        if (!fast)
+            sim_activate(uptr, uptr->wait);
     }
     return SCPE_OK;
 }
@@ -234,7 +253,8 @@ t_stat
 cr_help(FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
 {
    fprintf (st, "Card Reader\n\n");
-   fprintf (st, "The system supports one card reader.\n");
+   fprintf (st, "The system supports one card reader.  SET CR FASTIO hands each\n");
+   fprintf (st, "column to the program as soon as it has taken the last one.\n");
    fprint_set_help(st, dptr);
    fprint_show_help(st, dptr);
    return SCPE_OK;
@@ -170,6 +170,7 @@ t_stat cty_reset (DEVICE *dptr)
 t_stat cty_stop_os (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
     M[CTY_SWITCH] = 1;                                 /* tell OS to stop */
+    MEM_DIRTY(CTY_SWITCH);
     return SCPE_OK;
 }
 
@@ -76,6 +76,7 @@ uint8    dcox_buf[DC10_MLINES] = { 0 };           /* Output buffers */
 TMLN     dc_ldsc[DC10_MLINES] = { 0 };            /* Line descriptors */
 TMXR     dc_desc = { DC10_LINES, 0, 0, dc_ldsc };
 uint32   tx_enable, rx_rdy;                       /* Flags */
+uint32   tx_stall;                                /* Waiting for output to drain */
 uint32   dc_enable;                               /* Enable line */
 uint32   dc_ring;                                 /* Connection pending */
 uint32   rx_conn;                                 /* Connection flags */
@@ -187,6 +188,7 @@ t_stat dc_devio(uint32 dev, uint64 *data) {
                 }
              }
              tx_enable = 0;
+             tx_stall = 0;
              dc_enable = 0;
              rx_rdy = 0;                                /* Flags */
              rx_conn = 0;
@@ -216,6 +218,7 @@ t_stat dc_devio(uint32 dev, uint64 *data) {
                 uint32 mask = ~(1 << ln);
                 rx_rdy &= mask;
                 tx_enable &= mask;
+                tx_stall &= mask;
                 dc_enable &= mask;
                 lp = &dc_ldsc[ln];
                 if (rx_conn & (1 << ln) && lp->conn) {
@@ -237,13 +240,23 @@ t_stat dc_devio(uint32 dev, uint64 *data) {
              lp = &dc_ldsc[ln];
              if (*data & FLAG) {
                 tx_enable &= ~(1 << ln);
+                tx_stall &= ~(1 << ln);
                 dc_l_status &= ~(1LL << ln);
              } else if (lp->conn) {
                 int32 ch = *data & DATA;
                 ch = sim_tt_outcvt(ch, TT_GET_MODE (dc_unit.flags) | TTUF_KSR);
                 tmxr_putc_ln (lp, ch);
+                /* Buffer nearly full, push it all out now */
+                if (lp->xmte == 0 && tmxr_send_buffered_data (lp) == 0)
+                    lp->xmte = 1;
                 tx_enable |= (1 << ln);
-                dc_l_status |= (1LL << ln);
+                if (lp->xmte) {
+                    dc_l_status |= (1LL << ln);
+                } else {
+                    /* Hold off transmit done until the poll drains the line */
+                    tx_stall |= (1 << ln);
+                    dc_l_status &= ~(1LL << ln);
+                }
              }
          }
          dc_doscan(uptr);
@@ -311,6 +324,11 @@ int32 ln;
     tmxr_poll_tx(&dc_desc);
     tmxr_poll_rx(&dc_desc);
     for (ln = 0; ln < dc_desc.lines; ln++) {
+       /* Output drained, give the line its transmit done */
+       if ((tx_stall & (1 << ln)) != 0 && dc_ldsc[ln].xmte) {
+           tx_stall &= ~(1 << ln);
+           dc_l_status |= (1LL << ln);
+       }
        /* Check to see if any pending data for this line */
        if (tmxr_rqln(&dc_ldsc[ln]) > 0) {
            rx_rdy |= (1 << ln);
@@ -370,6 +388,7 @@ t_stat dc_reset (DEVICE *dptr)
     else
         sim_cancel (&dc_unit);                             /* else stop */
     tx_enable = 0;
+    tx_stall = 0;
     rx_rdy = 0;                             /* Flags */
     rx_conn = 0;
     dc_l_status = 0;
@@ -99,6 +99,7 @@
 
 #define STOP_HALT       1                               /* halted */
 #define STOP_IBKPT      2                               /* breakpoint */
+#define STOP_WBKPT      3                               /* write watchpoint */
 
 /* Debuging controls */
 #define DEBUG_CMD       0x0000001       /* Show device commands */
@@ -235,6 +236,8 @@ typedef unsigned long long int uint64;
 typedef unsigned int uint18;
 
 extern uint64   M[]; 
+extern uint32   M_dirty[];                       /* Pages changed since SAVE */
+#define MEM_DIRTY(a)    (SIM_DIRTY_SET(M_dirty, a), sim_idle_writes++)  /* also seen by IDLE=AUTO */
 extern uint18   PC;
 extern uint32   FLAGS;
 
@@ -303,6 +306,35 @@ void df10_setup(struct df10 *df, uint32 addr);
 int  df10_fetch(struct df10 *df);
 int  df10_read(struct df10 *df);
 int  df10_write(struct df10 *df);
+#define DF10_READ       0               /* Memory to device, as df10_read */
+#define DF10_WRITE      1               /* Device to memory, as df10_write */
+int  df10_block_transfer(struct df10 *df, uint64 *buf, int count, int dir, int *moved);
+
+/* Disk timing model, chosen per controller with SET <dev> TIMING= */
+#define DKT_FIXED       0               /* Fixed delay per step */
+#define DKT_FAST        1               /* Every step takes no time */
+#define DKT_REAL        2               /* Seek curve and rotational position */
+#define DKT_SCALED      3               /* DKT_REAL slowed by a factor */
+
+struct dk_timing {
+        int     mode;
+        int     scale;
+} ;
+
+/* Drive mechanics for the realistic model, in microseconds */
+struct dk_mech {
+        int32   rev;                    /* One revolution */
+        int32   seek_min;               /* Track to track seek */
+        int32   seek_max;               /* Full stroke seek */
+} ;
+
+t_stat dkt_set_timing(struct dk_timing *t, CONST char *cptr);
+void   dkt_show_timing(FILE *st, struct dk_timing *t);
+int32  dkt_delay(struct dk_timing *t, int32 fixed, double usec);
+int32  dkt_seek(struct dk_timing *t, const struct dk_mech *m, int dist, int ncyl);
+int32  dkt_rotate(struct dk_timing *t, const struct dk_mech *m, int sect, int nsect);
+int32  dkt_xfer(struct dk_timing *t, const struct dk_mech *m, int32 fixed, int words,
+                int wtrack);
 
 
 /* I/O system parameters */
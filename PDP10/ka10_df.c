@@ -22,6 +22,7 @@
 */
 
 #include "ka10_defs.h"
+#include <math.h>
 
 void df10_setirq(struct df10 *df) {
       df->status |= PI_ENABLE;
@@ -31,6 +32,7 @@ void df10_setirq(struct df10 *df) {
 void df10_writecw(struct df10 *df) {
       df->status |= 1 << df->ccw_comp;
       M[df->cia|1] = ((uint64)(df->ccw & WMASK) << CSHIFT) | ((uint64)df->cda & AMASK);
+      MEM_DIRTY(df->cia|1);
 }
 
 void df10_finish_op(struct df10 *df, int flags) {
@@ -96,6 +98,84 @@ int df10_read(struct df10 *df) {
      return 1;
 }
 
+/* Move up to count words between buf and memory in one call, following
+ * the channel command list the same way repeated df10_read (DF10_READ) or
+ * df10_write (DF10_WRITE) calls would.  Each data word of a command is
+ * copied as a block.  *moved is set to the number of words taken from or
+ * stored into buf.  Returns 0 once the channel is done, as df10_read and
+ * df10_write do, else 1 (all count words moved).
+ */
+int df10_block_transfer(struct df10 *df, uint64 *buf, int count, int dir, int *moved) {
+     int      i = 0;
+     uint32   n, k;
+
+     *moved = 0;
+     while (i < count) {
+         if (df->wcr == 0) {
+             if (!df10_fetch(df))
+                 return 0;
+         }
+         n = (uint32)((WMASK + 1 - df->wcr) & WMASK);  /* words left in this command */
+         if (n == 0 || n > (uint32)(count - i))
+             n = count - i;
+         if (df->cda != 0) {
+             /* Stop short of the end of the address space, cda wraps to 0
+                there and the single word routines handle it */
+             if (n > (uint32)(AMASK - df->cda))
+                 n = (uint32)(AMASK - df->cda);
+             if (n == 0) {
+                 if (dir == DF10_WRITE) {
+                     df->buf = buf[i];
+                     *moved = ++i;
+                     if (!df10_write(df))
+                         return 0;
+                 } else {
+                     int r = df10_read(df);
+
+                     buf[i] = df->buf;
+                     *moved = ++i;
+                     if (!r)
+                         return 0;
+                 }
+                 continue;
+             }
+             /* Same bound as df10_read/df10_write: checked before increment */
+             k = (df->cda > MEMSIZE) ? 0 : MEMSIZE - df->cda + 1;
+             if (k > n)
+                 k = n;
+             if (dir == DF10_WRITE) {
+                 uint32 a;
+
+                 memcpy(&M[df->cda + 1], &buf[i], k * sizeof(uint64));
+                 for (a = df->cda + 1; a <= df->cda + k; a++)
+                     MEM_DIRTY(a);
+             } else
+                 memcpy(&buf[i], &M[df->cda + 1], k * sizeof(uint64));
+             df->cda = (uint32)((df->cda + k) & AMASK);
+             df->wcr = (uint32)((df->wcr + k) & WMASK);
+             i += k;
+             *moved = i;
+             if (k < n) {
+                 df10_finish_op(df, 1<<df->nxmerr);
+                 return 0;
+             }
+         } else {
+             /* Skip: reads supply zeros, writes are discarded */
+             if (dir == DF10_READ)
+                 memset(&buf[i], 0, n * sizeof(uint64));
+             df->wcr = (uint32)((df->wcr + n) & WMASK);
+             i += n;
+             *moved = i;
+         }
+         df->buf = buf[i - 1];
+         if (df->wcr == 0) {
+             if (!df10_fetch(df))
+                 return 0;
+         }
+     }
+     return 1;
+}
+
 int df10_write(struct df10 *df) {
      if (df->wcr == 0) {
          if (!df10_fetch(df))
@@ -109,9 +189,110 @@ int df10_write(struct df10 *df) {
         }
         df->cda = (uint32)((df->cda + 1) & AMASK);
         M[df->cda] = df->buf;
+        MEM_DIRTY(df->cda);
      }
      if (df->wcr == 0) {
         return df10_fetch(df);
      }
      return 1;
 }
+
+/*
+ * Disk timing.  FIXED keeps each controller's own step delays, FAST
+ * lets every step complete at once, REALISTIC derives delays from the
+ * drive mechanics and SCALED is REALISTIC slowed down by a factor.
+ * Delays are returned as instruction counts for sim_activate.
+ */
+static const char *dkt_names[] = { "FIXED", "FAST", "REALISTIC", "SCALED" };
+
+t_stat dkt_set_timing(struct dk_timing *t, CONST char *cptr) {
+     char     gbuf[CBUFSIZE];
+     int      mode;
+     t_stat   r;
+     int32    scale;
+
+     if (cptr == NULL || *cptr == 0)
+         return SCPE_ARG;
+     cptr = get_glyph(cptr, gbuf, '=');
+     for (mode = 0; mode <= DKT_SCALED; mode++) {
+         if (strcmp(gbuf, dkt_names[mode]) == 0)
+             break;
+     }
+     if (mode > DKT_SCALED)
+         return SCPE_ARG;
+     if (mode == DKT_SCALED && *cptr != 0) {
+         scale = (int32) get_uint(cptr, 10, 1000, &r);
+         if (r != SCPE_OK || scale < 1)
+             return SCPE_ARG;
+         t->scale = scale;
+     } else if (*cptr != 0)
+         return SCPE_ARG;
+     if (t->scale < 1)
+         t->scale = 1;
+     t->mode = mode;
+     return SCPE_OK;
+}
+
+void dkt_show_timing(FILE *st, struct dk_timing *t) {
+     fprintf(st, "timing=%s", dkt_names[t->mode & 3]);
+     if (t->mode == DKT_SCALED)
+         fprintf(st, "=%d", t->scale);
+}
+
+/* Instructions per microsecond, or one if the timer is not calibrated */
+static double dkt_ipus(void) {
+     double   ips = sim_timer_inst_per_sec();
+
+     return (ips > 0.0) ? ips / 1000000.0 : 1.0;
+}
+
+int32 dkt_delay(struct dk_timing *t, int32 fixed, double usec) {
+     double   d;
+
+     switch (t->mode) {
+     default:
+     case DKT_FIXED:  return fixed;
+     case DKT_FAST:   return 0;
+     case DKT_REAL:   d = usec; break;
+     case DKT_SCALED: d = usec * t->scale; break;
+     }
+     d *= dkt_ipus();
+     return (d >= 2147483647.0) ? 2147483647 : (int32)d;
+}
+
+/* Whole seek over dist cylinders: settle time plus a square root curve */
+int32 dkt_seek(struct dk_timing *t, const struct dk_mech *m, int dist, int ncyl) {
+     double   us = 0.0;
+
+     if (dist > 0) {
+         us = m->seek_min;
+         if (ncyl > 1 && dist > 1)
+             us += (m->seek_max - m->seek_min) * sqrt((double)(dist - 1) / (ncyl - 1));
+     }
+     return dkt_delay(t, 0, us);
+}
+
+/* Wait for sector sect of nsect to come under the heads.  The platter
+   position follows simulated time, slowed down along with SCALED. */
+int32 dkt_rotate(struct dk_timing *t, const struct dk_mech *m, int sect, int nsect) {
+     double   now, pos;
+
+     if ((t->mode != DKT_REAL && t->mode != DKT_SCALED) || nsect <= 0)
+         return 0;
+     now = sim_gtime() / dkt_ipus();
+     if (t->mode == DKT_SCALED)
+         now /= t->scale;
+     pos = fmod(now, (double)m->rev) * nsect / m->rev;
+     pos = sect - pos;
+     if (pos < 0.0)
+         pos += nsect;
+     return dkt_delay(t, 0, pos * m->rev / nsect);
+}
+
+/* Time for words of a track of wtrack words to pass the heads */
+int32 dkt_xfer(struct dk_timing *t, const struct dk_mech *m, int32 fixed, int words,
+               int wtrack) {
+     if (wtrack <= 0)
+         return dkt_delay(t, fixed, 0.0);
+     return dkt_delay(t, fixed, (double)m->rev * words / wtrack);
+}
@@ -22,6 +22,7 @@
 */
 
 #include "ka10_defs.h"
+#include "sim_disk.h"
 
 #ifndef NUM_DEVS_DP
 #define NUM_DEVS_DP 0
@@ -38,8 +39,8 @@
 
 /* Flags in the unit flags word */
 
-#define UNIT_V_WLK      (UNIT_V_UF + 0)                 /* write locked */
-#define UNIT_V_DTYPE    (UNIT_V_UF + 1)                 /* disk type */
+#define UNIT_V_WLK      (DKUF_V_WLK)                    /* write locked */
+#define UNIT_V_DTYPE    (DKUF_V_UF + 0)                 /* disk type */
 #define UNIT_M_DTYPE    3
 #define UNIT_WLK        (1 << UNIT_V_WLK)
 #define UNIT_DTYPE      (UNIT_M_DTYPE << UNIT_V_DTYPE)
@@ -146,12 +147,13 @@ struct drvtyp {
     int32       cyl;                                    /* cylinders */
     int32       size;                                   /* #blocks */
     int32       devtype;                                /* device type */
+    struct dk_mech mech;                                /* rev, seek min, max us */
     };
 
 struct drvtyp dp_drv_tab[] = {
-    { RP01_SECT, RP01_SURF, RP01_CYL, RP01_SIZE, RP01_DTYPE},
-    { RP02_SECT, RP02_SURF, RP02_CYL, RP02_SIZE, RP02_DTYPE},
-    { RP03_SECT, RP03_SURF, RP03_CYL, RP03_SIZE, RP03_DTYPE},
+    { RP01_SECT, RP01_SURF, RP01_CYL, RP01_SIZE, RP01_DTYPE, { 25000, 20000, 80000 } },
+    { RP02_SECT, RP02_SURF, RP02_CYL, RP02_SIZE, RP02_DTYPE, { 25000, 20000, 80000 } },
+    { RP03_SECT, RP03_SURF, RP03_CYL, RP03_SIZE, RP03_DTYPE, { 25000, 20000, 80000 } },
     { 0 }
     };
 
@@ -159,16 +161,21 @@ struct drvtyp dp_drv_tab[] = {
 struct df10   dp_df10[NUM_DEVS_DP];
 uint32        dp_cur_unit[NUM_DEVS_DP];
 uint64        dp_buf[NUM_DEVS_DP][RP_NUMWD];
+UNIT          *dp_pend[NUM_DEVS_DP];    /* Unit with a request on dp_buf */
+struct dk_timing dp_timing[NUM_DEVS_DP];
 int           readin_flag = 0;
 
 t_stat        dp_devio(uint32 dev, uint64 *data);
 t_stat        dp_svc(UNIT *);
+void          dp_io_done(UNIT *, t_stat);
 t_stat        dp_boot(int32, DEVICE *);
 void          dp_ini(UNIT *, t_bool);
 t_stat        dp_reset(DEVICE *);
 t_stat        dp_attach(UNIT *, CONST char *);
 t_stat        dp_detach(UNIT *);
 t_stat        dp_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat        dp_set_timing(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat        dp_show_timing(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat        dp_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, 
                  const char *cptr);
 const char    *dp_description (DEVICE *dptr);
@@ -264,6 +271,12 @@ MTAB                dp_mod[] = {
     {UNIT_DTYPE, (RP03_DTYPE << UNIT_V_DTYPE), "RP03", "RP03", &dp_set_type },
     {UNIT_DTYPE, (RP02_DTYPE << UNIT_V_DTYPE), "RP02", "RP02", &dp_set_type },
     {UNIT_DTYPE, (RP01_DTYPE << UNIT_V_DTYPE), "RP01", "RP01", &dp_set_type },
+    {MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "TIMING", "TIMING",
+          &dp_set_timing, &dp_show_timing, NULL,
+          "Disk timing: FIXED, FAST, REALISTIC or SCALED=n" },
+    {MTAB_XTD|MTAB_VUN|MTAB_VALR, 0, "CACHE", "CACHE=size",
+          &sim_disk_set_cache, &sim_disk_show_cache, NULL,
+          "Set size of sector cache in K/M bytes, 0 disables" },
 
     {0}
 };
@@ -273,7 +286,7 @@ DEVICE              dpa_dev = {
     NUM_UNITS_DP, 8, 18, 1, 8, 36,
     NULL, NULL, &dp_reset, &dp_boot, &dp_attach, &dp_detach,
     &dp_dib[0], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &dp_help, NULL, NULL, &dp_description
+    NULL, NULL, &dp_help, &sim_disk_attach_help, NULL, &dp_description
 };
 
 #if (NUM_DEVS_DP > 1)
@@ -282,7 +295,7 @@ DEVICE              dpb_dev = {
     NUM_UNITS_DP, 8, 18, 1, 8, 36,
     NULL, NULL, &dp_reset, &dp_boot, &dp_attach, &dp_detach,
     &dp_dib[1], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &dp_help, NULL, NULL, &dp_description
+    NULL, NULL, &dp_help, &sim_disk_attach_help, NULL, &dp_description
 };
 
 #if (NUM_DEVS_DP > 2)
@@ -291,7 +304,7 @@ DEVICE              dpc_dev = {
     NUM_UNITS_DP, 8, 18, 1, 8, 36,
     NULL, NULL, &dp_reset, &dp_boot, &dp_attach, &dp_detach,
     &dp_dib[2], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &dp_help, NULL, NULL, &dp_description
+    NULL, NULL, &dp_help, &sim_disk_attach_help, NULL, &dp_description
 };
 
 #if (NUM_DEVS_DP > 3)
@@ -300,7 +313,7 @@ DEVICE              dpd_dev = {
     NUM_UNITS_DP, 8, 18, 1, 8, 36,
     NULL, NULL, &dp_reset, &dp_boot, &dp_attach, &dp_detach,
     &dp_dib[3], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &dp_help, NULL, NULL, &dp_description
+    NULL, NULL, &dp_help, &sim_disk_attach_help, NULL, &dp_description
 };
 
 #endif
@@ -512,7 +525,14 @@ t_stat dp_devio(uint32 dev, uint64 *data) {
              }
              return SCPE_OK;
          }
-         sim_activate(uptr, 150);
+         if (tmp == RD || tmp == RV || tmp == WR) {
+             int   dtype = GET_DTYPE(uptr->flags);
+             int32 d = dkt_rotate(&dp_timing[ctlr], &dp_drv_tab[dtype].mech,
+                            (uptr->UFLAGS >> 9) & 017, dp_drv_tab[dtype].sect);
+
+             sim_activate(uptr, d + dkt_delay(&dp_timing[ctlr], 150, 0.0));
+         } else
+             sim_activate(uptr, dkt_delay(&dp_timing[ctlr], 150, 0.0));
     }
     return SCPE_OK; 
 }
@@ -528,7 +548,7 @@ t_stat dp_svc (UNIT *uptr)
    int         cyl   = (uptr->UFLAGS >> 20) & 0777;
    DEVICE      *dptr = dp_devs[ctlr];
    struct df10 *df10 = &dp_df10[ctlr];
-   int diff, diffs, wc;
+   int diff, diffs;
    int         r;
    sect &= 017;
 
@@ -536,6 +556,15 @@ t_stat dp_svc (UNIT *uptr)
    case WR:
    case RV:
    case RD:
+           /* A completion can wake the unit after the transfer has ended */
+           if (uptr->UFLAGS & DONE)
+                return SCPE_OK;
+           if (dp_pend[ctlr]) {
+                /* Buffer busy, the completion reschedules its own unit */
+                if (dp_pend[ctlr] != uptr)
+                    sim_activate(uptr, 100);
+                return SCPE_OK;
+           }
            /* Cylinder, Surface, Sector all ok */
            if (BUF_EMPTY(uptr)) {
                  sim_debug(DEBUG_DETAIL, dptr, 
@@ -577,13 +606,11 @@ t_stat dp_svc (UNIT *uptr)
                 if (cmd != WR) {
                     /* Read the block */
                     int da = ((cyl * dp_drv_tab[dtype].surf + surf) 
-                                   * dp_drv_tab[dtype].sect + sect) * RP_NUMWD;
-                    sim_fseek(uptr->fileref, da * sizeof(uint64), SEEK_SET);
-                    wc = sim_fread (&dp_buf[ctlr][0], sizeof(uint64), RP_NUMWD,
-                           uptr->fileref);
-                    for (; wc < RP_NUMWD; wc++)
-                        dp_buf[ctlr][wc] = 0;
-                    uptr->hwmark = RP_NUMWD;
+                                   * dp_drv_tab[dtype].sect + sect);
+                    /* The buffer becomes valid when the read completes */
+                    dp_pend[ctlr] = uptr;
+                    sim_disk_rdsect_a(uptr, da, (uint8 *)&dp_buf[ctlr][0], NULL, 1,
+                           &dp_io_done);
                     uptr->DATAPTR = 0;
                     sect = sect + 1;
                     if (sect >= dp_drv_tab[dtype].sect) {
@@ -603,7 +630,7 @@ t_stat dp_svc (UNIT *uptr)
                     uptr->DATAPTR = 0;
                     uptr->hwmark = 0;
                 }
-                sim_activate(uptr, 50);
+                sim_activate(uptr, dkt_delay(&dp_timing[ctlr], 50, 0.0));
                 return SCPE_OK;
            }
            switch(cmd) {
@@ -625,13 +652,14 @@ t_stat dp_svc (UNIT *uptr)
            if (uptr->DATAPTR >= RP_NUMWD || r == 0 ) {
                if (cmd == WR) {
                     int da = ((cyl * dp_drv_tab[dtype].surf + surf)
-                                   * dp_drv_tab[dtype].sect + sect) * RP_NUMWD;
+                                   * dp_drv_tab[dtype].sect + sect);
                     /* write block the block */
                     for (; uptr->DATAPTR < RP_NUMWD; uptr->DATAPTR++)
                         dp_buf[ctlr][uptr->DATAPTR] = 0;
-                    sim_fseek(uptr->fileref, da * sizeof(uint64), SEEK_SET);
-                    wc = sim_fwrite(&dp_buf[ctlr][0],sizeof(uint64), RP_NUMWD,
-                           uptr->fileref);
+                    /* The buffer is not touched again until the write completes */
+                    dp_pend[ctlr] = uptr;
+                    sim_disk_wrsect_a(uptr, da, (uint8 *)&dp_buf[ctlr][0], NULL, 1,
+                           &dp_io_done);
                     uptr->STATUS |= SRC_DONE;
                     sect = sect + 1;
                     if (sect >= dp_drv_tab[dtype].sect) {
@@ -652,7 +680,8 @@ t_stat dp_svc (UNIT *uptr)
                 CLR_BUF(uptr);
            }
            if (r)
-               sim_activate(uptr, 25);
+               sim_activate(uptr, dkt_xfer(&dp_timing[ctlr], &dp_drv_tab[dtype].mech,
+                                25, 1, dp_drv_tab[dtype].sect * RP_NUMWD));
            else {
          sim_debug(DEBUG_DATA, dptr, "DP %03o DFS %012llo %06o %06o\n", ctlr, M[df10->cia|1], df10->ccw, df10->cda);
                uptr->STATUS &= ~(SRC_DONE|BUSY);
@@ -671,7 +700,13 @@ t_stat dp_svc (UNIT *uptr)
                diffs = (diff < 0) ? -1 : 1;
                sim_debug(DEBUG_DETAIL, dptr, "DP Seek %d %d %d %d\n",
                           ctlr, cyl, uptr->CUR_CYL, diff);
-               if (diff == 0) {
+               if (diff != 0 && dp_timing[ctlr].mode != DKT_FIXED &&
+                   cyl <= dp_drv_tab[dtype].cyl) {
+                   /* Whole seek in one step */
+                   uptr->CUR_CYL = cyl;
+                   sim_activate(uptr, dkt_seek(&dp_timing[ctlr], &dp_drv_tab[dtype].mech,
+                                 (diff < 0) ? -diff : diff, dp_drv_tab[dtype].cyl));
+               } else if (diff == 0) {
                    uptr->UFLAGS |= SEEK_DONE;
                    uptr->UFLAGS &= ~SEEK_STATE;
                    uptr->STATUS &= ~(BUSY|NOT_RDY);
@@ -705,11 +740,29 @@ t_stat dp_svc (UNIT *uptr)
 }
 
 
+/* Completion of a sim_disk request on the controller buffer.  Called
+   directly for synchronous units, else before the unit is next serviced. */
+void
+dp_io_done(UNIT *uptr, t_stat r)
+{
+    int         ctlr  = uptr->UFLAGS & 03;
+
+    if (dp_pend[ctlr] != uptr)
+        return;
+    dp_pend[ctlr] = NULL;
+    if (BUF_EMPTY(uptr) && ((uptr->UFLAGS & 070) >> 3) != WR) {
+        if (r != SCPE_OK)
+            memset(&dp_buf[ctlr][0], 0, sizeof(dp_buf[ctlr]));
+        uptr->hwmark = RP_NUMWD;
+    }
+}
+
 t_stat
 dp_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
     int         i;
     if (uptr == NULL) return SCPE_IERR;
+    if (uptr->flags & UNIT_ATT) return SCPE_ALATT;
     for (i = 0; dp_drv_tab[i].sect != 0; i++) {
         if (GET_DTYPE(val) == dp_drv_tab[i].devtype) {
             uptr->flags &= ~(UNIT_DTYPE);
@@ -722,6 +775,21 @@ dp_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 }
 
 
+t_stat
+dp_set_timing(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+    if (uptr == NULL) return SCPE_IERR;
+    return dkt_set_timing(&dp_timing[(uptr - dp_unit) / NUM_UNITS_DP], cptr);
+}
+
+t_stat
+dp_show_timing(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+    if (uptr == NULL) return SCPE_IERR;
+    dkt_show_timing(st, &dp_timing[(uptr - dp_unit) / NUM_UNITS_DP]);
+    return SCPE_OK;
+}
+
 t_stat
 dp_reset(DEVICE * dptr)
 {
@@ -755,11 +823,12 @@ dp_boot(int32 unit_num, DEVICE * dptr)
 
     addr = (MEMSIZE - 512) & RMASK;
     for (sect = 4; sect <= 7; sect++) {
-        sim_fseek(uptr->fileref, (sect * RP_NUMWD) * sizeof(uint64), SEEK_SET);
-        sim_fread (&dp_buf[0][0], sizeof(uint64), RP_NUMWD, uptr->fileref);
+        sim_disk_rdsect(uptr, sect, (uint8 *)&dp_buf[0][0], NULL, 1);
         ptr = 0;
-        for(wc = RP_NUMWD; wc > 0; wc--) 
+        for(wc = RP_NUMWD; wc > 0; wc--) {
+            MEM_DIRTY(addr);
             M[addr++] = dp_buf[0][ptr++];
+        }
     }
     PC = (MEMSIZE - 512) & RMASK;
     return SCPE_OK;
@@ -775,7 +844,8 @@ t_stat dp_attach (UNIT *uptr, CONST char *cptr)
     int ctlr;
 
     uptr->capac = dp_drv_tab[GET_DTYPE (uptr->flags)].size;
-    r = attach_unit (uptr, cptr);
+    r = sim_disk_attach (uptr, cptr, RP_NUMWD * sizeof(uint64), sizeof(uint64),
+                         TRUE, 0, "RP", 0, 0);
     if (r != SCPE_OK)
         return r;
     dptr = find_dev_from_unit(uptr);
@@ -798,7 +868,9 @@ t_stat dp_detach (UNIT *uptr)
         return SCPE_OK;
     if (sim_is_active (uptr))                              /* unit active? */
         sim_cancel (uptr);                                  /* cancel operation */
-    return detach_unit (uptr);
+    if (dp_pend[uptr->UFLAGS & 03] == uptr)
+        dp_pend[uptr->UFLAGS & 03] = NULL;
+    return sim_disk_detach (uptr);
 }
 
 t_stat dp_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
@@ -810,6 +882,8 @@ fprintf (st, "set the drive type to one of three disk types.\n");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 fprintf (st, "\nThe type options can be used only when a unit is not attached to a file.\n");
+fprintf (st, "SET %s TIMING=FIXED|FAST|REALISTIC|SCALED=n selects the disk timing model.\n", dptr->name);
+fprintf (st, "SET %sn CACHE=size keeps recently used sectors in memory.\n", dptr->name);
 fprintf (st, "The RP device supports the BOOT command.\n");
 fprint_reg_help (st, dptr);
 return SCPE_OK;
@@ -979,9 +979,12 @@ switch (fnc) {                                          /* at speed, check fnc *
             }
         sim_activate (uptr, DTU_LPERB (uptr) * dt_ltime);/* sched next block */
         M[DT_WC] = (M[DT_WC] + 1) & DMASK;              /* inc WC */
+        MEM_DIRTY(DT_WC);
         ma = M[DT_CA] & AMASK;                          /* get mem addr */
-        if (MEM_ADDR_OK (ma))                           /* store block # */
+        if (MEM_ADDR_OK (ma)) {                         /* store block # */
             M[ma] = blk;
+            MEM_DIRTY(ma);
+            }
         if (((dtsa & DTA_MODE) == 0) || (M[DT_WC] == 0))
                 dtsb = dtsb | DTB_DTF;                  /* set DTF */
         if (DEBUG_PRI (dt_dev, LOG_MS))
@@ -1019,13 +1022,17 @@ switch (fnc) {                                          /* at speed, check fnc *
         case 0:                                         /* normal read */
             M[DT_WC] = (M[DT_WC] + 1) & DMASK;          /* incr WC, CA */
             M[DT_CA] = (M[DT_CA] + 1) & DMASK;
+            MEM_DIRTY(DT_WC);
+            MEM_DIRTY(DT_CA);
             ma = M[DT_CA] & AMASK;                      /* mem addr */
             ba = (blk * DTU_BSIZE (uptr)) + wrd;        /* buffer ptr */
             dtdb = fbuf[ba];                            /* get tape word */
             if (dir)                                    /* rev? comp obv */
                 dtdb = dt_comobv (dtdb);
-            if (MEM_ADDR_OK (ma))                       /* mem addr legal? */
+            if (MEM_ADDR_OK (ma)) {                     /* mem addr legal? */
                 M[ma] = dtdb;
+                MEM_DIRTY(ma);
+                }
             if (M[DT_WC] == 0)                          /* wc ovf? */
                 dt_substate = DTO_WCO;
         case DTO_WCO:                                   /* wc ovf, not sob */
@@ -1077,6 +1084,8 @@ switch (fnc) {                                          /* at speed, check fnc *
         case 0:                                         /* normal write */
             M[DT_WC] = (M[DT_WC] + 1) & DMASK;          /* incr WC, CA */
             M[DT_CA] = (M[DT_CA] + 1) & DMASK;
+            MEM_DIRTY(DT_WC);
+            MEM_DIRTY(DT_CA);
         case DTO_WCO:                                   /* wc ovflo */
             ma = M[DT_CA] & AMASK;                      /* mem addr */
             ba = (blk * DTU_BSIZE (uptr)) + wrd;        /* buffer ptr */
@@ -1121,6 +1130,8 @@ switch (fnc) {                                          /* at speed, check fnc *
             relpos = DT_LIN2OF (uptr->pos, uptr);       /* cur pos in blk */
             M[DT_WC] = (M[DT_WC] + 1) & DMASK;          /* incr WC, CA */
             M[DT_CA] = (M[DT_CA] + 1) & DMASK;
+            MEM_DIRTY(DT_WC);
+            MEM_DIRTY(DT_CA);
             ma = M[DT_CA] & AMASK;                      /* mem addr */
             if ((relpos >= DT_HTLIN) &&                 /* in data zone? */
                 (relpos < (DTU_LPERB (uptr) - DT_HTLIN))) {
@@ -1132,8 +1143,10 @@ switch (fnc) {                                          /* at speed, check fnc *
             if (dir)                                    /* rev? comp obv */
                 dtdb = dt_comobv (dtdb);
             sim_activate (uptr, DT_WSIZE * dt_ltime);
-            if (MEM_ADDR_OK (ma))                       /* mem addr legal? */
+            if (MEM_ADDR_OK (ma)) {                     /* mem addr legal? */
                 M[ma] = dtdb;
+                MEM_DIRTY(ma);
+                }
             if (M[DT_WC] == 0)
                 dt_substate = DTO_WCO;
             if (((dtsa & DTA_MODE) == 0) || (M[DT_WC] == 0))
@@ -1163,6 +1176,8 @@ switch (fnc) {                                          /* at speed, check fnc *
             relpos = DT_LIN2OF (uptr->pos, uptr);       /* cur pos in blk */
             M[DT_WC] = (M[DT_WC] + 1) & DMASK;          /* incr WC, CA */
             M[DT_CA] = (M[DT_CA] + 1) & DMASK;
+            MEM_DIRTY(DT_WC);
+            MEM_DIRTY(DT_CA);
             ma = M[DT_CA] & AMASK;                      /* mem addr */
             if ((relpos >= DT_HTLIN) &&                 /* in data zone? */
                 (relpos < (DTU_LPERB (uptr) - DT_HTLIN))) {
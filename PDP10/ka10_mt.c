@@ -123,6 +123,7 @@
 
 t_stat         mt_devio(uint32 dev, uint64 *data);
 t_stat         mt_srv(UNIT *);
+int            mt_read_record(DEVICE *, UNIT *, int);
 t_stat         mt_boot(int32, DEVICE *);
 void           mt_ini(UNIT *, t_bool);
 t_stat         set_mta (UNIT *uptr, int32 val, CONST char *cptr, void *desc) ;
@@ -468,6 +469,84 @@ t_stat mt_error(UNIT * uptr, t_stat r, DEVICE * dptr)
        return SCPE_OK;
 }
 
+/* Type B: unpack a whole record and pass it through the DF10 in one
+   call.  Characters are packed as the per character loop in mt_srv
+   packs them, and the channel stops on the same word.  Returns the
+   number of characters taken from the record, the caller charges the
+   time they would have taken to pass the heads. */
+int mt_read_record(DEVICE *dptr, UNIT *uptr, int cc_max)
+{
+    static uint64       wbuf[BUFFSIZE/4 + 1];
+    uint64              word = mt_df10.buf;
+    uint32              nxm = 1 << mt_df10.nxmerr;
+    uint32              had_nxm = mt_df10.status & nxm;
+    uint32              i;
+    int                 nw = 0;
+    int                 pos = uptr->u5;
+    int                 moved = 0;
+    int                 used;
+    int                 cc;
+    int                 stop = 0;
+    uint8               ch;
+
+    for (i = 0; i < uptr->hwmark; i++) {
+        ch = mt_buffer[i];
+        if (uptr->flags & MTUF_7TRK) {
+            cc = 6 * (5 - pos);
+            if ((((uptr->u3 & ODD_PARITY) ? 0x40 : 0) ^
+                  parity_table[ch & 0x3f]) != 0)
+                  status |= PARITY_ERR;
+            word |= (uint64)(ch & 0x3f) << cc;
+        } else {
+            cc = (8 * (3 - pos)) + 4;
+            if (cc < 0)
+                word |= (uint64)(ch & 0x3f);
+            else
+                word |= (uint64)(ch & 0xff) << cc;
+        }
+        if (++pos == cc_max) {
+            wbuf[nw++] = word;
+            word = 0;
+            pos = 0;
+        }
+    }
+    if (uptr->hwmark != 0 && (uptr->flags & MTUF_7TRK) == 0 &&
+        (uptr->u3 & ODD_PARITY) == 0)
+        status |= PARITY_ERR;
+
+    used = uptr->hwmark;
+    if (nw != 0) {
+        if (mt_df10.wcr == 0 && !df10_fetch(&mt_df10)) {
+            stop = 1;
+            moved = 1;
+        } else if (!df10_block_transfer(&mt_df10, wbuf, nw, DF10_WRITE, &moved)) {
+            /* Out of memory stops before the word is stored, the end of
+               the list right after the last word that was */
+            stop = 1;
+            if (moved == 0 || (!had_nxm && (mt_df10.status & nxm)))
+                moved++;
+        }
+        uptr->u3 &= ~(MT_BUFFUL|MT_BRFUL);
+    }
+    if (stop) {
+        used = moved * cc_max;
+        uptr->u3 |= MT_STOP;
+        uptr->u5 = cc_max;
+        mt_df10.buf = wbuf[moved - 1];
+    } else {
+        uptr->u5 = pos;
+        mt_df10.buf = word;
+    }
+    uptr->u6 = used;
+    if (used != 0) {
+        status &= ~CHAR_COUNT;
+        status |= (uint64)(((used - 1) % cc_max) + 1) << 18;
+    }
+    sim_debug(DEBUG_DETAIL, dptr, "MT%o record %d words %d chars %d\n",
+              (int)(uptr - dptr->units), nw, moved, used);
+    return used;
+}
+
 /* Handle processing of tape requests. */
 t_stat mt_srv(UNIT * uptr)
 {
@@ -538,6 +617,11 @@ t_stat mt_srv(UNIT * uptr)
             uptr->hwmark = reclen;
             uptr->u6 = 0;
             uptr->u5 = 0;
+            if (dptr->flags & MTDF_TYPEB) {
+                /* Whole record at once, same time as a char per event */
+                sim_activate(uptr, 100 + 200 * mt_read_record(dptr, uptr, cc_max));
+                return SCPE_OK;
+            }
             sim_activate(uptr, 100);
             return SCPE_OK;
         }
@@ -813,6 +897,7 @@ mt_boot(int32 unit_num, DEVICE * dptr)
         }
         mt_read_word(uptr);
         M[addr] = mt_df10.buf;
+        MEM_DIRTY(addr);
     }
     PC = addr;
     return SCPE_OK;
@@ -45,6 +45,9 @@
 #define NO_TAPE_PP  000100
 #define TAPE_PR     000400
 
+#define UNIT_V_FASTIO (UNIT_V_UF + 0)
+#define UNIT_FASTIO   (1 << UNIT_V_FASTIO)
+
 
 t_stat         ptp_devio(uint32 dev, uint64 *data);
 t_stat         ptp_svc (UNIT *uptr);
@@ -73,11 +76,16 @@ UNIT ptp_unit = {
 
 REG ptp_reg[] = {
     { DRDATA (STATUS, ptp_unit.STATUS, 18), PV_LEFT },
+    { DRDATA (POS, ptp_unit.pos, T_ADDR_W), PV_LEFT },
     { DRDATA (TIME, ptp_unit.wait, 24), PV_LEFT },
     { NULL }
     };
 
 MTAB ptp_mod[] = {
+    { UNIT_FASTIO, 0, NULL, "TRUEIO", NULL, NULL, NULL,
+       "Punch at the modelled character rate" },
+    { UNIT_FASTIO, UNIT_FASTIO, "FASTIO", "FASTIO", NULL, NULL, NULL,
+       "Punch each frame as soon as it is output" },
     { 0 }
     };
 
@@ -98,11 +106,16 @@ UNIT ptr_unit = {
 
 REG ptr_reg[] = {
     { DRDATA (STATUS, ptr_unit.STATUS, 18), PV_LEFT },
+    { DRDATA (POS, ptr_unit.pos, T_ADDR_W), PV_LEFT },
     { DRDATA (TIME, ptr_unit.wait, 24), PV_LEFT },
     { NULL }
     };
 
 MTAB ptr_mod[] = {
+    { UNIT_FASTIO, 0, NULL, "TRUEIO", NULL, NULL, NULL,
+       "Read at the modelled character rate" },
+    { UNIT_FASTIO, UNIT_FASTIO, "FASTIO", "FASTIO", NULL, NULL, NULL,
+       "Read each frame as soon as it is asked for" },
     { 0 }
     };
 
@@ -115,6 +128,18 @@ DEVICE ptr_dev = {
     NULL, NULL, &ptr_help, NULL, NULL, &ptr_description
     };
 
+/* Start the next frame.  In FASTIO mode it is done on the spot rather
+   than after TIME; not attached still goes through the event so the
+   stop is reported the same way. */
+
+static void pt_start (UNIT *uptr)
+{
+    if ((uptr->flags & (UNIT_FASTIO|UNIT_ATT)) == (UNIT_FASTIO|UNIT_ATT))
+        uptr->action (uptr);
+    else
+        sim_activate (uptr, uptr->wait);
+}
+
 /* IOT routine */
 
 t_stat ptp_devio(uint32 dev, uint64 *data) {
@@ -132,7 +157,7 @@ t_stat ptp_devio(uint32 dev, uint64 *data) {
              uptr->STATUS |= NO_TAPE_PP;
          if (uptr->STATUS & BUSY_FLG) {
              uptr->CHR = 0;
-             sim_activate (&ptp_unit, ptp_unit.wait);
+             pt_start (uptr);
          }
          if (uptr->STATUS & DONE_FLG) 
              set_interrupt(dev, uptr->STATUS);
@@ -149,7 +174,7 @@ t_stat ptp_devio(uint32 dev, uint64 *data) {
              uptr->STATUS |= BUSY_FLG;
              uptr->STATUS &= ~DONE_FLG;
              clr_interrupt(dev);
-             sim_activate (&ptp_unit, ptp_unit.wait);
+             pt_start (uptr);
          }
          sim_debug(DEBUG_DATAIO, &ptp_dev, "PP: DATAO %012llo\n\r", *data);
          break;
@@ -232,7 +257,7 @@ t_stat ptr_devio(uint32 dev, uint64 *data) {
          if (uptr->STATUS & BUSY_FLG) {
              uptr->CHR = 0;
              uptr->CHL = 0;
-             sim_activate (&ptr_unit, ptr_unit.wait);
+             pt_start (uptr);
          }
          if (uptr->STATUS & DONE_FLG) 
              set_interrupt(dev, uptr->STATUS);
@@ -246,7 +271,7 @@ t_stat ptr_devio(uint32 dev, uint64 *data) {
              uptr->STATUS |= BUSY_FLG;
              uptr->STATUS &= ~DONE_FLG;
              clr_interrupt(dev);
-             sim_activate (&ptr_unit, ptr_unit.wait);
+             pt_start (uptr);
          }
          sim_debug(DEBUG_DATAIO, &ptr_dev, "PT: DATAI %012llo\n\r", *data);
          break;
@@ -256,6 +281,24 @@ t_stat ptr_devio(uint32 dev, uint64 *data) {
     return SCPE_OK;
 }
 
+/* Next frame off the tape.  The tape is normally read in whole at attach
+   time, so this is just an index into the buffer; POS is kept up to date
+   either way so a stop and continue does not rewind the tape. */
+
+static int ptr_getc (UNIT *uptr)
+{
+    int    ch;
+
+    if (uptr->filebuf == NULL) {
+        if ((ch = getc (uptr->fileref)) != EOF)
+            uptr->pos++;
+        return ch;
+    }
+    if (uptr->pos >= uptr->hwmark)
+        return EOF;
+    return ((uint8 *)uptr->filebuf)[uptr->pos++];
+}
+
 /* Unit service */
 t_stat ptr_svc (UNIT *uptr)
 {
@@ -271,8 +314,8 @@ t_stat ptr_svc (UNIT *uptr)
         return SCPE_UNATT;
     word = 0;
     while (count > 0) {
-        if ((temp = getc (ptr_unit.fileref)) == EOF) {
-           if (feof (ptr_unit.fileref)) {
+        if ((temp = ptr_getc (uptr)) == EOF) {
+           if (uptr->filebuf != NULL || feof (uptr->fileref)) {
              uptr->STATUS &= ~TAPE_PR;
              break;
            }
@@ -312,9 +355,19 @@ t_stat ptr_reset (DEVICE *dptr)
 t_stat ptr_attach (UNIT *uptr, CONST char *cptr)
 {
     t_stat reason;
+    uint32 size;
 
     reason = attach_unit (uptr, cptr);
+    if (reason != SCPE_OK)
+        return reason;
     uptr->STATUS |= TAPE_PR;
+    /* Read the whole tape in now, if that fails fall back to reading
+       it a frame at a time */
+    size = sim_fsize (uptr->fileref);
+    if (size != 0 && (uptr->filebuf = malloc (size)) != NULL) {
+        uptr->hwmark = fread (uptr->filebuf, 1, size, uptr->fileref);
+        sim_fseek (uptr->fileref, 0, SEEK_SET);
+    }
     return reason;
 }
 
@@ -323,6 +376,9 @@ t_stat ptr_attach (UNIT *uptr, CONST char *cptr)
 t_stat ptr_detach (UNIT *uptr)
 {
     uptr->STATUS &= ~TAPE_PR;
+    free (uptr->filebuf);
+    uptr->filebuf = NULL;
+    uptr->hwmark = 0;
     return detach_unit (uptr);
 }
 
@@ -331,7 +387,9 @@ t_stat ptr_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cpt
 fprintf (st, "Paper Tape Reader (PTR)\n\n");
 fprintf (st, "The paper tape reader (PTR) reads data from a disk file.  The POS register\n");
 fprintf (st, "specifies the number of the next data item to be read.  Thus, by changing\n");
-fprintf (st, "POS, the user can backspace or advance the reader.\n");
+fprintf (st, "POS, the user can backspace or advance the reader.  The tape is read\n");
+fprintf (st, "into memory when it is attached.  SET PTR FASTIO hands each frame to the\n");
+fprintf (st, "program as soon as it asks for it, rather than after TIME.\n");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 fprint_reg_help (st, dptr);
@@ -348,7 +406,8 @@ t_stat ptp_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cpt
 fprintf (st, "Paper Tape Punch (PTP)\n\n");
 fprintf (st, "The paper tape punch (PTP) writes data to a disk file.  The POS register\n");
 fprintf (st, "specifies the number of the next data item to be written.  Thus, by changing\n");
-fprintf (st, "POS, the user can backspace or advance the punch.\n");
+fprintf (st, "POS, the user can backspace or advance the punch.  SET PTP FASTIO\n");
+fprintf (st, "punches each frame as soon as it is output, rather than after TIME.\n");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 fprint_reg_help (st, dptr);
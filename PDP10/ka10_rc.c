@@ -100,17 +100,19 @@ struct drvtyp {
     int32       cyl;                                    /* cylinders */
     int32       size;                                   /* #blocks */
     int32       devtype;                                /* device type */
+    struct dk_mech mech;                                /* rev us, no seeks */
     };
 
 struct drvtyp rc_drv_tab[] = {
-    { RD10_WDS, RD10_SEGS, RD10_CYL, RD10_SIZE, RD10_DTYPE},
-    { RM10_WDS, RM10_SEGS, RM10_CYL, RM10_SIZE, RM10_DTYPE},
+    { RD10_WDS, RD10_SEGS, RD10_CYL, RD10_SIZE, RD10_DTYPE, { 33333, 0, 0 } },
+    { RM10_WDS, RM10_SEGS, RM10_CYL, RM10_SIZE, RM10_DTYPE, { 16667, 0, 0 } },
     { 0 }
     };
 
 struct  df10    rc_df10[NUM_DEVS_RC];
 uint64          rc_buf[NUM_DEVS_RC][RM10_WDS];
 uint32          rc_ipr[NUM_DEVS_RC];
+struct dk_timing rc_timing[NUM_DEVS_RC];
 
 t_stat          rc_devio(uint32 dev, uint64 *data);
 t_stat          rc_svc(UNIT *);
@@ -120,6 +122,8 @@ t_stat          rc_reset(DEVICE *);
 t_stat          rc_attach(UNIT *, CONST char *);
 t_stat          rc_detach(UNIT *);
 t_stat          rc_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat          rc_set_timing(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat          rc_show_timing(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat          rc_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
                      const char *cptr);
 const char      *rc_description (DEVICE *dptr);
@@ -159,6 +163,9 @@ MTAB                rc_mod[] = {
     {UNIT_WLK, UNIT_WLK, "write locked", "LOCKED", NULL},
     {UNIT_DTYPE, (RD10_DTYPE << UNIT_V_DTYPE), "RD10", "RD10", &rc_set_type },
     {UNIT_DTYPE, (RM10_DTYPE << UNIT_V_DTYPE), "RM10", "RM10", &rc_set_type },
+    {MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "TIMING", "TIMING",
+          &rc_set_timing, &rc_show_timing, NULL,
+          "Disk timing: FIXED, FAST, REALISTIC or SCALED=n" },
     {0}
 };
 
@@ -306,7 +313,11 @@ t_stat rc_devio(uint32 dev, uint64 *data) {
          if ((*data & WRITE) != 0)
             df10_read(df10);
          sim_debug(DEBUG_DETAIL, dptr, "HK %d cyl %o\n", ctlr, uptr->UFLAGS);
-         sim_activate(uptr, 100);
+         /* Wait for the segment to come under the heads */
+         sim_activate(uptr, dkt_delay(&rc_timing[ctlr], 100, 0.0) +
+                   dkt_rotate(&rc_timing[ctlr], &rc_drv_tab[dtype].mech,
+                              (((cyl >> 4) & 07) * 10) + (cyl & 017),
+                              rc_drv_tab[dtype].seg));
         break;
     }
     return SCPE_OK;
@@ -423,7 +434,8 @@ t_stat rc_svc (UNIT *uptr)
         uptr->UFLAGS = (uptr->UFLAGS & 7) + (seg << 3) + (cyl << 10);
     }
     if ((df10->status & PI_ENABLE) == 0) {
-        sim_activate(uptr, 20);
+        sim_activate(uptr, dkt_xfer(&rc_timing[ctlr], &rc_drv_tab[dtype].mech, 20,
+                                    1, rc_drv_tab[dtype].seg * seg_size));
     }
     return SCPE_OK;
 }
@@ -444,6 +456,38 @@ rc_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 }
 
 
+/* Timing of the controller whose device starts with uptr */
+static struct dk_timing *
+rc_dev_timing(UNIT *uptr)
+{
+    int         ctlr;
+
+    for (ctlr = 0; ctlr < NUM_DEVS_RC; ctlr++) {
+        if (rc_devs[ctlr]->units == uptr)
+            return &rc_timing[ctlr];
+    }
+    return NULL;
+}
+
+t_stat
+rc_set_timing(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+    struct dk_timing *t = rc_dev_timing(uptr);
+
+    if (t == NULL) return SCPE_IERR;
+    return dkt_set_timing(t, cptr);
+}
+
+t_stat
+rc_show_timing(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+    struct dk_timing *t = rc_dev_timing(uptr);
+
+    if (t == NULL) return SCPE_IERR;
+    dkt_show_timing(st, t);
+    return SCPE_OK;
+}
+
 t_stat
 rc_reset(DEVICE * dptr)
 {
@@ -486,6 +530,7 @@ rc_boot(int32 unit_num, DEVICE * dptr)
        fxread (&rc_buf[0][0], sizeof(uint64), wps, uptr->fileref);
        ptr = 0;
        for(wc = wps; wc > 0; wc--) {
+          MEM_DIRTY(addr);
           M[addr++] = rc_buf[0][ptr++];
        }
     }
@@ -529,6 +574,7 @@ fprintf (st, "set the drive type to one of two disk types\n\n");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 fprintf (st, "\nThe type options can be used only when a unit is not attached to a file.\n");
+fprintf (st, "SET %s TIMING=FIXED|FAST|REALISTIC|SCALED=n selects the disk timing model.\n", dptr->name);
 fprintf (st, "The RC device supports the BOOT command.\n");
 fprint_reg_help (st, dptr);
 return SCPE_OK;
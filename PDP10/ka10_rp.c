@@ -22,6 +22,7 @@
 */
 
 #include "ka10_defs.h"
+#include "sim_disk.h"
 
 #ifndef NUM_DEVS_RP
 #define NUM_DEVS_RP 0
@@ -38,8 +39,8 @@
 
 /* Flags in the unit flags word */
 
-#define UNIT_V_WLK      (UNIT_V_UF + 0)                 /* write locked */
-#define UNIT_V_DTYPE    (UNIT_V_UF + 1)                 /* disk type */
+#define UNIT_V_WLK      (DKUF_V_WLK)                    /* write locked */
+#define UNIT_V_DTYPE    (DKUF_V_UF + 0)                 /* disk type */
 #define UNIT_M_DTYPE    7
 #define UNIT_WLK        (1 << UNIT_V_WLK)
 #define UNIT_DTYPE      (UNIT_M_DTYPE << UNIT_V_DTYPE)
@@ -272,19 +273,32 @@ struct drvtyp {
     int32       cyl;                                    /* cylinders */
     int32       size;                                   /* #blocks */
     int32       devtype;                                /* device type */
+    struct dk_mech mech;                                /* rev, seek min, max us */
     };
 
 struct drvtyp rp_drv_tab[] = {
-    { RP04_SECT, RP04_SURF, RP04_CYL, RP04_SIZE, RP04_DEV },
-    { RP06_SECT, RP06_SURF, RP06_CYL, RP06_SIZE, RP06_DEV },
-    { RP07_SECT, RP07_SURF, RP07_CYL, RP07_SIZE, RP07_DEV },
+    { RP04_SECT, RP04_SURF, RP04_CYL, RP04_SIZE, RP04_DEV, { 16667, 7000, 55000 } },
+    { RP06_SECT, RP06_SURF, RP06_CYL, RP06_SIZE, RP06_DEV, { 16667, 7000, 55000 } },
+    { RP07_SECT, RP07_SURF, RP07_CYL, RP07_SIZE, RP07_DEV, { 16667, 5000, 40000 } },
     { 0 }
     };
 
 
+/* Sectors read ahead are kept in rp_buf.  A read fetches the rest of the
+   track in one request, bounded by the words left in the current channel
+   command; the sectors held are rp_blba .. rp_blba + rp_bcnt - 1 of unit
+   rp_bunit.  rp_pend is the unit with a request on the buffer
+   outstanding. */
+#define RP_BUFSECT      RP07_SECT
+
 struct df10   rp_df10[NUM_DEVS_RP];
 uint32        rp_cur_unit[NUM_DEVS_RP];
-uint64        rp_buf[NUM_DEVS_RP][RP_NUMWD];
+uint64        rp_buf[NUM_DEVS_RP][RP_NUMWD * RP_BUFSECT];
+t_lba         rp_blba[NUM_DEVS_RP];
+int           rp_bcnt[NUM_DEVS_RP];
+int           rp_bunit[NUM_DEVS_RP];
+UNIT          *rp_pend[NUM_DEVS_RP];
+struct dk_timing rp_timing[NUM_DEVS_RP];
 int           rp_reg[NUM_DEVS_RP];
 int           rp_ivect[NUM_DEVS_RP];
 int           rp_imode[NUM_DEVS_RP];
@@ -298,12 +312,15 @@ int           rp_devirq(uint32 dev, int addr);
 void          rp_write(int ctlr, int unit, int reg, uint32 data);
 uint32        rp_read(int ctlr, int unit, int reg);
 t_stat        rp_svc(UNIT *);
+void          rp_io_done(UNIT *, t_stat);
 t_stat        rp_boot(int32, DEVICE *);
 void          rp_ini(UNIT *, t_bool);
 t_stat        rp_reset(DEVICE *);
 t_stat        rp_attach(UNIT *, CONST char *);
 t_stat        rp_detach(UNIT *);
 t_stat        rp_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat        rp_set_timing(UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat        rp_show_timing(FILE *st, UNIT *uptr, int32 val, CONST void *desc);
 t_stat        rp_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, 
                     const char *cptr);
 const char    *rp_description (DEVICE *dptr);
@@ -398,6 +415,12 @@ MTAB                rp_mod[] = {
     {UNIT_DTYPE, (RP07_DTYPE << UNIT_V_DTYPE), "RP07", "RP07", &rp_set_type },
     {UNIT_DTYPE, (RP06_DTYPE << UNIT_V_DTYPE), "RP06", "RP06", &rp_set_type },
     {UNIT_DTYPE, (RP04_DTYPE << UNIT_V_DTYPE), "RP04", "RP04", &rp_set_type },
+    {MTAB_XTD|MTAB_VDV|MTAB_VALR, 0, "TIMING", "TIMING",
+          &rp_set_timing, &rp_show_timing, NULL,
+          "Disk timing: FIXED, FAST, REALISTIC or SCALED=n" },
+    {MTAB_XTD|MTAB_VUN|MTAB_VALR, 0, "CACHE", "CACHE=size",
+          &sim_disk_set_cache, &sim_disk_show_cache, NULL,
+          "Set size of sector cache in K/M bytes, 0 disables" },
     {0}
 };
 
@@ -406,7 +429,7 @@ DEVICE              rpa_dev = {
     NUM_UNITS_RP, 8, 18, 1, 8, 36,
     NULL, NULL, &rp_reset, &rp_boot, &rp_attach, &rp_detach,
     &rp_dib[0], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &rp_help, NULL, NULL, &rp_description
+    NULL, NULL, &rp_help, &sim_disk_attach_help, NULL, &rp_description
 };
 
 #if (NUM_DEVS_RP > 1)
@@ -415,7 +438,7 @@ DEVICE              rpb_dev = {
     NUM_UNITS_RP, 8, 18, 1, 8, 36,
     NULL, NULL, &rp_reset, &rp_boot, &rp_attach, &rp_detach,
     &rp_dib[1], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &rp_help, NULL, NULL, &rp_description
+    NULL, NULL, &rp_help, &sim_disk_attach_help, NULL, &rp_description
 };
 
 #if (NUM_DEVS_RP > 2)
@@ -424,7 +447,7 @@ DEVICE              rpc_dev = {
     NUM_UNITS_RP, 8, 18, 1, 8, 36,
     NULL, NULL, &rp_reset, &rp_boot, &rp_attach, &rp_detach,
     &rp_dib[2], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &rp_help, NULL, NULL, &rp_description
+    NULL, NULL, &rp_help, &sim_disk_attach_help, NULL, &rp_description
 };
 
 #if (NUM_DEVS_RP > 3)
@@ -433,7 +456,7 @@ DEVICE              rpd_dev = {
     NUM_UNITS_RP, 8, 18, 1, 8, 36,
     NULL, NULL, &rp_reset, &rp_boot, &rp_attach, &rp_detach,
     &rp_dib[3], DEV_DISABLE | DEV_DEBUG, 0, dev_debug,
-    NULL, NULL, &rp_help, NULL, NULL, &rp_description
+    NULL, NULL, &rp_help, &sim_disk_attach_help, NULL, &rp_description
 };
 
 #endif
@@ -653,7 +676,7 @@ rp_write(int ctlr, int unit, int reg, uint32 data) {
                 uptr->u3 |= (ER1_ILF << 16);
             }
             if (uptr->u3 & DS_PIP)
-                sim_activate(uptr, 100);
+                sim_activate(uptr, dkt_delay(&rp_timing[ctlr], 100, 0.0));
             sim_debug(DEBUG_DETAIL, dptr, "RPA%o AStatus=%06o\n", unit, uptr->u3);
         }
         return;
@@ -778,6 +801,8 @@ t_stat rp_svc (UNIT *uptr)
     struct df10 *df;
     int          cyl = uptr->u4 & 01777;
     int          diff, da;
+    int          wc, n;
+    uint64      *bp;
     t_stat       r;
 
     /* Find dptr, and df10 */
@@ -798,6 +823,13 @@ t_stat rp_svc (UNIT *uptr)
             uptr->u3 |= (ER1_IAE << 16)|DS_ERR|DS_DRY|DS_ATA;
         }
         diff = cyl - (uptr->u5 & 01777);
+        if (diff != 0 && rp_timing[ctlr].mode != DKT_FIXED) {
+            /* Whole seek in one step */
+            uptr->u5 += diff;
+            sim_activate(uptr, dkt_seek(&rp_timing[ctlr], &rp_drv_tab[dtype].mech,
+                                (diff < 0) ? -diff : diff, rp_drv_tab[dtype].cyl));
+            return SCPE_OK;
+        }
         if (diff < 0) {
             if (diff < -50) {
                 uptr->u5 -= 50;
@@ -825,6 +857,15 @@ t_stat rp_svc (UNIT *uptr)
         } else {
             uptr->u3 &= ~DS_PIP;
             uptr->u6 = 0;
+            /* Wait for the sector to come round */
+            if (GET_FNC(uptr->u3) == FNC_SEARCH || GET_FNC(uptr->u3) >= FNC_XFER) {
+                n = dkt_rotate(&rp_timing[ctlr], &rp_drv_tab[dtype].mech,
+                               GET_SC(uptr->u4), rp_drv_tab[dtype].sect);
+                if (n > 0) {
+                    sim_activate(uptr, n);
+                    return SCPE_OK;
+                }
+            }
         }
     }
 
@@ -867,9 +908,17 @@ t_stat rp_svc (UNIT *uptr)
     case FNC_READ:                                 /* read */
     case FNC_READH:                                /* read w/ headers */
     case FNC_WCHK:                                 /* write check */
+        /* A completion can wake the unit after the transfer has ended */
+        if ((uptr->u3 & CR_GO) == 0)
+            return SCPE_OK;
+        if (rp_pend[ctlr]) {
+            /* Buffer busy, the completion reschedules its own unit */
+            if (rp_pend[ctlr] != uptr)
+                sim_activate(uptr, 100);
+            return SCPE_OK;
+        }
 
         if (uptr->u6 == 0) {
-            int wc;
             if (GET_SC(uptr->u4) > rp_drv_tab[dtype].sect ||
                 GET_SF(uptr->u4) > rp_drv_tab[dtype].surf) {
                 uptr->u3 |= (ER1_IAE << 16)|DS_ERR|DS_DRY|DS_ATA;
@@ -883,18 +932,48 @@ t_stat rp_svc (UNIT *uptr)
             }
         sim_debug(DEBUG_DETAIL, dptr, "RPA%o read (%d,%d,%d)\n", unit, cyl, 
                    GET_SC(uptr->u4), GET_SF(uptr->u4));
-            da = GET_DA(uptr->u4, dtype) * RP_NUMWD;
-            sim_fseek(uptr->fileref, da * sizeof(uint64), SEEK_SET);
-            wc = sim_fread (&rp_buf[ctlr][0], sizeof(uint64), RP_NUMWD,
-                                uptr->fileref);
-            while (wc < RP_NUMWD) 
-                rp_buf[ctlr][wc++] = 0;
             uptr->hwmark = RP_NUMWD;
         }
-
-        df->buf = rp_buf[ctlr][uptr->u6++];
-        sim_debug(DEBUG_DATA, dptr, "RPA%o read word %d %012llo\n", unit, uptr->u6, df->buf);
-        if (df10_write(df)) {
+        da = GET_DA(uptr->u4, dtype);
+        if (rp_bunit[ctlr] != unit || (t_lba)da < rp_blba[ctlr] ||
+            (t_lba)da >= rp_blba[ctlr] + rp_bcnt[ctlr]) {
+            /* Read to the end of the track, or as far as the current
+               channel command goes if that is shorter */
+            n = rp_drv_tab[dtype].sect - GET_SC(uptr->u4);
+            if (df->wcr != 0) {
+                wc = (WMASK + 1 - df->wcr) & WMASK;
+                wc = (wc + RP_NUMWD - 1) / RP_NUMWD;
+                if (n > wc)
+                    n = wc;
+            } else
+                n = 1;
+            if (n > RP_BUFSECT)
+                n = RP_BUFSECT;
+            if (n < 1)
+                n = 1;
+            rp_bunit[ctlr] = unit;
+            rp_blba[ctlr] = da;
+            rp_bcnt[ctlr] = n;
+            rp_pend[ctlr] = uptr;
+            sim_disk_rdsect_a(uptr, da, (uint8 *)&rp_buf[ctlr][0], NULL, n,
+                              &rp_io_done);
+            if (rp_pend[ctlr])
+                return SCPE_OK;
+        }
+        bp = &rp_buf[ctlr][(da - rp_blba[ctlr]) * RP_NUMWD];
+
+        /* Move the rest of the sector in one go, then wait as long as
+           the words would have taken one at a time */
+        r = df10_block_transfer(df, &bp[uptr->u6],
+                                uptr->hwmark - uptr->u6, DF10_WRITE, &wc);
+        if (dptr->dctrl & DEBUG_DATA) {
+            int i;
+            for (i = 0; i < wc; i++)
+                sim_debug(DEBUG_DATA, dptr, "RPA%o read word %d %012llo\n", unit,
+                          uptr->u6 + i + 1, bp[uptr->u6 + i]);
+        }
+        uptr->u6 += wc;
+        if (r) {
             if (uptr->u6 == uptr->hwmark) {
                 /* Increment to next sector. Set Last Sector */
                 uptr->u6 = 0;
@@ -910,7 +989,8 @@ t_stat rp_svc (UNIT *uptr)
                     }
                 }
             }
-            sim_activate(uptr, 20);
+            sim_activate(uptr, dkt_xfer(&rp_timing[ctlr], &rp_drv_tab[dtype].mech, 20 * wc,
+                         wc, rp_drv_tab[dtype].sect * RP_NUMWD));
         } else {
             sim_debug(DEBUG_DETAIL, dptr, "RPA%o read done\n", unit);
             uptr->u3 |= DS_DRY;
@@ -923,6 +1003,14 @@ t_stat rp_svc (UNIT *uptr)
 
     case FNC_WRITE:                                /* write */
     case FNC_WRITEH:                               /* write w/ headers */
+        if ((uptr->u3 & CR_GO) == 0)
+            return SCPE_OK;
+        if (rp_pend[ctlr]) {
+            if (rp_pend[ctlr] != uptr)
+                sim_activate(uptr, 100);
+            return SCPE_OK;
+        }
+        rp_bcnt[ctlr] = 0;
         if (uptr->u6 == 0) {
             if (GET_SC(uptr->u4) > rp_drv_tab[dtype].sect ||
                 GET_SF(uptr->u4) > rp_drv_tab[dtype].surf) {
@@ -936,18 +1024,25 @@ t_stat rp_svc (UNIT *uptr)
                 return SCPE_OK;
             }
         }
-        r = df10_read(df);
-        rp_buf[ctlr][uptr->u6++] = df->buf;
-        sim_debug(DEBUG_DATA, dptr, "RPA%o write word %d %012llo\n", unit, uptr->u6, df->buf);
+        r = df10_block_transfer(df, &rp_buf[ctlr][uptr->u6],
+                                RP_NUMWD - uptr->u6, DF10_READ, &wc);
+        if (dptr->dctrl & DEBUG_DATA) {
+            int i;
+            for (i = 0; i < wc; i++)
+                sim_debug(DEBUG_DATA, dptr, "RPA%o write word %d %012llo\n", unit,
+                          uptr->u6 + i + 1, rp_buf[ctlr][uptr->u6 + i]);
+        }
+        uptr->u6 += wc;
         if (r == 0 || uptr->u6 == RP_NUMWD) {
             while (uptr->u6 < RP_NUMWD) 
                 rp_buf[ctlr][uptr->u6++] = 0;
         sim_debug(DEBUG_DETAIL, dptr, "RPA%o write (%d,%d,%d)\n", unit, cyl, 
                    GET_SC(uptr->u4), GET_SF(uptr->u4));
-            da = GET_DA(uptr->u4, dtype) * RP_NUMWD;
-            sim_fseek(uptr->fileref, da * sizeof(uint64), SEEK_SET);
-            sim_fwrite (&rp_buf[ctlr][0], sizeof(uint64), RP_NUMWD,
-                                uptr->fileref);
+            /* The buffer is not touched again until the write completes */
+            da = GET_DA(uptr->u4, dtype);
+            rp_pend[ctlr] = uptr;
+            sim_disk_wrsect_a(uptr, da, (uint8 *)&rp_buf[ctlr][0], NULL, 1,
+                              &rp_io_done);
             uptr->u6 = 0;
             if (r) {
                 uptr->u4 += 0x10000;
@@ -965,7 +1060,8 @@ t_stat rp_svc (UNIT *uptr)
              }
         }
         if (r) {
-            sim_activate(uptr, 20);
+            sim_activate(uptr, dkt_xfer(&rp_timing[ctlr], &rp_drv_tab[dtype].mech, 20 * wc,
+                         wc, rp_drv_tab[dtype].sect * RP_NUMWD));
         } else {
         sim_debug(DEBUG_DETAIL, dptr, "RPA%o write done\n", unit);
             uptr->u3 |= DS_DRY;
@@ -980,12 +1076,26 @@ t_stat rp_svc (UNIT *uptr)
 }
 
 
+/* Completion of a sim_disk request on the controller buffer.  Called
+   directly for synchronous units, else before the unit is next serviced. */
+void
+rp_io_done(UNIT *uptr, t_stat r)
+{
+    int         ctlr = (uptr - rp_unit) / NUM_UNITS_RP;
+
+    if (r != SCPE_OK && rp_bcnt[ctlr] != 0)
+        memset(&rp_buf[ctlr][0], 0, rp_bcnt[ctlr] * RP_NUMWD * sizeof(uint64));
+    rp_pend[ctlr] = NULL;
+}
+
 t_stat
 rp_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
     int         i;
 
     if (uptr == NULL) return SCPE_IERR;
+    if (uptr->flags & UNIT_ATT)
+        return SCPE_ALATT;
     uptr->flags &= ~(UNIT_DTYPE);
     uptr->flags |= val;
     i = GET_DTYPE(val);
@@ -994,6 +1104,21 @@ rp_set_type(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 }
 
 
+t_stat
+rp_set_timing(UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+    if (uptr == NULL) return SCPE_IERR;
+    return dkt_set_timing(&rp_timing[(uptr - rp_unit) / NUM_UNITS_RP], cptr);
+}
+
+t_stat
+rp_show_timing(FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+    if (uptr == NULL) return SCPE_IERR;
+    dkt_show_timing(st, &rp_timing[(uptr - rp_unit) / NUM_UNITS_RP]);
+    return SCPE_OK;
+}
+
 t_stat
 rp_reset(DEVICE * rptr)
 {
@@ -1004,6 +1129,7 @@ rp_reset(DEVICE * rptr)
         rp_df10[ctlr].ccw_comp = 14;
         rp_attn[ctlr] = 0;
         rp_rae[ctlr] = 0;
+        rp_bcnt[ctlr] = 0;
     }
     return SCPE_OK;
 }
@@ -1017,15 +1143,18 @@ rp_boot(int32 unit_num, DEVICE * rptr)
     uint32              ptr;
     int                 wc;
 
-    sim_fseek(uptr->fileref, 0, SEEK_SET);
-    sim_fread (&rp_buf[0][0], sizeof(uint64), RP_NUMWD, uptr->fileref);
+    rp_bcnt[0] = 0;
+    sim_disk_rdsect(uptr, 0, (uint8 *)&rp_buf[0][0], NULL, 1);
     addr = rp_buf[0][0] & RMASK;
     wc = (rp_buf[0][0] >> 18) & RMASK;
     ptr = 1;
-    for(; wc > 0; wc--) 
+    for(; wc > 0; wc--) {
+        MEM_DIRTY(addr);
         M[addr++] = rp_buf[0][ptr++];
+    }
     addr = rp_buf[0][ptr++] & RMASK;
     M[addr] = rp_buf[0][ptr];
+    MEM_DIRTY(addr);
     PC = addr;
     return SCPE_OK;
 }
@@ -1040,7 +1169,8 @@ t_stat rp_attach (UNIT *uptr, CONST char *cptr)
     int ctlr;
 
     uptr->capac = rp_drv_tab[GET_DTYPE (uptr->flags)].size;
-    r = attach_unit (uptr, cptr);
+    r = sim_disk_attach (uptr, cptr, RP_NUMWD * sizeof(uint64), sizeof(uint64),
+                         TRUE, 0, "RP", 0, 0);
     if (r != SCPE_OK)
         return r;
     rptr = find_dev_from_unit(uptr);
@@ -1062,12 +1192,19 @@ t_stat rp_attach (UNIT *uptr, CONST char *cptr)
 
 t_stat rp_detach (UNIT *uptr)
 {
+    int ctlr = (uptr - rp_unit) / NUM_UNITS_RP;
+    int unit = (uptr - rp_unit) % NUM_UNITS_RP;
+
     if (!(uptr->flags & UNIT_ATT))                          /* attached? */
         return SCPE_OK;
     if (sim_is_active (uptr))                              /* unit active? */
         sim_cancel (uptr);                                  /* cancel operation */
+    if (rp_pend[ctlr] == uptr)
+        rp_pend[ctlr] = NULL;
+    if (rp_bunit[ctlr] == unit)
+        rp_bcnt[ctlr] = 0;
     uptr->u3 &= ~(DS_VV|DS_WRL|DS_DPR|DS_DRY);
-    return detach_unit (uptr);
+    return sim_disk_detach (uptr);
 }
 
 t_stat rp_help (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, const char *cptr)
@@ -1080,6 +1217,8 @@ fprintf (st, "standard 044 compliant bad block table on the last track.\n\n");
 fprint_set_help (st, dptr);
 fprint_show_help (st, dptr);
 fprintf (st, "\nThe type options can be used only when a unit is not attached to a file.\n");
+fprintf (st, "SET %s TIMING=FIXED|FAST|REALISTIC|SCALED=n selects the disk timing model.\n", dptr->name);
+fprintf (st, "SET %sn CACHE=size keeps recently used sectors in memory.\n", dptr->name);
 fprintf (st, "The RP device supports the BOOT command.\n");
 fprint_reg_help (st, dptr);
 return SCPE_OK;
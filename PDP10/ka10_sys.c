@@ -122,7 +122,8 @@ DEVICE *sim_devices[] = {
 const char *sim_stop_messages[] = {
     "Unknown error",
     "HALT instruction",
-    "Breakpoint"
+    "Breakpoint",
+    "Write watchpoint"
      };
 
 /* Simulator debug controls */
@@ -212,6 +213,7 @@ for ( ;; ) {                                            /* loop until JRST */
             cksm = cksm + data;                         /* add to cksm */
             pa = ((uint32) count + 1) & RMASK;             /* store */
             M[pa] = data;
+            MEM_DIRTY(pa);
             }                                           /* end for */
         data = getrimw (fileref);                       /* get cksm */
         if (data == RIM_EOF)
@@ -231,20 +233,13 @@ return SCPE_OK;
 }
 
 
-int get_word(FILE *fileref, uint64 *word) 
-{
-   char cbuf[5];
-  
-   if (sim_fread(cbuf, 1, 5, fileref) != 5) 
-       return 1;
-   *word = ((uint64)(cbuf[0]) << 29) |
-           ((uint64)(cbuf[1]) << 22) |
-           ((uint64)(cbuf[2]) << 15) |
-           ((uint64)(cbuf[3]) << 8) |
-           ((uint64)(cbuf[4] & 0177) << 1) |
-           ((uint64)(cbuf[4] & 0200) >> 7);
-    return 0;
-}
+/* Unpack the 36 bit word stored in the five bytes at bp */
+#define GET_WORD(bp)    (((uint64)(bp)[0] << 29) | \
+                         ((uint64)(bp)[1] << 22) | \
+                         ((uint64)(bp)[2] << 15) | \
+                         ((uint64)(bp)[3] << 8) | \
+                         ((uint64)((bp)[4] & 0177) << 1) | \
+                         ((uint64)((bp)[4] & 0200) >> 7))
 
 /* SAV file loader
 
@@ -261,31 +256,48 @@ int get_word(FILE *fileref, uint64 *word)
 
 t_stat load_sav (FILE *fileref)
 {
+    uint8  *buf, *bp, *end;
     uint64 data;
-    uint32 pa;
+    uint32 pa, sz;
     int32 wc;
+    t_stat r = SCPE_OK;
 
-    for ( ;; ) {                                        /* loop */
-        if (get_word(fileref, &data))
-            return SCPE_OK;
+    /* Read the whole file once and unpack from the buffer */
+    sz = sim_fsize (fileref);
+    if (sz == 0)
+        return SCPE_OK;
+    if ((buf = (uint8 *)malloc (sz)) == NULL)
+        return SCPE_MEM;
+    sz = (uint32)sim_fread (buf, 1, sz, fileref);
+    end = buf + (sz - (sz % 5));                       /* whole words only */
+    for (bp = buf; bp < end; ) {                       /* loop */
+        data = GET_WORD(bp);
+        bp += 5;
         wc = (int32)(data >> 18);
         pa = (uint32) (data & RMASK);
         if (wc == (OP_JRST << 9)) {
             printf("Start addr=%06o\n", pa);
             PC = pa;
-            return SCPE_OK;
+            break;
         }
         while (wc != 0) {
             pa++;
             pa &= RMASK;
             wc++;
             wc &= RMASK;
-            if (get_word(fileref, &data))
-               return SCPE_FMT;
-            M[pa] = data;
+            if (bp >= end) {
+               r = SCPE_FMT;
+               break;
+            }
+            M[pa] = GET_WORD(bp);
+            MEM_DIRTY(pa);
+            bp += 5;
         }                                              /* end if  count*/
+        if (r != SCPE_OK)
+            break;
     }
-    return SCPE_OK;
+    free (buf);
+    return r;
 }
 
 /* EXE file loader
@@ -317,8 +329,8 @@ t_stat load_sav (FILE *fileref)
 
 t_stat load_exe (FILE *fileref)
 {
-uint64 data, dirbuf[DIRSIZ], pagbuf[PAG_SIZE], entbuf[2];
-int32 ndir, entvec, i, j, k, cont, bsz, bty, rpt, wc;
+uint64 data, dirbuf[DIRSIZ], entbuf[2];
+int32 ndir, entvec, i, k, cont, bsz, bty, rpt, wc;
 int32 fpage, mpage;
 uint32 ma;
 
@@ -370,21 +382,24 @@ for (i = 0; i < ndir; i = i + 2) {                      /* loop thru dir */
     fpage = (int32) (dirbuf[i] & RMASK);                /* file page */
     mpage = (int32) (dirbuf[i + 1] & RMASK);            /* memory page */
     rpt = (int32) ((dirbuf[i + 1] >> 27) + 1);          /* repeat count */
-    for (j = 0; j < rpt; j++, mpage++) {                /* loop thru rpts */
-        if (fpage) {                                    /* file pages? */
-            fseek (fileref, (fpage << PAG_V_PN) * sizeof (uint64), SEEK_SET);
-            wc = fxread (pagbuf, sizeof (uint64), PAG_SIZE, fileref);
-            if (wc < PAG_SIZE)
-                return SCPE_FMT;
-            fpage++;
-            }
-        ma = mpage << PAG_V_PN;                         /* mem addr */
-        for (k = 0; k < PAG_SIZE; k++, ma++) {          /* copy buf to mem */
-            if (ma > MEMSIZE)
-                return SCPE_NXM;
-            M[ma] = fpage? (pagbuf[k] & FMASK): 0;
-            }                                           /* end copy */
-        }                                               /* end rpt */
+    ma = mpage << PAG_V_PN;                             /* mem addr */
+    wc = rpt * PAG_SIZE;                                /* words to load */
+    k = (ma < MEMSIZE) ? MEMSIZE - ma : 0;              /* words that fit */
+    if (wc > k)
+        wc = k;
+    if (fpage) {                                        /* file pages? */
+        /* The repeated pages are consecutive in the file, read them
+           straight into memory */
+        fseek (fileref, (fpage << PAG_V_PN) * sizeof (uint64), SEEK_SET);
+        if (fxread (&M[ma], sizeof (uint64), wc, fileref) < (size_t)wc)
+            return SCPE_FMT;
+        }
+    for (k = 0; k < wc; k++, ma++) {                    /* clean up mem */
+        M[ma] = fpage? (M[ma] & FMASK): 0;
+        MEM_DIRTY(ma);
+        }                                               /* end copy */
+    if (wc < rpt * PAG_SIZE)                            /* ran off memory */
+        return SCPE_NXM;
     }                                                   /* end directory */
 if (entvec && entbuf[1])
     PC = (int32) entbuf[1] & RMASK;               /* start addr */
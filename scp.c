@@ -260,9 +260,11 @@
 #define SCH_LE          7
 
 #define MAX_DO_NEST_LVL 20                              /* DO cmd nesting level */
-#define SRBSIZ          1024                            /* save/restore buffer */
+#define SRBSIZ          SIM_DIRTY_PGSIZE                /* save/restore buffer (one dirty page) */
 #define SIM_BRK_INILNT  4096                            /* bpt tbl length */
 #define SIM_BRK_ALLTYP  0xFFFFFFFB
+#define QUEUE_TYPE_LIST 0                               /* sorted delta list */
+#define QUEUE_TYPE_HEAP 1                               /* binary heap on absolute time */
 #define UPDATE_SIM_TIME                                         \
     if (1) {                                                    \
         int32 _x;                                               \
@@ -438,6 +440,7 @@ t_stat dep_addr (int32 flag, const char *cptr, t_addr addr, DEVICE *dptr,
 void fprint_fields (FILE *stream, t_value before, t_value after, BITFIELD* bitdefs);
 t_stat step_svc (UNIT *ptr);
 t_stat expect_svc (UNIT *ptr);
+t_stat export_svc (UNIT *ptr);
 t_stat shift_args (char *do_arg[], size_t arg_count);
 t_stat set_on (int32 flag, CONST char *cptr);
 t_stat set_verify (int32 flag, CONST char *cptr);
@@ -450,6 +453,13 @@ void int_handler (int signal);
 t_stat set_prompt (int32 flag, CONST char *cptr);
 t_stat sim_set_asynch (int32 flag, CONST char *cptr);
 t_stat sim_set_environment (int32 flag, CONST char *cptr);
+t_stat sim_set_queue (int32 flag, CONST char *cptr);
+t_stat sim_set_export (int32 flag, CONST char *cptr);
+t_stat sim_show_export (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+static t_stat show_queue_stats (FILE *st);
+static void _sim_heap_remove (UNIT *uptr);
+static void _sim_heap_sort (void);
+static t_stat _sim_queue_insert (UNIT *uptr, int32 event_time);
 static const char *get_dbg_verb (uint32 dbits, DEVICE* dptr);
 
 /* Global data */
@@ -485,6 +495,17 @@ int32 sim_step = 0;
 static double sim_time;
 static uint32 sim_rtime;
 static int32 noqueue_time;
+static int32 sim_queue_type = QUEUE_TYPE_LIST;          /* event queue organization */
+static UNIT **sim_heap = NULL;                          /* event heap */
+static int32 sim_heap_cnt = 0;                          /* event heap entries */
+static int32 sim_heap_lnt = 0;                          /* event heap allocated length */
+static t_uint64 sim_heap_seq = 0;                       /* event heap insertion sequence */
+static int32 sim_queue_depth = 0;                       /* current queue depth */
+static int32 sim_queue_max_depth = 0;                   /* maximum queue depth */
+static double sim_queue_inserts = 0;                    /* activations */
+static double sim_queue_cancels = 0;                    /* cancels */
+double sim_queue_dispatches = 0;                        /* events dispatched */
+static double sim_queue_depth_sum = 0;                  /* sum of depths at activation */
 volatile int32 stop_cpu = 0;
 static char **sim_argv;
 t_value *sim_eval = NULL;
@@ -498,6 +519,15 @@ struct timespec sim_deb_basetime;                       /* debug timestamp relat
 char *sim_prompt = NULL;                                /* prompt string */
 static FILE *sim_gotofile;                              /* the currently open do file */
 static int32 sim_goto_line[MAX_DO_NEST_LVL+1];          /* the current line number in the currently open do file */
+typedef struct {
+    char        *name;                                  /* label */
+    char        *line;                                  /* label line, for echo */
+    long        pos;                                    /* file position after it */
+    int32       lineno;                                 /* its line number */
+    } DO_LABEL;
+static DO_LABEL *sim_do_labels[MAX_DO_NEST_LVL+1];      /* label index of each do file */
+static int32 sim_do_nlabels[MAX_DO_NEST_LVL+1];         /* labels in it, -1 if not built */
+static void sim_do_free_labels (int32 depth);
 static int32 sim_do_echo = 0;                           /* the echo status of the currently open do file */
 static int32 sim_show_message = 1;                      /* the message display status of the currently open do file */
 static int32 sim_on_inherit = 0;                        /* the inherit status of on state and conditions when executing do files */
@@ -516,6 +546,7 @@ static SCHTAB sim_staba;                                /* Memory search specifi
 
 static UNIT sim_step_unit = { UDATA (&step_svc, 0, 0)  };
 static UNIT sim_expect_unit = { UDATA (&expect_svc, 0, 0)  };
+static UNIT sim_export_unit = { UDATA (&export_svc, 0, 0)  };
 #if defined USE_INT64
 static const char *sim_si64 = "64b data";
 #else
@@ -531,6 +562,8 @@ const char *sim_savename = sim_name;      /* Simulator Name used in SAVE/RESTORE
 /* Tables and strings */
 
 const char save_vercur[] = "V4.0";
+const char save_ver40i[] = "V4.0I";                     /* incremental to a base save */
+const char save_ver40m[] = "V4.0M";                     /* memory stored for mapping */
 const char save_ver40[] = "V4.0";
 const char save_ver35[] = "V3.5";
 const char save_ver32[] = "V3.2";
@@ -753,6 +786,14 @@ static const char simh_help[] =
       " to a file.  This includes the contents of main memory and all registers,\n"
       " and the I/O connections of devices:\n\n"
       "++SAVE <filename>\n\n"
+      "4Switches\n"
+      " Switches can influence the output and behavior of the SAVE command\n\n"
+      "++-I      Only saves the memory changed since the last SAVE or RESTORE\n"
+      "++-M      Stores memory so that RESTORE -M can map it from the file\n"
+      "\n"
+      " A file written with -I refers to the file of the last SAVE or RESTORE\n"
+      " as its base, and restoring it restores the base first.  Memory which\n"
+      " doesn't track its changes is saved in full.\n\n"
 #define HLP_RESTORE     "*Commands Saving_and_Restoring_State RESTORE"
       "3RESTORE\n"
       " The RESTORE command (abbreviation REST, alternately GET) restores a\n"
@@ -763,7 +804,11 @@ static const char simh_help[] =
       "++-Q      Suppresses version warning messages\n"
       "++-D      Suppress detaching and attaching devices during a restore\n"
       "++-F      Overrides the related file timestamp validation check\n"
+      "++-M      Maps memory saved by SAVE -M from the file instead of reading it\n"
       "\n"
+      " Memory mapped by RESTORE -M is loaded from the save file as it is used,\n"
+      " so that file must not be changed by anything other than this simulator\n"
+      " while it is running.\n\n"
       "4Notes:\n"
       " 1) SAVE file format compresses zeroes to minimize file size.\n"
       " 2) The simulator can't restore active incoming telnet sessions to\n"
@@ -984,6 +1029,14 @@ static const char simh_help[] =
       "++++++++                     specified destination {STDOUT,STDERR,DEBUG\n"
       "++++++++                     or filename)\n"
       "+set console NOLOG           disable console logging\n"
+      "+set console OUTBUFFER{=msec}\n"
+      "++++++++                     hold console output until a newline, an\n"
+      "++++++++                     input poll or msec (default 10) elapse\n"
+      "+set console NOOUTBUFFER     write console output a character at a time\n"
+      "+set console JOURNAL=file    record console input and when it arrived\n"
+      "+set console REPLAY=file     replay recorded console input at the same\n"
+      "++++++++                     simulated times, ignoring the keyboard\n"
+      "+set console NOJOURNAL       stop recording or replaying console input\n"
        /***************** 80 character line width template *************************/
 #define HLP_SET_REMOTE "*Commands SET REMOTE"
       "3Remote\n"
@@ -995,6 +1048,16 @@ static const char simh_help[] =
       "++++++++                     before automatic continue\n"
       "+set remote MASTER           enable master mode remote console\n"
       "+set remote NOMASTER         disable remote master mode console\n"
+      "+set remote MONITOR          run EXAMINE, SHOW and other reporting\n"
+      "++++++++                     commands without leaving instruction\n"
+      "++++++++                     execution\n"
+      "+set remote NOMONITOR        run all commands outside of instruction\n"
+      "++++++++                     execution (default)\n"
+      "4Framed Requests\n"
+      " A remote console command line of the form \"@tag command\" is a framed\n"
+      " request.  It is not echoed or prompted, and its reply is a line\n"
+      " \"@tag status length\" followed by exactly length bytes of command output.\n"
+      " status is the numeric command status, 0 for success.\n"
 #define HLP_SET_DEFAULT "*Commands SET Working_Directory"
       "3Working Directory\n"
       "+set default <dir>           set the current directory\n"
@@ -1040,6 +1103,12 @@ static const char simh_help[] =
       "5-E\n"
       " The -E switch causes data blob output to also display the data as\n"
       " EBCDIC characters.\n"
+      "5-B\n"
+      " The -B switch queues debug messages in memory and has a separate\n"
+      " thread write them to the debug file, so producing them slows the\n"
+      " simulator much less.  If messages are produced faster than they can be\n"
+      " written, some are dropped and the number dropped is noted in the debug\n"
+      " file.  All queued messages are written whenever the simulator stops.\n"
 #define HLP_SET_BREAK  "*Commands SET Breakpoints"
       "3Breakpoints\n"
       "+set break <list>            set breakpoints\n"
@@ -1049,6 +1118,8 @@ static const char simh_help[] =
       "3Throttle\n"
       "+set throttle {x{M|K|%%}}|{x/t}\n"
       "++++++++                     set simulation rate\n"
+      "+set -a throttle x{M|K}      set simulation rate, pacing against absolute\n"
+      "++++++++                     deadlines (sleep, then spin) for even timing\n"
       "+set nothrottle              set simulation rate to maximum\n"
 #define HLP_SET_ASYNCH "*Commands SET Asynch"
       "3Asynch\n"
@@ -1094,6 +1165,32 @@ static const char simh_help[] =
 #define HLP_SET_PROMPT "*Commands SET Command_Prompt"
       "3Command Prompt\n"
       "+set prompt \"string\"        sets an alternate simulator prompt string\n"
+#define HLP_SET_QUEUE "*Commands SET Event_Queue"
+      "3Event Queue\n"
+      "+set queue list              keep pending events in a sorted list\n"
+      "+set queue heap              keep pending events in a binary heap\n"
+       /***************** 80 character line width template *************************/
+      " The event queue records the pending activations of all units.  The\n"
+      " default list organization is efficient when few events are pending.\n"
+      " The heap organization keeps the cost of activating and canceling events\n"
+      " proportional to the logarithm of the number of pending events, which\n"
+      " helps configurations with many simultaneously active units.  Pending\n"
+      " events are preserved when the organization is changed.\n"
+#define HLP_SET_EXPORT "*Commands SET Front_Panel_Export"
+      "3Front Panel Export\n"
+      "+set export name rate item{ item...}\n"
+      "++++++++                     publish values in shared memory\n"
+      "+set noexport                stop publishing values\n"
+       /***************** 80 character line width template *************************/
+      " SET EXPORT creates (or attaches to) the shared memory segment name and\n"
+      " publishes the listed values in it rate times per second while the\n"
+      " simulator runs, and again each time it stops or a command completes.\n"
+      " Each item has the form {@}{dev:}reg{[count]}.  A count exports the\n"
+      " first count elements of a register array.  A leading @ exports the\n"
+      " contents of the device memory location addressed by the register.\n"
+      " The default device is used when dev: is omitted.  Front panel\n"
+      " applications read the segment directly, without EXAMINE commands, so\n"
+      " this is normally issued by the front panel API rather than typed.\n"
       "3Device and Unit\n"
       "+set <dev> OCT|DEC|HEX       set device display radix\n"
       "+set <dev> ENABLED           enable device\n"
@@ -1118,6 +1215,7 @@ static const char simh_help[] =
       "+sh{ow} s{how}               show SHOW commands for all devices\n" 
       "+sh{ow} n{ames}              show logical names\n"
       "+sh{ow} q{ueue}              show event queue\n"
+      "+sh{ow} q{ueue} statistics   show event queue statistics\n"
       "+sh{ow} ti{me}               show simulated time\n"
       "+sh{ow} th{rottle}           show simulation rate\n"
       "+sh{ow} a{synch}             show asynchronouse I/O state\n" 
@@ -1138,8 +1236,11 @@ static const char simh_help[] =
       "+sh{ow} video                show video capabilities\n"
 #endif
       "+sh{ow} clocks               show calibrated timers\n"
+      "+sh{ow} performance          show instruction, event, idle and device rates\n"
+      "+sh{ow} performance json     show the same totals as one JSON object\n"
       "+sh{ow} throttle             show throttle info\n"
       "+sh{ow} on                   show on condition actions\n"
+      "+sh{ow} export               show front panel shared memory export\n"
       "+h{elp} <dev> show           displays the device specific show commands\n"
       "++++++++                     available\n"
 #define HLP_SHOW_CONFIG         "*Commands SHOW"
@@ -1164,9 +1265,11 @@ static const char simh_help[] =
 #define HLP_SHOW_MULTIPLEXER    "*Commands SHOW"
 #define HLP_SHOW_VIDEO          "*Commands SHOW"
 #define HLP_SHOW_CLOCKS         "*Commands SHOW"
+#define HLP_SHOW_PERFORMANCE    "*Commands SHOW"
 #define HLP_SHOW_ON             "*Commands SHOW"
 #define HLP_SHOW_SEND           "*Commands SHOW"
 #define HLP_SHOW_EXPECT         "*Commands SHOW"
+#define HLP_SHOW_EXPORT         "*Commands SHOW"
 #define HLP_HELP                "*Commands HELP"
        /***************** 80 character line width template *************************/
       "2HELP\n"
@@ -1784,6 +1887,9 @@ static CTAB set_glob_tab[] = {
     { "QUIET",      &set_quiet,                 1, HLP_SET_QUIET },
     { "NOQUIET",    &set_quiet,                 0, HLP_SET_QUIET },
     { "PROMPT",     &set_prompt,                0, HLP_SET_PROMPT },
+    { "QUEUE",      &sim_set_queue,             0, HLP_SET_QUEUE },
+    { "EXPORT",     &sim_set_export,            1, HLP_SET_EXPORT },
+    { "NOEXPORT",   &sim_set_export,            0, HLP_SET_EXPORT },
     { NULL,         NULL,                       0 }
     };
 
@@ -1831,8 +1937,10 @@ static SHTAB show_glob_tab[] = {
     { "VIDEO",          &vid_show,                  0, HLP_SHOW_VIDEO },
 #endif
     { "CLOCKS",         &sim_show_timers,           0, HLP_SHOW_CLOCKS },
+    { "PERFORMANCE",    &sim_show_performance,      0, HLP_SHOW_PERFORMANCE },
     { "SEND",           &sim_show_send,             0, HLP_SHOW_SEND },
     { "EXPECT",         &sim_show_expect,           0, HLP_SHOW_EXPECT },
+    { "EXPORT",         &sim_show_export,           0, HLP_SHOW_EXPORT },
     { "ON",             &show_on,                   0, HLP_SHOW_ON },
     { NULL,             NULL,                       0 }
     };
@@ -2010,6 +2118,7 @@ else if (*argv[0]) {                                    /* sim name arg? */
 stat = process_stdin_commands (SCPE_BARE_STATUS(stat), argv);
 
 detach_all (0, TRUE);                                   /* close files */
+sim_hist_close ();                                      /* close history file */
 sim_set_deboff (0, NULL);                               /* close debug */
 sim_set_logoff (0, NULL);                               /* close log */
 sim_set_notelnet (0, NULL);                             /* close Telnet */
@@ -2067,6 +2176,7 @@ while (stat != SCPE_EXIT) {                             /* in case exit */
         }
     if (sim_vm_post != NULL)
         (*sim_vm_post) (TRUE);
+    sim_export_update ();                               /* publish command effects */
     }                                                   /* end while */
 return stat;
 }
@@ -2773,6 +2883,7 @@ if (flag >= 0) {                                        /* Only bump nesting fro
 strcpy( sim_do_filename[sim_do_depth], do_arg[0]);      /* stash away do file name for possible use by 'call' command */
 sim_do_label[sim_do_depth] = label;                     /* stash away do label for possible use in messages */
 sim_goto_line[sim_do_depth] = 0;
+sim_do_free_labels (sim_do_depth);                      /* new file, no labels yet */
 if (label) {
     sim_gotofile = fpin;
     sim_do_echo = echo;
@@ -2880,6 +2991,7 @@ do {
 Cleanup_Return:
 fclose (fpin);                                          /* close file */
 sim_gotofile = NULL;
+sim_do_free_labels (sim_do_depth);
 if (flag >= 0) {
     sim_do_echo = saved_sim_do_echo;                    /* restore echo state we entered with */
     sim_show_message = saved_sim_show_message;          /* restore message display state we entered with */
@@ -3556,41 +3668,93 @@ return sim_exp_show (st, exp, gbuf);
 
 /* Goto command */
 
-t_stat goto_cmd (int32 flag, CONST char *fcptr)
+/* The labels of a do file are indexed the first time it does a goto, so
+   loops around a goto don't rescan the file each time round. */
+
+static void sim_do_free_labels (int32 depth)
+{
+int32 i;
+
+for (i = 0; i < sim_do_nlabels[depth]; i++) {
+    free (sim_do_labels[depth][i].name);
+    free (sim_do_labels[depth][i].line);
+    }
+free (sim_do_labels[depth]);
+sim_do_labels[depth] = NULL;
+sim_do_nlabels[depth] = -1;
+}
+
+static t_stat sim_do_index_labels (int32 depth)
 {
-char cbuf[CBUFSIZE], gbuf[CBUFSIZE], gbuf1[CBUFSIZE];
+char cbuf[CBUFSIZE], gbuf[CBUFSIZE];
 const char *cptr;
 long fpos;
-int32 saved_do_echo = sim_do_echo;
-int32 saved_goto_line = sim_goto_line[sim_do_depth];
+int32 lineno = 0;
+int32 n = 0, max = 0;
+DO_LABEL *labels = NULL, *nl;
 
-if (NULL == sim_gotofile) return SCPE_UNK;              /* only valid inside of do_cmd */
-get_glyph (fcptr, gbuf1, 0);
-if ('\0' == gbuf1[0]) return SCPE_ARG;                  /* unspecified goto target */
 fpos = ftell(sim_gotofile);                             /* Save start position */
-rewind(sim_gotofile);                                   /* start search for label */
-sim_goto_line[sim_do_depth] = 0;                        /* reset line number */
-sim_do_echo = 0;                                        /* Don't echo while searching for label */
+rewind(sim_gotofile);                                   /* scan for labels */
 while (1) {
     cptr = read_line (cbuf, sizeof(cbuf), sim_gotofile);/* get cmd line */
     if (cptr == NULL) break;                            /* exit on eof */
-    sim_goto_line[sim_do_depth] += 1;                   /* record line number */
-    if (*cptr == 0) continue;                           /* ignore blank */
+    lineno += 1;                                        /* record line number */
     if (*cptr != ':') continue;                         /* ignore non-labels */
     ++cptr;                                             /* skip : */
     while (sim_isspace (*cptr)) ++cptr;                 /* skip blanks */
-    cptr = get_glyph (cptr, gbuf, 0);                   /* get label glyph */
-    if (0 == strcmp(gbuf, gbuf1)) {
+    get_glyph (cptr, gbuf, 0);                          /* get label glyph */
+    if (n == max) {
+        max = max ? 2 * max : 16;
+        nl = (DO_LABEL *)realloc (labels, max * sizeof (*labels));
+        if (nl == NULL)
+            break;
+        labels = nl;
+        }
+    labels[n].name = strdup (gbuf);
+    labels[n].line = strdup (cbuf);
+    labels[n].pos = ftell(sim_gotofile);
+    labels[n].lineno = lineno;
+    if ((labels[n].name == NULL) || (labels[n].line == NULL)) {
+        free (labels[n].name);
+        free (labels[n].line);
+        break;
+        }
+    n++;
+    }
+fseek(sim_gotofile, fpos, SEEK_SET);                    /* restore start position */
+sim_do_labels[depth] = labels;
+sim_do_nlabels[depth] = n;
+return (cptr == NULL) ? SCPE_OK : SCPE_MEM;
+}
+
+t_stat goto_cmd (int32 flag, CONST char *fcptr)
+{
+char gbuf1[CBUFSIZE];
+DO_LABEL *lp;
+int32 i;
+t_stat r;
+
+if (NULL == sim_gotofile) return SCPE_UNK;              /* only valid inside of do_cmd */
+get_glyph (fcptr, gbuf1, 0);
+if ('\0' == gbuf1[0]) return SCPE_ARG;                  /* unspecified goto target */
+if (sim_do_nlabels[sim_do_depth] < 0) {                 /* first goto in this file? */
+    r = sim_do_index_labels (sim_do_depth);
+    if (r != SCPE_OK) {
+        sim_do_free_labels (sim_do_depth);
+        return r;
+        }
+    }
+for (i = 0; i < sim_do_nlabels[sim_do_depth]; i++) {
+    lp = &sim_do_labels[sim_do_depth][i];
+    if (0 == strcmp(lp->name, gbuf1)) {
+        fseek(sim_gotofile, lp->pos, SEEK_SET);         /* continue after the label */
+        sim_goto_line[sim_do_depth] = lp->lineno;
         sim_brk_clract ();                              /* goto defangs current actions */
-        sim_do_echo = saved_do_echo;                    /* restore echo mode */
         if (sim_do_echo)                                /* echo if -v */
-            sim_printf("%s> %s\n", do_position(), cbuf);
+            sim_printf("%s> %s\n", do_position(), lp->line);
         return SCPE_OK;
         }
     }
-sim_do_echo = saved_do_echo;                            /* restore echo mode */
-fseek(sim_gotofile, fpos, SEEK_SET);                    /* resture start position */
-sim_goto_line[sim_do_depth] = saved_goto_line;          /* restore start line number */
 return SCPE_ARG;
 }
 
@@ -4154,7 +4318,7 @@ if (*cptr == 0) {                                       /* now eol? */
 GET_SWITCHES (cptr);                                    /* get more switches */
 
 while (*cptr != 0) {                                    /* do all mods */
-    cptr = get_glyph (cptr, gbuf, ',');                 /* get modifier */
+    cptr = get_glyph (svptr = cptr, gbuf, ',');         /* get modifier */
     if ((cvptr = strchr (gbuf, '=')))                   /* = value? */
         *cvptr++ = 0;
     for (mptr = dptr->modifiers; mptr && (mptr->mask != 0); mptr++) {
@@ -4169,6 +4333,11 @@ while (*cptr != 0) {                                    /* do all mods */
             )) {
             if (cvptr && !(mptr->mask & MTAB_SHP))
                 return SCPE_ARG;
+            if (cvptr && MODMASK(mptr,MTAB_NC)) {       /* value case sensitive? */
+                get_glyph_nc (svptr, gbuf, ',');
+                if ((cvptr = strchr (gbuf, '=')))
+                    *cvptr++ = 0;
+                }
             show_one_mod (ofile, dptr, uptr, mptr, cvptr, 1);
             break;
             }                                           /* end if */
@@ -4518,24 +4687,36 @@ t_stat show_queue (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST
 {
 DEVICE *dptr;
 UNIT *uptr;
-int32 accum;
+int32 accum, i;
+char gbuf[CBUFSIZE];
 
-if (cptr && (*cptr != 0))
-    return SCPE_2MARG;
+if (cptr && (*cptr != 0)) {
+    cptr = get_glyph (cptr, gbuf, 0);
+    if (*cptr != 0)
+        return SCPE_2MARG;
+    if (MATCH_CMD (gbuf, "STATISTICS") == 0)
+        return show_queue_stats (st);
+    return SCPE_ARG;
+    }
 if (sim_clock_queue == QUEUE_LIST_END)
     fprintf (st, "%s event queue empty, time = %.0f, executing %.0f instructios/sec\n",
              sim_name, sim_time, sim_timer_inst_per_sec ());
 else {
     fprintf (st, "%s event queue status, time = %.0f, executing %.0f instructions/sec\n",
              sim_name, sim_time, sim_timer_inst_per_sec ());
+    if (sim_queue_type == QUEUE_TYPE_HEAP)              /* heap? */
+        _sim_heap_sort ();                              /* present in time order */
     accum = 0;
-    for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next) {
+    for (uptr = sim_clock_queue, i = 0; uptr != QUEUE_LIST_END; ) {
         if (uptr == &sim_step_unit)
             fprintf (st, "  Step timer");
         else
             if (uptr == &sim_expect_unit)
                 fprintf (st, "  Expect fired");
             else
+                if (uptr == &sim_export_unit)
+                    fprintf (st, "  Front panel export");
+                else
                 if ((dptr = find_dev_from_unit (uptr)) != NULL) {
                     fprintf (st, "  %s", sim_dname (dptr));
                     if (dptr->numunits > 1)
@@ -4543,8 +4724,15 @@ else {
                     }
                 else
                     fprintf (st, "  Unknown");
-        fprintf (st, " at %d\n", accum + uptr->time);
-        accum = accum + uptr->time;
+        if (sim_queue_type == QUEUE_TYPE_HEAP) {
+            fprintf (st, " at %d\n", (int32)(uptr->q_due - sim_time));
+            uptr = (++i < sim_heap_cnt) ? sim_heap[i] : QUEUE_LIST_END;
+            }
+        else {
+            fprintf (st, " at %d\n", accum + uptr->time);
+            accum = accum + uptr->time;
+            uptr = uptr->next;
+            }
         }
     }
 sim_show_clock_queues (st, dnotused, unotused, flag, cptr);
@@ -5587,9 +5775,128 @@ sprintf (uname, "%s%d", sim_dname (d), (int)(uptr-d->units));
 return uname;
 }
 
+/* Memory dirty page tracking
+
+   sim_dirty_maps records, for each memory unit whose simulator keeps a
+   dirty page map, the map itself, the number of addresses it covers and
+   the unit capacity when the map was last cleared.  sim_save_base names
+   the file written by the last SAVE or read by the last RESTORE, which is
+   the base that an incremental SAVE -I records changes against.
+*/
+
+typedef struct {
+    UNIT        *uptr;                                  /* memory unit */
+    uint32      *map;                                   /* dirty page bitmap */
+    t_addr      size;                                   /* addresses covered */
+    t_addr      capac;                                  /* capacity at last clear */
+    } DIRTYMAP;
+
+static DIRTYMAP *sim_dirty_maps = NULL;
+static int32 sim_dirty_cnt = 0;
+static char *sim_save_base = NULL;
+
+/* Memory regions mapped from a save file by RESTORE -M
+
+   Pages of a mapped region which haven't been written still come from
+   the save file, so the regions are copied to private memory before
+   anything can rewrite that file.
+*/
+
+typedef struct {
+    void        *addr;                                  /* region start */
+    size_t      size;                                   /* region length */
+    } MAPPEDMEM;
+
+static MAPPEDMEM *sim_mapped_mem = NULL;
+static int32 sim_mapped_cnt = 0;
+
+static void sim_mapped_release (void)
+{
+int32 i;
+
+for (i = 0; i < sim_mapped_cnt; i++)
+    sim_fmap_release (sim_mapped_mem[i].addr, sim_mapped_mem[i].size);
+free (sim_mapped_mem);
+sim_mapped_mem = NULL;
+sim_mapped_cnt = 0;
+}
+
+static void sim_mapped_add (void *addr, size_t size)
+{
+MAPPEDMEM *mm = (MAPPEDMEM *)realloc (sim_mapped_mem, (sim_mapped_cnt + 1) * sizeof (*mm));
+
+if (mm == NULL) {                                       /* can't track it? */
+    sim_fmap_release (addr, size);                      /* then don't keep it */
+    return;
+    }
+sim_mapped_mem = mm;
+sim_mapped_mem[sim_mapped_cnt].addr = addr;
+sim_mapped_mem[sim_mapped_cnt].size = size;
+sim_mapped_cnt = sim_mapped_cnt + 1;
+}
+
+/* Register a dirty page map for a memory unit */
+
+t_stat sim_dirty_register (UNIT *uptr, uint32 *map, t_addr size)
+{
+int32 i;
+DIRTYMAP *dm;
+
+for (i = 0; i < sim_dirty_cnt; i++) {
+    if (sim_dirty_maps[i].uptr == uptr)
+        break;
+    }
+if (i == sim_dirty_cnt) {
+    dm = (DIRTYMAP *)realloc (sim_dirty_maps, (sim_dirty_cnt + 1) * sizeof (*dm));
+    if (dm == NULL)
+        return SCPE_MEM;
+    sim_dirty_maps = dm;
+    sim_dirty_cnt = sim_dirty_cnt + 1;
+    }
+sim_dirty_maps[i].uptr = uptr;
+sim_dirty_maps[i].map = map;
+sim_dirty_maps[i].size = size;
+sim_dirty_maps[i].capac = (t_addr)-1;                   /* no base yet */
+return SCPE_OK;
+}
+
+static DIRTYMAP *sim_dirty_find (UNIT *uptr)
+{
+int32 i;
+
+for (i = 0; i < sim_dirty_cnt; i++) {
+    if (sim_dirty_maps[i].uptr == uptr)
+        return &sim_dirty_maps[i];
+    }
+return NULL;
+}
+
+/* Mark the current memory contents as the base for SAVE -I */
+
+static void sim_dirty_clear (const char *base)
+{
+int32 i;
+DIRTYMAP *dm;
+
+for (i = 0; i < sim_dirty_cnt; i++) {
+    dm = &sim_dirty_maps[i];
+    memset (dm->map, 0, SIM_DIRTY_MAPSIZE (dm->size) * sizeof (*dm->map));
+    dm->capac = dm->uptr->capac;
+    }
+free (sim_save_base);
+sim_save_base = (char *)malloc (1 + strlen (base));
+if (sim_save_base)
+    strcpy (sim_save_base, base);
+}
+
 /* Save command
 
-   sa[ve] filename              save state to specified file
+   sa[ve] {-i|-m} filename      save state to specified file
+
+   The -I switch writes an incremental save which only records the memory
+   pages changed since the last SAVE or RESTORE, and refers to that file
+   as its base.  The -M switch stores memory described by a MEMDESC
+   uncompressed and page aligned, so RESTORE -M can map it.
 */
 
 t_stat save_cmd (int32 flag, CONST char *cptr)
@@ -5604,17 +5911,28 @@ if (*cptr == 0)                                         /* must be more */
 gbuf[sizeof(gbuf)-1] = '\0';
 strncpy (gbuf, cptr, sizeof(gbuf)-1);
 sim_trim_endspc (gbuf);
+if (sim_switches & SWMASK ('I')) {                      /* incremental? */
+    if (sim_save_base == NULL)
+        return sim_messagef (SCPE_ARG, "An incremental SAVE needs a prior SAVE or RESTORE as its base\n");
+    if (strcmp (gbuf, sim_save_base) == 0)
+        return sim_messagef (SCPE_ARG, "An incremental SAVE can't overwrite its base: %s\n", gbuf);
+    if (sim_switches & SWMASK ('M'))
+        return sim_messagef (SCPE_ARG, "SAVE -I and -M can't be combined\n");
+    }
+sim_mapped_release ();                                  /* stop using mapped files */
 if ((sfile = sim_fopen (gbuf, "wb")) == NULL)
     return SCPE_OPENERR;
 r = sim_save (sfile);
 fclose (sfile);
+if (r == SCPE_OK)
+    sim_dirty_clear (gbuf);                             /* new base */
 return r;
 }
 
 t_stat sim_save (FILE *sfile)
 {
 void *mbuf;
-int32 l, t;
+int32 l, t, skip, lim;
 uint32 i, j, device_count;
 t_addr k, high;
 t_value val;
@@ -5624,13 +5942,23 @@ size_t sz;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
+DIRTYMAP *dm;
+MEMDESC *mp;
+uint8 *mdata;
+t_bool incremental = ((sim_switches & SWMASK ('I')) != 0) && (sim_save_base != NULL);
+t_bool mappable = ((sim_switches & SWMASK ('M')) != 0) && !incremental;
 
 #define WRITE_I(xx) sim_fwrite (&(xx), sizeof (xx), 1, sfile)
 
 /* Don't make changes below without also changing save_vercur above */
 
-fprintf (sfile, "%s\n%s\n%s\n%s\n%s\n%.0f\n",
-    save_vercur,                                        /* [V2.5] save format */
+if (incremental)                                        /* [V4.0I] base file */
+    fprintf (sfile, "%s\n%s\n", save_ver40i, sim_save_base);
+else if (mappable)                                      /* [V4.0M] mappable memory */
+    fprintf (sfile, "%s\n", save_ver40m);
+else
+    fprintf (sfile, "%s\n", save_vercur);               /* [V2.5] save format */
+fprintf (sfile, "%s\n%s\n%s\n%s\n%.0f\n",
     sim_savename,                                       /* sim name */
     sim_si64, sim_sa64, eth_capabilities(),             /* [V3.5] options */
     sim_time);                                          /* [V3.2] sim time */
@@ -5693,27 +6021,92 @@ for (i = 0; i < (device_count + sim_internal_device_count); i++) {/* loop thru d
                 fclose (sfile);
                 return SCPE_MEM;
                 }
+            mp = dptr->memory;
+            if (mp && ((mp->unit != j) || (mp->width != sz) ||
+                (dptr->aincr != 1) || (high > mp->size)))
+                mp = NULL;                              /* can't save in bulk */
+            dm = (incremental) ? sim_dirty_find (uptr) : NULL;
+            if (dm && (dm->capac != high))              /* resized since base? */
+                dm = NULL;                              /* save it all */
+            skip = 0;
             for (k = 0; k < high; ) {                   /* loop thru mem */
-                zeroflg = TRUE;
-                for (l = 0; (l < SRBSIZ) && (k < high); l++,
-                     k = k + (dptr->aincr)) {           /* check for 0 block */
-                    r = dptr->examine (&val, k, uptr, SIM_SW_REST);
-                    if (r != SCPE_OK) {
-                        free (mbuf);
-                        return r;
+                if (mappable && mp && (k == mp->first)) {/* [V4.0M] raw memory? */
+                    int32 pad;
+
+                    mdata = (uint8 *)mp->base + k * sz;
+                    l = 0;
+                    WRITE_I (l);                        /* write raw marker */
+                    l = -(int32)(high - k);
+                    WRITE_I (l);                        /* and element count */
+                    pad = (int32)(((size_t)mdata - (size_t)(sim_ftell (sfile) + sizeof (pad))) &
+                                  (sim_fmap_pagesize () - 1));/* align file to memory pages */
+                    WRITE_I (pad);
+                    for (l = 0; l < pad; l++)
+                        fputc (0, sfile);
+                    sim_fwrite (mdata, sz, high - k, sfile);
+                    k = high;                           /* all done */
+                    continue;
+                    }
+                lim = SRBSIZ;                           /* block size limit */
+                if (dm) {                               /* [V4.0I] tracked? */
+                    t_addr pg = (k / dptr->aincr) >> SIM_DIRTY_V_PG;
+
+                    lim = (int32)(((pg + 1) << SIM_DIRTY_V_PG) -  /* stop at */
+                                  (k / dptr->aincr));   /* page boundary */
+                    if ((pg < (dm->size >> SIM_DIRTY_V_PG)) &&
+                        (!SIM_DIRTY_TEST (dm->map, pg))) {/* unchanged page? */
+                        l = lim;
+                        if ((t_addr)l > ((high - k + dptr->aincr - 1) / dptr->aincr))
+                            l = (int32)((high - k + dptr->aincr - 1) / dptr->aincr);
+                        skip = skip + l;                /* accumulate skip */
+                        k = k + l * dptr->aincr;
+                        continue;
                         }
-                    if (val) zeroflg = FALSE;
-                    SZ_STORE (sz, val, mbuf, l);
-                    }                                   /* end for l */
+                    if (skip) {                         /* end of skip run? */
+                        l = 0;
+                        WRITE_I (l);                    /* write skip marker */
+                        WRITE_I (skip);                 /* and skip count */
+                        skip = 0;
+                        }
+                    }
+                if (mp && (k >= mp->first)) {           /* bulk memory? */
+                    mdata = (uint8 *)mp->base + k * sz;
+                    l = lim;
+                    if ((t_addr)l > (high - k))
+                        l = (int32)(high - k);
+                    k = k + l;
+                    zeroflg = (mdata[0] == 0) &&        /* check for 0 block */
+                              (memcmp (mdata, mdata + 1, l * sz - 1) == 0);
+                    }
+                else {
+                    mdata = (uint8 *)mbuf;
+                    zeroflg = TRUE;
+                    for (l = 0; (l < lim) && (k < high) &&
+                         !(mp && (k == mp->first)); l++,
+                         k = k + (dptr->aincr)) {       /* check for 0 block */
+                        r = dptr->examine (&val, k, uptr, SIM_SW_REST);
+                        if (r != SCPE_OK) {
+                            free (mbuf);
+                            return r;
+                            }
+                        if (val) zeroflg = FALSE;
+                        SZ_STORE (sz, val, mbuf, l);
+                        }                               /* end for l */
+                    }
                 if (zeroflg) {                          /* all zero's? */
                     l = -l;                             /* invert block count */
                     WRITE_I (l);                        /* write only count */
                     }
                 else {
                     WRITE_I (l);                        /* block count */
-                    sim_fwrite (mbuf, sz, l, sfile);
+                    sim_fwrite (mdata, sz, l, sfile);
                     }
                 }                                       /* end for k */
+            if (skip) {                                 /* trailing skip run? */
+                l = 0;
+                WRITE_I (l);
+                WRITE_I (skip);
+                }
             free (mbuf);                                /* dealloc buffer */
             }                                           /* end if mem */
         else {                                          /* no memory */
@@ -5742,6 +6135,9 @@ return (ferror (sfile))? SCPE_IOERR: SCPE_OK;           /* error during save? */
 /* Restore command
 
    re[store] filename           restore state from specified file
+
+   An incremental save file is restored by first restoring its base and
+   then applying the recorded changes.
 */
 
 t_stat restore_cmd (int32 flag, CONST char *cptr)
@@ -5758,11 +6154,75 @@ strncpy (gbuf, cptr, sizeof(gbuf)-1);
 sim_trim_endspc (gbuf);
 if ((rfile = sim_fopen (gbuf, "rb")) == NULL)
     return SCPE_OPENERR;
+sim_mapped_release ();                                  /* drop prior mappings */
 r = sim_rest (rfile);
 fclose (rfile);
+if (r == SCPE_OK)
+    sim_dirty_clear (gbuf);                             /* new base */
 return r;
 }
 
+/* Restore a raw [V4.0M] memory run of cnt elements starting at address k.
+
+   Memory with a MEMDESC is mapped from the file when -M was given, the
+   host is little endian, and the file data lines up with the memory
+   pages.  Otherwise it is read, in bulk if possible.
+*/
+
+static t_stat sim_rest_raw (FILE *rfile, DEVICE *dptr, UNIT *uptr, t_addr k,
+                            int32 cnt, MEMDESC *mp, t_bool map_memory, void *mbuf)
+{
+int32 pad, l, j;
+size_t sz = SZ_D (dptr);
+t_value val;
+t_stat r;
+
+if ((sim_fread (&pad, sizeof (pad), 1, rfile) == 0) || (pad < 0) ||
+    (sim_fseeko (rfile, pad, SEEK_CUR) != 0))
+    return SCPE_IOERR;
+if (mp && (k >= mp->first)) {                           /* bulk memory? */
+    uint8 *mdata = (uint8 *)mp->base + k * sz;
+    size_t bytes = cnt * sz;
+    size_t pgsz = sim_fmap_pagesize ();
+    t_offset pos = sim_ftell (rfile);
+
+    if ((t_addr)cnt > (mp->size - k))
+        return SCPE_NXM;
+    if (map_memory && sim_end &&                        /* map it if possible */
+        ((((size_t)mdata ^ (size_t)pos) & (pgsz - 1)) == 0)) {
+        size_t head = (pgsz - ((size_t)mdata & (pgsz - 1))) & (pgsz - 1);
+        size_t span = (bytes > head) ? ((bytes - head) / pgsz) * pgsz : 0;
+
+        if (span &&
+            (sim_fread (mdata, 1, head, rfile) == head) &&
+            (sim_fmap_fixed (rfile, pos + head, mdata + head, span) == SCPE_OK)) {
+            sim_mapped_add (mdata + head, span);
+            if ((sim_fseeko (rfile, span, SEEK_CUR) != 0) ||
+                (sim_fread (mdata + head + span, 1, bytes - head - span, rfile) != bytes - head - span))
+                return SCPE_IOERR;
+            return SCPE_OK;
+            }
+        if (sim_fseeko (rfile, pos, SEEK_SET) != 0)     /* back to the start */
+            return SCPE_IOERR;
+        }
+    if (sim_fread (mdata, sz, cnt, rfile) != (size_t)cnt)
+        return SCPE_IOERR;
+    return SCPE_OK;
+    }
+for ( ; cnt > 0; cnt = cnt - l) {                       /* no descriptor */
+    l = (cnt > SRBSIZ) ? SRBSIZ : cnt;
+    if (sim_fread (mbuf, sz, l, rfile) != (size_t)l)
+        return SCPE_IOERR;
+    for (j = 0; j < l; j++, k = k + (dptr->aincr)) {
+        SZ_LOAD (sz, val, mbuf, j);
+        r = dptr->deposit (val, k, uptr, SIM_SW_REST);
+        if (r != SCPE_OK)
+            return r;
+        }
+    }
+return SCPE_OK;
+}
+
 t_stat sim_rest (FILE *rfile)
 {
 char buf[CBUFSIZE];
@@ -5777,17 +6237,20 @@ t_addr k, high, old_capac;
 t_value val, mask;
 t_stat r;
 size_t sz;
-t_bool v40, v35, v32;
+t_bool v40, v35, v32, v40i, v40m;
 DEVICE *dptr;
 UNIT *uptr;
 REG *rptr;
+MEMDESC *mp;
+uint8 *mdata;
 struct stat rstat;
 t_bool force_restore = ((sim_switches & SWMASK ('F')) != 0);
 t_bool dont_detach_attach = ((sim_switches & SWMASK ('D')) != 0);
 t_bool suppress_warning = ((sim_switches & SWMASK ('Q')) != 0);
+t_bool map_memory = ((sim_switches & SWMASK ('M')) != 0);
 t_bool warned = FALSE;
 
-sim_switches &= ~(SWMASK ('F') | SWMASK ('D') | SWMASK ('Q'));  /* remove digested switches */
+sim_switches &= ~(SWMASK ('F') | SWMASK ('D') | SWMASK ('Q') | SWMASK ('M'));  /* remove digested switches */
 #define READ_S(xx) if (read_line ((xx), sizeof(xx), rfile) == NULL) \
     return SCPE_IOERR;
 #define READ_I(xx) if (sim_fread (&xx, sizeof (xx), 1, rfile) == 0) \
@@ -5795,8 +6258,31 @@ sim_switches &= ~(SWMASK ('F') | SWMASK ('D') | SWMASK ('Q'));  /* remove digest
 
 fstat (fileno (rfile), &rstat);
 READ_S (buf);                                           /* [V2.5+] read version */
-v40 = v35 = v32 = FALSE;
-if (strcmp (buf, save_ver40) == 0)                      /* version 4.0? */
+v40 = v35 = v32 = v40i = v40m = FALSE;
+if (strcmp (buf, save_ver40i) == 0) {                   /* version 4.0 incremental? */
+    FILE *bfile;
+
+    v40i = v40 = v35 = v32 = TRUE;
+    READ_S (buf);                                       /* base file */
+    if ((bfile = sim_fopen (buf, "rb")) == NULL) {
+        sim_printf ("Can't open base save file: %s\n", buf);
+        return SCPE_OPENERR;
+        }
+    sim_switches = SWMASK ('F') |                       /* attach files are newer than the base */
+                   (suppress_warning ? SWMASK ('Q') : 0) |
+                   (dont_detach_attach ? SWMASK ('D') : 0) |
+                   (map_memory ? SWMASK ('M') : 0);
+    r = sim_rest (bfile);                               /* restore base */
+    fclose (bfile);
+    if (r != SCPE_OK)
+        return r;
+    strcpy (buf, save_ver40);
+    }
+else if (strcmp (buf, save_ver40m) == 0) {              /* version 4.0 mappable? */
+    v40m = v40 = v35 = v32 = TRUE;
+    strcpy (buf, save_ver40);
+    }
+else if (strcmp (buf, save_ver40) == 0)                 /* version 4.0? */
     v40 = v35 = v32 = TRUE;
 else if (strcmp (buf, save_ver35) == 0)                 /* version 3.5? */
     v35 = v32 = TRUE;
@@ -5964,11 +6450,49 @@ for ( ;; ) {                                            /* device loop */
             sz = SZ_D (dptr);                           /* allocate buffer */
             if ((mbuf = calloc (SRBSIZ, sz)) == NULL)
                 return SCPE_MEM;
+            mp = dptr->memory;
+            if (mp && (((uint32)unitno != mp->unit) || (mp->width != sz) ||
+                (dptr->aincr != 1) || (high > mp->size)))
+                mp = NULL;                              /* can't restore in bulk */
             for (k = 0; k < high; ) {                   /* loop thru mem */
                 if (sim_fread (&blkcnt, sizeof (blkcnt), 1, rfile) == 0) {/* block count */
                     free (mbuf);
                     return SCPE_IOERR;
                     }
+                if ((blkcnt == 0) && (v40i || v40m)) {  /* [V4.0I/M] extended record? */
+                    if ((sim_fread (&limit, sizeof (limit), 1, rfile) == 0) ||
+                        (limit == 0) || ((limit > 0) && !v40i) || ((limit < 0) && !v40m)) {
+                        free (mbuf);
+                        return SCPE_IOERR;
+                        }
+                    if (limit > 0) {                    /* unchanged since base? */
+                        k = k + limit * dptr->aincr;    /* skip it */
+                        continue;
+                        }
+                    r = sim_rest_raw (rfile, dptr, uptr, k, -limit, mp, map_memory, mbuf);
+                    if (r != SCPE_OK) {
+                        free (mbuf);
+                        return r;
+                        }
+                    k = k + (-limit) * dptr->aincr;
+                    continue;
+                    }
+                if (mp && (k >= mp->first)) {           /* bulk memory? */
+                    limit = (blkcnt < 0) ? -blkcnt : blkcnt;
+                    if ((limit <= 0) || ((t_addr)limit > (mp->size - k))) {
+                        free (mbuf);
+                        return SCPE_NXM;
+                        }
+                    mdata = (uint8 *)mp->base + k * sz;
+                    if (blkcnt < 0)                     /* compressed? */
+                        memset (mdata, 0, limit * sz);
+                    else if (sim_fread (mdata, sz, blkcnt, rfile) != (size_t)blkcnt) {
+                        free (mbuf);
+                        return SCPE_IOERR;
+                        }
+                    k = k + limit;
+                    continue;
+                    }
                 if (blkcnt < 0)                         /* compressed? */
                     limit = -blkcnt;
                 else limit = (int32)sim_fread (mbuf, sz, blkcnt, rfile);
@@ -6226,6 +6750,7 @@ if (sim_log)                                            /* flush log if enabled
 sim_throt_sched ();                                     /* set throttle */
 sim_rtcn_init_all ();                                   /* re-init clocks */
 sim_start_timer_services ();                            /* enable wall clock timing */
+sim_perf_run_start ();                                  /* start performance totals */
 
 do {
     t_addr *addrs;
@@ -6235,6 +6760,7 @@ do {
         if (r != SCPE_REMOTE)
             break;
         sim_remote_process_command ();                  /* Process the command and resume processing */
+        sim_export_update ();                           /* publish effects to front panel */
         }
     if ((flag != RU_NEXT) ||                            /* done if not doing NEXT */
         (--sim_next <=0))
@@ -6272,6 +6798,8 @@ do {
 
 sim_is_running = 0;                                     /* flag idle */
 sim_stop_timer_services ();                             /* disable wall clock timing */
+sim_perf_run_stop ();                                   /* update performance totals */
+sim_export_update ();                                   /* publish stopped state */
 sim_ttcmd ();                                           /* restore console */
 sim_brk_clrall (BRK_TYP_DYN_STEPOVER);                  /* cancel any step/over subroutine breakpoints */
 signal (SIGINT, SIG_DFL);                               /* cancel WRU */
@@ -6283,6 +6811,7 @@ if (sim_log)                                            /* flush console log */
     fflush (sim_log);
 if (sim_deb)                                            /* flush debug log */
     sim_debug_flush ();
+sim_hist_flush ();                                      /* flush history file */
 for (i = 1; (dptr = sim_devices[i]) != NULL; i++) {     /* flush attached files */
     for (j = 0; j < dptr->numunits; j++) {              /* if not buffered in mem */
         uptr = dptr->units + j;
@@ -6333,9 +6862,16 @@ sim_interval = 0;                                       /* reset queue */
 sim_time = sim_rtime = 0;
 noqueue_time = 0;
 for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = sim_clock_queue) {
-    sim_clock_queue = uptr->next;
-    uptr->next = NULL;
+    if (sim_queue_type == QUEUE_TYPE_HEAP) {
+        _sim_heap_remove (uptr);
+        sim_clock_queue = (sim_heap_cnt) ? sim_heap[0] : QUEUE_LIST_END;
+        }
+    else {
+        sim_clock_queue = uptr->next;
+        uptr->next = NULL;
+        }
     }
+sim_queue_depth = 0;
 return reset_all (0);
 }
 
@@ -6412,6 +6948,194 @@ t_stat expect_svc (UNIT *uptr)
 return SCPE_EXPECT | (sim_do_echo ? 0 : SCPE_NOMESSAGE);
 }
 
+/* Front panel shared memory export
+
+   SET EXPORT publishes a list of register values (and memory locations
+   addressed by registers) in a shared memory segment laid out as a
+   SIM_PANEL_SHMEM.  Updates are bracketed by increments of the sequence
+   word, so a front panel reading the segment sees an odd sequence while
+   an update is in progress and a changed sequence if one overlapped its
+   copy.  Only the simulator thread updates the segment.
+*/
+
+typedef struct {
+    DEVICE              *dptr;                          /* device */
+    REG                 *rptr;                          /* register */
+    uint32              idx;                            /* array index */
+    t_bool              indirect;                       /* export memory at register value */
+    } EXPORT_ITEM;
+
+static SHMEM *sim_export_shmem = NULL;                  /* export segment */
+static SIM_PANEL_SHMEM *sim_export = NULL;              /* mapped segment */
+static EXPORT_ITEM *sim_export_items = NULL;            /* exported values */
+static uint32 sim_export_count = 0;
+static uint32 sim_export_rate = 0;                      /* updates per second */
+static char sim_export_name[CBUFSIZE];                  /* segment name */
+
+void sim_export_update (void)
+{
+uint32 i;
+t_value val, mval;
+EXPORT_ITEM *ep;
+
+if (sim_export == NULL)
+    return;
+++sim_export->sequence;                                 /* odd: update in progress */
+SIM_PANEL_SHMEM_BARRIER ();
+for (i = 0, ep = sim_export_items; i < sim_export_count; i++, ep++) {
+    val = get_rval (ep->rptr, ep->idx);
+    if (ep->indirect) {
+        mval = 0;
+        if ((ep->dptr->examine == NULL) ||
+            (ep->dptr->examine (&mval, (t_addr)val, ep->dptr->units, 0) != SCPE_OK))
+            mval = 0;
+        val = mval;
+        }
+    sim_export->values[i] = (unsigned long long)val;
+    }
+sim_export->simulation_time = (unsigned long long)sim_gtime ();
+++sim_export->update_count;
+SIM_PANEL_SHMEM_BARRIER ();
+++sim_export->sequence;                                 /* even: snapshot consistent */
+}
+
+t_stat export_svc (UNIT *uptr)
+{
+sim_export_update ();
+if (sim_export_rate)
+    sim_activate_after (uptr, 1000000 / sim_export_rate);
+return SCPE_OK;
+}
+
+static void sim_export_close (void)
+{
+sim_cancel (&sim_export_unit);
+if (sim_export_shmem)
+    sim_shmem_close (sim_export_shmem);
+sim_export_shmem = NULL;
+sim_export = NULL;
+free (sim_export_items);
+sim_export_items = NULL;
+sim_export_count = 0;
+sim_export_rate = 0;
+sim_export_name[0] = '\0';
+}
+
+t_stat sim_set_export (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE], name[CBUFSIZE];
+char *rname, *c;
+CONST char *tptr;
+EXPORT_ITEM *items = NULL, *nitems;
+uint32 count = 0, rate, n, i;
+t_bool indirect;
+DEVICE *dptr;
+REG *rptr;
+void *addr;
+t_stat r;
+
+if (!flag) {                                            /* NOEXPORT */
+    if (cptr && (*cptr != 0))
+        return SCPE_2MARG;
+    sim_export_close ();
+    return SCPE_OK;
+    }
+if ((!cptr) || (*cptr == 0))
+    return SCPE_2FARG;
+cptr = get_glyph_nc (cptr, name, 0);                    /* segment name */
+cptr = get_glyph (cptr, gbuf, 0);                       /* update rate */
+if (gbuf[0] == 0)
+    return SCPE_2FARG;
+rate = (uint32) get_uint (gbuf, 10, 1000, &r);
+if ((r != SCPE_OK) || (rate == 0))
+    return sim_messagef (SCPE_ARG, "Invalid export rate: %s\n", gbuf);
+if (*cptr == 0)
+    return SCPE_2FARG;
+while (*cptr != 0) {                                    /* parse items */
+    cptr = get_glyph (cptr, gbuf, 0);
+    rname = gbuf;
+    indirect = (*rname == '@');
+    if (indirect)
+        ++rname;
+    dptr = sim_dflt_dev;
+    if ((c = strchr (rname, ':'))) {                    /* device specified? */
+        *c = '\0';
+        dptr = find_dev (rname);
+        if (dptr == NULL) {
+            free (items);
+            return sim_messagef (SCPE_NXDEV, "Non-existent device: %s\n", rname);
+            }
+        rname = c + 1;
+        }
+    n = 1;
+    if ((c = strchr (rname, '['))) {                    /* element count? */
+        *c++ = '\0';
+        n = (uint32) strtotv (c, &tptr, 10);
+        if ((n == 0) || (*tptr != ']') || (tptr[1] != 0) || (indirect && (n > 1))) {
+            free (items);
+            return sim_messagef (SCPE_ARG, "Invalid export item: %s\n", rname);
+            }
+        }
+    rptr = find_reg (rname, &tptr, dptr);
+    if ((rptr == NULL) || (*tptr != 0)) {
+        free (items);
+        return sim_messagef (SCPE_NXREG, "Non-existent register: %s %s\n", sim_dname (dptr), rname);
+        }
+    if (n > rptr->depth) {
+        free (items);
+        return SCPE_SUB;
+        }
+    nitems = (EXPORT_ITEM *)realloc (items, (count + n) * sizeof (*items));
+    if (nitems == NULL) {
+        free (items);
+        return SCPE_MEM;
+        }
+    items = nitems;
+    for (i = 0; i < n; i++) {
+        items[count + i].dptr = dptr;
+        items[count + i].rptr = rptr;
+        items[count + i].idx = i;
+        items[count + i].indirect = indirect;
+        }
+    count += n;
+    }
+sim_export_close ();                                    /* release any prior export */
+r = sim_shmem_open (name, SIM_PANEL_SHMEM_SIZE (count), &sim_export_shmem, &addr);
+if (r != SCPE_OK) {
+    free (items);
+    return sim_messagef (r, "Can't open shared memory segment: %s\n", name);
+    }
+sim_export = (SIM_PANEL_SHMEM *)addr;
+sim_export->magic = 0;
+sim_export->sequence = 0;
+sim_export->value_count = count;
+sim_export->reserved = 0;
+sim_export->update_count = 0;
+sim_export_items = items;
+sim_export_count = count;
+sim_export_rate = rate;
+strcpy (sim_export_name, name);
+sim_export_update ();
+SIM_PANEL_SHMEM_BARRIER ();
+sim_export->magic = SIM_PANEL_SHMEM_MAGIC;
+sim_activate_after (&sim_export_unit, 1000000 / rate);
+return SCPE_OK;
+}
+
+t_stat sim_show_export (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (cptr && (*cptr != 0))
+    return SCPE_2MARG;
+if (sim_export == NULL) {
+    fprintf (st, "No front panel export\n");
+    return SCPE_OK;
+    }
+fprintf (st, "Front panel export to %s: %u values, %u updates/sec, %" LL_FMT "u updates\n",
+         sim_export_name, (unsigned int)sim_export_count, (unsigned int)sim_export_rate,
+         (t_uint64)sim_export->update_count);
+return SCPE_OK;
+}
+
 /* Cancel scheduled step service */
 
 t_stat sim_cancel_step (void)
@@ -8235,14 +8959,19 @@ return schptr;
 
 int32 test_search (t_value *values, SCHTAB *schptr)
 {
-t_value *val = NULL;
+t_value vbuf[16];                                       /* usual case, no malloc */
+t_value *val = vbuf;
 int32 i, updown;
 int32 ret = 0;
 
 if (schptr == NULL)
     return ret;
 
-val = (t_value *)malloc (schptr->count * sizeof (*values));
+if (schptr->count > (sizeof (vbuf) / sizeof (vbuf[0]))) {
+    val = (t_value *)malloc (schptr->count * sizeof (*values));
+    if (val == NULL)
+        return ret;
+    }
 
 for (i=0; i<(int32)schptr->count; i++) {
     val[i] = values[i];
@@ -8280,7 +9009,7 @@ for (; (i>=0) && (i<(int32)schptr->count) && ret; i += updown) {
             break;
 
         case SCH_N: case SCH_NE:
-            if (val[i] != schptr->comp[i])
+            if (val[i] == schptr->comp[i])
                 ret = 0;
             break;
 
@@ -8305,7 +9034,8 @@ for (; (i>=0) && (i<(int32)schptr->count) && ret; i += updown) {
             break;
         }
     }
-free (val);
+if (val != vbuf)
+    free (val);
 return ret;
 }
 
@@ -8493,6 +9223,14 @@ return SCPE_OK;
    The event queue is maintained in clock order; entry timeouts are
    RELATIVE to the time in the previous entry.
 
+   Alternatively (SET QUEUE HEAP), the event queue is maintained as a
+   binary heap ordered by ABSOLUTE due time, with ties broken by order
+   of activation.  sim_clock_queue then always points at the earliest
+   entry (the heap root), whose time field is maintained exactly as it
+   is for the head of the list, and the next field of every queued unit
+   is QUEUE_LIST_END.  Activation and cancelation then cost O(log n)
+   rather than O(n) in the number of pending events.
+
    sim_process_event - process event
 
    Inputs:
@@ -8502,6 +9240,120 @@ return SCPE_OK;
                         or 0 (SCPE_OK) if no exceptions
 */
 
+/* Event heap support routines
+
+   _sim_heap_up         move an entry towards the root
+   _sim_heap_down       move an entry towards the leaves
+   _sim_heap_insert     add an entry with an absolute due time
+   _sim_heap_remove     remove an entry
+   _sim_heap_head       make sim_clock_queue and sim_interval reflect the root
+   _sim_heap_sort       sort the heap into time order (still a valid heap)
+*/
+
+#define HEAP_BEFORE(a,b) (((a)->q_due < (b)->q_due) || \
+                          (((a)->q_due == (b)->q_due) && ((a)->q_seq < (b)->q_seq)))
+
+static void _sim_heap_up (int32 i)
+{
+UNIT *uptr = sim_heap[i];
+int32 p;
+
+while (i > 0) {
+    p = (i - 1) / 2;
+    if (!HEAP_BEFORE (uptr, sim_heap[p]))
+        break;
+    sim_heap[i] = sim_heap[p];
+    sim_heap[i]->q_index = i;
+    i = p;
+    }
+sim_heap[i] = uptr;
+uptr->q_index = i;
+}
+
+static void _sim_heap_down (int32 i)
+{
+UNIT *uptr = sim_heap[i];
+int32 c;
+
+while ((c = 2 * i + 1) < sim_heap_cnt) {
+    if (((c + 1) < sim_heap_cnt) && HEAP_BEFORE (sim_heap[c + 1], sim_heap[c]))
+        c = c + 1;
+    if (!HEAP_BEFORE (sim_heap[c], uptr))
+        break;
+    sim_heap[i] = sim_heap[c];
+    sim_heap[i]->q_index = i;
+    i = c;
+    }
+sim_heap[i] = uptr;
+uptr->q_index = i;
+}
+
+static t_stat _sim_heap_insert (UNIT *uptr, double due)
+{
+if (sim_heap_cnt >= sim_heap_lnt) {                     /* need more room? */
+    int32 lnt = (sim_heap_lnt) ? 2 * sim_heap_lnt : 64;
+    UNIT **heap = (UNIT **)realloc (sim_heap, lnt * sizeof (*sim_heap));
+
+    if (heap == NULL)
+        return SCPE_MEM;
+    sim_heap = heap;
+    sim_heap_lnt = lnt;
+    }
+uptr->q_due = due;
+uptr->q_seq = sim_heap_seq++;
+uptr->next = QUEUE_LIST_END;                            /* mark active */
+sim_heap[sim_heap_cnt] = uptr;
+_sim_heap_up (sim_heap_cnt++);
+return SCPE_OK;
+}
+
+static void _sim_heap_remove (UNIT *uptr)
+{
+int32 i = uptr->q_index;
+UNIT *last = sim_heap[--sim_heap_cnt];
+
+uptr->next = NULL;                                      /* hygiene */
+uptr->time = 0;
+uptr->q_index = -1;
+if (i < sim_heap_cnt) {                                 /* fill hole with last */
+    sim_heap[i] = last;
+    last->q_index = i;
+    _sim_heap_up (i);
+    _sim_heap_down (last->q_index);
+    }
+}
+
+static void _sim_heap_head (void)
+{
+if (sim_heap_cnt == 0) {
+    sim_clock_queue = QUEUE_LIST_END;
+    sim_interval = noqueue_time = NOQUEUE_WAIT;
+    }
+else {
+    sim_clock_queue = sim_heap[0];
+    sim_interval = sim_clock_queue->time = (int32)(sim_clock_queue->q_due - sim_time);
+    }
+}
+
+static int _sim_heap_compare (const void *pa, const void *pb)
+{
+const UNIT *a = *((UNIT * const *)pa);
+const UNIT *b = *((UNIT * const *)pb);
+
+if (HEAP_BEFORE (a, b))
+    return -1;
+return (HEAP_BEFORE (b, a)) ? 1 : 0;
+}
+
+static void _sim_heap_sort (void)
+{
+int32 i;
+
+qsort (sim_heap, sim_heap_cnt, sizeof (*sim_heap), _sim_heap_compare);
+for (i = 0; i < sim_heap_cnt; i++)
+    sim_heap[i]->q_index = i;
+}
+
 t_stat sim_process_event (void)
 {
 UNIT *uptr;
@@ -8520,13 +9372,22 @@ if (sim_clock_queue == QUEUE_LIST_END) {                /* queue empty? */
 sim_processing_event = TRUE;
 do {
     uptr = sim_clock_queue;                             /* get first */
-    sim_clock_queue = uptr->next;                       /* remove first */
-    uptr->next = NULL;                                  /* hygiene */
-    uptr->time = 0;
-    if (sim_clock_queue != QUEUE_LIST_END)
-        sim_interval = sim_clock_queue->time;
-    else
-        sim_interval = noqueue_time = NOQUEUE_WAIT;
+    if (sim_queue_type == QUEUE_TYPE_HEAP) {
+        _sim_heap_remove (uptr);                        /* remove root */
+        _sim_heap_head ();
+        }
+    else {
+        sim_clock_queue = uptr->next;                   /* remove first */
+        uptr->next = NULL;                              /* hygiene */
+        uptr->time = 0;
+        if (sim_clock_queue != QUEUE_LIST_END)
+            sim_interval = sim_clock_queue->time;
+        else
+            sim_interval = noqueue_time = NOQUEUE_WAIT;
+        }
+    sim_queue_depth = sim_queue_depth - 1;
+    sim_queue_dispatches = sim_queue_dispatches + 1;
+    uptr->q_dispatches = uptr->q_dispatches + 1;
     sim_debug (SIM_DBG_EVENT, sim_dflt_dev, "Processing Event for %s\n", sim_uname (uptr));
     AIO_EVENT_BEGIN(uptr);
     if (uptr->action != NULL)
@@ -8568,9 +9429,6 @@ return _sim_activate (uptr, event_time);
 
 t_stat _sim_activate (UNIT *uptr, int32 event_time)
 {
-UNIT *cptr, *prvptr;
-int32 accum;
-
 AIO_ACTIVATE (_sim_activate, uptr, event_time);
 if (sim_is_active (uptr))                               /* already active? */
     return SCPE_OK;
@@ -8578,6 +9436,39 @@ UPDATE_SIM_TIME;                                        /* update sim time */
 
 sim_debug (SIM_DBG_ACTIVATE, sim_dflt_dev, "Activating %s delay=%d\n", sim_uname (uptr), event_time);
 
+return _sim_queue_insert (uptr, event_time);
+}
+
+/* _sim_queue_insert - insert an inactive unit on the event queue
+
+   Inputs:
+        uptr    =       pointer to unit
+        event_time =    relative timeout
+   Outputs:
+        reason  =       result (SCPE_OK if ok)
+
+   Sim time must already be up to date.
+*/
+
+static t_stat _sim_queue_insert (UNIT *uptr, int32 event_time)
+{
+UNIT *cptr, *prvptr;
+int32 accum;
+
+sim_queue_inserts = sim_queue_inserts + 1;
+sim_queue_depth_sum = sim_queue_depth_sum + sim_queue_depth;
+if (++sim_queue_depth > sim_queue_max_depth)
+    sim_queue_max_depth = sim_queue_depth;
+if (sim_queue_type == QUEUE_TYPE_HEAP) {
+    t_stat r = _sim_heap_insert (uptr, sim_time + event_time);
+
+    if (r != SCPE_OK) {
+        sim_queue_depth = sim_queue_depth - 1;
+        return r;
+        }
+    _sim_heap_head ();
+    return SCPE_OK;
+    }
 prvptr = NULL;
 accum = 0;
 for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
@@ -8697,17 +9588,30 @@ sim_debug (SIM_DBG_EVENT, sim_dflt_dev, "Canceling Event for %s\n", sim_uname(up
 UPDATE_SIM_TIME;                                        /* update sim time */
 if (!sim_is_active (uptr))
     return SCPE_OK;
+if (sim_queue_type == QUEUE_TYPE_HEAP) {
+    if (uptr->next == NULL)                             /* not on the heap? */
+        return SCPE_OK;
+    _sim_heap_remove (uptr);
+    _sim_heap_head ();
+    sim_queue_depth = sim_queue_depth - 1;
+    sim_queue_cancels = sim_queue_cancels + 1;
+    return SCPE_OK;
+    }
 nptr = QUEUE_LIST_END;
 
 if (sim_clock_queue == uptr) {
     nptr = sim_clock_queue = uptr->next;
     uptr->next = NULL;                                  /* hygiene */
+    sim_queue_depth = sim_queue_depth - 1;
+    sim_queue_cancels = sim_queue_cancels + 1;
     }
 else {
     for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
         if (cptr->next == uptr) {
             nptr = cptr->next = uptr->next;
             uptr->next = NULL;                          /* hygiene */
+            sim_queue_depth = sim_queue_depth - 1;
+            sim_queue_cancels = sim_queue_cancels + 1;
             break;                                      /* end queue scan */
             }
         }
@@ -8758,6 +9662,13 @@ int32 accum = 0;
 
 AIO_VALIDATE;
 AIO_RETURN_TIME(uptr);
+if (sim_queue_type == QUEUE_TYPE_HEAP) {
+    if (uptr->next == NULL)                             /* not on the heap? */
+        return 0;
+    if (sim_interval > 0)
+        accum = sim_interval;
+    return accum + (int32)(uptr->q_due - sim_clock_queue->q_due) + 1;
+    }
 for (cptr = sim_clock_queue; cptr != QUEUE_LIST_END; cptr = cptr->next) {
     if (cptr == sim_clock_queue) {
         if (sim_interval > 0)
@@ -8804,12 +9715,107 @@ int32 sim_qcount (void)
 int32 cnt;
 UNIT *uptr;
 
+if (sim_queue_type == QUEUE_TYPE_HEAP)
+    return sim_heap_cnt;
 cnt = 0;
 for (uptr = sim_clock_queue; uptr != QUEUE_LIST_END; uptr = uptr->next)
     cnt++;
 return cnt;
 }
 
+/* Set event queue organization
+
+   Pending events are removed in time order and requeued in the new
+   organization, so switching preserves both their due times and the
+   order of events due at the same time.
+*/
+
+t_stat sim_set_queue (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+int32 type, i, cnt;
+UNIT **pend, *uptr;
+int32 *delay;
+double inserts, depth_sum;
+t_stat r = SCPE_OK;
+
+if ((!cptr) || (*cptr == 0))
+    return SCPE_2FARG;
+cptr = get_glyph (cptr, gbuf, 0);
+if (*cptr != 0)
+    return SCPE_2MARG;
+if (MATCH_CMD (gbuf, "LIST") == 0)
+    type = QUEUE_TYPE_LIST;
+else if (MATCH_CMD (gbuf, "HEAP") == 0)
+    type = QUEUE_TYPE_HEAP;
+else
+    return sim_messagef (SCPE_ARG, "Unknown event queue organization: %s\n", gbuf);
+if (type == sim_queue_type)
+    return SCPE_OK;
+UPDATE_SIM_TIME;                                        /* update sim time */
+cnt = sim_qcount ();
+pend = (UNIT **)calloc (cnt + 1, sizeof (*pend));
+delay = (int32 *)calloc (cnt + 1, sizeof (*delay));
+if ((pend == NULL) || (delay == NULL)) {
+    free (pend);
+    free (delay);
+    return SCPE_MEM;
+    }
+if (sim_queue_type == QUEUE_TYPE_HEAP) {
+    _sim_heap_sort ();
+    for (i = 0; i < cnt; i++) {
+        pend[i] = sim_heap[i];
+        delay[i] = (int32)(sim_heap[i]->q_due - sim_time);
+        pend[i]->next = NULL;
+        pend[i]->time = 0;
+        }
+    sim_heap_cnt = 0;
+    }
+else {
+    int32 accum = 0;
+
+    for (i = 0, uptr = sim_clock_queue; uptr != QUEUE_LIST_END; i++) {
+        accum = accum + uptr->time;
+        pend[i] = uptr;
+        delay[i] = accum;
+        uptr = uptr->next;
+        pend[i]->next = NULL;
+        pend[i]->time = 0;
+        }
+    }
+sim_clock_queue = QUEUE_LIST_END;
+sim_interval = noqueue_time = NOQUEUE_WAIT;
+sim_queue_depth = 0;
+sim_queue_type = type;
+inserts = sim_queue_inserts;                            /* requeueing isn't activity */
+depth_sum = sim_queue_depth_sum;
+for (i = 0; i < cnt; i++) {                             /* requeue in time order */
+    if (_sim_queue_insert (pend[i], delay[i]) != SCPE_OK)
+        r = SCPE_MEM;
+    }
+sim_queue_inserts = inserts;
+sim_queue_depth_sum = depth_sum;
+free (pend);
+free (delay);
+return r;
+}
+
+/* Show event queue statistics */
+
+static t_stat show_queue_stats (FILE *st)
+{
+fprintf (st, "%s event queue statistics, organization: %s\n", sim_name,
+         (sim_queue_type == QUEUE_TYPE_HEAP) ? "heap" : "list");
+fprintf (st, "  Events activated:       %.0f\n", sim_queue_inserts);
+fprintf (st, "  Events dispatched:      %.0f\n", sim_queue_dispatches);
+fprintf (st, "  Events canceled:        %.0f\n", sim_queue_cancels);
+fprintf (st, "  Current queue depth:    %d\n", sim_queue_depth);
+fprintf (st, "  Maximum queue depth:    %d\n", sim_queue_max_depth);
+fprintf (st, "  Average queue depth:    %.2f\n",
+         (sim_queue_inserts > 0) ? sim_queue_depth_sum / sim_queue_inserts : 0.0);
+return SCPE_OK;
+}
+
 /* Breakpoint package.  This module replaces the VM-implemented one
    instruction breakpoint capability.
 
@@ -8827,6 +9833,14 @@ return cnt;
    is the bitwise OR of all the type fields).  A simulator need only check for
    a breakpoint of type X if bit SWMASK('X') is set in sim_brk_sum.
 
+   In addition to the table, a sparse bitmap records which addresses have any
+   breakpoint set.  The bitmap is organized as a directory of pages, each
+   covering SIM_BRK_PGSIZE addresses, with pages only allocated when they
+   contain a breakpoint.  sim_brk_test consults the bitmap first, so the
+   common case of no breakpoint at the tested address costs a couple of
+   loads rather than a binary search of the table.  Breakpoints at addresses
+   beyond the reach of the directory are found by searching the table.
+
    The package contains the following public routines:
 
         sim_brk_init            initialize
@@ -8843,6 +9857,76 @@ return cnt;
    Initialize breakpoint system.
 */
 
+#define SIM_BRK_V_PG    12                              /* page size, log2 */
+#define SIM_BRK_PGSIZE  (1u << SIM_BRK_V_PG)
+#define SIM_BRK_PGMASK  (SIM_BRK_PGSIZE - 1)
+#define SIM_BRK_MAXPG   65536                           /* directory size limit */
+
+typedef struct {
+    uint32      cnt;                                    /* addresses marked */
+    uint32      map[SIM_BRK_PGSIZE / 32];               /* address bitmap */
+    } BRKPG;
+
+static BRKPG **sim_brk_pg = NULL;                       /* page directory */
+static uint32 sim_brk_pg_lnt = 0;                       /* directory length */
+static int32 sim_brk_far = 0;                           /* bkpts beyond directory */
+
+/* Mark or unmark an address in the breakpoint bitmap */
+
+static void sim_brk_map (t_addr loc, t_bool set)
+{
+t_addr pg = loc >> SIM_BRK_V_PG;
+uint32 off = (uint32)(loc & SIM_BRK_PGMASK);
+uint32 bit = 1u << (off & 31);
+BRKPG *pp;
+
+if (pg >= SIM_BRK_MAXPG) {                              /* out of reach? */
+    sim_brk_far += (set) ? 1 : -1;
+    return;
+    }
+if (pg >= sim_brk_pg_lnt) {                             /* directory too short? */
+    uint32 i, lnt;
+    BRKPG **dir;
+
+    if (!set)
+        return;
+    for (lnt = (sim_brk_pg_lnt) ? sim_brk_pg_lnt : 16; lnt <= pg; lnt = lnt * 2) ;
+    dir = (BRKPG **) realloc (sim_brk_pg, lnt * sizeof (*dir));
+    if (dir == NULL) {                                  /* can't extend? */
+        sim_brk_far += 1;                               /* search table instead */
+        return;
+        }
+    for (i = sim_brk_pg_lnt; i < lnt; i++)
+        dir[i] = NULL;
+    sim_brk_pg = dir;
+    sim_brk_pg_lnt = lnt;
+    }
+pp = sim_brk_pg[pg];
+if (set) {
+    if (pp == NULL) {
+        pp = (BRKPG *) calloc (1, sizeof (*pp));
+        if (pp == NULL) {                               /* no memory? */
+            sim_brk_far += 1;                           /* search table instead */
+            return;
+            }
+        sim_brk_pg[pg] = pp;
+        }
+    if ((pp->map[off >> 5] & bit) == 0) {
+        pp->map[off >> 5] |= bit;
+        pp->cnt = pp->cnt + 1;
+        }
+    }
+else {
+    if ((pp == NULL) || ((pp->map[off >> 5] & bit) == 0))
+        return;
+    pp->map[off >> 5] &= ~bit;
+    if (--pp->cnt == 0) {                               /* page now empty? */
+        free (pp);
+        sim_brk_pg[pg] = NULL;
+        }
+    }
+}
+
 t_stat sim_brk_init (void)
 {
 sim_brk_lnt = SIM_BRK_INILNT;
@@ -8914,6 +9998,7 @@ bp->typ = 0;
 bp->cnt = 0;
 bp->act = NULL;
 sim_brk_ent = sim_brk_ent + 1;
+sim_brk_map (loc, TRUE);                                /* mark in bitmap */
 return bp;
 }
 
@@ -8969,6 +10054,7 @@ if (bp->act != NULL)                                    /* deallocate action */
 for ( ; bp < (sim_brk_tab + sim_brk_ent - 1); bp++)     /* erase entry */
     *bp = *(bp + 1);
 sim_brk_ent = sim_brk_ent - 1;                          /* decrement count */
+sim_brk_map (loc, FALSE);                               /* unmark in bitmap */
 sim_brk_summ = 0;                                       /* recalc summary */
 for (bp = sim_brk_tab; bp < (sim_brk_tab + sim_brk_ent); bp++)
     sim_brk_summ = sim_brk_summ | bp->typ;
@@ -9060,7 +10146,15 @@ uint32 sim_brk_test (t_addr loc, uint32 btyp)
 {
 BRKTAB *bp;
 uint32 spc = (btyp >> SIM_BKPT_V_SPC) & (SIM_BKPT_N_SPC - 1);
+t_addr pg = loc >> SIM_BRK_V_PG;
 
+if ((pg < sim_brk_pg_lnt) ?                             /* bitmap says no break? */
+    ((sim_brk_pg[pg] == NULL) ||
+     ((sim_brk_pg[pg]->map[(loc & SIM_BRK_PGMASK) >> 5] & (1u << (loc & 31))) == 0)) :
+    (sim_brk_far == 0)) {
+    sim_brk_pend[spc] = FALSE;
+    return 0;
+    }
 if (sim_brk_summ & BRK_TYP_DYN_ALL)
     btyp |= BRK_TYP_DYN_ALL;
 
@@ -9195,6 +10289,149 @@ memset (exp, 0, sizeof(*exp));
 return SCPE_OK;
 }
 
+/* Compiled expect rules
+
+   The literal rules of a context are built into a single Aho-Corasick
+   automaton.  Each state records the first (lowest numbered) literal rule
+   which ends there, so checking an output character costs one table
+   lookup no matter how many rules are active.  The regular expression
+   rules are joined into one alternation which is evaluated first; only
+   when it matches are the individual expressions evaluated (in rule order)
+   to find the rule that matched and to extract its sub matches.
+
+   The compiled form is discarded whenever a rule is added or removed and
+   is rebuilt on the next character checked, replaying the data already
+   in the match buffer.
+*/
+
+static void sim_exp_uncompile (EXPECT *exp)
+{
+free (exp->ac_goto);
+exp->ac_goto = NULL;
+free (exp->ac_rule);
+exp->ac_rule = NULL;
+exp->ac_states = 0;
+exp->ac_state = 0;
+exp->regex_rules = 0;
+#if defined(USE_REGEX)
+if (exp->regex_ok)
+    regfree (&exp->regex);
+exp->regex_ok = FALSE;
+#endif
+}
+
+static t_stat sim_exp_compile (EXPECT *exp)
+{
+int32 i, c, r, st, states = 1, next, head, tail;
+int32 *fail, *queue;
+uint32 j;
+EXPTAB *ep;
+
+sim_exp_uncompile (exp);
+for (i = 0; i < exp->size; i++) {                       /* size the automaton */
+    if (exp->rules[i].switches & EXP_TYP_REGEX)
+        exp->regex_rules += 1;
+    else
+        states += exp->rules[i].size;
+    }
+exp->ac_goto = (int32 *)malloc (states * 256 * sizeof (*exp->ac_goto));
+exp->ac_rule = (int32 *)malloc (states * sizeof (*exp->ac_rule));
+fail = (int32 *)calloc (states, sizeof (*fail));
+queue = (int32 *)malloc (states * sizeof (*queue));
+if ((exp->ac_goto == NULL) || (exp->ac_rule == NULL) ||
+    (fail == NULL) || (queue == NULL)) {
+    free (fail);
+    free (queue);
+    sim_exp_uncompile (exp);
+    return SCPE_MEM;
+    }
+for (st = 0; st < states * 256; st++)
+    exp->ac_goto[st] = -1;
+for (st = 0; st < states; st++)
+    exp->ac_rule[st] = -1;
+next = 1;
+for (i = 0; i < exp->size; i++) {                       /* build the trie */
+    ep = &exp->rules[i];
+    if (ep->switches & EXP_TYP_REGEX)
+        continue;
+    for (j = 0, st = 0; j < ep->size; j++) {
+        c = ep->match[j];
+        if (exp->ac_goto[st * 256 + c] < 0)
+            exp->ac_goto[st * 256 + c] = next++;
+        st = exp->ac_goto[st * 256 + c];
+        }
+    if (exp->ac_rule[st] < 0)                           /* earlier rule wins */
+        exp->ac_rule[st] = i;
+    }
+head = tail = 0;
+for (c = 0; c < 256; c++) {                             /* depth 1 fails to root */
+    st = exp->ac_goto[c];
+    if (st < 0)
+        exp->ac_goto[c] = 0;
+    else {
+        fail[st] = 0;
+        queue[tail++] = st;
+        }
+    }
+while (head < tail) {                                   /* breadth first */
+    r = queue[head++];
+    if ((exp->ac_rule[fail[r]] >= 0) &&                 /* inherit suffix match */
+        ((exp->ac_rule[r] < 0) || (exp->ac_rule[fail[r]] < exp->ac_rule[r])))
+        exp->ac_rule[r] = exp->ac_rule[fail[r]];
+    for (c = 0; c < 256; c++) {
+        st = exp->ac_goto[r * 256 + c];
+        if (st < 0)
+            exp->ac_goto[r * 256 + c] = exp->ac_goto[fail[r] * 256 + c];
+        else {
+            fail[st] = exp->ac_goto[fail[r] * 256 + c];
+            queue[tail++] = st;
+            }
+        }
+    }
+free (fail);
+free (queue);
+exp->ac_states = states;
+#if defined(USE_REGEX)
+if (exp->regex_rules) {                                 /* combine expressions */
+    size_t len = 1;
+    char *pattern;
+
+    for (i = 0; i < exp->size; i++) {
+        if (exp->rules[i].switches & EXP_TYP_REGEX)
+            len += strlen (exp->rules[i].match_pattern) + 1;
+        }
+    pattern = (char *)calloc (len, 1);
+    if (pattern) {
+        exp->regex_ok = TRUE;
+        for (i = 0; i < exp->size; i++) {
+            const char *mp = exp->rules[i].match_pattern;
+            size_t mlen = strlen (mp) - 2;              /* without surrounding quotes */
+            size_t k;
+
+            if (!(exp->rules[i].switches & EXP_TYP_REGEX))
+                continue;
+            for (k = 1; k <= mlen; k++)                 /* back references would be */
+                if ((mp[k] == '\\') && sim_isdigit (mp[k + 1]))/* renumbered when combined */
+                    exp->regex_ok = FALSE;
+            if (*pattern)
+                strcat (pattern, "|");
+            strcat (pattern, "(");
+            strncat (pattern, mp + 1, mlen);
+            strcat (pattern, ")");
+            }
+        if (exp->regex_ok &&
+            regcomp (&exp->regex, pattern, REG_EXTENDED | REG_NOSUB))
+            exp->regex_ok = FALSE;
+        free (pattern);
+        }
+    }
+#endif
+for (j = 0; j < exp->buf_ins; j++)                      /* catch up with buffered data */
+    exp->ac_state = exp->ac_goto[exp->ac_state * 256 + exp->buf[j]];
+exp->compiles += 1;
+return SCPE_OK;
+}
+
 /* Set expect */
 
 t_stat sim_set_expect (EXPECT *exp, CONST char *cptr)
@@ -9275,6 +10512,7 @@ free (ep->act);                                         /* deallocate action */
 if (ep->switches & EXP_TYP_REGEX)
     regfree (&ep->regex);                               /* release compiled regex */
 #endif
+sim_exp_uncompile (exp);                                /* rules changing */
 exp->size -= 1;                                         /* decrement count */
 for (i=ep-exp->rules; i<exp->size; i++)                 /* shuffle up remaining rules */
     exp->rules[i] = exp->rules[i+1];
@@ -9300,7 +10538,12 @@ for (i=0; i<exp->size; i++) {
     free (exp->rules[i].match);                         /* deallocate match string */
     free (exp->rules[i].match_pattern);                 /* deallocate display format match string */
     free (exp->rules[i].act);                           /* deallocate action */
+#if defined(USE_REGEX)
+    if (exp->rules[i].switches & EXP_TYP_REGEX)
+        regfree (&exp->rules[i].regex);                 /* release compiled regex */
+#endif
     }
+sim_exp_uncompile (exp);
 free (exp->rules);
 exp->rules = NULL;
 exp->size = 0;
@@ -9368,6 +10611,7 @@ if (ep)                                                 /* no, allocate */
     sim_exp_clr_tab (exp, ep);                          /* clear it */
 if (after && exp->size)
     return sim_messagef (SCPE_ARG, "Multiple concurrent EXPECT rules aren't valid when a HALTAFTER parameter is non-zero\n");
+sim_exp_uncompile (exp);                                /* rules changing */
 exp->rules = (EXPTAB *) realloc (exp->rules, sizeof (*exp->rules)*(exp->size + 1));
 ep = &exp->rules[exp->size];
 exp->size += 1;
@@ -9458,6 +10702,14 @@ if (exp->buf_size) {
     fprintf (st, "Buffer Contents: %s\n", bstr);
     free (bstr);
     }
+if (exp->chars) {
+    fprintf (st, "Characters Checked: %.0f\n", exp->chars);
+    fprintf (st, "Rules Matched: %.0f\n", exp->matches);
+    fprintf (st, "RegEx Evaluations: %.0f\n", exp->regex_execs);
+    fprintf (st, "Rule Compilations: %.0f\n", exp->compiles);
+    if (exp->ac_states)
+        fprintf (st, "Literal Match States: %d\n", exp->ac_states);
+    }
 if (exp->after)
     fprintf (st, "Halt After: %d instructions\n", exp->after);
 if (exp->dptr && exp->dbit)
@@ -9486,121 +10738,89 @@ t_stat sim_exp_check (EXPECT *exp, uint8 data)
 {
 int32 i;
 EXPTAB *ep;
-int regex_checks = 0;
 char *tstr = NULL;
 
 if ((!exp) || (!exp->rules))                            /* Anying to check? */
     return SCPE_OK;
+if ((exp->ac_states == 0) &&                            /* rules changed? */
+    (sim_exp_compile (exp) != SCPE_OK))
+    return SCPE_MEM;
 
 exp->buf[exp->buf_ins++] = data;                        /* Save new data */
 exp->buf[exp->buf_ins] = '\0';                          /* Nul terminate for RegEx match */
+exp->chars += 1;
 
-for (i=0; i < exp->size; i++) {
-    ep = &exp->rules[i];
-    if (ep->switches & EXP_TYP_REGEX) {
-#if defined (USE_REGEX)
-        regmatch_t *matches;
-        char *cbuf = (char *)exp->buf;
-        static size_t sim_exp_match_sub_count = 0;
+exp->ac_state = exp->ac_goto[exp->ac_state * 256 + data];/* step literal automaton */
+i = exp->ac_rule[exp->ac_state];                        /* first literal rule matched */
+if (i < 0)
+    i = exp->size;
+if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
+    char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
 
-        if (tstr)
-            cbuf = tstr;
-        else {
-            if (strlen ((char *)exp->buf) != exp->buf_ins) { /* Nul characters in buffer? */
-                size_t off;
-                tstr = (char *)malloc (exp->buf_ins + 1);
-
-                tstr[0] = '\0';
-                for (off=0; off < exp->buf_ins; off += 1 + strlen ((char *)&exp->buf[off]))
-                    strcpy (&tstr[strlen (tstr)], (char *)&exp->buf[off]);
-                cbuf = tstr;
-                }
-            }
-        ++regex_checks;
-        matches = (regmatch_t *)calloc ((ep->regex.re_nsub + 1), sizeof(*matches));
-        if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-            char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
-            sim_debug (exp->dbit, exp->dptr, "Checking String: %s\n", estr);
+    sim_debug (exp->dbit, exp->dptr, "Checking String: %s\n", estr);
+    if (i != exp->size)
+        sim_debug (exp->dbit, exp->dptr, "Matches Literal Rule: %s\n", exp->rules[i].match_pattern);
+    free (estr);
+    }
+#if defined (USE_REGEX)
+if (exp->regex_rules) {
+    char *cbuf = (char *)exp->buf;
+    static size_t sim_exp_match_sub_count = 0;
+    int32 r;
+
+    if (strlen ((char *)exp->buf) != exp->buf_ins) {    /* Nul characters in buffer? */
+        size_t off;
+        tstr = (char *)malloc (exp->buf_ins + 1);
+
+        tstr[0] = '\0';
+        for (off=0; off < exp->buf_ins; off += 1 + strlen ((char *)&exp->buf[off]))
+            strcpy (&tstr[strlen (tstr)], (char *)&exp->buf[off]);
+        cbuf = tstr;
+        }
+    exp->regex_execs += 1;
+    if ((!exp->regex_ok) ||                             /* any expression match? */
+        (!regexec (&exp->regex, cbuf, 0, NULL, REG_NOTBOL))) {
+        for (r = 0; r < i; r++) {                       /* find the first one */
+            regmatch_t *matches;
+
+            ep = &exp->rules[r];
+            if (!(ep->switches & EXP_TYP_REGEX))
+                continue;
+            exp->regex_execs += 1;
+            matches = (regmatch_t *)calloc ((ep->regex.re_nsub + 1), sizeof(*matches));
             sim_debug (exp->dbit, exp->dptr, "Against RegEx Match Rule: %s\n", ep->match_pattern);
-            free (estr);
-            }
-        if (!regexec (&ep->regex, cbuf, ep->regex.re_nsub + 1, matches, REG_NOTBOL)) {
-            size_t j;
-            char *buf = (char *)malloc (1 + exp->buf_ins);
-
-            for (j=0; j<ep->regex.re_nsub + 1; j++) {
-                char env_name[32];
-
-                sprintf (env_name, "_EXPECT_MATCH_GROUP_%d", (int)j);
-                memcpy (buf, &cbuf[matches[j].rm_so], matches[j].rm_eo-matches[j].rm_so);
-                buf[matches[j].rm_eo-matches[j].rm_so] = '\0';
-                setenv (env_name, buf, 1);      /* Make the match and substrings available as environment variables */
-                sim_debug (exp->dbit, exp->dptr, "%s=%s\n", env_name, buf);
-                }
-            for (; j<sim_exp_match_sub_count; j++) {
-                char env_name[32];
+            if (!regexec (&ep->regex, cbuf, ep->regex.re_nsub + 1, matches, REG_NOTBOL)) {
+                size_t j;
+                char *buf = (char *)malloc (1 + exp->buf_ins);
+
+                for (j=0; j<ep->regex.re_nsub + 1; j++) {
+                    char env_name[32];
+
+                    sprintf (env_name, "_EXPECT_MATCH_GROUP_%d", (int)j);
+                    memcpy (buf, &cbuf[matches[j].rm_so], matches[j].rm_eo-matches[j].rm_so);
+                    buf[matches[j].rm_eo-matches[j].rm_so] = '\0';
+                    setenv (env_name, buf, 1);          /* Make the match and substrings available as environment variables */
+                    sim_debug (exp->dbit, exp->dptr, "%s=%s\n", env_name, buf);
+                    }
+                for (; j<sim_exp_match_sub_count; j++) {
+                    char env_name[32];
 
-                sprintf (env_name, "_EXPECT_MATCH_GROUP_%d", (int)j);
-                setenv (env_name, "", 1);      /* Remove previous extra environment variables */
-                }
-            sim_exp_match_sub_count = ep->regex.re_nsub;
-            free (matches);
-            free (buf);
-            break;
-            }
-        free (matches);
-#endif
-        }
-    else {
-        if (exp->buf_ins < ep->size) {                          /* Match stradle end of buffer */
-            /* 
-             * First compare the newly deposited data at the beginning 
-             * of buffer with the end of the match string
-             */
-            if (exp->buf_ins) {
-                if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                    char *estr = sim_encode_quoted_string (exp->buf, exp->buf_ins);
-                    char *mstr = sim_encode_quoted_string (&ep->match[ep->size-exp->buf_ins], exp->buf_ins);
-
-                    sim_debug (exp->dbit, exp->dptr, "Checking String[0:%d]: %s\n", exp->buf_ins, estr);
-                    sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                    free (estr);
-                    free (mstr);
+                    sprintf (env_name, "_EXPECT_MATCH_GROUP_%d", (int)j);
+                    setenv (env_name, "", 1);           /* Remove previous extra environment variables */
                     }
-                if (memcmp (exp->buf, &ep->match[ep->size-exp->buf_ins], exp->buf_ins))
-                    continue;
-                }
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->size-exp->buf_ins);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size-exp->buf_ins);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_size-(ep->size-exp->buf_ins), ep->size-exp->buf_ins, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
-                }
-            if (memcmp (&exp->buf[exp->buf_size-(ep->size-exp->buf_ins)], ep->match, ep->size-exp->buf_ins))
-                continue;
-            break;
-            }
-        else {
-            if (sim_deb && exp->dptr && (exp->dptr->dctrl & exp->dbit)) {
-                char *estr = sim_encode_quoted_string (&exp->buf[exp->buf_ins-ep->size], ep->size);
-                char *mstr = sim_encode_quoted_string (ep->match, ep->size);
-
-                sim_debug (exp->dbit, exp->dptr, "Checking String[%d:%d]: %s\n", exp->buf_ins-ep->size, ep->size, estr);
-                sim_debug (exp->dbit, exp->dptr, "Against Match Data: %s\n", mstr);
-                free (estr);
-                free (mstr);
+                sim_exp_match_sub_count = ep->regex.re_nsub;
+                free (matches);
+                free (buf);
+                i = r;
+                break;
                 }
-            if (memcmp (&exp->buf[exp->buf_ins-ep->size], ep->match, ep->size))
-                continue;
-            break;
+            free (matches);
             }
         }
     }
+#endif
 if (exp->buf_ins == exp->buf_size) {                    /* At end of match buffer? */
-    if (regex_checks) {
+    if (exp->regex_rules) {
         /* When processing regular expressions, let the match buffer fill 
            up and then shuffle the buffer contents down by half the buffer size
            so that the regular expression has a single contiguous buffer to 
@@ -9616,6 +10836,8 @@ if (exp->buf_ins == exp->buf_size) {                    /* At end of match buffe
         }
     }
 if (i != exp->size) {                                   /* Found? */
+    ep = &exp->rules[i];
+    exp->matches += 1;
     sim_debug (exp->dbit, exp->dptr, "Matched expect pattern: %s\n", ep->match_pattern);
     setenv ("_EXPECT_MATCH_PATTERN", ep->match_pattern, 1);   /* Make the match detail available as an environment variable */
     if (ep->cnt > 0) {
@@ -9644,6 +10866,7 @@ if (i != exp->size) {                                   /* Found? */
         }
     /* Matched data is no longer available for future matching */
     exp->buf_ins = 0;
+    exp->ac_state = 0;
     }
 free (tstr);
 return SCPE_OK;
@@ -9805,18 +11028,41 @@ while (dptr->debflags[offset].name && (offset < 32)) {
 return some_match ? some_match : debtab_nomatch;
 }
 
-/* Prints standard debug prefix unless previous call unterminated */
+/* Captures the time of day and PC values which the debug prefix may show */
 
-static const char *sim_debug_prefix (uint32 dbits, DEVICE* dptr)
+static void _sim_debug_stamp (struct timespec *time_now, t_value *pc)
+{
+if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A')))
+    clock_gettime(CLOCK_REALTIME, time_now);
+else
+    memset (time_now, 0, sizeof (*time_now));
+*pc = 0;
+if (sim_deb_switches & SWMASK ('P')) {
+    /* Some simulators expose the PC as a register, some don't expose it or expose a register 
+       which is not a variable which is updated during instruction execution (i.e. only upon
+       exit of sim_instr()).  For the -P debug option to be effective, such a simulator should
+       provide a routine which returns the value of the current PC and set the sim_vm_pc_value
+       routine pointer to that routine.
+     */
+    if (sim_vm_pc_value)
+        *pc = (*sim_vm_pc_value)();
+    else
+        *pc = get_rval (sim_PC, 0);
+    }
+}
+
+/* Formats a standard debug prefix from captured values */
+
+static const char *_sim_debug_prefix_fmt (char *buf, uint32 dbits, DEVICE* dptr,
+                                          struct timespec time_now, double gtime,
+                                          t_value val, t_bool aux_thread)
 {
 const char* debug_type = get_dbg_verb (dbits, dptr);
 char tim_t[32] = "";
 char tim_a[32] = "";
 char pc_s[64] = "";
-struct timespec time_now;
 
 if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
-    clock_gettime(CLOCK_REALTIME, &time_now);
     if (sim_deb_switches & SWMASK ('R'))
         sim_timespec_diff (&time_now, &time_now, &sim_deb_basetime);
     if (sim_deb_switches & SWMASK ('T')) {
@@ -9830,23 +11076,731 @@ if (sim_deb_switches & (SWMASK ('T') | SWMASK ('R') | SWMASK ('A'))) {
         }
     }
 if (sim_deb_switches & SWMASK ('P')) {
-    t_value val;
-    
-    /* Some simulators expose the PC as a register, some don't expose it or expose a register 
-       which is not a variable which is updated during instruction execution (i.e. only upon
-       exit of sim_instr()).  For the -P debug option to be effective, such a simulator should
-       provide a routine which returns the value of the current PC and set the sim_vm_pc_value
-       routine pointer to that routine.
-     */
-    if (sim_vm_pc_value)
-        val = (*sim_vm_pc_value)();
-    else
-        val = get_rval (sim_PC, 0);
     sprintf(pc_s, "-%s:", sim_PC->name);
     sprint_val (&pc_s[strlen(pc_s)], val, sim_PC->radix, sim_PC->width, sim_PC->flags & REG_FMT);
     }
-sprintf(debug_line_prefix, "DBG(%s%s%.0f%s)%s> %s %s: ", tim_t, tim_a, sim_gtime(), pc_s, AIO_MAIN_THREAD ? "" : "+", dptr->name, debug_type);
-return debug_line_prefix;
+sprintf(buf, "DBG(%s%s%.0f%s)%s> %s %s: ", tim_t, tim_a, gtime, pc_s, aux_thread ? "+" : "", dptr->name, debug_type);
+return buf;
+}
+
+/* Prints standard debug prefix unless previous call unterminated */
+
+static const char *sim_debug_prefix (uint32 dbits, DEVICE* dptr)
+{
+struct timespec time_now;
+t_value val;
+
+_sim_debug_stamp (&time_now, &val);
+return _sim_debug_prefix_fmt (debug_line_prefix, dbits, dptr, time_now, sim_gtime(), val, !AIO_MAIN_THREAD);
+}
+
+/* Debug trace ring
+
+   With SET DEBUG -B, _sim_debug doesn't write to the debug file itself.
+   It still formats each message, but then splits it into fixed size
+   records which also carry the values needed to build the message
+   prefix.  The records go into a lock free ring and a writer thread
+   formats the prefixes and writes the records to the debug file.  A
+   thread adding records never waits: when the ring is full the record is
+   dropped and counted, and the writer notes the number of dropped
+   records in the debug file.
+
+   Each slot holds a sequence number which tells whether it is free for
+   the producer at a given ring position or filled for the consumer at
+   that position (the bounded queue design described by Dmitry Vyukov),
+   so any number of threads can add records concurrently.  Other output
+   written directly to the debug file (sim_debug_bits, for instance) is
+   not ordered with respect to ring records until the ring is drained,
+   which happens whenever the simulator stops.
+*/
+
+#if defined(SIM_ASYNCH_IO) && (defined(_WIN32) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4))
+#define SIM_DEBUG_RING 1
+
+#if defined(_WIN32)
+#define DEBRING_CAS(ptr, old, new) (InterlockedCompareExchange ((volatile LONG *)(ptr), (LONG)(new), (LONG)(old)) == (LONG)(old))
+#define DEBRING_INC(ptr) InterlockedIncrement ((volatile LONG *)(ptr))
+#define DEBRING_BARRIER() MemoryBarrier ()
+#else
+#define DEBRING_CAS(ptr, old, new) __sync_bool_compare_and_swap (ptr, old, new)
+#define DEBRING_INC(ptr) __sync_fetch_and_add (ptr, 1)
+#define DEBRING_BARRIER() __sync_synchronize ()
+#endif
+
+#define DEBRING_TEXT    192                             /* text bytes per record */
+#define DEBRING_DFLT    16384                           /* default ring records */
+
+#define DEBREC_PREFIX   1                               /* record starts a line */
+#define DEBREC_EOL      2                               /* record ends a line */
+#define DEBREC_AUX      4                               /* from an I/O thread */
+
+typedef struct {
+    volatile uint32     seq;                            /* slot sequence */
+    uint32              dbits;                          /* debug bits */
+    DEVICE              *dptr;                          /* device */
+    double              gtime;                          /* simulated time */
+    t_value             pc;                             /* PC value */
+    struct timespec     when;                           /* time of day */
+    uint16              len;                            /* text length */
+    uint16              flags;                          /* record flags */
+    char                text[DEBRING_TEXT];             /* message text */
+    } DEBREC;
+
+static DEBREC *sim_debring = NULL;                      /* ring slots */
+static uint32 sim_debring_mask = 0;                     /* ring size - 1 */
+static volatile uint32 sim_debring_head = 0;            /* next position to fill */
+static uint32 sim_debring_tail = 0;                     /* next position to write */
+static volatile uint32 sim_debring_drops = 0;           /* records dropped */
+static uint32 sim_debring_noted = 0;                    /* drops noted in file */
+static volatile t_bool sim_debring_quit = FALSE;        /* writer should exit */
+static t_bool sim_debring_active = FALSE;               /* ring in use */
+static pthread_t sim_debring_writer;                    /* writer thread */
+
+/* Put a piece of a debug line into the ring */
+
+static void _sim_debring_put (const DEBREC *info, uint32 flags, const char *txt, size_t len)
+{
+uint32 pos, seq;
+DEBREC *rec;
+
+for ( ;; ) {
+    pos = sim_debring_head;
+    rec = &sim_debring[pos & sim_debring_mask];
+    seq = rec->seq;
+    if (seq == pos) {                                   /* slot free? */
+        if (DEBRING_CAS (&sim_debring_head, pos, pos + 1))
+            break;                                      /* claimed it */
+        }
+    else
+        if ((int32)(seq - pos) < 0) {                   /* ring full? */
+            DEBRING_INC (&sim_debring_drops);
+            return;
+            }
+    }
+rec->dbits = info->dbits;
+rec->dptr = info->dptr;
+rec->gtime = info->gtime;
+rec->pc = info->pc;
+rec->when = info->when;
+rec->flags = (uint16)(flags | info->flags);
+rec->len = (uint16)len;
+memcpy (rec->text, txt, len);
+DEBRING_BARRIER ();
+rec->seq = pos + 1;                                     /* publish */
+}
+
+/* Write any records waiting in the ring, returns the number written */
+
+static uint32 _sim_debring_drain (void)
+{
+uint32 count = 0;
+uint32 drops;
+DEBREC *rec;
+char prefix[256];
+
+for ( ;; ) {
+    rec = &sim_debring[sim_debring_tail & sim_debring_mask];
+    if (rec->seq != sim_debring_tail + 1)               /* nothing more? */
+        break;
+    DEBRING_BARRIER ();
+    if (rec->flags & DEBREC_PREFIX)
+        fputs (_sim_debug_prefix_fmt (prefix, rec->dbits, rec->dptr, rec->when, rec->gtime,
+                                      rec->pc, (rec->flags & DEBREC_AUX) != 0), sim_deb);
+    fprintf (sim_deb, "%.*s%s", (int)rec->len, rec->text, (rec->flags & DEBREC_EOL) ? "\r\n" : "");
+    DEBRING_BARRIER ();
+    rec->seq = sim_debring_tail + sim_debring_mask + 1; /* free the slot */
+    sim_debring_tail = sim_debring_tail + 1;
+    ++count;
+    }
+drops = sim_debring_drops;
+if (drops != sim_debring_noted) {
+    fprintf (sim_deb, "DBG> %u debug records dropped, ring full\r\n", drops - sim_debring_noted);
+    sim_debring_noted = drops;
+    }
+return count;
+}
+
+static void *_sim_debring_writer (void *arg)
+{
+while (1) {
+    if (_sim_debring_drain () == 0) {                   /* idle? */
+        if (sim_debring_quit)
+            break;
+        fflush (sim_deb);
+        sim_os_ms_sleep (1);
+        }
+    }
+return NULL;
+}
+#endif /* SIM_DEBUG_RING */
+
+/* Start using the debug trace ring for the current debug file */
+
+t_stat sim_debug_ring_start (uint32 records)
+{
+#if defined (SIM_DEBUG_RING)
+uint32 i, size;
+
+sim_debug_ring_stop ();
+if (records == 0)
+    records = DEBRING_DFLT;
+for (size = 2; size < records; size = size << 1)        /* power of 2 size */
+    ;
+sim_debring = (DEBREC *)calloc (size, sizeof (*sim_debring));
+if (sim_debring == NULL)
+    return SCPE_MEM;
+for (i = 0; i < size; i++)
+    sim_debring[i].seq = i;
+sim_debring_mask = size - 1;
+sim_debring_head = sim_debring_tail = 0;
+sim_debring_drops = sim_debring_noted = 0;
+sim_debring_quit = FALSE;
+if (pthread_create (&sim_debring_writer, NULL, _sim_debring_writer, NULL)) {
+    free (sim_debring);
+    sim_debring = NULL;
+    return sim_messagef (SCPE_OPENERR, "Can't start the debug output thread\n");
+    }
+sim_debring_active = TRUE;
+return SCPE_OK;
+#else
+return sim_messagef (SCPE_NOFNC, "Buffered debug output isn't available on this host\n");
+#endif
+}
+
+/* Write everything in the debug trace ring and stop using it */
+
+void sim_debug_ring_stop (void)
+{
+#if defined (SIM_DEBUG_RING)
+if (!sim_debring_active)
+    return;
+sim_debring_quit = TRUE;
+pthread_join (sim_debring_writer, NULL);
+sim_debring_active = FALSE;
+_sim_debring_drain ();                                  /* anything added late */
+free (sim_debring);
+sim_debring = NULL;
+#endif
+}
+
+/* Show the state of the debug trace ring */
+
+void sim_debug_ring_show (FILE *st)
+{
+#if defined (SIM_DEBUG_RING)
+if (!sim_debring_active)
+    return;
+fprintf (st, "   Debug messages are buffered in a %u record ring, %u records dropped\n",
+             sim_debring_mask + 1, (uint32)sim_debring_drops);
+#endif
+}
+
+/* Binary instruction history streams
+
+   A history file is a fixed header followed by one record per retired
+   instruction.  Each record is a common prefix (sequence number and
+   simulated time) followed by the simulator specific payload, which is
+   written as it sits in memory.  The header records the host byte order
+   and payload size so that a file is only decoded by a matching simulator.
+*/
+
+#define HIST_MAGIC      "SIMHIST"
+#define HIST_VERSION    1
+#define HIST_ORDER      0x01020304
+#define HIST_BUFSIZ     (1 << 16)
+
+typedef struct {
+    char                magic[8];
+    uint32              version;
+    uint32              order;                          /* HIST_ORDER in writer's byte order */
+    uint32              prefix;                         /* common prefix bytes per record */
+    uint32              reclen;                         /* payload bytes per record */
+    char                sim[64];                        /* simulator name */
+    } HISTHDR;
+
+typedef struct {
+    t_uint64            seq;                            /* record sequence number */
+    t_uint64            time;                           /* simulated time */
+    } HISTPFX;
+
+FILE *sim_hist_file = NULL;                             /* history stream */
+static char *sim_hist_name = NULL;
+static uint8 *sim_hist_buf = NULL;
+static size_t sim_hist_pos = 0;
+static uint32 sim_hist_reclen = 0;
+static t_uint64 sim_hist_seq = 0;
+
+/* Open a history stream for records of reclen bytes */
+
+t_stat sim_hist_open (const char *filename, uint32 reclen)
+{
+HISTHDR hdr;
+
+sim_hist_close ();
+if ((reclen == 0) || (reclen + sizeof (HISTPFX) > HIST_BUFSIZ))
+    return SCPE_IERR;
+sim_hist_buf = (uint8 *)malloc (HIST_BUFSIZ);
+sim_hist_name = (char *)malloc (strlen (filename) + 1);
+if ((sim_hist_buf == NULL) || (sim_hist_name == NULL)) {
+    sim_hist_close ();
+    return SCPE_MEM;
+    }
+strcpy (sim_hist_name, filename);
+sim_hist_file = sim_fopen (filename, "wb");
+if (sim_hist_file == NULL) {
+    sim_hist_close ();
+    return sim_messagef (SCPE_OPENERR, "Can't open history file %s: %s\n", filename, strerror (errno));
+    }
+memset (&hdr, 0, sizeof (hdr));
+strcpy (hdr.magic, HIST_MAGIC);
+hdr.version = HIST_VERSION;
+hdr.order = HIST_ORDER;
+hdr.prefix = sizeof (HISTPFX);
+hdr.reclen = reclen;
+strncpy (hdr.sim, sim_name, sizeof (hdr.sim) - 1);
+if (fwrite (&hdr, sizeof (hdr), 1, sim_hist_file) != 1) {
+    sim_hist_close ();
+    return SCPE_IOERR;
+    }
+sim_hist_reclen = reclen;
+sim_hist_pos = 0;
+sim_hist_seq = 0;
+return SCPE_OK;
+}
+
+/* Write out buffered history records */
+
+t_stat sim_hist_flush (void)
+{
+t_stat r = SCPE_OK;
+
+if (sim_hist_file == NULL)
+    return SCPE_OK;
+if ((sim_hist_pos != 0) &&
+    (fwrite (sim_hist_buf, 1, sim_hist_pos, sim_hist_file) != sim_hist_pos))
+    r = SCPE_IOERR;
+sim_hist_pos = 0;
+fflush (sim_hist_file);
+return r;
+}
+
+/* Close the history stream */
+
+void sim_hist_close (void)
+{
+if (sim_hist_file != NULL) {
+    sim_hist_flush ();
+    fclose (sim_hist_file);
+    }
+sim_hist_file = NULL;
+free (sim_hist_buf);
+sim_hist_buf = NULL;
+free (sim_hist_name);
+sim_hist_name = NULL;
+sim_hist_reclen = 0;
+}
+
+/* Append one record to the history stream */
+
+void sim_hist_write (const void *rec)
+{
+HISTPFX pfx;
+
+if (sim_hist_file == NULL)
+    return;
+if (sim_hist_pos + sizeof (pfx) + sim_hist_reclen > HIST_BUFSIZ) {
+    if (fwrite (sim_hist_buf, 1, sim_hist_pos, sim_hist_file) != sim_hist_pos) {
+        sim_printf ("History file %s write error, history file closed\n", sim_hist_name);
+        sim_hist_close ();
+        return;
+        }
+    sim_hist_pos = 0;
+    }
+pfx.seq = sim_hist_seq++;
+pfx.time = (t_uint64)sim_gtime ();
+memcpy (sim_hist_buf + sim_hist_pos, &pfx, sizeof (pfx));
+memcpy (sim_hist_buf + sim_hist_pos + sizeof (pfx), rec, sim_hist_reclen);
+sim_hist_pos += sizeof (pfx) + sim_hist_reclen;
+}
+
+/* Show the state of the history stream */
+
+void sim_hist_show (FILE *st)
+{
+if (sim_hist_file == NULL)
+    fprintf (st, "no history file");
+else
+    fprintf (st, "history file=%s, %" LL_FMT "u records", sim_hist_name, sim_hist_seq);
+}
+
+/* Decode a history file, calling print for each record's payload */
+
+t_stat sim_hist_decode (FILE *st, const char *filename, uint32 reclen,
+                        const char *title, void (*print)(FILE *st, const void *rec))
+{
+FILE *fp;
+HISTHDR hdr;
+HISTPFX pfx;
+uint8 *rec;
+t_stat r = SCPE_OK;
+
+fp = sim_fopen (filename, "rb");
+if (fp == NULL)
+    return sim_messagef (SCPE_OPENERR, "Can't open history file %s: %s\n", filename, strerror (errno));
+if ((fread (&hdr, sizeof (hdr), 1, fp) != 1) ||
+    (memcmp (hdr.magic, HIST_MAGIC, sizeof (HIST_MAGIC)) != 0)) {
+    fclose (fp);
+    return sim_messagef (SCPE_FMT, "%s is not a history file\n", filename);
+    }
+hdr.sim[sizeof (hdr.sim) - 1] = '\0';
+if ((hdr.version != HIST_VERSION) || (hdr.order != HIST_ORDER) ||
+    (hdr.prefix != sizeof (pfx)) || (hdr.reclen != reclen) ||
+    (strcmp (hdr.sim, sim_name) != 0)) {
+    fclose (fp);
+    return sim_messagef (SCPE_FMT, "History file %s was written by %s on an incompatible host or version\n", filename, hdr.sim);
+    }
+rec = (uint8 *)malloc (reclen);
+if (rec == NULL) {
+    fclose (fp);
+    return SCPE_MEM;
+    }
+fprintf (st, "%-13s%s", "SEQUENCE", title);
+while (fread (&pfx, sizeof (pfx), 1, fp) == 1) {
+    if (fread (rec, reclen, 1, fp) != 1) {
+        r = sim_messagef (SCPE_IOERR, "History file %s is truncated\n", filename);
+        break;
+        }
+    fprintf (st, "%12" LL_FMT "u ", pfx.seq);
+    print (st, rec);
+    }
+free (rec);
+fclose (fp);
+return r;
+}
+
+/* Instruction profiler
+
+   The CPU calls sim_prof_sample with the address of each instruction it
+   executes.  Every sim_prof_interval'th call is counted in a histogram
+   made of pages of counters which are only allocated once an address in
+   them has been sampled, so sparse use of a large address space stays
+   small.  The check for an inactive profiler is a single test of
+   sim_prof_countdown.
+*/
+
+#define PROF_PAGE_BITS  10
+#define PROF_PAGE_SIZE  (1 << PROF_PAGE_BITS)
+#define PROF_TOP_DFLT   20
+
+int32 sim_prof_countdown = 0;                           /* samples until next count, 0 = off */
+static int32 sim_prof_interval = 0;                     /* instructions per sample */
+static t_uint64 **sim_prof_pages = NULL;                /* histogram pages */
+static uint32 sim_prof_npages = 0;
+static t_addr sim_prof_mask = 0;                        /* valid address bits */
+static t_uint64 sim_prof_samples = 0;
+static DEVICE *sim_prof_dev = NULL;                     /* profiled CPU */
+
+typedef struct {
+    t_addr              addr;
+    t_uint64            count;
+    } PROFENT;
+
+static void sim_prof_free (void)
+{
+uint32 i;
+
+for (i = 0; i < sim_prof_npages; i++)
+    free (sim_prof_pages[i]);
+free (sim_prof_pages);
+sim_prof_pages = NULL;
+sim_prof_npages = 0;
+sim_prof_samples = 0;
+}
+
+/* Count one sample */
+
+void _sim_prof_sample (t_addr pc)
+{
+t_uint64 *page;
+uint32 pg;
+
+sim_prof_countdown = sim_prof_interval;
+pc &= sim_prof_mask;
+pg = (uint32)(pc >> PROF_PAGE_BITS);
+page = sim_prof_pages[pg];
+if (page == NULL) {
+    page = sim_prof_pages[pg] = (t_uint64 *)calloc (PROF_PAGE_SIZE, sizeof (*page));
+    if (page == NULL) {                                 /* out of memory, give up */
+        sim_prof_countdown = 0;
+        return;
+        }
+    }
+page[pc & (PROF_PAGE_SIZE - 1)]++;
+sim_prof_samples++;
+}
+
+/* SET CPU PROFILE{=interval} start (or restart) profiling */
+
+t_stat sim_set_profile (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+DEVICE *dptr = find_dev_from_unit (uptr);
+int32 interval = 1;
+t_stat r;
+
+if (dptr == NULL)
+    return SCPE_IERR;
+if ((cptr != NULL) && (*cptr != 0)) {
+    interval = (int32) get_uint (cptr, 10, 1000000, &r);
+    if ((r != SCPE_OK) || (interval == 0))
+        return SCPE_ARG;
+    }
+sim_clr_profile (uptr, 0, NULL, NULL);
+sim_prof_mask = (dptr->awidth >= 32) ? 0xFFFFFFFF : ((t_addr)1 << dptr->awidth) - 1;
+sim_prof_npages = (uint32)((sim_prof_mask >> PROF_PAGE_BITS) + 1);
+sim_prof_pages = (t_uint64 **)calloc (sim_prof_npages, sizeof (*sim_prof_pages));
+if (sim_prof_pages == NULL) {
+    sim_prof_npages = 0;
+    return SCPE_MEM;
+    }
+sim_prof_dev = dptr;
+sim_prof_interval = interval;
+sim_prof_countdown = interval;
+return SCPE_OK;
+}
+
+/* SET CPU NOPROFILE stop profiling and discard the samples */
+
+t_stat sim_clr_profile (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+sim_prof_countdown = 0;
+sim_prof_interval = 0;
+sim_prof_dev = NULL;
+sim_prof_free ();
+return SCPE_OK;
+}
+
+static int _sim_prof_compare (const void *a, const void *b)
+{
+const PROFENT *pa = (const PROFENT *)a, *pb = (const PROFENT *)b;
+
+if (pa->count != pb->count)
+    return (pa->count < pb->count) ? 1 : -1;
+return (pa->addr < pb->addr) ? -1 : (pa->addr > pb->addr);
+}
+
+/* SHOW CPU PROFILE{=n} list the n most frequently sampled addresses */
+
+t_stat sim_show_profile (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+const char *cptr = (const char *)desc;
+DEVICE *dptr = sim_prof_dev;
+uint32 top = PROF_TOP_DFLT;
+uint32 i, j, n, used, w;
+t_addr v;
+PROFENT *ent;
+t_stat r;
+
+if (sim_prof_interval == 0) {
+    fprintf (st, "Profiling disabled\n");
+    return SCPE_OK;
+    }
+if ((cptr != NULL) && (*cptr != 0)) {
+    top = (uint32) get_uint (cptr, 10, 0xFFFFFFFF, &r);
+    if ((r != SCPE_OK) || (top == 0))
+        return SCPE_ARG;
+    }
+for (i = used = 0; i < sim_prof_npages; i++)            /* count used addresses */
+    if (sim_prof_pages[i])
+        for (j = 0; j < PROF_PAGE_SIZE; j++)
+            used += (sim_prof_pages[i][j] != 0);
+fprintf (st, "Profile: %" LL_FMT "u samples, 1 every %d instructions, %u addresses\n",
+             sim_prof_samples, sim_prof_interval, used);
+if (used == 0)
+    return SCPE_OK;
+ent = (PROFENT *)malloc (used * sizeof (*ent));
+if (ent == NULL)
+    return SCPE_MEM;
+for (i = n = 0; i < sim_prof_npages; i++)
+    if (sim_prof_pages[i])
+        for (j = 0; j < PROF_PAGE_SIZE; j++)
+            if (sim_prof_pages[i][j]) {
+                ent[n].addr = ((t_addr)i << PROF_PAGE_BITS) + j;
+                ent[n++].count = sim_prof_pages[i][j];
+                }
+qsort (ent, n, sizeof (*ent), _sim_prof_compare);
+if (top > n)
+    top = n;
+for (w = 1, v = sim_prof_mask; v >= dptr->aradix; v = v / dptr->aradix)
+    w++;                                                /* address digits */
+fprintf (st, "\n%-*s %12s %7s  Instruction\n", (int)w, "Address", "Count", "Percent");
+for (i = 0; i < top; i++) {
+    fprint_val (st, ent[i].addr, dptr->aradix, dptr->awidth, PV_RZRO);
+    fprintf (st, " %12" LL_FMT "u %6.2f%%  ", ent[i].count,
+                 (100.0 * (double)ent[i].count) / (double)sim_prof_samples);
+    if ((get_aval (ent[i].addr, dptr, dptr->units) == SCPE_OK) &&
+        (fprint_sym (st, ent[i].addr, sim_eval, dptr->units, SWMASK ('M')) > 0))
+        fprint_val (st, sim_eval[0], dptr->dradix, dptr->dwidth, PV_RZRO);
+    fputc ('\n', st);
+    }
+free (ent);
+return SCPE_OK;
+}
+
+/* Front panel lights
+
+   A CPU describes each row of panel lights with sim_lights_define, giving
+   the number of lights and an array (usually also visible as a register)
+   which receives their intensities.  While lights are enabled the CPU
+   tests sim_lights_due once per instruction; every sim_lights_interval'th
+   instruction it passes the current value of each row to sim_lights_value
+   and then calls sim_lights_end_sample.  Each lit bit bumps an on-time
+   counter.  After sim_lights_window samples the counters are converted to
+   duty cycles scaled to SIM_LIGHTS_FULL, published, and cleared, so a
+   front panel reading the intensity registers sees how long each light was
+   really on during the last display interval.
+*/
+
+#define LIGHTS_WINDOW_DFLT  1000
+
+typedef struct {
+    uint32              width;                          /* number of lights */
+    uint32              *duty;                          /* published intensities */
+    uint32              accum[64];                      /* on-time this interval */
+    } LIGHTS;
+
+int32 sim_lights_countdown = 0;                         /* instructions until next sample, 0 = off */
+static int32 sim_lights_interval = 0;                   /* instructions per sample */
+static uint32 sim_lights_window = LIGHTS_WINDOW_DFLT;   /* samples per display interval */
+static uint32 sim_lights_samples = 0;                   /* samples this interval */
+static t_uint64 sim_lights_intervals = 0;               /* intervals published */
+static LIGHTS sim_lights[SIM_LIGHTS_MAX];
+
+t_stat sim_lights_define (uint32 row, uint32 width, uint32 *duty)
+{
+if ((row >= SIM_LIGHTS_MAX) || (width > 64))
+    return SCPE_IERR;
+if ((sim_lights[row].width == width) && (sim_lights[row].duty == duty))
+    return SCPE_OK;
+memset (&sim_lights[row], 0, sizeof (sim_lights[row]));
+sim_lights[row].width = width;
+sim_lights[row].duty = duty;
+if (duty)
+    memset (duty, 0, width * sizeof (*duty));
+return SCPE_OK;
+}
+
+/* Accumulate one sample of a row of lights */
+
+void sim_lights_value (uint32 row, t_uint64 value)
+{
+LIGHTS *lp = &sim_lights[row];
+uint32 bit;
+
+if (lp->width < 64)
+    value &= (((t_uint64)1) << lp->width) - 1;
+for (bit = 0; value != 0; bit++, value >>= 1) {         /* skip dark lights cheaply */
+    while ((value & 0xFF) == 0) {
+        bit += 8;
+        value >>= 8;
+        }
+    lp->accum[bit] += (uint32)(value & 1);
+    }
+}
+
+/* Finish a sample, publishing the lights at the end of an interval */
+
+void sim_lights_end_sample (void)
+{
+uint32 row, bit;
+LIGHTS *lp;
+
+sim_lights_countdown = sim_lights_interval;
+if (++sim_lights_samples < sim_lights_window)
+    return;
+for (row = 0, lp = sim_lights; row < SIM_LIGHTS_MAX; row++, lp++) {
+    if (lp->duty == NULL)
+        continue;
+    for (bit = 0; bit < lp->width; bit++) {
+        lp->duty[bit] = (uint32)(((t_uint64)lp->accum[bit] * SIM_LIGHTS_FULL) / sim_lights_samples);
+        lp->accum[bit] = 0;
+        }
+    }
+sim_lights_samples = 0;
+sim_lights_intervals++;
+}
+
+static void sim_lights_clear (void)
+{
+uint32 row;
+
+sim_lights_samples = 0;
+sim_lights_intervals = 0;
+for (row = 0; row < SIM_LIGHTS_MAX; row++) {
+    memset (sim_lights[row].accum, 0, sizeof (sim_lights[row].accum));
+    if (sim_lights[row].duty)
+        memset (sim_lights[row].duty, 0, sim_lights[row].width * sizeof (*sim_lights[row].duty));
+    }
+}
+
+/* SET CPU LIGHTS{=interval{:window}} sample the lights every interval
+   instructions, publishing them every window samples */
+
+t_stat sim_set_lights (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+char gbuf[CBUFSIZE];
+int32 interval = 1;
+uint32 window = LIGHTS_WINDOW_DFLT;
+t_stat r;
+
+if ((cptr != NULL) && (*cptr != 0)) {
+    cptr = get_glyph (cptr, gbuf, ':');
+    interval = (int32) get_uint (gbuf, 10, 1000000, &r);
+    if ((r != SCPE_OK) || (interval == 0))
+        return SCPE_ARG;
+    if (*cptr != 0) {
+        window = (uint32) get_uint (cptr, 10, 10000000, &r);
+        if ((r != SCPE_OK) || (window == 0))
+            return SCPE_ARG;
+        }
+    }
+sim_lights_clear ();
+sim_lights_interval = interval;
+sim_lights_window = window;
+sim_lights_countdown = interval;
+return SCPE_OK;
+}
+
+/* SET CPU NOLIGHTS stop sampling and darken the lights */
+
+t_stat sim_clr_lights (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+sim_lights_countdown = 0;
+sim_lights_interval = 0;
+sim_lights_clear ();
+return SCPE_OK;
+}
+
+/* SHOW CPU LIGHTS display the sampling parameters and last intensities */
+
+t_stat sim_show_lights (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+uint32 row, bit;
+LIGHTS *lp;
+
+if (sim_lights_interval == 0) {
+    fprintf (st, "lights disabled");
+    return SCPE_OK;
+    }
+fprintf (st, "lights sampled every %d instructions, %u samples per interval, %" LL_FMT "u intervals",
+             sim_lights_interval, sim_lights_window, sim_lights_intervals);
+for (row = 0, lp = sim_lights; row < SIM_LIGHTS_MAX; row++, lp++) {
+    if ((lp->duty == NULL) || (lp->width == 0))
+        continue;
+    fprintf (st, "\n  row %u:", row);
+    for (bit = lp->width; bit-- > 0; )                  /* most significant first */
+        fprintf (st, " %u", lp->duty[bit]);
+    }
+return SCPE_OK;
 }
 
 void fprint_fields (FILE *stream, t_value before, t_value after, BITFIELD* bitdefs)
@@ -9952,6 +11906,8 @@ while (1) {                                         /* format passed string, arg
 if (sim_is_running) {
     char *c, *remnant = buf;
 
+    sim_putchar_flush ();                           /* keep console output ordered */
+
     while ((c = strchr(remnant, '\n'))) {
         if ((c != buf) && (*(c - 1) != '\r'))
             printf("%.*s\r\n", (int)(c-remnant), remnant);
@@ -10072,7 +12028,20 @@ if (sim_deb && dptr && (dptr->dctrl & dbits)) {
     char *buf = stackbuf;
     va_list arglist;
     int32 i, j, len;
-    const char* debug_prefix = sim_debug_prefix(dbits, dptr);   /* prefix to print if required */
+    const char* debug_prefix = NULL;
+#if defined (SIM_DEBUG_RING)
+    DEBREC info;
+
+    if (sim_debring_active) {                           /* capture prefix values */
+        info.dbits = dbits;
+        info.dptr = dptr;
+        info.gtime = sim_gtime();
+        info.flags = AIO_MAIN_THREAD ? 0 : DEBREC_AUX;
+        _sim_debug_stamp (&info.when, &info.pc);
+        }
+    else
+#endif
+    debug_prefix = sim_debug_prefix(dbits, dptr);       /* prefix to print if required */
 
     buf[bufsize-1] = '\0';
 
@@ -10104,15 +12073,36 @@ if (sim_deb && dptr && (dptr->dctrl & dbits)) {
 
 /* Output the formatted data expanding newlines where they exist */
 
+    if (sim_deb == stdout)
+        sim_putchar_flush ();                           /* keep console output ordered */
+#if defined (SIM_DEBUG_RING)
+    if (sim_debring_active) {                           /* queue it in pieces */
+        for (i = j = 0; i <= len; ++i) {
+            t_bool eol = (i < len) && ('\n' == buf[i]);
+
+            if ((!eol) && (i < len) && ((i - j) < DEBRING_TEXT))
+                continue;
+            if ((i > j) || eol) {                       /* empty lines are zero length records */
+                _sim_debring_put (&info, (debug_unterm ? 0 : DEBREC_PREFIX) | (eol ? DEBREC_EOL : 0), &buf[j], i - j);
+                debug_unterm = !eol;
+                }
+            j = eol ? i + 1 : i;
+            if ((!eol) && (i < len))                    /* full record, rescan char */
+                --i;
+            }
+        debug_unterm = len ? (((buf[len-1]=='\n')) ? 0 : 1) : debug_unterm;
+        if (buf != stackbuf)
+            free (buf);
+        return;
+        }
+#endif
     for (i = j = 0; i < len; ++i) {
         if ('\n' == buf[i]) {
-            if (i >= j) {
-                if ((i != j) || (i == 0)) {
-                    if (debug_unterm)
-                        fprintf (sim_deb, "%.*s\r\n", i-j, &buf[j]);
-                    else                                /* print prefix when required */
-                        fprintf (sim_deb, "%s%.*s\r\n", debug_prefix, i-j, &buf[j]);
-                    }
+            if (i >= j) {                               /* empty lines too */
+                if (debug_unterm)
+                    fprintf (sim_deb, "%.*s\r\n", i-j, &buf[j]);
+                else                                    /* print prefix when required */
+                    fprintf (sim_deb, "%s%.*s\r\n", debug_prefix, i-j, &buf[j]);
                 debug_unterm = 0;
                 }
             j = i + 1;
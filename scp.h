@@ -132,6 +132,7 @@ t_stat sim_run_boot_prep (void);
 double sim_gtime (void);
 uint32 sim_grtime (void);
 int32 sim_qcount (void);
+t_stat sim_dirty_register (UNIT *uptr, uint32 *map, t_addr size);
 t_stat attach_unit (UNIT *uptr, CONST char *cptr);
 t_stat detach_unit (UNIT *uptr);
 t_stat assign_device (DEVICE *dptr, const char *cptr);
@@ -204,6 +205,7 @@ t_stat show_dev_debug (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST cha
 const char *sim_error_text (t_stat stat);
 t_stat sim_string_to_stat (const char *cptr, t_stat *cond);
 t_stat sim_cancel_step (void);
+void sim_export_update (void);
 void sim_printf (const char* fmt, ...) GCC_FMT_ATTR(1, 2);
 void sim_perror (const char* msg);
 t_stat sim_messagef (t_stat stat, const char* fmt, ...) GCC_FMT_ATTR(2, 3);
@@ -212,6 +214,32 @@ void sim_debug_bits_hdr (uint32 dbits, DEVICE* dptr, const char *header,
     BITFIELD* bitdefs, uint32 before, uint32 after, int terminate);
 void sim_debug_bits (uint32 dbits, DEVICE* dptr, BITFIELD* bitdefs,
     uint32 before, uint32 after, int terminate);
+t_stat sim_debug_ring_start (uint32 records);
+void sim_debug_ring_stop (void);
+void sim_debug_ring_show (FILE *st);
+t_stat sim_hist_open (const char *filename, uint32 reclen);
+t_stat sim_hist_flush (void);
+void sim_hist_close (void);
+void sim_hist_write (const void *rec);
+void sim_hist_show (FILE *st);
+t_stat sim_hist_decode (FILE *st, const char *filename, uint32 reclen,
+                        const char *title, void (*print)(FILE *st, const void *rec));
+void _sim_prof_sample (t_addr pc);
+t_stat sim_set_profile (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat sim_clr_profile (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat sim_show_profile (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+#define sim_prof_sample(pc) \
+    do { if (sim_prof_countdown && (--sim_prof_countdown == 0)) _sim_prof_sample (pc); } while (0)
+#define SIM_LIGHTS_MAX      8                           /* rows of lights */
+#define SIM_LIGHTS_FULL     1000                        /* intensity of a light on all the time */
+t_stat sim_lights_define (uint32 row, uint32 width, uint32 *duty);
+void sim_lights_value (uint32 row, t_uint64 value);
+void sim_lights_end_sample (void);
+t_stat sim_set_lights (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat sim_clr_lights (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
+t_stat sim_show_lights (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+#define sim_lights_due() \
+    (sim_lights_countdown && (--sim_lights_countdown == 0))
 #if defined (__DECC) && defined (__VMS) && (defined (__VAX) || (__DECC_VER < 60590001))
 #define CANT_USE_MACRO_VA_ARGS 1
 #endif
@@ -279,6 +307,10 @@ extern t_bool sim_asynch_enabled;
 /* VM interface */
 
 extern char sim_name[];
+extern FILE *sim_hist_file;
+extern int32 sim_prof_countdown;
+extern int32 sim_lights_countdown;
+extern double sim_queue_dispatches;
 extern DEVICE *sim_devices[];
 extern REG *sim_PC;
 extern const char *sim_stop_messages[];
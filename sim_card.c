@@ -60,6 +60,14 @@
 
     The card module uses up7 to hold a buffer for the card being translated
     and the backward translation table. Which is generated from the table.
+
+    Cards are translated ahead in batches of CARD_BATCH, so most calls to
+    sim_read_card just hand out the next translated image. Changing the
+    format while attached translates the unread cards again.
+
+    With asynchronous I/O enabled a thread per reader translates the next
+    batch while the current one is being read, so the card cycle never
+    waits on the host file.
 */
 
 #if defined(USE_SIM_CARD)
@@ -67,6 +75,9 @@
 #include <ctype.h>
 #include "sim_defs.h"
 #include "sim_card.h"
+#if defined(SIM_ASYNCH_IO)
+#include <pthread.h>
+#endif
 
 
 /* Character conversion tables */
@@ -319,6 +330,7 @@ static uint16 ebcdic_to_hol[256] = {
 };
 
 static uint16 hol_to_ebcdic[4096];
+static int    hol_to_ebcdic_init = 0;
 
 const uint8        sim_parity_table[64] = {
     /* 0    1    2    3    4    5    6    7 */
@@ -332,6 +344,28 @@ const uint8        sim_parity_table[64] = {
     0100, 0000, 0000, 0100, 0000, 0100, 0100, 0000
 };
 
+#define CARD_BATCH      2000            /* Cards translated ahead, one box */
+#define CARD_XLAT_FLAGS (UNIT_CARD_MODE|MODE_LOWER|MODE_CHAR)
+
+struct _card_rec {
+    t_offset            pos;            /* File offset of card */
+    t_stat              status;         /* Result of translation */
+    uint16              image[80];      /* Translated card */
+};
+
+#if defined(SIM_ASYNCH_IO)
+struct _card_aio {
+    pthread_t           thread;         /* Translate ahead thread */
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;           /* Signals busy and quit changes */
+    int                 busy;           /* Thread is filling spare */
+    int                 quit;           /* Thread should exit */
+    struct _card_rec    *spare;         /* Next batch */
+    int                 spare_cnt;      /* Cards in spare, -1 none */
+    uint32              spare_flags;    /* Format flags spare was translated with */
+};
+#endif
+
 struct card_formats {
     uint32      mode;
     const char  *name;
@@ -474,8 +508,11 @@ static int cmpcard(const char *p, const char *s) {
 }
 
 
-t_stat
-sim_read_card(UNIT * uptr)
+/* Translate the next card from the file into image. *more is
+   cleared when nothing further can be read from the file now. */
+static t_stat
+_sim_xlat_card(UNIT * uptr, DEVICE *dptr, struct _card_data *data,
+               uint16 *image, int *more)
 {
     int                 i;
     char                c;
@@ -484,24 +521,20 @@ sim_read_card(UNIT * uptr)
     int                 len;
     int                 size;
     int                 col;
-    struct _card_data   *data;
-    DEVICE              *dptr;
+    const uint16        *xlat;
     t_stat              r = SCPE_OK;
 
-    if ((uptr->flags & UNIT_ATT) == 0)
-        return SCPE_UNATT;      /* attached? */
-
-    dptr = find_dev_from_unit( uptr);
-    data = (struct _card_data *)uptr->up7;
     sim_debug(DEBUG_CARD, dptr, "Read card ");
 
+    /* Clear image buffer */
+    for (col = 0; col < 80; image[col++] = 0);
+
 /* Move data to start at begining of buffer */
     if (data->ptr > 0) {
-        int                 ptr = data->ptr;
-        int                 start = 0;
+        int                 start = data->len - data->ptr;
 
-        while (ptr < data->len)
-            (data->cbuff)[start++] = (data->cbuff)[ptr++];
+        memmove(&data->cbuff[0], &data->cbuff[data->ptr], start);
+        data->fpos += data->ptr;
         data->len -= data->ptr;
         /* On eof, just return */
         if (!feof(uptr->fileref) && data->len < 512)
@@ -513,6 +546,7 @@ sim_read_card(UNIT * uptr)
         size = data->len;
     } else {
         /* Load rest of buffer */
+        data->fpos += data->len;
         if (!feof(uptr->fileref)) {
             len = sim_fread(&data->cbuff[0], 1, sizeof(data->cbuff), uptr->fileref);
             size = len;
@@ -523,18 +557,17 @@ sim_read_card(UNIT * uptr)
 
     if ((len < 0 || size == 0) && feof(uptr->fileref)) {
         sim_debug(DEBUG_CARD, dptr, "EOF\n");
+        *more = 0;
         return SCPE_EOF;
     }
 
     if (ferror(uptr->fileref)) {        /* error? */
         perror("Card reader I/O error");
         clearerr(uptr->fileref);
+        *more = 0;
         return SCPE_IOERR;
     }
 
-    /* Clear image buffer */
-    for (col = 0; col < 80; data->image[col++] = 0);
-
     if ((uptr->flags & UNIT_CARD_MODE) == MODE_AUTO) {
         mode = MODE_TEXT;   /* Default is text */
 
@@ -612,7 +645,7 @@ sim_read_card(UNIT * uptr)
             int         j = 0;
             for(col = 0, i = 4; col < 80; i++) {
                 if (data->cbuff[i] >= '0' && data->cbuff[i] <= '7') {
-                    data->image[col] = (data->image[col] << 3) |
+                    image[col] = (image[col] << 3) |
                                          (data->cbuff[i] - '0');
                     j++;
                 } else if (data->cbuff[i] == '\n' || 
@@ -628,15 +661,28 @@ sim_read_card(UNIT * uptr)
                 }
             }
         } else if (cmpcard(&data->cbuff[0], "eor")) {
-            data->image[0] = 07;        /* 7/8/9 punch */
+            image[0] = 07;        /* 7/8/9 punch */
             i = 4;
         } else if (cmpcard(&data->cbuff[0], "eof")) {
-            data->image[0] = 015;       /* 6/7/9 punch */
+            image[0] = 015;       /* 6/7/9 punch */
             i = 4;
         } else if (cmpcard(&data->cbuff[0], "eoi")) {
-            data->image[0] = 017;       /* 6/7/8/9 punch */
+            image[0] = 017;       /* 6/7/8/9 punch */
             i = 4;
         } else {
+            switch(uptr->flags & MODE_CHAR) {
+            default:
+            case 0:
+            case MODE_026:
+                   xlat = ascii_to_hol_026;
+                   break;
+            case MODE_029:
+                   xlat = ascii_to_hol_029;
+                   break;
+            case MODE_EBCDIC:
+                   xlat = ascii_to_hol_ebcdic;
+                   break;
+            }
             /* Convert text line into card image */
             for (col = 0, i = 0; col < 80 && i < size; i++) {
                 c = data->cbuff[i];
@@ -655,21 +701,10 @@ sim_read_card(UNIT * uptr)
                     sim_debug(DEBUG_CARD, dptr, "%c", c);
                     if ((uptr->flags & MODE_LOWER) == 0)
                         c = toupper(c);
-                    switch(uptr->flags & MODE_CHAR) {
-                    case 0:
-                    case MODE_026:
-                           temp = ascii_to_hol_026[(int)c];
-                           break;
-                    case MODE_029:
-                           temp = ascii_to_hol_029[(int)c];
-                           break;
-                    case MODE_EBCDIC:
-                           temp = ascii_to_hol_ebcdic[(int)c];
-                           break;
-                    }
+                    temp = xlat[(int)c];
                     if (temp & 0xf000)
                         r = SCPE_IOERR;
-                    data->image[col++] = temp & 0xfff;
+                    image[col++] = temp & 0xfff;
                 }
             }
         }
@@ -695,8 +730,8 @@ sim_read_card(UNIT * uptr)
         /* Move data to buffer */
         for (col = i = 0; i < 160;) {
             temp |= data->cbuff[i];
-            data->image[col] = (data->cbuff[i++] >> 4) & 0xF;
-            data->image[col++] |= ((uint16)data->cbuff[i++]) << 4;
+            image[col] = (data->cbuff[i++] >> 4) & 0xF;
+            image[col++] |= ((uint16)data->cbuff[i++]) << 4;
         }
         /* Check if format error */
         if (temp & 0xF) 
@@ -724,13 +759,13 @@ sim_read_card(UNIT * uptr)
             c = data->cbuff[i] & 077;
             if (sim_parity_table[(int)c] == (data->cbuff[i++] & 0100))
                 r = SCPE_IOERR;
-            data->image[col] = ((uint16)c) << 6;
+            image[col] = ((uint16)c) << 6;
             if (data->cbuff[i] & 0x80)
                 break;
             c = data->cbuff[i] & 077;
             if (sim_parity_table[(int)c] == (data->cbuff[i++] & 0100))
                 r = SCPE_IOERR;
-            data->image[col++] |= c;
+            image[col++] |= c;
         }
 
         if (col >= 80 && (data->cbuff[i] & 0x80) == 0) {
@@ -764,7 +799,7 @@ sim_read_card(UNIT * uptr)
                 r = SCPE_IOERR;
             sim_debug(DEBUG_CARD, dptr, "%c", sim_six_to_ascii[(int)c]);
             /* Convert to top column */
-            data->image[col++] = sim_bcd_to_hol(c);
+            image[col++] = sim_bcd_to_hol(c);
         }
 
         if (col >= 80 && (data->cbuff[i] & 0x80) == 0) {
@@ -788,7 +823,7 @@ sim_read_card(UNIT * uptr)
         /* Move data to buffer */
         for (i = 0; i < 80; i++) {
             temp = data->cbuff[i];
-            data->image[i] = ebcdic_to_hol[temp];
+            image[i] = ebcdic_to_hol[temp];
         }
         break;
 
@@ -800,6 +835,152 @@ sim_read_card(UNIT * uptr)
     return r;
 }
 
+/* Translate the next batch of cards into deck, returns number of cards */
+static int
+_sim_card_fill(UNIT * uptr, DEVICE *dptr, struct _card_data *data,
+               struct _card_rec *deck)
+{
+    struct _card_rec    *rec;
+    int                 more = 1;
+    int                 cnt = 0;
+
+    while (more && cnt < CARD_BATCH) {
+        rec = &deck[cnt];
+        rec->pos = data->fpos + ((data->ptr > 0) ? data->ptr : data->len);
+        rec->status = _sim_xlat_card(uptr, dptr, data, rec->image, &more);
+        if (rec->status == SCPE_EOF && !more)
+            break;              /* End of file, not a card */
+        cnt++;
+        /* Stop if the card could not be taken from the buffer */
+        if (rec->pos == data->fpos + ((data->ptr > 0) ? data->ptr : data->len))
+            break;
+    }
+    return cnt;
+}
+
+/* Restart translation at file offset pos */
+static void
+_sim_card_seek(UNIT * uptr, struct _card_data *data, t_offset pos)
+{
+    data->fpos = pos;
+    data->ptr = data->len = 0;
+    data->deck_cnt = data->deck_next = 0;
+    sim_fseeko(uptr->fileref, pos, SEEK_SET);
+}
+
+#if defined(SIM_ASYNCH_IO)
+static void *
+_card_aio_thread(void *arg)
+{
+    UNIT                *uptr = (UNIT *)arg;
+    struct _card_data   *data = (struct _card_data *)uptr->up7;
+    struct _card_aio    *aio = data->aio;
+    DEVICE              *dptr = find_dev_from_unit(uptr);
+    int                 cnt;
+
+    pthread_mutex_lock(&aio->lock);
+    while (!aio->quit) {
+        if (!aio->busy) {
+            pthread_cond_wait(&aio->cond, &aio->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&aio->lock);
+        cnt = _sim_card_fill(uptr, dptr, data, aio->spare);
+        pthread_mutex_lock(&aio->lock);
+        aio->spare_cnt = cnt;
+        aio->busy = 0;
+        pthread_cond_broadcast(&aio->cond);
+    }
+    pthread_mutex_unlock(&aio->lock);
+    return NULL;
+}
+
+/* Wait for the thread to finish, the file is then ours */
+static void
+_card_aio_wait(struct _card_aio *aio)
+{
+    pthread_mutex_lock(&aio->lock);
+    while (aio->busy)
+        pthread_cond_wait(&aio->cond, &aio->lock);
+    pthread_mutex_unlock(&aio->lock);
+}
+
+/* Have the thread translate the next batch */
+static void
+_card_aio_start(UNIT * uptr, struct _card_aio *aio)
+{
+    pthread_mutex_lock(&aio->lock);
+    aio->spare_cnt = -1;
+    aio->spare_flags = uptr->flags & CARD_XLAT_FLAGS;
+    aio->busy = 1;
+    pthread_cond_broadcast(&aio->cond);
+    pthread_mutex_unlock(&aio->lock);
+}
+#endif
+
+t_stat
+sim_read_card(UNIT * uptr)
+{
+    struct _card_data   *data;
+    struct _card_rec    *rec;
+    DEVICE              *dptr;
+
+    if ((uptr->flags & UNIT_ATT) == 0)
+        return SCPE_UNATT;      /* attached? */
+
+    dptr = find_dev_from_unit( uptr);
+    data = (struct _card_data *)uptr->up7;
+
+    /* Format changed, translate unread cards again */
+    if (data->deck_next < data->deck_cnt &&
+        (uptr->flags & CARD_XLAT_FLAGS) != data->deck_flags) {
+#if defined(SIM_ASYNCH_IO)
+        if (data->aio) {
+            _card_aio_wait(data->aio);
+            data->aio->spare_cnt = -1;
+        }
+#endif
+        _sim_card_seek(uptr, data, data->deck[data->deck_next].pos);
+    }
+
+    if (data->deck_next == data->deck_cnt) {
+#if defined(SIM_ASYNCH_IO)
+        struct _card_aio    *aio = data->aio;
+
+        if (aio) {
+            _card_aio_wait(aio);
+            if (aio->spare_cnt > 0) {
+                if (aio->spare_flags == (uptr->flags & CARD_XLAT_FLAGS)) {
+                    rec = data->deck;
+                    data->deck = aio->spare;
+                    aio->spare = rec;
+                    data->deck_cnt = aio->spare_cnt;
+                    data->deck_next = 0;
+                    data->deck_flags = aio->spare_flags;
+                } else
+                    _sim_card_seek(uptr, data, aio->spare[0].pos);
+            }
+            aio->spare_cnt = -1;
+        }
+#endif
+        if (data->deck_next == data->deck_cnt) {
+            data->deck_flags = uptr->flags & CARD_XLAT_FLAGS;
+            data->deck_next = 0;
+            data->deck_cnt = _sim_card_fill(uptr, dptr, data, data->deck);
+            if (data->deck_cnt == 0)
+                return SCPE_EOF;
+        }
+#if defined(SIM_ASYNCH_IO)
+        if (aio)
+            _card_aio_start(uptr, aio);
+#endif
+    }
+
+    rec = &data->deck[data->deck_next++];
+    memcpy(data->image, rec->image, sizeof(data->image));
+    return rec->status;
+}
+
 /* Check if reader is at last card.
  *
  */
@@ -812,7 +993,16 @@ sim_card_eof(UNIT *uptr)
         return 1;               /* attached? */
 
     data = (struct _card_data *)uptr->up7;
-        
+
+    if (data->deck_next < data->deck_cnt)
+        return 0;               /* Translated cards left */
+#if defined(SIM_ASYNCH_IO)
+    if (data->aio) {
+        _card_aio_wait(data->aio);
+        if (data->aio->spare_cnt > 0)
+            return 0;
+    }
+#endif
     if (data->ptr > 0) {
         if ((data->ptr - data->len) == 0 && feof(uptr->fileref))
             return 1;
@@ -1050,19 +1240,28 @@ sim_card_attach(UNIT * uptr, CONST char *cptr)
         data = (struct _card_data *)uptr->up7;
     } else {
         data = (struct _card_data *)uptr->up7;
+        free(data->deck);
     }
     memset(data, 0, sizeof(struct _card_data));
+    data->deck = (struct _card_rec *)malloc(CARD_BATCH * sizeof(struct _card_rec));
+    if (data->deck == NULL) {
+        sim_card_detach(uptr);
+        return SCPE_MEM;
+    }
 
-    for (i = 0; i < 4096; i++) 
-        hol_to_ebcdic[i] = 0x100;
-    for (i = 0; i < 256; i++) {
-        uint16     temp = ebcdic_to_hol[i];
-        if (hol_to_ebcdic[temp] != 0x100) {
-            fprintf(stderr, "Translation error %02x is %03x and %03x\n",
-                i, temp, hol_to_ebcdic[temp]);
-        } else {
-            hol_to_ebcdic[temp] = i;
+    if (!hol_to_ebcdic_init) {
+        for (i = 0; i < 4096; i++) 
+            hol_to_ebcdic[i] = 0x100;
+        for (i = 0; i < 256; i++) {
+            uint16     temp = ebcdic_to_hol[i];
+            if (hol_to_ebcdic[temp] != 0x100) {
+                fprintf(stderr, "Translation error %02x is %03x and %03x\n",
+                    i, temp, hol_to_ebcdic[temp]);
+            } else {
+                hol_to_ebcdic[temp] = i;
+            }
         }
+        hol_to_ebcdic_init = 1;
     }
 
     memset(&data->hol_to_ascii[0], 0xff, 4096);
@@ -1085,6 +1284,29 @@ sim_card_attach(UNIT * uptr, CONST char *cptr)
 
     data->ptr = 0;      /* Set for initial read */
     data->len = 0;
+
+#if defined(SIM_ASYNCH_IO)
+    if (sim_asynch_enabled) {
+        struct _card_aio    *aio;
+
+        aio = (struct _card_aio *)calloc(1, sizeof(struct _card_aio));
+        if (aio != NULL) {
+            aio->spare = (struct _card_rec *)malloc(CARD_BATCH * sizeof(struct _card_rec));
+            aio->spare_cnt = -1;
+            pthread_mutex_init(&aio->lock, NULL);
+            pthread_cond_init(&aio->cond, NULL);
+            data->aio = aio;
+            if (aio->spare == NULL ||
+                pthread_create(&aio->thread, NULL, _card_aio_thread, uptr) != 0) {
+                pthread_mutex_destroy(&aio->lock);
+                pthread_cond_destroy(&aio->cond);
+                free(aio->spare);
+                free(aio);
+                data->aio = NULL;       /* Translate synchronously */
+            }
+        }
+    }
+#endif
     return SCPE_OK;
 }
 
@@ -1093,6 +1315,24 @@ sim_card_detach(UNIT * uptr)
 {
     /* Free buffer if one allocated */
     if (uptr->up7 != 0) {
+        struct _card_data   *data = (struct _card_data *)uptr->up7;
+
+#if defined(SIM_ASYNCH_IO)
+        if (data->aio) {
+            struct _card_aio    *aio = data->aio;
+
+            pthread_mutex_lock(&aio->lock);
+            aio->quit = 1;
+            pthread_cond_broadcast(&aio->cond);
+            pthread_mutex_unlock(&aio->lock);
+            pthread_join(aio->thread, NULL);
+            pthread_mutex_destroy(&aio->lock);
+            pthread_cond_destroy(&aio->cond);
+            free(aio->spare);
+            free(aio);
+        }
+#endif
+        free(data->deck);
         free((void *)uptr->up7);
         uptr->up7 = 0;
     }
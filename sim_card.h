@@ -87,6 +87,9 @@ extern "C" {
 #define MODE_CHAR       (0x30 << UNIT_V_CARD_MODE)
 
 
+struct _card_rec;
+struct _card_aio;
+
 struct _card_data
 {
     int                 ptr;            /* Pointer in buffer */
@@ -94,6 +97,12 @@ struct _card_data
     char                cbuff[1024];    /* Read in buffer for cards */
     uint16              image[80];      /* Image */
     uint8               hol_to_ascii[4096]; /* Back conversion table */
+    t_offset            fpos;           /* File offset of cbuff[0] */
+    struct _card_rec    *deck;          /* Cards translated ahead */
+    int                 deck_cnt;       /* Number of cards in deck */
+    int                 deck_next;      /* Next card to hand out */
+    uint32              deck_flags;     /* Format flags deck was translated with */
+    struct _card_aio    *aio;           /* Translate ahead thread */
 };
 
 /* Generic routines. */
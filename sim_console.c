@@ -140,6 +140,7 @@
 static t_stat sim_os_poll_kbd (void);
 static t_bool sim_os_poll_kbd_ready (int ms_timeout);
 static t_stat sim_os_putchar (int32 out);
+static t_stat sim_os_putbuf (const char *buf, int32 len);
 static t_stat sim_os_ttinit (void);
 static t_stat sim_os_ttrun (void);
 static t_stat sim_os_ttcmd (void);
@@ -148,6 +149,7 @@ static t_bool sim_os_ttisatty (void);
 
 static t_stat sim_set_rem_telnet (int32 flag, CONST char *cptr);
 static t_stat sim_set_rem_connections (int32 flag, CONST char *cptr);
+static t_stat sim_set_rem_monitor (int32 flag, CONST char *cptr);
 static t_stat sim_set_rem_timeout (int32 flag, CONST char *cptr);
 static t_stat sim_set_rem_master (int32 flag, CONST char *cptr);
 
@@ -155,6 +157,10 @@ static t_stat sim_set_rem_master (int32 flag, CONST char *cptr);
 static t_stat sim_set_halt (int32 flag, CONST char *cptr);
 static t_stat sim_set_response (int32 flag, CONST char *cptr);
 static t_stat sim_set_delay (int32 flag, CONST char *cptr);
+static t_stat sim_set_cons_outbuf (int32 flag, CONST char *cptr);
+static t_stat sim_show_cons_outbuf (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+static t_stat sim_set_cons_journal (int32 flag, CONST char *cptr);
+static t_stat sim_show_cons_journal (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
 
 
 #define KMAP_WRU        0
@@ -275,6 +281,11 @@ static CTAB set_con_tab[] = {
     { "DELAY", &sim_set_delay, 0 },
     { "RESPONSE", &sim_set_response, 1 | CMD_WANTSTR },
     { "NORESPONSE", &sim_set_response, 0 },
+    { "OUTBUFFER", &sim_set_cons_outbuf, 1 },
+    { "NOOUTBUFFER", &sim_set_cons_outbuf, 0 },
+    { "JOURNAL", &sim_set_cons_journal, 1 },
+    { "REPLAY", &sim_set_cons_journal, 2 },
+    { "NOJOURNAL", &sim_set_cons_journal, 0 },
     { NULL, NULL, 0 }
     };
 
@@ -285,6 +296,8 @@ static CTAB set_rem_con_tab[] = {
     { "TIMEOUT", &sim_set_rem_timeout, 0 },
     { "MASTER", &sim_set_rem_master, 1 },
     { "NOMASTER", &sim_set_rem_master, 0 },
+    { "MONITOR", &sim_set_rem_monitor, 1 },
+    { "NOMONITOR", &sim_set_rem_monitor, 0 },
     { NULL, NULL, 0 }
     };
 
@@ -303,6 +316,8 @@ static SHTAB show_con_tab[] = {
     { "INPUT", &sim_show_cons_send_input, 0 },
     { "RESPONSE", &sim_show_cons_send_input, 0 },
     { "DELAY", &sim_show_cons_expect, 0 },
+    { "OUTBUFFER", &sim_show_cons_outbuf, 0 },
+    { "JOURNAL", &sim_show_cons_journal, 0 },
     { NULL, NULL, 0 }
     };
 
@@ -405,7 +420,8 @@ DEVICE sim_remote_console = {
     2, 0, 0, 0, 0, 0, 
     NULL, NULL, sim_rem_con_reset, NULL, NULL, NULL, 
     NULL, DEV_DEBUG | DEV_NOSAVE, 0, sim_rem_con_debug};
-#define MAX_REMOTE_SESSIONS 40          /* Arbitrary Session Limit */
+#define MAX_REMOTE_SESSIONS 256         /* Arbitrary Session Limit */
+#define REM_TAG_SIZE        32          /* Framed request tag size */
 static int32 *sim_rem_buf_size = NULL;
 static int32 *sim_rem_buf_ptr = NULL;
 static char **sim_rem_buf = NULL;
@@ -423,6 +439,9 @@ static t_bool sim_rem_master_mode = FALSE;  /* Master Mode Enabled Flag */
 static t_bool sim_rem_master_was_enabled = FALSE; /* Master was Enabled */
 static t_bool sim_rem_master_was_connected = FALSE; /* Master Mode has been connected */
 static t_offset sim_rem_cmd_log_start = 0;  /* Log File saved position */
+static t_bool sim_rem_monitor = FALSE;      /* run monitoring commands from the service routine */
+static t_bool *sim_rem_framed = NULL;       /* per line current command is a framed request */
+static char *sim_rem_frame_tags = NULL;     /* per line framed request tag (REM_TAG_SIZE each) */
 
 
 /* SET REMOTE CONSOLE command */
@@ -469,6 +488,8 @@ if (sim_rem_con_tmxr.lines > 1)
     fprintf (st, "Remote Console Input Connections from %d sources are supported concurrently\n", sim_rem_con_tmxr.lines);
 if (sim_rem_read_timeout)
     fprintf (st, "Remote Console Input automatically continues after %d seconds\n", sim_rem_read_timeout);
+if (sim_rem_monitor)
+    fprintf (st, "Remote Console monitoring commands run without leaving instruction execution\n");
 if (!sim_rem_con_tmxr.master)
     fprintf (st, "Remote Console Command input is disabled\n");
 else
@@ -610,6 +631,23 @@ static CTAB allowed_single_remote_cmds[] = {
     { NULL,       NULL }
     };
 
+/* Single mode commands which only report state.  With SET REMOTE MONITOR
+   these run directly from the remote console's unit service routine.
+   Event service happens between instructions, so they see consistent
+   state without forcing sim_instr to return. */
+
+static CTAB allowed_monitor_remote_cmds[] = {
+    { "EXAMINE",  &exdep_cmd,      EX_E },
+    { "EVALUATE", &eval_cmd,          0 },
+    { "PWD",      &pwd_cmd,           0 },
+    { "DIR",      &dir_cmd,           0 },
+    { "LS",       &dir_cmd,           0 },
+    { "ECHO",     &echo_cmd,          0 },
+    { "SHOW",     &show_cmd,          0 },
+    { "HELP",     &x_help_cmd,        0 },
+    { NULL,       NULL }
+    };
+
 static t_stat x_help_cmd (int32 flag, CONST char *cptr)
 {
 CTAB *cmdp, *cmdph;
@@ -651,10 +689,55 @@ if (!stat_nomessage) {
 return stat;
 }
 
-static void _sim_rem_log_out (TMLN *lp)
+/* Send the output of a framed request
+
+   A framed request is a command line of the form "@tag command".  Its reply
+   is a header line "@tag status length" followed by exactly length bytes of
+   command output, with no prompts or echo, so that a supervising program
+   can parse it.  status is the numeric SCP status (0 for success).
+*/
+
+static void _sim_rem_framed_out (TMLN *lp, int32 line, t_stat stat)
+{
+char cbuf[4*CBUFSIZE];
+char *text = NULL;
+size_t len = 0, size = 0, n;
+int32 unwritten;
+
+if (sim_log) {
+    fflush (sim_log);
+    sim_fseeko (sim_log, sim_rem_cmd_log_start, SEEK_SET);
+    while ((n = fread (cbuf, 1, sizeof (cbuf), sim_log)) > 0) {
+        if (len + n + 1 > size) {
+            size = len + n + 1 + sizeof (cbuf);
+            text = (char *)realloc (text, size);
+            }
+        memcpy (text + len, cbuf, n);
+        len += n;
+        }
+    }
+tmxr_linemsgf (lp, "@%s %d %d\r\n", &sim_rem_frame_tags[line*REM_TAG_SIZE], 
+                   SCPE_BARE_STATUS(stat), (int)len);
+if (len)
+    tmxr_linemsgn (lp, text, len);                      /* the count, not strlen, frames it */
+free (text);
+sim_rem_framed[line] = FALSE;
+do {
+    unwritten = tmxr_send_buffered_data (lp);
+    if (unwritten == lp->txbsz)
+        sim_os_ms_sleep (100);
+    } while (unwritten == lp->txbsz);
+}
+
+static void _sim_rem_log_out (TMLN *lp, t_stat stat)
 {
 char cbuf[4*CBUFSIZE];
+int32 line = (int32)(lp - sim_rem_con_tmxr.ldsc);
 
+if (sim_rem_framed[line]) {
+    _sim_rem_framed_out (lp, line, stat);
+    return;
+    }
 if (sim_log) {
     int32 unwritten;
 
@@ -716,6 +799,7 @@ CONST char *cptr;
 CTAB *cmdp = NULL;
 CTAB *basecmdp = NULL;
 uint32 read_start_time = 0;
+t_bool in_place = FALSE;
 
 tmxr_poll_rx (&sim_rem_con_tmxr);                      /* poll input */
 for (i=(was_active_command ? sim_rem_cmd_active_line : 0); 
@@ -740,7 +824,9 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                 stat = SCPE_STEP;
                 _sim_rem_message ("STEP", stat);        /* produce a STEP complete message */
                 }
-            _sim_rem_log_out (lp);
+            else
+                stat = sim_last_cmd_stat;
+            _sim_rem_log_out (lp, stat);
             sim_rem_active_command = NULL;              /* Restart loop to process available input */
             was_active_command = FALSE;
             i = -1;
@@ -771,7 +857,7 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                 sim_stop_timer_services ();
                 stat = SCPE_STOP;
                 _sim_rem_message ("RUN", stat);
-                _sim_rem_log_out (lp);
+                _sim_rem_log_out (lp, stat);
                 for (j=0; j < sim_rem_con_tmxr.lines; j++) {
                     TMLN *lpj = &sim_rem_con_tmxr.ldsc[j];
                     if ((i == j) || (!lpj->conn))
@@ -799,7 +885,7 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                     tmxr_reset_ln (lp);
                     continue;
                     }
-                if (sim_rem_buf_ptr[i] == 0) {
+                if ((sim_rem_buf_ptr[i] == 0) && (c != '@')) {
                     /* we just picked up the first character on a command line */
                     if (!master_session)
                         tmxr_linemsgf (lp, "\r\n%s", sim_prompt);
@@ -877,7 +963,8 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                     if (sim_rem_buf_ptr[i] == 0)
                         break;
                 case '\r':
-                    tmxr_linemsg (lp, "\r\n");
+                    if (!sim_rem_framed[i])
+                        tmxr_linemsg (lp, "\r\n");
                     if (sim_rem_buf_ptr[i]+1 >= sim_rem_buf_size[i]) {
                         sim_rem_buf_size[i] += 1024;
                         sim_rem_buf[i] = (char *)realloc (sim_rem_buf[i], sim_rem_buf_size[i]);
@@ -904,7 +991,10 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                     close_session = TRUE;
                     break;
                 default:
-                    tmxr_putc_ln (lp, c);
+                    if ((sim_rem_buf_ptr[i] == 0) && (c == '@'))
+                        sim_rem_framed[i] = TRUE;       /* framed request, no echo */
+                    if (!sim_rem_framed[i])
+                        tmxr_putc_ln (lp, c);
                     if (sim_rem_buf_ptr[i]+2 >= sim_rem_buf_size[i]) {
                         sim_rem_buf_size[i] += 1024;
                         sim_rem_buf[i] = (char *)realloc (sim_rem_buf[i], sim_rem_buf_size[i]);
@@ -939,6 +1029,29 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
         sim_rem_buf[i][sim_rem_buf_ptr[i]] = '\0';
         while (isspace(cbuf[0]))
             memmove (cbuf, cbuf+1, strlen(cbuf+1)+1);   /* skip leading whitespace */
+        if (sim_rem_framed[i]) {                        /* "@tag command"? */
+            char *tag = &sim_rem_frame_tags[i*REM_TAG_SIZE];
+            char *p = cbuf + 1;
+            int32 n = 0;
+
+            while (*p && !isspace (*p)) {
+                if (n < REM_TAG_SIZE - 1)
+                    tag[n++] = *p;
+                ++p;
+                }
+            tag[n] = '\0';
+            while (isspace (*p))
+                ++p;
+            memmove (cbuf, p, strlen (p) + 1);
+            if (cbuf[0] == '\0') {                      /* empty request */
+                tmxr_linemsgf (lp, "@%s 0 0\r\n", tag);
+                tmxr_send_buffered_data (lp);
+                sim_rem_framed[i] = FALSE;
+                if (sim_rem_single_mode[i])
+                    break;
+                continue;
+                }
+            }
         if (cbuf[0] == '\0') {
             if (sim_rem_single_mode[i]) {
                 sim_rem_single_mode[i] = FALSE;
@@ -1008,8 +1121,13 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
                                 cmdp = find_ctab (allowed_master_remote_cmds, "CONTINUE");
                                 }
                             }
-                        else
+                        else {
+                            if (sim_rem_monitor &&      /* monitoring command? */
+                                sim_rem_single_mode[i] &&
+                                find_ctab (allowed_monitor_remote_cmds, gbuf))
+                                in_place = TRUE;        /* run it right here */
                             stat = SCPE_REMOTE;         /* force processing outside of sim_instr() */
+                            }
                         }
                     }
                 }
@@ -1019,7 +1137,9 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
         sim_rem_active_number = -1;
         if ((stat != SCPE_OK) && (stat != SCPE_REMOTE))
             stat = _sim_rem_message (gbuf, stat);
-        _sim_rem_log_out (lp);
+        if ((stat != SCPE_REMOTE) &&                    /* output now unless deferred */
+            !(cmdp && (cmdp->action == &x_step_cmd)))
+            _sim_rem_log_out (lp, stat);
         if (master_session && !sim_rem_master_mode) {
             sim_rem_single_mode[i] = TRUE;
             return SCPE_STOP;
@@ -1069,6 +1189,8 @@ for (i=(was_active_command ? sim_rem_cmd_active_line : 0);
         if ((cmdp && (cmdp->action == &x_step_cmd)) ||
             (stat == SCPE_REMOTE)) {
             sim_rem_cmd_active_line = i;
+            if (in_place)                               /* monitoring command? */
+                sim_remote_process_command ();          /*   execute without leaving sim_instr */
             break;
             }
         }
@@ -1086,7 +1208,8 @@ if (sim_rem_cmd_active_line != -1) {
     if (steps)
         sim_activate(uptr, steps);                      /* check again after 'steps' instructions */
     else
-        return SCPE_REMOTE;                             /* force sim_instr() to exit to process command */
+        if (!in_place)                                  /* output is sent on the next activation */
+            return SCPE_REMOTE;                         /* force sim_instr() to exit to process command */
     }
 else
     sim_activate_after(uptr, 100000);                   /* check again in 100 milliaeconds */
@@ -1180,11 +1303,23 @@ sim_rem_single_mode = (t_bool *)realloc (sim_rem_single_mode, sizeof(*sim_rem_si
 memset (sim_rem_single_mode, 0, sizeof(*sim_rem_single_mode)*lines);
 sim_rem_read_timeouts = (uint32 *)realloc (sim_rem_read_timeouts, sizeof(*sim_rem_read_timeouts)*lines);
 memset (sim_rem_read_timeouts, 0, sizeof(*sim_rem_read_timeouts)*lines);
+sim_rem_framed = (t_bool *)realloc (sim_rem_framed, sizeof(*sim_rem_framed)*lines);
+memset (sim_rem_framed, 0, sizeof(*sim_rem_framed)*lines);
+sim_rem_frame_tags = (char *)realloc (sim_rem_frame_tags, REM_TAG_SIZE*lines);
+memset (sim_rem_frame_tags, 0, REM_TAG_SIZE*lines);
 sim_rem_command_buf = (char *)realloc (sim_rem_command_buf, 4*CBUFSIZE+1);
 memset (sim_rem_command_buf, 0, 4*CBUFSIZE+1);
 return SCPE_OK;
 }
 
+static t_stat sim_set_rem_monitor (int32 flag, CONST char *cptr)
+{
+if (cptr && *cptr)
+    return SCPE_2MARG;
+sim_rem_monitor = (flag != 0);
+return SCPE_OK;
+}
+
 static t_stat sim_set_rem_timeout (int32 flag, CONST char *cptr)
 {
 int32 timeout;
@@ -1456,6 +1591,14 @@ if (!sim_quiet) {
     }
 if (sim_deb_switches & SWMASK ('N'))
     sim_deb_switches &= ~SWMASK ('N');          /* Only process the -N flag initially */
+if (sim_deb_switches & SWMASK ('B')) {          /* buffered by a writer thread? */
+    r = sim_debug_ring_start (0);
+    if (r != SCPE_OK)
+        sim_deb_switches &= ~SWMASK ('B');
+    else
+        if (!sim_quiet)
+            sim_printf ("   Debug messages are buffered and written by a separate thread\n");
+    }
 
 return SCPE_OK;
 }
@@ -1472,6 +1615,10 @@ if (sim_deb == NULL)                                    /* no debug? */
     return SCPE_OK;
 
 if (sim_deb == sim_log) {                               /* debug is log */
+    if (saved_deb_switches & SWMASK ('B')) {
+        sim_debug_ring_stop ();                         /* write buffered messages */
+        sim_debug_ring_start (0);
+        }
     fflush (sim_deb);                                   /* fflush is the best we can do */
     return SCPE_OK;
     }
@@ -1496,6 +1643,7 @@ if (cptr && (*cptr != 0))                               /* now eol? */
     return SCPE_2MARG;
 if (sim_deb == NULL)                                    /* no debug? */
     return SCPE_OK;
+sim_debug_ring_stop ();                                 /* write buffered messages */
 sim_close_logfile (&sim_deb_ref);
 sim_deb = NULL;
 sim_deb_switches = 0;
@@ -1521,6 +1669,7 @@ if (sim_deb) {
         fprintf (st, "   Debug messages display time of day as hh:mm:ss.msec%s\n", sim_deb_switches & SWMASK ('R') ? " relative to the start of debugging" : "");
     if (sim_deb_switches & SWMASK ('A'))
         fprintf (st, "   Debug messages display time of day as seconds.msec%s\n", sim_deb_switches & SWMASK ('R') ? " relative to the start of debugging" : "");
+    sim_debug_ring_show (st);
     for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
         if (!(dptr->flags & DEV_DIS) &&
             (dptr->flags & DEV_DEBUG) &&
@@ -1946,14 +2095,200 @@ t_stat sim_show_cons_send_input (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag,
 return sim_show_send_input (st, &sim_con_send);
 }
 
+/* Buffered console output
+
+   When enabled, console output characters are collected and written with a
+   single host call when a newline is output, the buffer fills, the oldest
+   character has waited sim_con_obuf_ms, the keyboard is polled, or the
+   simulator stops.  Telnet and serial consoles defer tmxr_poll_tx the same
+   way.  The first character held schedules the CON-OBUF unit, so a prompt
+   without a newline still goes out on time while the guest waits.
+*/
+
+#define CON_OBUF_SIZE   4096
+
+static t_bool sim_con_obuf_enab = FALSE;                    /* output buffering enabled */
+static uint32 sim_con_obuf_ms = 10;                         /* max msec output is held */
+static int32 sim_con_obuf_cnt = 0;                          /* characters held */
+static double sim_con_obuf_time = 0.0;                      /* host time of oldest held char */
+static char sim_con_obuf[CON_OBUF_SIZE];
+
+static t_stat sim_con_obuf_svc (UNIT *uptr);
+
+static UNIT sim_con_obuf_unit = { UDATA (&sim_con_obuf_svc, 0, 0) };
+
+static DEVICE sim_con_obuf_dev = {
+    "CON-OBUF", &sim_con_obuf_unit, NULL, NULL, 
+    1, 0, 0, 0, 0, 0, 
+    NULL, NULL, NULL, NULL, NULL, NULL, 
+    NULL, DEV_NOSAVE, 0, NULL};
+
+/* Write out whatever has been held since the unit was scheduled */
+
+static t_stat sim_con_obuf_svc (UNIT *uptr)
+{
+sim_putchar_flush ();
+return SCPE_OK;
+}
+
+/* Count a character just made pending; return TRUE if it can be held */
+
+static t_bool sim_con_obuf_held (int32 c)
+{
+if (!sim_con_obuf_enab)
+    return FALSE;
+if (sim_con_obuf_cnt++ == 0) {
+    sim_con_obuf_time = sim_host_time ();
+    if (!sim_is_active (&sim_con_obuf_unit))            /* flush it by the deadline */
+        sim_activate_after (&sim_con_obuf_unit, sim_con_obuf_ms * 1000);
+    }
+else
+    if ((sim_host_time () - sim_con_obuf_time) * 1000.0 >= sim_con_obuf_ms)
+        return FALSE;                                       /* deadline passed */
+return ((c != '\n') && (sim_con_obuf_cnt < CON_OBUF_SIZE));
+}
+
+void sim_putchar_flush (void)
+{
+if (sim_con_obuf_cnt == 0)
+    return;
+if ((sim_con_tmxr.master == 0) &&                           /* not Telnet? */
+    (sim_con_ldsc.serport == 0))                            /* and not serial port */
+    sim_os_putbuf (sim_con_obuf, sim_con_obuf_cnt);
+else
+    tmxr_poll_tx (&sim_con_tmxr);
+sim_con_obuf_cnt = 0;
+}
+
+static t_stat sim_set_cons_outbuf (int32 flag, CONST char *cptr)
+{
+int32 val;
+t_stat r;
+
+sim_putchar_flush ();
+if (flag == 0) {
+    if (cptr && *cptr)
+        return SCPE_2MARG;
+    sim_con_obuf_enab = FALSE;
+    return SCPE_OK;
+    }
+if (cptr && *cptr) {
+    val = (int32) get_uint (cptr, 10, 1000, &r);
+    if ((r != SCPE_OK) || (val == 0))
+        return SCPE_ARG;
+    sim_con_obuf_ms = val;
+    }
+sim_con_obuf_enab = TRUE;
+return SCPE_OK;
+}
+
+static t_stat sim_show_cons_outbuf (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (sim_con_obuf_enab)
+    fprintf (st, "Output buffered, held at most %d msec\n", sim_con_obuf_ms);
+else
+    fprintf (st, "Output unbuffered\n");
+return SCPE_OK;
+}
+
+/* Console input journal
+
+   SET CONSOLE JOURNAL=file records each character typed at the console
+   with the simulated time it was taken.  SET CONSOLE REPLAY=file feeds
+   the same characters back at the same simulated times, ignoring the
+   keyboard apart from the WRU character, so a run can be repeated
+   exactly.  Characters injected by SEND are not recorded since the
+   script that sent them will send them again.
+*/
+
+static FILE *sim_con_jrnl = NULL;                       /* journal file */
+static char sim_con_jrnl_name[CBUFSIZE];                /* its name */
+static t_bool sim_con_jrnl_replay = FALSE;              /* replaying it */
+static double sim_con_jrnl_time;                        /* time of next char */
+static int32 sim_con_jrnl_char;                         /* next char to replay */
+
+static void sim_con_jrnl_next (void)
+{
+if (fscanf (sim_con_jrnl, "%lf %o", &sim_con_jrnl_time, &sim_con_jrnl_char) != 2) {
+    fclose (sim_con_jrnl);                              /* end of journal */
+    sim_con_jrnl = NULL;
+    sim_con_jrnl_replay = FALSE;
+    }
+}
+
+static t_stat sim_set_cons_journal (int32 flag, CONST char *cptr)
+{
+char gbuf[CBUFSIZE];
+
+if (flag == 0) {
+    if (cptr && *cptr)
+        return SCPE_2MARG;
+    }
+else {
+    if ((cptr == NULL) || (*cptr == 0))
+        return SCPE_2FARG;
+    cptr = get_glyph_nc (cptr, gbuf, 0);                /* get file name */
+    if (*cptr != 0)
+        return SCPE_2MARG;
+    }
+if (sim_con_jrnl) {                                     /* close current one */
+    fclose (sim_con_jrnl);
+    sim_con_jrnl = NULL;
+    sim_con_jrnl_replay = FALSE;
+    }
+if (flag == 0)
+    return SCPE_OK;
+sim_con_jrnl = sim_fopen (gbuf, (flag == 1) ? "w" : "r");
+if (sim_con_jrnl == NULL)
+    return SCPE_OPENERR;
+strcpy (sim_con_jrnl_name, gbuf);
+if (flag == 2) {
+    sim_con_jrnl_replay = TRUE;
+    sim_con_jrnl_next ();
+    }
+return SCPE_OK;
+}
+
+static t_stat sim_show_cons_journal (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr)
+{
+if (sim_con_jrnl == NULL)
+    fprintf (st, "No console journal\n");
+else
+    fprintf (st, "%s console input %s \"%s\"\n",
+                 sim_con_jrnl_replay ? "Replaying" : "Recording",
+                 sim_con_jrnl_replay ? "from" : "to", sim_con_jrnl_name);
+return SCPE_OK;
+}
+
 /* Poll for character */
 
+static t_stat sim_poll_kbd_host (void);
+
 t_stat sim_poll_kbd (void)
 {
 t_stat c;
 
+sim_putchar_flush ();                                       /* make prompts visible */
 if (sim_send_poll_data (&sim_con_send, &c))                 /* injected input characters available? */
     return c;
+if (sim_con_jrnl_replay) {
+    sim_poll_kbd_host ();                                   /* only for WRU */
+    if (!sim_con_jrnl_replay || (sim_gtime () < sim_con_jrnl_time))
+        return SCPE_OK;
+    c = sim_con_jrnl_char | SCPE_KFLAG;
+    sim_con_jrnl_next ();
+    return c;
+    }
+c = sim_poll_kbd_host ();
+if (sim_con_jrnl && (c & SCPE_KFLAG))
+    fprintf (sim_con_jrnl, "%.0f %o\n", sim_gtime (), c & ~SCPE_KFLAG);
+return c;
+}
+
+static t_stat sim_poll_kbd_host (void)
+{
+t_stat c;
+
 if (!sim_rem_master_mode) {
     if ((sim_con_ldsc.rxbps) &&                             /* rate limiting && */
         (sim_gtime () < sim_con_ldsc.rxnexttime))           /* too soon? */
@@ -1994,6 +2329,12 @@ if ((sim_con_tmxr.master == 0) &&                       /* not Telnet? */
     (sim_con_ldsc.serport == 0)) {                      /* and not serial port */
     if (sim_log)                                        /* log file? */
         fputc (c, sim_log);
+    if (sim_con_obuf_enab) {                            /* buffering output? */
+        sim_con_obuf[sim_con_obuf_cnt] = (char)c;
+        if (!sim_con_obuf_held (c))
+            sim_putchar_flush ();
+        return SCPE_OK;
+        }
     return sim_os_putchar (c);                          /* in-window version */
     }
 if (!sim_con_ldsc.conn) {                               /* no Telnet or serial connection? */
@@ -2003,7 +2344,10 @@ if (!sim_con_ldsc.conn) {                               /* no Telnet or serial c
         sim_con_ldsc.rcve = 1;                          /* rcv enabled */
     }
 tmxr_putc_ln (&sim_con_ldsc, c);                        /* output char */
-tmxr_poll_tx (&sim_con_tmxr);                           /* poll xmt */
+if (!sim_con_obuf_held (c)) {                           /* can't defer? */
+    sim_con_obuf_cnt = 0;
+    tmxr_poll_tx (&sim_con_tmxr);                       /* poll xmt */
+    }
 return SCPE_OK;
 }
 
@@ -2016,6 +2360,12 @@ if ((sim_con_tmxr.master == 0) &&                       /* not Telnet? */
     (sim_con_ldsc.serport == 0)) {                      /* and not serial port */
     if (sim_log)                                        /* log file? */
         fputc (c, sim_log);
+    if (sim_con_obuf_enab) {                            /* buffering output? */
+        sim_con_obuf[sim_con_obuf_cnt] = (char)c;
+        if (!sim_con_obuf_held (c))
+            sim_putchar_flush ();
+        return SCPE_OK;
+        }
     return sim_os_putchar (c);                          /* in-window version */
     }
 if (!sim_con_ldsc.conn) {                               /* no Telnet or serial connection? */
@@ -2027,7 +2377,10 @@ if (!sim_con_ldsc.conn) {                               /* no Telnet or serial c
 if (sim_con_ldsc.xmte == 0)                             /* xmt disabled? */
     r = SCPE_STALL;
 else r = tmxr_putc_ln (&sim_con_ldsc, c);               /* no, Telnet output */
-tmxr_poll_tx (&sim_con_tmxr);                           /* poll xmt */
+if ((r != SCPE_OK) || !sim_con_obuf_held (c)) {         /* can't defer? */
+    sim_con_obuf_cnt = 0;
+    tmxr_poll_tx (&sim_con_tmxr);                       /* poll xmt */
+    }
 return r;                                               /* return status */
 }
 
@@ -2231,6 +2584,7 @@ t_stat sim_ttinit (void)
 {
 sim_con_tmxr.ldsc->mp = &sim_con_tmxr;
 sim_register_internal_device (&sim_con_telnet);
+sim_register_internal_device (&sim_con_obuf_dev);
 tmxr_startup ();
 return sim_os_ttinit ();
 }
@@ -2283,11 +2637,13 @@ else
     pthread_mutex_unlock (&sim_tmxr_poll_lock);
 #endif
 tmxr_stop_poll ();
+sim_putchar_flush ();                                   /* write held output */
 return sim_os_ttcmd ();
 }
 
 t_stat sim_ttclose (void)
 {
+sim_putchar_flush ();
 tmxr_shutdown ();
 return sim_os_ttclose ();
 }
@@ -2465,6 +2821,15 @@ if ((status != SS$_NORMAL) || (iosb.status != SS$_NORMAL))
 return SCPE_OK;
 }
 
+static t_stat sim_os_putbuf (const char *buf, int32 len)
+{
+t_stat r = SCPE_OK;
+
+while ((len-- > 0) && (r == SCPE_OK))
+    r = sim_os_putchar ((uint8)*buf++);
+return r;
+}
+
 /* Win32 routines */
 
 #elif defined (_WIN32)
@@ -2635,6 +3000,15 @@ if (c != 0177) {
 return SCPE_OK;
 }
 
+static t_stat sim_os_putbuf (const char *buf, int32 len)
+{
+t_stat r = SCPE_OK;
+
+while ((len-- > 0) && (r == SCPE_OK))
+    r = sim_os_putchar ((uint8)*buf++);
+return r;
+}
+
 /* OS/2 routines, from Bruce Ray and Holger Veit */
 
 #elif defined (__OS2__)
@@ -2716,6 +3090,15 @@ if (c != 0177) {
 return SCPE_OK;
 }
 
+static t_stat sim_os_putbuf (const char *buf, int32 len)
+{
+t_stat r = SCPE_OK;
+
+while ((len-- > 0) && (r == SCPE_OK))
+    r = sim_os_putchar ((uint8)*buf++);
+return r;
+}
+
 /* Metrowerks CodeWarrior Macintosh routines, from Louis Chretien and
    Peter Schorn */
 
@@ -2902,6 +3285,15 @@ if (c != 0177) {
 return SCPE_OK;
 }
 
+static t_stat sim_os_putbuf (const char *buf, int32 len)
+{
+t_stat r = SCPE_OK;
+
+while ((len-- > 0) && (r == SCPE_OK))
+    r = sim_os_putchar ((uint8)*buf++);
+return r;
+}
+
 /* BSD UNIX routines */
 
 #elif defined (BSDTTY)
@@ -3018,6 +3410,20 @@ write (1, &c, 1);
 return SCPE_OK;
 }
 
+static t_stat sim_os_putbuf (const char *buf, int32 len)
+{
+int32 n;
+
+while (len > 0) {
+    n = (int32)write (1, buf, len);
+    if (n <= 0)
+        return SCPE_TTOERR;
+    buf += n;
+    len -= n;
+    }
+return SCPE_OK;
+}
+
 /* POSIX UNIX routines, from Leendert Van Doorn */
 
 #else
@@ -3156,6 +3562,20 @@ c = out;
 return SCPE_OK;
 }
 
+static t_stat sim_os_putbuf (const char *buf, int32 len)
+{
+int32 n;
+
+while (len > 0) {
+    n = (int32)write (1, buf, len);
+    if (n <= 0)
+        return SCPE_TTOERR;
+    buf += n;
+    len -= n;
+    }
+return SCPE_OK;
+}
+
 #endif
 
 /* Decode a string.
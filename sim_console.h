@@ -116,6 +116,7 @@ t_stat sim_set_noconsole_port (void);
 t_stat sim_poll_kbd (void);
 t_stat sim_putchar (int32 c);
 t_stat sim_putchar_s (int32 c);
+void sim_putchar_flush (void);
 t_stat sim_ttinit (void);
 t_stat sim_ttrun (void);
 t_stat sim_ttcmd (void);
@@ -289,7 +289,6 @@ typedef uint32          t_addr;
 
 /* System independent definitions */
 
-#define FLIP_SIZE       (1 << 16)                       /* flip buf size */
 #if !defined (PATH_MAX)                                 /* usually in limits */
 #define PATH_MAX        512
 #endif
@@ -423,6 +422,7 @@ typedef struct EXPECT EXPECT;
 typedef struct SEND SEND;
 typedef struct DEBTAB DEBTAB;
 typedef struct FILEREF FILEREF;
+typedef struct MEMDESC MEMDESC;
 typedef struct BITFIELD BITFIELD;
 
 typedef t_stat (*ACTIVATE_API)(UNIT *unit, int32 interval);
@@ -465,6 +465,7 @@ struct DEVICE {
                                                         /* attach help */
     void *help_ctx;                                     /* Context available to help routines */
     const char          *(*description)(DEVICE *dptr);  /* Device Description */
+    MEMDESC             *memory;                        /* bulk memory descriptor */
     };
 
 /* Device flags */
@@ -538,6 +539,12 @@ struct UNIT {
     void                *up7;                           /* device specific */
     void                *up8;                           /* device specific */
     void                *tmxr;                          /* TMXR linkage */
+    double              q_dispatches;                   /* events dispatched */
+    /* Event queue heap control */
+    /* These fields are only meaningful when the event queue is a heap */
+    double              q_due;                          /* absolute due time */
+    t_uint64            q_seq;                          /* insertion sequence */
+    int32               q_index;                        /* heap position */
 #ifdef SIM_ASYNCH_IO
     void                (*a_check_completion)(UNIT *);
     t_bool              (*a_is_active)(UNIT *);
@@ -750,6 +757,19 @@ struct EXPECT {
     uint8               *buf;                           /* buffer of output data which has produced */
     uint32              buf_ins;                        /* buffer insertion point for the next output data */
     uint32              buf_size;                       /* buffer size */
+    int32               *ac_goto;                       /* literal rule automaton transitions */
+    int32               *ac_rule;                       /* first literal rule ending in each state */
+    int32               ac_states;                      /* automaton states, 0 = not compiled */
+    int32               ac_state;                       /* current automaton state */
+    int32               regex_rules;                    /* count of regular expression rules */
+#if defined(USE_REGEX)
+    regex_t             regex;                          /* all regular expression rules combined */
+    t_bool              regex_ok;                       /* combined expression is valid */
+#endif
+    double              compiles;                       /* times the rules were compiled */
+    double              chars;                          /* characters checked */
+    double              regex_execs;                    /* regular expression evaluations */
+    double              matches;                        /* rules matched */
     };
 
 /* Send Context */
@@ -793,6 +813,41 @@ struct FILEREF {
     int32               refcount;                       /* reference count */
     };
 
+/* Bulk memory descriptor
+
+   A device whose memory unit is a flat array of directly stored values
+   can describe it so SAVE and RESTORE transfer it with single reads and
+   writes rather than calling examine and deposit for every location.
+   Each element must be SZ_D bytes wide, hold exactly the value examine
+   returns, and the device address increment must be 1.  Addresses below
+   first (registers that examine and deposit map elsewhere, say) are
+   still transferred through examine and deposit.
+*/
+
+struct MEMDESC {
+    uint32              unit;                           /* memory unit number */
+    void                *base;                          /* element for address 0 */
+    size_t              width;                          /* bytes per element */
+    t_addr              size;                           /* elements in array */
+    t_addr              first;                          /* first address held in the array */
+    };
+
+/* Memory dirty page tracking
+
+   A simulator which registers a dirty page map for a memory unit with
+   sim_dirty_register must mark every page it changes, including changes
+   made by DMA devices and loaders.  SAVE -I then only records the pages
+   changed since the last SAVE or RESTORE.  Pages are sized in units of
+   the memory's address increment.
+*/
+
+#define SIM_DIRTY_V_PG  10                              /* log2 page size */
+#define SIM_DIRTY_PGSIZE (1u << SIM_DIRTY_V_PG)
+#define SIM_DIRTY_MAPSIZE(n) ((((n) >> SIM_DIRTY_V_PG) + 32) / 32)
+#define SIM_DIRTY_SET(map,a) \
+    (map)[((uint32)(a)) >> (SIM_DIRTY_V_PG + 5)] |= (1u << ((((uint32)(a)) >> SIM_DIRTY_V_PG) & 31))
+#define SIM_DIRTY_TEST(map,pg) (((map)[((uint32)(pg)) >> 5] >> (((uint32)(pg)) & 31)) & 1)
+
 /* 
    The following macros exist to help populate structure contents
 
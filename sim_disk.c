@@ -48,6 +48,8 @@ Public routines:
    sim_disk_show_fmt         show disk format
    sim_disk_set_capac        set disk capacity
    sim_disk_show_capac       show disk capacity
+   sim_disk_set_cache        set sector cache size
+   sim_disk_show_cache       show sector cache size and statistics
    sim_disk_set_async        enable asynchronous operation
    sim_disk_clr_async        disable asynchronous operation
    sim_disk_data_trace       debug support
@@ -87,15 +89,48 @@ Internal routines:
 #include <pthread.h>
 #endif
 
+/* Units a device's capacity is given in: bytes, 16 bit words, or 36 bit
+   words each held in a 64 bit container word (the PDP-10 drives) */
+
+#define DK_CAPAC_FACTOR(dptr) ((((dptr)->dwidth / (dptr)->aincr) == 16) ? 2 : \
+                               ((((dptr)->dwidth / (dptr)->aincr) == 36) ? 8 : 1))
+
 struct disk_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
     uint32              dbit;               /* debugging bit */
     uint32              sector_size;        /* Disk Sector Size (of the pseudo disk) */
-    uint32              capac_factor;       /* Units of Capacity (2 = word, 1 = byte) */
+    uint32              capac_factor;       /* Units of Capacity (8 = 36b word, 2 = word, 1 = byte) */
     uint32              xfer_element_size;  /* Disk Bus Transfer size (1 - byte, 2 - word, 4 - longword) */
     uint32              storage_sector_size;/* Sector size of the containing storage */
     uint32              removable;          /* Removable device flag */
     uint32              auto_format;        /* Format determined dynamically */
+    uint8               *map_base;          /* SIMH format container mapped into memory (ATTACH -P) */
+    size_t              map_size;           /* bytes mapped */
+    t_bool              map_writable;       /* mapping may be stored into */
+    FILE                *ovl_base;          /* base image of an overlay container (ATTACH -D on a SIMH disk) */
+    uint8               *ovl_map;           /* sectors present in the overlay, one bit each */
+    t_lba               ovl_sectors;        /* sectors covered by the map */
+    t_offset            ovl_size;           /* disk size in bytes */
+    t_offset            ovl_data;           /* offset of sector 0 in the overlay file */
+    uint32              cache_slots;        /* Sector cache size in sectors (0 = no cache) */
+    uint32              cache_used;         /* slots in use */
+    uint8               *cache_data;        /* cached sector contents */
+    t_lba               *cache_lba;         /* sector held by each slot */
+    uint8               *cache_dirty;       /* slot modified since written to the container */
+    int32               *cache_hash;        /* hash bucket heads */
+    int32               *cache_hnext;       /* hash chain links */
+    uint32              cache_hmask;        /* hash bucket mask */
+    int32               *cache_prev;        /* LRU list links */
+    int32               *cache_next;
+    int32               cache_mru;          /* most recently used slot */
+    int32               cache_lru;          /* least recently used slot */
+    uint32              cache_ndirty;       /* count of dirty slots */
+    uint32              cache_dirty_ms;     /* time the cache last went from clean to dirty */
+    t_lba               cache_seq;          /* sector following the previous read */
+    uint32              cache_hits;         /* sectors read from the cache */
+    uint32              cache_misses;       /* sectors read from the container */
+    uint32              cache_readahead;    /* sectors read ahead */
+    uint32              cache_writebacks;   /* sectors written back */
 #if defined _WIN32
     HANDLE              disk_handle;        /* OS specific Raw device handle */
 #endif
@@ -108,13 +143,19 @@ struct disk_context {
     pthread_cond_t      io_cond;
     pthread_cond_t      io_done;
     pthread_cond_t      startup_cond;
-    int                 io_dop;
-    uint8               *buf;
-    t_seccnt            *rsects;
-    t_seccnt            sects;
-    t_lba               lba;
-    DISK_PCALLBACK      callback;
-    t_stat              io_status;
+#define DISK_AIO_DEPTH  16                  /* requests outstanding per unit */
+    struct disk_aio_request {
+        int                 dop;
+        uint8               *buf;
+        t_seccnt            *rsects;
+        t_seccnt            sects;
+        t_lba               lba;
+        DISK_PCALLBACK      callback;
+        t_stat              status;
+        }               io_queue[DISK_AIO_DEPTH];
+    uint32              io_enq;             /* requests queued */
+    uint32              io_svc;             /* requests performed */
+    uint32              io_cmp;             /* completions delivered */
 #endif
     };
 
@@ -127,27 +168,8 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;   \
 if ((!callback) || !ctx->asynch_io)
 
 #define AIO_CALL(op, _lba, _buf, _rsects, _sects,  _callback)   \
-    if (ctx->asynch_io) {                                       \
-        struct disk_context *ctx =                              \
-                      (struct disk_context *)uptr->disk_ctx;    \
-                                                                \
-        pthread_mutex_lock (&ctx->io_lock);                     \
-                                                                \
-        sim_debug (ctx->dbit, ctx->dptr,                        \
-      "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d)\n",\
-                op, (int)(uptr-ctx->dptr->units), _lba, _sects);\
-                                                                \
-        if (ctx->callback)                                      \
-            abort(); /* horrible mistake, stop */               \
-        ctx->io_dop = op;                                       \
-        ctx->lba = _lba;                                        \
-        ctx->buf = _buf;                                        \
-        ctx->sects = _sects;                                    \
-        ctx->rsects = _rsects;                                  \
-        ctx->callback = _callback;                              \
-        pthread_cond_signal (&ctx->io_cond);                    \
-        pthread_mutex_unlock (&ctx->io_lock);                   \
-        }                                                       \
+    if (ctx->asynch_io)                                         \
+        _disk_queue (uptr, op, _lba, _buf, _rsects, _sects, _callback);\
     else                                                        \
         if (_callback)                                          \
             (_callback) (uptr, r);
@@ -158,6 +180,43 @@ if ((!callback) || !ctx->asynch_io)
 #define DOP_WSEC  2             /* sim_disk_wrsect_a */
 #define DOP_IAVL  3             /* sim_disk_isavailable_a */
 
+static void _disk_completion_dispatch (UNIT *uptr);
+
+/* Queue a request for the unit's I/O thread.  Several requests may be
+   outstanding; they are performed in the order queued and their callbacks
+   are delivered in the same order.  If the queue is full, wait for the
+   oldest request to complete and deliver its callback before queueing. */
+
+static void _disk_queue (UNIT *uptr, int op, t_lba lba, uint8 *buf, t_seccnt *rsects, t_seccnt sects, DISK_PCALLBACK callback)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_aio_request *req;
+
+pthread_mutex_lock (&ctx->io_lock);
+
+sim_debug (ctx->dbit, ctx->dptr, "sim_disk AIO_CALL(op=%d, unit=%d, lba=0x%X, sects=%d, queued=%d)\n",
+           op, (int)(uptr-ctx->dptr->units), lba, sects, (int)(ctx->io_enq - ctx->io_cmp));
+
+while ((ctx->io_enq - ctx->io_cmp) >= DISK_AIO_DEPTH) {
+    while (ctx->io_svc == ctx->io_cmp)
+        pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
+    pthread_mutex_unlock (&ctx->io_lock);
+    _disk_completion_dispatch (uptr);
+    pthread_mutex_lock (&ctx->io_lock);
+    }
+req = &ctx->io_queue[ctx->io_enq % DISK_AIO_DEPTH];
+req->dop = op;
+req->lba = lba;
+req->buf = buf;
+req->sects = sects;
+req->rsects = rsects;
+req->callback = callback;
+req->status = SCPE_OK;
+++ctx->io_enq;
+pthread_cond_signal (&ctx->io_cond);
+pthread_mutex_unlock (&ctx->io_lock);
+}
+
 static void *
 _disk_io(void *arg)
 {
@@ -177,24 +236,28 @@ sim_debug (ctx->dbit, ctx->dptr, "_disk_io(unit=%d) starting\n", (int)(uptr-ctx-
 
 pthread_mutex_lock (&ctx->io_lock);
 pthread_cond_signal (&ctx->startup_cond);   /* Signal we're ready to go */
-while (ctx->asynch_io) {
-    pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
-    if (ctx->io_dop == DOP_DONE)
+while (1) {
+    struct disk_aio_request *req;
+
+    while (ctx->asynch_io && (ctx->io_svc == ctx->io_enq))
+        pthread_cond_wait (&ctx->io_cond, &ctx->io_lock);
+    if (ctx->io_svc == ctx->io_enq)                     /* shutting down and nothing queued? */
         break;
+    req = &ctx->io_queue[ctx->io_svc % DISK_AIO_DEPTH];
     pthread_mutex_unlock (&ctx->io_lock);
-    switch (ctx->io_dop) {
+    switch (req->dop) {
         case DOP_RSEC:
-            ctx->io_status = sim_disk_rdsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            req->status = sim_disk_rdsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_WSEC:
-            ctx->io_status = sim_disk_wrsect (uptr, ctx->lba, ctx->buf, ctx->rsects, ctx->sects);
+            req->status = sim_disk_wrsect (uptr, req->lba, req->buf, req->rsects, req->sects);
             break;
         case DOP_IAVL:
-            ctx->io_status = sim_disk_isavailable (uptr);
+            req->status = sim_disk_isavailable (uptr);
             break;
         }
     pthread_mutex_lock (&ctx->io_lock);
-    ctx->io_dop = DOP_DONE;
+    ++ctx->io_svc;
     pthread_cond_signal (&ctx->io_done);
     sim_activate (uptr, ctx->asynch_io_latency);
     }
@@ -211,25 +274,28 @@ return NULL;
    routine is to put the unit in proper condition to digest what may have
    occurred in the asynchrconous thread.
   
-   Since disk processing only handles a single I/O at a time to a
-   particular disk device (due to using stdio for the SimH Disk format
-   and stdio doesn't have an atomic seek+(read|write) operation),
-   we have the opportunity to possibly detect improper attempts to
-   issue multiple concurrent I/O requests. */
+   The I/O thread performs a unit's requests one at a time (stdio, which
+   the SimH Disk format uses, doesn't have an atomic seek+(read|write)
+   operation), so every request completed since the last dispatch is
+   delivered here, oldest first. */
 static void _disk_completion_dispatch (UNIT *uptr)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-DISK_PCALLBACK callback = ctx->callback;
 
-sim_debug (ctx->dbit, ctx->dptr, "_disk_completion_dispatch(unit=%d, dop=%d, callback=%p)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop, ctx->callback);
-
-if (ctx->io_dop != DOP_DONE)
-    abort();                                            /* horribly wrong, stop */
+pthread_mutex_lock (&ctx->io_lock);
+while (ctx->io_cmp != ctx->io_svc) {
+    struct disk_aio_request *req = &ctx->io_queue[ctx->io_cmp % DISK_AIO_DEPTH];
+    DISK_PCALLBACK callback = req->callback;
+    t_stat status = req->status;
 
-if (ctx->callback && ctx->io_dop == DOP_DONE) {
-    ctx->callback = NULL;
-    callback (uptr, ctx->io_status);
+    ++ctx->io_cmp;
+    pthread_mutex_unlock (&ctx->io_lock);
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_completion_dispatch(unit=%d, callback=%p, status=%d)\n", (int)(uptr-ctx->dptr->units), callback, status);
+    if (callback)
+        callback (uptr, status);
+    pthread_mutex_lock (&ctx->io_lock);
     }
+pthread_mutex_unlock (&ctx->io_lock);
 }
 
 static t_bool _disk_is_active (UNIT *uptr)
@@ -237,8 +303,8 @@ static t_bool _disk_is_active (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug (ctx->dbit, ctx->dptr, "_disk_is_active(unit=%d, dop=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop);
-    return (ctx->io_dop != DOP_DONE);
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_is_active(unit=%d, queued=%d)\n", (int)(uptr-ctx->dptr->units), (int)(ctx->io_enq - ctx->io_svc));
+    return (ctx->io_enq != ctx->io_svc);
     }
 return FALSE;
 }
@@ -248,10 +314,10 @@ static void _disk_cancel (UNIT *uptr)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 if (ctx) {
-    sim_debug (ctx->dbit, ctx->dptr, "_disk_cancel(unit=%d, dop=%d)\n", (int)(uptr-ctx->dptr->units), ctx->io_dop);
+    sim_debug (ctx->dbit, ctx->dptr, "_disk_cancel(unit=%d, queued=%d)\n", (int)(uptr-ctx->dptr->units), (int)(ctx->io_enq - ctx->io_svc));
     if (ctx->asynch_io) {
         pthread_mutex_lock (&ctx->io_lock);
-        while (ctx->io_dop != DOP_DONE)
+        while (ctx->io_enq != ctx->io_svc)
             pthread_cond_wait (&ctx->io_done, &ctx->io_lock);
         pthread_mutex_unlock (&ctx->io_lock);
         }
@@ -427,6 +493,8 @@ t_offset sim_disk_size (UNIT *uptr)
 {
 switch (DK_GET_FMT (uptr)) {                            /* case on format */
     case DKUF_F_STD:                                    /* SIMH format */
+        if (uptr->disk_ctx && ((struct disk_context *)uptr->disk_ctx)->ovl_base)
+            return ((struct disk_context *)uptr->disk_ctx)->ovl_size;
         return sim_fsize_ex (uptr->fileref);
     case DKUF_F_VHD:                                    /* VHD format */
         return sim_vhd_disk_size (uptr->fileref);
@@ -504,6 +572,656 @@ return SCPE_OK;
 #endif
 }
 
+/* Sector cache
+
+   An optional LRU cache of whole sectors, sized with SET <unit> CACHE=size.
+   Reads are satisfied from the cache where possible; a miss that continues
+   a sequential run reads ahead DK_CACHE_READAHEAD further sectors.  Writes
+   only update the cache and are written back when the slot is reused, a
+   second after the first unwritten change (from the DSK-CACHE unit's
+   event, so an idle guest's data still reaches the container), when the
+   simulator stops (the unit's io_flush routine) and on detach.  The cache holds the data as
+   returned by sim_disk_rdsect, so it works with every container format.
+*/
+
+#define DK_CACHE_READAHEAD  32              /* sectors read ahead on a sequential miss */
+#define DK_CACHE_FLUSH_MS   1000            /* maximum age of unwritten data */
+#define DK_CACHE_MAX_RUN    128             /* maximum sectors per write back */
+
+static struct disk_cache_setting {          /* CACHE= settings, kept across attaches */
+    UNIT                *uptr;
+    t_offset            bytes;
+    } *disk_cache_settings = NULL;
+static int disk_cache_setting_count = 0;
+
+static t_stat _sim_disk_rdsect_nocache (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects);
+static t_stat _sim_disk_wrsect_nocache (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects);
+static t_stat _disk_cache_writeback (UNIT *uptr, int32 only_slot);
+static t_stat _disk_cache_flush_svc (UNIT *uptr);
+static void _sim_disk_flush_container (UNIT *uptr);
+
+static UNIT sim_disk_cache_unit = { UDATA (&_disk_cache_flush_svc, 0, 0) };
+
+static DEVICE sim_disk_cache_dev = {
+    "DSK-CACHE", &sim_disk_cache_unit, NULL, NULL, 
+    1, 0, 0, 0, 0, 0, 
+    NULL, NULL, NULL, NULL, NULL, NULL, 
+    NULL, DEV_NOSAVE, 0, NULL};
+
+/* Write back every cache whose oldest unwritten change has aged out */
+
+static t_stat _disk_cache_flush_svc (UNIT *uptr)
+{
+uint32 now = sim_os_msec ();
+uint32 wait = DK_CACHE_FLUSH_MS;
+t_bool pending = FALSE;
+int i;
+
+for (i = 0; i < disk_cache_setting_count; i++) {
+    UNIT *duptr = disk_cache_settings[i].uptr;
+    struct disk_context *ctx = (struct disk_context *)duptr->disk_ctx;
+    uint32 age;
+
+    if (!(duptr->flags & UNIT_ATT) || (ctx == NULL) || (ctx->cache_ndirty == 0))
+        continue;
+    age = now - ctx->cache_dirty_ms;
+    if (age < DK_CACHE_FLUSH_MS) {
+        if (DK_CACHE_FLUSH_MS - age < wait)
+            wait = DK_CACHE_FLUSH_MS - age;
+        pending = TRUE;
+        continue;
+        }
+#if defined (SIM_ASYNCH_IO)
+    if (ctx->asynch_io) {                               /* the I/O thread uses the cache too */
+        pthread_mutex_lock (&ctx->io_lock);
+        if (ctx->io_enq == ctx->io_svc)                 /* idle, and held so while locked */
+            _sim_disk_flush_container (duptr);
+        pthread_mutex_unlock (&ctx->io_lock);
+        if (ctx->cache_ndirty) {                        /* busy, try again shortly */
+            if (DK_CACHE_FLUSH_MS / 10 < wait)
+                wait = DK_CACHE_FLUSH_MS / 10;
+            pending = TRUE;
+            }
+        continue;
+        }
+#endif
+    _sim_disk_flush_container (duptr);
+    }
+if (pending)
+    sim_activate_after (uptr, wait * 1000);
+return SCPE_OK;
+}
+
+static struct disk_cache_setting *_disk_cache_setting (UNIT *uptr)
+{
+int i;
+
+for (i = 0; i < disk_cache_setting_count; i++)
+    if (disk_cache_settings[i].uptr == uptr)
+        return &disk_cache_settings[i];
+return NULL;
+}
+
+static uint32 _disk_cache_bucket (struct disk_context *ctx, t_lba lba)
+{
+return (uint32)(lba ^ (lba >> 13)) & ctx->cache_hmask;
+}
+
+static int32 _disk_cache_find (struct disk_context *ctx, t_lba lba)
+{
+int32 slot = ctx->cache_hash[_disk_cache_bucket (ctx, lba)];
+
+while ((slot >= 0) && (ctx->cache_lba[slot] != lba))
+    slot = ctx->cache_hnext[slot];
+return slot;
+}
+
+static void _disk_cache_unlink (struct disk_context *ctx, int32 slot)
+{
+if (ctx->cache_prev[slot] >= 0)
+    ctx->cache_next[ctx->cache_prev[slot]] = ctx->cache_next[slot];
+else
+    ctx->cache_mru = ctx->cache_next[slot];
+if (ctx->cache_next[slot] >= 0)
+    ctx->cache_prev[ctx->cache_next[slot]] = ctx->cache_prev[slot];
+else
+    ctx->cache_lru = ctx->cache_prev[slot];
+}
+
+static void _disk_cache_touch (struct disk_context *ctx, int32 slot)
+{
+if (ctx->cache_mru == slot)
+    return;
+_disk_cache_unlink (ctx, slot);
+ctx->cache_prev[slot] = -1;
+ctx->cache_next[slot] = ctx->cache_mru;
+if (ctx->cache_mru >= 0)
+    ctx->cache_prev[ctx->cache_mru] = slot;
+ctx->cache_mru = slot;
+if (ctx->cache_lru < 0)
+    ctx->cache_lru = slot;
+}
+
+static int _disk_cache_lba_compare (const void *pa, const void *pb)
+{
+t_lba a = *(const t_lba *)pa;
+t_lba b = *(const t_lba *)pb;
+
+return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+/* Write back dirty sectors, coalescing runs of adjacent sectors.  With
+   only_slot >= 0 just the run containing that slot is written. */
+
+static t_stat _disk_cache_writeback (UNIT *uptr, int32 only_slot)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_lba *lbas;
+uint8 *run;
+uint32 i, count = 0, n;
+t_stat r, stat = SCPE_OK;
+
+if (ctx->cache_ndirty == 0)
+    return SCPE_OK;
+if (only_slot >= 0) {
+    t_lba first = ctx->cache_lba[only_slot], last = first;
+    int32 slot;
+
+    lbas = (t_lba *)malloc (2 * DK_CACHE_MAX_RUN * sizeof (*lbas));
+    if (lbas == NULL)
+        return SCPE_MEM;
+    while ((first > 0) && (last - first + 1 < DK_CACHE_MAX_RUN) &&
+           ((slot = _disk_cache_find (ctx, first - 1)) >= 0) && ctx->cache_dirty[slot])
+        --first;
+    while ((last - first + 1 < DK_CACHE_MAX_RUN) &&
+           ((slot = _disk_cache_find (ctx, last + 1)) >= 0) && ctx->cache_dirty[slot])
+        ++last;
+    for (; first <= last; first++)
+        lbas[count++] = first;
+    }
+else {
+    lbas = (t_lba *)malloc (ctx->cache_ndirty * sizeof (*lbas));
+    if (lbas == NULL)
+        return SCPE_MEM;
+    for (i = 0; i < ctx->cache_used; i++)
+        if (ctx->cache_dirty[i])
+            lbas[count++] = ctx->cache_lba[i];
+    qsort (lbas, count, sizeof (*lbas), _disk_cache_lba_compare);
+    }
+run = (uint8 *)malloc (DK_CACHE_MAX_RUN * ctx->sector_size);
+if (run == NULL) {
+    free (lbas);
+    return SCPE_MEM;
+    }
+for (i = 0; i < count; i += n) {
+    uint32 j;
+
+    for (n = 1; (i + n < count) && (n < DK_CACHE_MAX_RUN) && (lbas[i + n] == lbas[i] + n); n++)
+        ;
+    for (j = 0; j < n; j++) {
+        int32 slot = _disk_cache_find (ctx, lbas[i + j]);
+
+        memcpy (run + j * ctx->sector_size, ctx->cache_data + (size_t)slot * ctx->sector_size, ctx->sector_size);
+        ctx->cache_dirty[slot] = 0;
+        }
+    r = _sim_disk_wrsect_nocache (uptr, lbas[i], run, NULL, n);
+    if (r != SCPE_OK)
+        stat = r;
+    ctx->cache_ndirty -= n;
+    ctx->cache_writebacks += n;
+    }
+free (run);
+free (lbas);
+return stat;
+}
+
+/* Get a slot for a sector, evicting the least recently used one if needed */
+
+static int32 _disk_cache_alloc (UNIT *uptr, t_lba lba, t_stat *stat)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+int32 slot, *link;
+
+if (ctx->cache_used < ctx->cache_slots) {             /* free slot, link it as most recent */
+    slot = (int32)ctx->cache_used++;
+    ctx->cache_prev[slot] = -1;
+    ctx->cache_next[slot] = ctx->cache_mru;
+    if (ctx->cache_mru >= 0)
+        ctx->cache_prev[ctx->cache_mru] = slot;
+    else
+        ctx->cache_lru = slot;
+    ctx->cache_mru = slot;
+    }
+else {
+    slot = ctx->cache_lru;
+    if (ctx->cache_dirty[slot]) {
+        t_stat r = _disk_cache_writeback (uptr, slot);
+
+        if (r != SCPE_OK)
+            *stat = r;
+        }
+    link = &ctx->cache_hash[_disk_cache_bucket (ctx, ctx->cache_lba[slot])];
+    while (*link != slot)
+        link = &ctx->cache_hnext[*link];
+    *link = ctx->cache_hnext[slot];
+    _disk_cache_touch (ctx, slot);
+    }
+ctx->cache_lba[slot] = lba;
+ctx->cache_dirty[slot] = 0;
+ctx->cache_hnext[slot] = ctx->cache_hash[_disk_cache_bucket (ctx, lba)];
+ctx->cache_hash[_disk_cache_bucket (ctx, lba)] = slot;
+return slot;
+}
+
+static void _disk_cache_free (struct disk_context *ctx)
+{
+free (ctx->cache_data);
+free (ctx->cache_lba);
+free (ctx->cache_dirty);
+free (ctx->cache_hash);
+free (ctx->cache_hnext);
+free (ctx->cache_prev);
+free (ctx->cache_next);
+ctx->cache_data = NULL;
+ctx->cache_lba = NULL;
+ctx->cache_dirty = NULL;
+ctx->cache_hash = ctx->cache_hnext = ctx->cache_prev = ctx->cache_next = NULL;
+ctx->cache_slots = ctx->cache_used = ctx->cache_ndirty = 0;
+}
+
+/* (Re)build the cache of an attached unit from its CACHE= setting */
+
+static t_stat _disk_cache_setup (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache_setting *set = _disk_cache_setting (uptr);
+t_stat r = SCPE_OK;
+uint32 slots, buckets;
+
+if (ctx->cache_slots) {
+    r = _disk_cache_writeback (uptr, -1);
+    _disk_cache_free (ctx);
+    }
+if ((set == NULL) || (set->bytes < ctx->sector_size))
+    return r;
+slots = (uint32)(set->bytes / ctx->sector_size);
+for (buckets = 1; buckets < slots; buckets <<= 1)
+    ;
+ctx->cache_data = (uint8 *)malloc ((size_t)slots * ctx->sector_size);
+ctx->cache_lba = (t_lba *)calloc (slots, sizeof (*ctx->cache_lba));
+ctx->cache_dirty = (uint8 *)calloc (slots, sizeof (*ctx->cache_dirty));
+ctx->cache_hnext = (int32 *)calloc (slots, sizeof (*ctx->cache_hnext));
+ctx->cache_prev = (int32 *)calloc (slots, sizeof (*ctx->cache_prev));
+ctx->cache_next = (int32 *)calloc (slots, sizeof (*ctx->cache_next));
+ctx->cache_hash = (int32 *)malloc (buckets * sizeof (*ctx->cache_hash));
+if (!ctx->cache_data || !ctx->cache_lba || !ctx->cache_dirty || !ctx->cache_hnext ||
+    !ctx->cache_prev || !ctx->cache_next || !ctx->cache_hash) {
+    _disk_cache_free (ctx);
+    return SCPE_MEM;
+    }
+memset (ctx->cache_hash, 0xFF, buckets * sizeof (*ctx->cache_hash));    /* all buckets empty (-1) */
+ctx->cache_hmask = buckets - 1;
+ctx->cache_slots = slots;
+ctx->cache_used = ctx->cache_ndirty = 0;
+ctx->cache_mru = ctx->cache_lru = -1;
+ctx->cache_seq = 0;
+ctx->cache_hits = ctx->cache_misses = ctx->cache_readahead = ctx->cache_writebacks = 0;
+return r;
+}
+
+static t_stat _disk_cache_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_lba total = (t_lba)((uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1)));
+t_seccnt i = 0, done = 0;
+t_stat r = SCPE_OK;
+
+while (i < sects) {
+    int32 slot = _disk_cache_find (ctx, lba + i);
+    t_seccnt miss, ra = 0, got = 0, j;
+    uint8 *tbuf;
+
+    if (slot >= 0) {                                    /* hit */
+        memcpy (buf + i * ctx->sector_size, ctx->cache_data + (size_t)slot * ctx->sector_size, ctx->sector_size);
+        _disk_cache_touch (ctx, slot);
+        ++ctx->cache_hits;
+        ++done;
+        ++i;
+        continue;
+        }
+    for (miss = 1; (i + miss < sects) && (_disk_cache_find (ctx, lba + i + miss) < 0); miss++)
+        ;
+    if ((lba + i == ctx->cache_seq) && (i + miss == sects)) {/* sequential run continues? */
+        ra = DK_CACHE_READAHEAD;
+        if (ra > ctx->cache_slots / 4)
+            ra = ctx->cache_slots / 4;
+        if (lba + sects + ra > total)
+            ra = (lba + sects < total) ? total - (lba + sects) : 0;
+        }
+    tbuf = (uint8 *)malloc ((miss + ra) * ctx->sector_size);
+    if (tbuf == NULL)
+        return SCPE_MEM;
+    r = _sim_disk_rdsect_nocache (uptr, lba + i, tbuf, &got, miss + ra);
+    if (r == SCPE_OK) {
+        memcpy (buf + i * ctx->sector_size, tbuf, miss * ctx->sector_size);
+        for (j = 0; (j < got) && (j < miss + ra); j++) {
+            if ((j >= miss) &&                          /* read ahead sector */
+                (_disk_cache_find (ctx, lba + i + j) >= 0))
+                continue;                               /* already cached, possibly newer */
+            slot = _disk_cache_alloc (uptr, lba + i + j, &r);
+            memcpy (ctx->cache_data + (size_t)slot * ctx->sector_size, tbuf + j * ctx->sector_size, ctx->sector_size);
+            }
+        ctx->cache_misses += miss;
+        ctx->cache_readahead += (got > miss) ? got - miss : 0;
+        done += (got < miss) ? got : miss;
+        }
+    free (tbuf);
+    if (r != SCPE_OK)
+        break;
+    i += miss;
+    }
+ctx->cache_seq = lba + sects;
+if (sectsread)
+    *sectsread = done;
+return r;
+}
+
+static t_stat _disk_cache_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_seccnt i;
+t_stat r = SCPE_OK;
+
+for (i = 0; i < sects; i++) {
+    int32 slot = _disk_cache_find (ctx, lba + i);
+
+    if (slot < 0)
+        slot = _disk_cache_alloc (uptr, lba + i, &r);
+    else
+        _disk_cache_touch (ctx, slot);
+    memcpy (ctx->cache_data + (size_t)slot * ctx->sector_size, buf + i * ctx->sector_size, ctx->sector_size);
+    if (!ctx->cache_dirty[slot]) {
+        if (ctx->cache_ndirty++ == 0) {
+            ctx->cache_dirty_ms = sim_os_msec ();
+            if (!sim_is_active (&sim_disk_cache_unit))  /* age it out from an event */
+                sim_activate_after (&sim_disk_cache_unit, DK_CACHE_FLUSH_MS * 1000);
+            }
+        ctx->cache_dirty[slot] = 1;
+        }
+    }
+if (sectswritten)
+    *sectswritten = sects;
+if ((sim_os_msec () - ctx->cache_dirty_ms) >= DK_CACHE_FLUSH_MS) {
+    t_stat wr = _disk_cache_writeback (uptr, -1);
+
+    if (r == SCPE_OK)
+        r = wr;
+    }
+return r;
+}
+
+/* Set the sector cache size (SET <unit> CACHE=size{K|M|G}, CACHE=0 disables) */
+
+t_stat sim_disk_set_cache (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
+{
+struct disk_cache_setting *set;
+t_offset bytes;
+char *eptr;
+
+if ((cptr == NULL) || (*cptr == '\0'))
+    return SCPE_ARG;
+bytes = (t_offset)strtotv (cptr, (CONST char **)&eptr, 10);
+if (eptr == cptr)
+    return SCPE_ARG;
+switch (toupper (*eptr)) {
+    case 'G':
+        bytes *= 1024;
+    case 'M':
+        bytes *= 1024;
+    case 'K':
+        bytes *= 1024;
+        ++eptr;
+        break;
+    case '\0':
+        break;
+    default:
+        return SCPE_ARG;
+    }
+if ((*eptr != '\0') && (toupper (*eptr) != 'B'))
+    return SCPE_ARG;
+set = _disk_cache_setting (uptr);
+if (set == NULL) {
+    if (bytes == 0)
+        return SCPE_OK;
+    disk_cache_settings = (struct disk_cache_setting *)realloc (disk_cache_settings, (disk_cache_setting_count + 1) * sizeof (*disk_cache_settings));
+    if (disk_cache_settings == NULL)
+        return SCPE_MEM;
+    set = &disk_cache_settings[disk_cache_setting_count++];
+    set->uptr = uptr;
+    }
+set->bytes = bytes;
+sim_register_internal_device (&sim_disk_cache_dev);
+if (uptr->flags & UNIT_ATT)
+    return _disk_cache_setup (uptr);
+return SCPE_OK;
+}
+
+t_stat sim_disk_show_cache (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+struct disk_cache_setting *set = _disk_cache_setting (uptr);
+
+if ((set == NULL) || (set->bytes == 0)) {
+    fprintf (st, "no cache");
+    return SCPE_OK;
+    }
+if (set->bytes % (1024*1024) == 0)
+    fprintf (st, "cache=%dM", (int)(set->bytes / (1024*1024)));
+else
+    fprintf (st, "cache=%dK", (int)(set->bytes / 1024));
+if ((uptr->flags & UNIT_ATT) && ctx && ctx->cache_slots) {
+    uint32 reads = ctx->cache_hits + ctx->cache_misses;
+
+    fprintf (st, ", %u of %u sectors used, %u hits, %u misses", ctx->cache_used, ctx->cache_slots, ctx->cache_hits, ctx->cache_misses);
+    if (reads)
+        fprintf (st, " (%.1f%% hit)", (100.0 * ctx->cache_hits) / reads);
+    fprintf (st, ", %u read ahead, %u written back, %u dirty", ctx->cache_readahead, ctx->cache_writebacks, ctx->cache_ndirty);
+    }
+return SCPE_OK;
+}
+
+/* Overlay containers
+
+   An overlay holds only the sectors written since it was created from a
+   read-only base image (normally a SIMH format disk shared by several
+   simulator instances).  It is created with ATTACH -D <overlay> <base>
+   when the base isn't a VHD.  The file is laid out as:
+
+        0       "SIMHOVL1"
+        8       sector size (uint32)
+        16      disk size in bytes (uint64)
+        24      offset of sector 0's data (uint64)
+        32      base image path, NUL terminated
+        4096    map, one bit per sector, set when the overlay holds it
+        data    sector n at data + n * sector size
+
+   Data is written at its natural offset, so sectors never written are
+   holes in the host file on file systems that support sparse files.  The
+   map is kept in memory and each change is written through after the
+   data it describes.  Numeric fields are little endian (sim_fread).
+*/
+
+#define OVL_MAGIC       "SIMHOVL1"
+#define OVL_HDR_SIZE    4096
+#define OVL_PATH_MAX    (OVL_HDR_SIZE - 32)
+
+static t_bool _ovl_present (struct disk_context *ctx, t_lba lba)
+{
+return (lba < ctx->ovl_sectors) && ((ctx->ovl_map[lba >> 3] >> (lba & 7)) & 1);
+}
+
+static t_stat _sim_disk_ovl_create (const char *ovlname, const char *basename, t_offset min_size, uint32 sector_size)
+{
+FILE *base, *ovl;
+t_offset size, data;
+uint32 val32;
+t_uint64 val64;
+char path[OVL_PATH_MAX];
+uint8 zeros[512];
+size_t mapsize, n;
+
+if (strlen (basename) >= sizeof (path))
+    return SCPE_ARG;
+base = sim_fopen (basename, "rb");
+if (base == NULL)
+    return SCPE_OPENERR;
+size = sim_fsize_ex (base);
+fclose (base);
+if (size < min_size)
+    size = min_size;
+size = ((size + sector_size - 1) / sector_size) * sector_size;
+mapsize = (size_t)(((size / sector_size) + 7) / 8);
+data = ((OVL_HDR_SIZE + mapsize + OVL_HDR_SIZE - 1) / OVL_HDR_SIZE) * OVL_HDR_SIZE;
+ovl = sim_fopen (ovlname, "wb");
+if (ovl == NULL)
+    return SCPE_OPENERR;
+memset (path, 0, sizeof (path));
+strcpy (path, basename);
+memset (zeros, 0, sizeof (zeros));
+fwrite (OVL_MAGIC, 1, 8, ovl);
+val32 = sector_size;
+sim_fwrite (&val32, sizeof (val32), 1, ovl);
+val32 = 0;
+sim_fwrite (&val32, sizeof (val32), 1, ovl);
+val64 = (t_uint64)size;
+sim_fwrite (&val64, sizeof (val64), 1, ovl);
+val64 = (t_uint64)data;
+sim_fwrite (&val64, sizeof (val64), 1, ovl);
+fwrite (path, 1, sizeof (path), ovl);
+for (n = 0; n < mapsize; n += sizeof (zeros))          /* empty map */
+    fwrite (zeros, 1, ((mapsize - n) < sizeof (zeros)) ? (mapsize - n) : sizeof (zeros), ovl);
+if (ferror (ovl)) {
+    fclose (ovl);
+    remove (ovlname);
+    return SCPE_IOERR;
+    }
+fclose (ovl);
+return SCPE_OK;
+}
+
+/* Check whether a newly opened SIMH format container is an overlay and,
+   if so, load its map and open the base image */
+
+static t_stat _sim_disk_ovl_open (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+char magic[8], path[OVL_PATH_MAX];
+uint32 ssize, pad;
+t_uint64 size, data;
+size_t mapsize;
+
+if ((sim_fseeko (uptr->fileref, 0, SEEK_SET)) ||
+    (fread (magic, 1, sizeof (magic), uptr->fileref) != sizeof (magic)) ||
+    (memcmp (magic, OVL_MAGIC, sizeof (magic)) != 0))
+    return SCPE_OK;                                     /* ordinary SIMH disk */
+if ((sim_fread (&ssize, sizeof (ssize), 1, uptr->fileref) != 1) ||
+    (sim_fread (&pad, sizeof (pad), 1, uptr->fileref) != 1) ||
+    (sim_fread (&size, sizeof (size), 1, uptr->fileref) != 1) ||
+    (sim_fread (&data, sizeof (data), 1, uptr->fileref) != 1) ||
+    (fread (path, 1, sizeof (path), uptr->fileref) != sizeof (path)))
+    return SCPE_FMT;
+path[sizeof (path) - 1] = '\0';
+if (ssize != ctx->sector_size)
+    return sim_messagef (SCPE_FMT, "Overlay sector size %u doesn't match the device's %u\n", ssize, ctx->sector_size);
+ctx->ovl_sectors = (t_lba)(size / ssize);
+mapsize = (ctx->ovl_sectors + 7) / 8;
+ctx->ovl_map = (uint8 *)calloc (mapsize + 1, 1);
+if (ctx->ovl_map == NULL)
+    return SCPE_MEM;
+if ((sim_fseeko (uptr->fileref, OVL_HDR_SIZE, SEEK_SET)) ||
+    (fread (ctx->ovl_map, 1, mapsize, uptr->fileref) != mapsize)) {
+    free (ctx->ovl_map);
+    ctx->ovl_map = NULL;
+    return SCPE_FMT;
+    }
+ctx->ovl_base = sim_fopen (path, "rb");
+if (ctx->ovl_base == NULL) {
+    free (ctx->ovl_map);
+    ctx->ovl_map = NULL;
+    return sim_messagef (SCPE_OPENERR, "Can't open overlay base image: %s\n", path);
+    }
+ctx->ovl_size = (t_offset)size;
+ctx->ovl_data = (t_offset)data;
+return SCPE_OK;
+}
+
+static void _sim_disk_ovl_close (struct disk_context *ctx)
+{
+if (ctx->ovl_base)
+    fclose (ctx->ovl_base);
+free (ctx->ovl_map);
+ctx->ovl_base = NULL;
+ctx->ovl_map = NULL;
+}
+
+static t_stat _sim_disk_ovl_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_seccnt i, n;
+
+for (i = 0; i < sects; i += n) {                        /* runs from the same file */
+    t_bool present = _ovl_present (ctx, lba + i);
+    FILE *f = present ? uptr->fileref : ctx->ovl_base;
+    t_offset da = (present ? ctx->ovl_data : 0) + ((t_offset)(lba + i)) * ctx->sector_size;
+    uint8 *bptr = buf + i * ctx->sector_size;
+    size_t elems, got = 0;
+
+    for (n = 1; (i + n < sects) && (_ovl_present (ctx, lba + i + n) == present); n++)
+        ;
+    elems = (n * ctx->sector_size) / ctx->xfer_element_size;
+    if (sim_fseeko (f, da, SEEK_SET) == 0)
+        got = sim_fread (bptr, ctx->xfer_element_size, elems, f);
+    if (got < elems)                                    /* beyond the end of the base */
+        memset (bptr + got * ctx->xfer_element_size, 0, (elems - got) * ctx->xfer_element_size);
+    if (ferror (f))
+        return SCPE_IOERR;
+    }
+if (sectsread)
+    *sectsread = sects;
+return SCPE_OK;
+}
+
+static t_stat _sim_disk_ovl_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_lba first, last, s;
+size_t elems = (sects * ctx->sector_size) / ctx->xfer_element_size;
+t_bool changed = FALSE;
+
+if (sectswritten)
+    *sectswritten = 0;
+if (lba + sects > ctx->ovl_sectors)
+    return SCPE_IOERR;
+if ((sim_fseeko (uptr->fileref, ctx->ovl_data + ((t_offset)lba) * ctx->sector_size, SEEK_SET)) ||
+    (sim_fwrite (buf, ctx->xfer_element_size, elems, uptr->fileref) != elems))
+    return SCPE_IOERR;
+for (s = lba; s < lba + sects; s++)
+    if (!_ovl_present (ctx, s)) {
+        ctx->ovl_map[s >> 3] |= (uint8)(1 << (s & 7));
+        changed = TRUE;
+        }
+if (changed) {                                          /* write the changed part of the map */
+    first = lba >> 3;
+    last = (lba + sects - 1) >> 3;
+    if ((sim_fseeko (uptr->fileref, OVL_HDR_SIZE + (t_offset)first, SEEK_SET)) ||
+        (fwrite (&ctx->ovl_map[first], 1, last - first + 1, uptr->fileref) != last - first + 1))
+        return SCPE_IOERR;
+    }
+if (sectswritten)
+    *sectswritten = sects;
+return SCPE_OK;
+}
+
 /* Read Sectors */
 
 static t_stat _sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
@@ -515,8 +1233,16 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
+if (ctx->ovl_base)
+    return _sim_disk_ovl_rdsect (uptr, lba, buf, sectsread, sects);
 da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
+if (ctx->map_base && ((da + tbc) <= (t_offset)ctx->map_size)) {/* mapped container? */
+    sim_buf_copy_swapped (buf, ctx->map_base + (size_t)da, ctx->xfer_element_size, tbc/ctx->xfer_element_size);
+    if (sectsread)
+        *sectsread = sects;
+    return SCPE_OK;
+    }
 if (sectsread)
     *sectsread = 0;
 err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
@@ -533,12 +1259,21 @@ return err;
 
 t_stat sim_disk_rdsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
 {
-t_stat r;
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
-t_seccnt sread = 0;
 
 sim_debug (ctx->dbit, ctx->dptr, "sim_disk_rdsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
+if (ctx->cache_slots)
+    return _disk_cache_rdsect (uptr, lba, buf, sectsread, sects);
+return _sim_disk_rdsect_nocache (uptr, lba, buf, sectsread, sects);
+}
+
+static t_stat _sim_disk_rdsect_nocache (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectsread, t_seccnt sects)
+{
+t_stat r;
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_seccnt sread = 0;
+
 if ((sects == 1) &&                                     /* Single sector reads */
     (lba >= (uptr->capac*ctx->capac_factor)/(ctx->sector_size/((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1)))) {/* beyond the end of the disk */
     memset (buf, '\0', ctx->sector_size);               /* are bad block management efforts - zero buffer */
@@ -631,8 +1366,16 @@ struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
 sim_debug (ctx->dbit, ctx->dptr, "_sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
 
+if (ctx->ovl_base)
+    return _sim_disk_ovl_wrsect (uptr, lba, buf, sectswritten, sects);
 da = ((t_offset)lba) * ctx->sector_size;
 tbc = sects * ctx->sector_size;
+if (ctx->map_writable && ((da + tbc) <= (t_offset)ctx->map_size)) {/* mapped container? */
+    sim_buf_copy_swapped (ctx->map_base + (size_t)da, buf, ctx->xfer_element_size, tbc/ctx->xfer_element_size);
+    if (sectswritten)
+        *sectswritten = sects;
+    return SCPE_OK;
+    }
 if (sectswritten)
     *sectswritten = 0;
 err = sim_fseeko (uptr->fileref, da, SEEK_SET);          /* set pos */
@@ -648,15 +1391,24 @@ return err;
 t_stat sim_disk_wrsect (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
 {
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+sim_debug (ctx->dbit, ctx->dptr, "sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
+
+if (ctx->cache_slots)
+    return _disk_cache_wrsect (uptr, lba, buf, sectswritten, sects);
+return _sim_disk_wrsect_nocache (uptr, lba, buf, sectswritten, sects);
+}
+
+static t_stat _sim_disk_wrsect_nocache (UNIT *uptr, t_lba lba, uint8 *buf, t_seccnt *sectswritten, t_seccnt sects)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 uint32 f = DK_GET_FMT (uptr);
 t_stat r;
 uint8 *tbuf = NULL;
 
-sim_debug (ctx->dbit, ctx->dptr, "sim_disk_wrsect(unit=%d, lba=0x%X, sects=%d)\n", (int)(uptr-ctx->dptr->units), lba, sects);
-
 if (uptr->dynflags & UNIT_DISK_CHK) {
     DEVICE *dptr = find_dev_from_unit (uptr);
-    uint32 capac_factor = ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* capacity units (word: 2, byte: 1) */
+    uint32 capac_factor = DK_CAPAC_FACTOR (dptr); /* capacity units (36b word: 8, word: 2, byte: 1) */
     t_lba total_sectors = (t_lba)((uptr->capac*capac_factor)/(ctx->sector_size/((dptr->flags & DEV_SECTORS) ? 512 : 1)));
     t_lba sect;
 
@@ -810,8 +1562,6 @@ switch (DK_GET_FMT (uptr)) {                            /* case on format */
 */
 static void _sim_disk_io_flush (UNIT *uptr)
 {
-uint32 f = DK_GET_FMT (uptr);
-
 #if defined (SIM_ASYNCH_IO)
 struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
 
@@ -819,8 +1569,22 @@ sim_disk_clr_async (uptr);
 if (sim_asynch_enabled)
     sim_disk_set_async (uptr, ctx->asynch_io_latency);
 #endif
+_sim_disk_flush_container (uptr);
+}
+
+/* Write back cached sectors and push buffered data out to the container */
+
+static void _sim_disk_flush_container (UNIT *uptr)
+{
+uint32 f = DK_GET_FMT (uptr);
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+
+if (ctx->cache_ndirty)                                  /* write back cached sectors */
+    _disk_cache_writeback (uptr, -1);
 switch (f) {                                            /* case on format */
     case DKUF_F_STD:                                    /* Simh */
+        if (ctx->map_writable)
+            sim_fmap_sync (ctx->map_base, ctx->map_size);
         fflush (uptr->fileref);
         break;
     case DKUF_F_VHD:                                    /* Virtual Disk */
@@ -832,6 +1596,35 @@ switch (f) {                                            /* case on format */
         }
 }
 
+/* Map a SIMH format container into memory (ATTACH -P).  A writable
+   container shorter than the simulated disk is extended first; failure
+   just leaves the unit using file I/O. */
+
+static t_stat _sim_disk_map (UNIT *uptr)
+{
+struct disk_context *ctx = (struct disk_context *)uptr->disk_ctx;
+t_offset size = ((t_offset)uptr->capac)*ctx->capac_factor*((ctx->dptr->flags & DEV_SECTORS) ? 512 : 1);
+t_bool writable = ((uptr->flags & UNIT_RO) == 0);
+void *base;
+
+if ((size <= 0) || ((t_offset)(size_t)size != size))
+    return SCPE_MEM;
+if (sim_fsize_ex (uptr->fileref) < size) {
+    if (!writable)
+        return SCPE_FMT;
+    fflush (uptr->fileref);
+    if (((t_offset)(t_addr)size != size) ||
+        sim_set_fsize (uptr->fileref, (t_addr)size))
+        return SCPE_IOERR;
+    }
+if (sim_fmap_file (uptr->fileref, (size_t)size, writable, &base) != SCPE_OK)
+    return SCPE_IOERR;
+ctx->map_base = (uint8 *)base;
+ctx->map_size = (size_t)size;
+ctx->map_writable = writable;
+return SCPE_OK;
+}
+
 static t_stat _err_return (UNIT *uptr, t_stat stat)
 {
 free (uptr->filename);
@@ -880,6 +1673,19 @@ if (sim_switches & SWMASK ('D')) {                      /* create difference dis
     cptr = get_glyph_nc (cptr, gbuf, 0);                /* get spec */
     if (*cptr == 0)                                     /* must be more */
         return SCPE_2FARG;
+    if ((DK_GET_FMT (uptr) == DKUF_F_STD) &&            /* SIMH format base? */
+        (NULL == (vhd = sim_vhd_disk_open (cptr, "rb")))) {
+        uint32 capac_factor = DK_CAPAC_FACTOR (dptr);
+        t_stat r = _sim_disk_ovl_create (gbuf, cptr, ((t_offset)uptr->capac)*capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1), (uint32)sector_size);
+
+        if (r != SCPE_OK)
+            return sim_messagef (r, "Unable to create overlay %s on %s\n", gbuf, cptr);
+        if (!sim_quiet)
+            sim_printf ("%s%d: creating overlay '%s' on '%s'\n", sim_dname (dptr), (int)(uptr-dptr->units), gbuf, cptr);
+        return sim_disk_attach (uptr, gbuf, sector_size, xfer_element_size, dontautosize, dbit, dtype, pdp11tracksize, completion_delay);
+        }
+    if (DK_GET_FMT (uptr) == DKUF_F_STD)
+        sim_vhd_disk_close (vhd);
     vhd = sim_vhd_disk_create_diff (gbuf, cptr);
     if (vhd) {
         sim_vhd_disk_close (vhd);
@@ -911,7 +1717,7 @@ if (sim_switches & SWMASK ('C')) {                      /* create vhd disk & cop
     if (!sim_quiet) {
         sim_printf ("%s%d: creating new virtual disk '%s'\n", sim_dname (dptr), (int)(uptr-dptr->units), gbuf);
         }
-    capac_factor = ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* capacity units (word: 2, byte: 1) */
+    capac_factor = DK_CAPAC_FACTOR (dptr); /* capacity units (36b word: 8, word: 2, byte: 1) */
     vhd = sim_vhd_disk_create (gbuf, ((t_offset)uptr->capac)*capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1));
     if (!vhd) {
         return sim_messagef (r, "%s%d: can't create virtual disk '%s'\n", sim_dname (dptr), (int)(uptr-dptr->units), gbuf);
@@ -1072,7 +1878,7 @@ if ((uptr->filename == NULL) || (uptr->disk_ctx == NULL))
     return _err_return (uptr, SCPE_MEM);
 strncpy (uptr->filename, cptr, CBUFSIZE);               /* save name */
 ctx->sector_size = (uint32)sector_size;                 /* save sector_size */
-ctx->capac_factor = ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* save capacity units (word: 2, byte: 1) */
+ctx->capac_factor = DK_CAPAC_FACTOR (dptr); /* save capacity units (36b word: 8, word: 2, byte: 1) */
 ctx->xfer_element_size = (uint32)xfer_element_size;     /* save xfer_element_size */
 ctx->dptr = dptr;                                       /* save DEVICE pointer */
 ctx->dbit = dbit;                                       /* save debug bit */
@@ -1130,6 +1936,15 @@ if (DK_GET_FMT (uptr) == DKUF_F_VHD) {
         set_cmd (0, cmd);
         }
     }
+if ((DK_GET_FMT (uptr) == DKUF_F_STD) && (!created)) {  /* overlay container? */
+    t_stat r = _sim_disk_ovl_open (uptr);
+
+    if (r != SCPE_OK) {
+        fclose (uptr->fileref);
+        uptr->fileref = NULL;
+        return _err_return (uptr, r);
+        }
+    }
 uptr->flags = uptr->flags | UNIT_ATT;
 uptr->pos = 0;
 
@@ -1167,7 +1982,7 @@ if ((created) && (!copied)) {
     if (sim_switches & SWMASK ('I')) {                  /* Initialize To Sector Address */
         uint8 *init_buf = (uint8*) malloc (1024*1024);
         t_lba lba, sect;
-        uint32 capac_factor = ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* capacity units (word: 2, byte: 1) */
+        uint32 capac_factor = DK_CAPAC_FACTOR (dptr); /* capacity units (36b word: 8, word: 2, byte: 1) */
         t_seccnt sectors_per_buffer = (t_seccnt)((1024*1024)/sector_size);
         t_lba total_sectors = (t_lba)((uptr->capac*capac_factor)/(sector_size/((dptr->flags & DEV_SECTORS) ? 512 : 1)));
         t_seccnt sects = sectors_per_buffer;
@@ -1206,7 +2021,7 @@ if ((created) && (!copied)) {
 if (sim_switches & SWMASK ('K')) {
     t_stat r = SCPE_OK;
     t_lba lba, sect;
-    uint32 capac_factor = ((dptr->dwidth / dptr->aincr) == 16) ? 2 : 1; /* capacity units (word: 2, byte: 1) */
+    uint32 capac_factor = DK_CAPAC_FACTOR (dptr); /* capacity units (36b word: 8, word: 2, byte: 1) */
     t_seccnt sectors_per_buffer = (t_seccnt)((1024*1024)/sector_size);
     t_lba total_sectors = (t_lba)((uptr->capac*capac_factor)/(sector_size/((dptr->flags & DEV_SECTORS) ? 512 : 1)));
     t_seccnt sects = sectors_per_buffer;
@@ -1254,16 +2069,16 @@ if (sim_switches & SWMASK ('K')) {
     uptr->dynflags |= UNIT_DISK_CHK;
     }
 
-capac = size_function (uptr->fileref);
+capac = ctx->ovl_base ? ctx->ovl_size : size_function (uptr->fileref);
 if (capac && (capac != (t_offset)-1)) {
     if (dontautosize) {
         if ((capac < (((t_offset)uptr->capac)*ctx->capac_factor*((dptr->flags & DEV_SECTORS) ? 512 : 1))) && (DKUF_F_STD != DK_GET_FMT (uptr))) {
             if (!sim_quiet) {
                 sim_printf ("%s%d: non expandable disk %s is smaller than simulated device (", sim_dname (dptr), (int)(uptr-dptr->units), cptr);
                 sim_print_val ((t_addr)(capac/ctx->capac_factor), 10, T_ADDR_W, PV_LEFT);
-                sim_printf ("%s < ", (ctx->capac_factor == 2) ? "W" : "");
+                sim_printf ("%s < ", (ctx->capac_factor > 1) ? "W" : "");
                 sim_print_val (uptr->capac*((dptr->flags & DEV_SECTORS) ? 512 : 1), 10, T_ADDR_W, PV_LEFT);
-                sim_printf ("%s)\n", (ctx->capac_factor == 2) ? "W" : "");
+                sim_printf ("%s)\n", (ctx->capac_factor > 1) ? "W" : "");
                 }
             }
         }
@@ -1276,6 +2091,12 @@ if (capac && (capac != (t_offset)-1)) {
 sim_disk_set_async (uptr, completion_delay);
 #endif
 uptr->io_flush = _sim_disk_io_flush;
+if ((sim_switches & SWMASK ('P')) &&                    /* map into memory? */
+    (DK_GET_FMT (uptr) == DKUF_F_STD) && (!ctx->ovl_base) &&
+    (_sim_disk_map (uptr) != SCPE_OK))
+    sim_printf ("%s%d: Can't map %s into memory, using file I/O\n", sim_dname (dptr), (int)(uptr-dptr->units), cptr);
+if (_disk_cache_setup (uptr) != SCPE_OK)
+    sim_printf ("%s%d: Can't allocate sector cache\n", sim_dname (dptr), (int)(uptr-dptr->units));
 
 return SCPE_OK;
 }
@@ -1326,6 +2147,10 @@ uptr->dynflags &= ~(UNIT_NO_FIO | UNIT_DISK_CHK);
 free (uptr->filename);
 uptr->filename = NULL;
 uptr->fileref = NULL;
+_disk_cache_free (ctx);
+_sim_disk_ovl_close (ctx);
+if (ctx->map_base)
+    sim_fmap_unmap (ctx->map_base, ctx->map_size);      /* already synced by io_flush */
 free (uptr->disk_ctx);
 uptr->disk_ctx = NULL;
 uptr->io_flush = NULL;
@@ -1392,8 +2217,14 @@ fprintf (st, "                operation.\n");
 fprintf (st, "    -X          When creating a VHD, create a fixed sized VHD (vs a Dynamically\n");
 fprintf (st, "                expanding one).\n");
 fprintf (st, "    -D          Create a Differencing VHD (relative to an already existing VHD\n");
-fprintf (st, "                disk)\n");
+fprintf (st, "                disk).  If the existing disk is a SIMH format disk, create an\n");
+fprintf (st, "                overlay instead, which holds only the sectors written from then\n");
+fprintf (st, "                on and reads all others from the (unchanged) existing disk.\n");
+fprintf (st, "                    ATTACH -D <unit> <overlay> <base>\n");
 fprintf (st, "    -M          Merge a Differencing VHD into its parent VHD disk\n");
+fprintf (st, "    -P          Map a SIMH format container into memory, so transfers are\n");
+fprintf (st, "                memory copies.  The mapping is written back to the file when\n");
+fprintf (st, "                the simulator stops and on detach.\n");
 fprintf (st, "    -O          Override consistency checks when attaching differencing disks\n");
 fprintf (st, "                which have unexpected parent disk GUID or timestamps\n\n");
 fprintf (st, "    -Y          Answer Yes to prompt to overwrite last track (on disk create)\n");
@@ -785,9 +785,28 @@ void ethq_remove(ETH_QUE* que)
   }
 }
 
+static void ethq_fill_item(struct eth_item* item, int32 type, const uint8 *data, int used, size_t len, size_t crc_len, const uint8 *crc_data, int32 status)
+{
+  item->type = type;
+  item->packet.len = len;
+  item->packet.used = used;
+  item->packet.crc_len = crc_len;
+  if (len <= sizeof (item->packet.msg)) {
+    memcpy(item->packet.msg, data, ((len > crc_len) ? len : crc_len));
+    if (crc_data && (crc_len > len))
+      memcpy(&item->packet.msg[len], crc_data, ETH_CRC_SIZE);
+    }
+  else {
+    item->packet.oversize = (uint8 *)realloc (item->packet.oversize, ((len > crc_len) ? len : crc_len));
+    memcpy(item->packet.oversize, data, ((len > crc_len) ? len : crc_len));
+    if (crc_data && (crc_len > len))
+      memcpy(&item->packet.oversize[len], crc_data, ETH_CRC_SIZE);
+    }
+  item->packet.status = status;
+}
+
 void ethq_insert_data(ETH_QUE* que, int32 type, const uint8 *data, int used, size_t len, size_t crc_len, const uint8 *crc_data, int32 status)
 {
-  struct eth_item* item;
 
   /* if queue empty, set pointers to beginning */
   if (!que->count) {
@@ -809,23 +828,7 @@ void ethq_insert_data(ETH_QUE* que, int32 type, const uint8 *data, int used, siz
     que->high = que->count;
 
   /* set information in (new) tail item */
-  item = &que->item[que->tail];
-  item->type = type;
-  item->packet.len = len;
-  item->packet.used = used;
-  item->packet.crc_len = crc_len;
-  if (len <= sizeof (item->packet.msg)) {
-    memcpy(item->packet.msg, data, ((len > crc_len) ? len : crc_len));
-    if (crc_data && (crc_len > len))
-      memcpy(&item->packet.msg[len], crc_data, ETH_CRC_SIZE);
-    }
-  else {
-    item->packet.oversize = (uint8 *)realloc (item->packet.oversize, ((len > crc_len) ? len : crc_len));
-    memcpy(item->packet.oversize, data, ((len > crc_len) ? len : crc_len));
-    if (crc_data && (crc_len > len))
-      memcpy(&item->packet.oversize[len], crc_data, ETH_CRC_SIZE);
-    }
-  item->packet.status = status;
+  ethq_fill_item(&que->item[que->tail], type, data, used, len, crc_len, crc_data, status);
 }
 
 void ethq_insert(ETH_QUE* que, int32 type, ETH_PACK* pack, int32 status)
@@ -863,6 +866,10 @@ t_stat eth_write (ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
   {return SCPE_NOFNC;}
 int eth_read (ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine)
   {return SCPE_NOFNC;}
+int eth_read_batch (ETH_DEV* dev, ETH_PACK* packets, int max, ETH_PCALLBACK routine)
+  {return 0;}
+t_stat eth_set_coalesce (ETH_DEV* dev, uint32 packets, uint32 delay)
+  {return SCPE_NOFNC;}
 t_stat eth_filter (ETH_DEV* dev, int addr_count, ETH_MAC* const addresses,
                    ETH_BOOL all_multicast, ETH_BOOL promiscuous)
   {return SCPE_NOFNC;}
@@ -1493,6 +1500,9 @@ static void eth_get_nic_hw_addr(ETH_DEV* dev, const char *devname)
 /* Forward declarations */
 static void
 _eth_callback(u_char* info, const struct pcap_pkthdr* header, const u_char* data);
+#if defined (USE_READER_THREAD)
+static int _eth_rq_count (ETH_DEV* dev);
+#endif
 
 static t_stat
 _eth_write(ETH_DEV* dev, ETH_PACK* packet, ETH_PCALLBACK routine);
@@ -1672,14 +1682,26 @@ while (dev->handle) {
         break;
       }
     if ((status > 0) && (dev->asynch_io)) {
-      int wakeup_needed;
-
-      pthread_mutex_lock (&dev->lock);
-      wakeup_needed = (dev->read_queue.count != 0);
-      pthread_mutex_unlock (&dev->lock);
-      if (wakeup_needed) {
-        sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
-        sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
+      int count = _eth_rq_count (dev);
+
+      if (count != 0) {
+        if ((dev->coalesce_packets > 1) && ((uint32)count < dev->coalesce_packets)) {
+          /* Let the first packet wait a while for others to arrive so
+             the simulator can take them with one service call */
+          if (!dev->coalesce_armed) {
+            dev->coalesce_armed = 1;
+            ++dev->coalesce_wakeups;
+            sim_debug(dev->dbit, dev->dptr, "Queueing coalesced poll\n");
+            /* coalesce_delay is in uSec, the latency in instructions */
+            sim_activate_abs (dev->dptr->units, dev->asynch_io_latency +
+                              (int32)((dev->coalesce_delay * sim_timer_inst_per_sec ()) / 1000000.0));
+            }
+          }
+        else {
+          sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
+          dev->coalesce_armed = 1;
+          sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
+          }
         }
       }
     if (status < 0) {
@@ -1766,9 +1788,7 @@ int wakeup_needed;
 
 dev->asynch_io = 1;
 dev->asynch_io_latency = latency;
-pthread_mutex_lock (&dev->lock);
-wakeup_needed = (dev->read_queue.count != 0);
-pthread_mutex_unlock (&dev->lock);
+wakeup_needed = (_eth_rq_count (dev) != 0);
 if (wakeup_needed) {
   sim_debug(dev->dbit, dev->dptr, "Queueing automatic poll\n");
   sim_activate_abs (dev->dptr->units, dev->asynch_io_latency);
@@ -1790,6 +1810,24 @@ return SCPE_OK;
 #endif
 }
 
+/* Receive interrupt coalescing
+
+   With asynchronous reads enabled, the reader thread normally wakes the
+   simulator for every arriving packet.  When coalescing is enabled the
+   first packet of a burst schedules a wakeup delay uSec later, and the
+   wakeup is only brought forward once packets are queued.  Devices which
+   take the queued packets with eth_read_batch then raise one interrupt
+   per burst rather than one per packet.  packets <= 1 disables it.
+*/
+t_stat eth_set_coalesce (ETH_DEV* dev, uint32 packets, uint32 delay)
+{
+if (!dev)
+  return SCPE_IERR;
+dev->coalesce_packets = packets;
+dev->coalesce_delay = delay;
+return SCPE_OK;
+}
+
 t_stat eth_set_throttle (ETH_DEV* dev, uint32 time, uint32 burst, uint32 delay)
 {
 if (!dev)
@@ -2120,6 +2158,10 @@ strcpy(dev->name, savname);
 dev->dptr = dptr;
 dev->dbit = dbit;
 
+/* receive coalescing is off until the device asks for it */
+dev->coalesce_packets = 0;
+dev->coalesce_delay = 0;
+
 #if defined (USE_READER_THREAD)
 if (1) {
   pthread_attr_t attr;
@@ -3140,6 +3182,127 @@ eth_packet_trace(dev, response.msg, response.len, ((function == 1) ? "loopbackre
 return 1;
 }
 
+#if defined (USE_READER_THREAD)
+/* Reader thread receive queue
+
+   The reader thread is the only producer and eth_read (on the simulator
+   thread) is the only consumer of dev->read_queue.  Where the host has
+   atomic intrinsics the queue is run without the mutex: the producer fills
+   the slot at tail, the consumer empties the slot at head, and only count
+   is shared (the atomic add is also a full memory barrier).  A full queue
+   drops the arriving packet rather than the oldest one, since the producer
+   may not move head.
+*/
+#if defined (_WIN32)
+#define ETHQ_ADD(var, n) InterlockedExchangeAdd ((volatile LONG *)&(var), (n))
+#elif defined (__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#define ETHQ_ADD(var, n) __sync_fetch_and_add (&(var), (n))
+#endif
+
+static int _eth_rq_count (ETH_DEV* dev)
+{
+#if defined (ETHQ_ADD)
+return ETHQ_ADD (dev->read_queue.count, 0);
+#else
+int count;
+
+pthread_mutex_lock (&dev->lock);
+count = dev->read_queue.count;
+pthread_mutex_unlock (&dev->lock);
+return count;
+#endif
+}
+
+static void _eth_rq_insert (ETH_DEV* dev, const uint8 *data, size_t len, size_t crc_len, const uint8 *crc_data)
+{
+ETH_QUE* que = &dev->read_queue;
+#if defined (ETHQ_ADD)
+int count = ETHQ_ADD (que->count, 0);
+
+if (count >= que->max) {                /* full? drop the arrival */
+  ++que->loss;
+  return;
+  }
+ethq_fill_item (&que->item[que->tail], ETH_ITM_NORMAL, data, 0, len, crc_len, crc_data, 0);
+que->item[que->tail].arrival = sim_host_time ();
+if (++que->tail == que->max)
+  que->tail = 0;
+count = 1 + ETHQ_ADD (que->count, 1);   /* publish the filled slot */
+if (count > que->high)
+  que->high = count;
+++dev->packets_received;
+#else
+pthread_mutex_lock (&dev->lock);
+ethq_insert_data (que, ETH_ITM_NORMAL, data, 0, len, crc_len, crc_data, 0);
+que->item[que->tail].arrival = sim_host_time ();
+++dev->packets_received;
+pthread_mutex_unlock (&dev->lock);
+#endif
+}
+
+static void _eth_rq_release (ETH_QUE* que)
+{
+#if defined (ETHQ_ADD)
+struct eth_item* item = &que->item[que->head];
+
+if (item->packet.oversize) {
+  free (item->packet.oversize);
+  item->packet.oversize = NULL;
+  }
+if (++que->head == que->max)
+  que->head = 0;
+ETHQ_ADD (que->count, -1);              /* hand the slot back to the producer */
+#else
+ethq_remove (que);
+#endif
+}
+
+static int _eth_rq_remove (ETH_DEV* dev, ETH_PACK* packet)
+{
+ETH_QUE* que = &dev->read_queue;
+struct eth_item* item;
+double delay;
+
+#if !defined (ETHQ_ADD)
+pthread_mutex_lock (&dev->lock);
+#endif
+if (_eth_rq_count (dev) <= 0) {
+#if !defined (ETHQ_ADD)
+  pthread_mutex_unlock (&dev->lock);
+#endif
+  return 0;
+  }
+item = &que->item[que->head];
+packet->len = item->packet.len;
+packet->crc_len = item->packet.crc_len;
+memcpy(packet->msg, item->packet.msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
+delay = sim_host_time () - item->arrival;
+_eth_rq_release (que);
+#if !defined (ETHQ_ADD)
+pthread_mutex_unlock (&dev->lock);
+#endif
+++dev->read_queue_delivered;
+dev->read_queue_delay_sum += delay;
+if (delay > dev->read_queue_delay_max)
+  dev->read_queue_delay_max = delay;
+return 1;
+}
+
+#if defined (USE_BPF)
+static void _eth_rq_flush (ETH_DEV* dev)
+{
+#if defined (ETHQ_ADD)
+while (_eth_rq_count (dev) > 0)
+  _eth_rq_release (&dev->read_queue);
+#else
+pthread_mutex_lock (&dev->lock);
+ethq_clear (&dev->read_queue);
+pthread_mutex_unlock (&dev->lock);
+#endif
+}
+#endif /* USE_BPF */
+#endif /* USE_READER_THREAD */
+
 static void
 _eth_callback(u_char* info, const struct pcap_pkthdr* header, const u_char* data)
 {
@@ -3261,10 +3424,7 @@ if (bpf_used ? to_me : (to_me && !from_me)) {
 
     eth_packet_trace (dev, data, len, "rcvqd");
 
-    pthread_mutex_lock (&dev->lock);
-    ethq_insert_data(&dev->read_queue, ETH_ITM_NORMAL, data, 0, len, crc_len, crc_data, 0);
-    ++dev->packets_received;
-    pthread_mutex_unlock (&dev->lock);
+    _eth_rq_insert (dev, data, len, crc_len, crc_data);
     free(moved_data);
     }
 #else /* !USE_READER_THREAD */
@@ -3402,17 +3562,9 @@ if (status < 0) {
 
 #else /* USE_READER_THREAD */
 
-  status = 0;
-  pthread_mutex_lock (&dev->lock);
-  if (dev->read_queue.count > 0) {
-    ETH_ITEM* item = &dev->read_queue.item[dev->read_queue.head];
-    packet->len = item->packet.len;
-    packet->crc_len = item->packet.crc_len;
-    memcpy(packet->msg, item->packet.msg, ((packet->len > packet->crc_len) ? packet->len : packet->crc_len));
-    status = 1;
-    ethq_remove(&dev->read_queue);
-  }
-  pthread_mutex_unlock (&dev->lock);  
+  status = _eth_rq_remove (dev, packet);
+  if (!status)
+    dev->coalesce_armed = 0;            /* drained, next arrival starts a new burst */
   if ((status) && (routine))
     routine(0);
 #endif
@@ -3420,6 +3572,30 @@ if (status < 0) {
 return status;
 }
 
+/* Read up to max packets in one call, invoking the callback once when any
+   were read.  Returns the number of packets stored in packets[].
+*/
+int eth_read_batch(ETH_DEV* dev, ETH_PACK* packets, int max, ETH_PCALLBACK routine)
+{
+int count = 0;
+
+if ((!dev) || (dev->eth_api == ETH_API_NONE) || (!packets))
+  return 0;
+while ((count < max) && eth_read (dev, &packets[count], NULL))
+  ++count;
+#if defined (USE_READER_THREAD)
+if (count == max)                       /* more may still be queued */
+  dev->coalesce_armed = 0;
+#endif
+if (count) {
+  ++dev->read_batches;
+  dev->read_batch_packets += count;
+  if (routine)
+    routine(0);
+  }
+return count;
+}
+
 t_stat eth_filter(ETH_DEV* dev, int addr_count, ETH_MAC* const addresses,
                   ETH_BOOL all_multicast, ETH_BOOL promiscuous)
 {
@@ -3608,9 +3784,7 @@ if (dev->eth_api == ETH_API_PCAP) {
     pcap_freecode(&bpf);
     }
 #ifdef USE_READER_THREAD
-  pthread_mutex_lock (&dev->lock);
-  ethq_clear (&dev->read_queue); /* Empty FIFO Queue when filter list changes */
-  pthread_mutex_unlock (&dev->lock);
+  _eth_rq_flush (dev);           /* Empty FIFO Queue when filter list changes */
 #endif
   }
 #endif /* USE_BPF */
@@ -3820,8 +3994,20 @@ if (dev->throttle_count)
 fprintf(st, "  Read Queue: Count:       %d\n", dev->read_queue.count);
 fprintf(st, "  Read Queue: High:        %d\n", dev->read_queue.high);
 fprintf(st, "  Read Queue: Loss:        %d\n", dev->read_queue.loss);
+if (dev->read_queue_delivered) {
+  fprintf(st, "  Read Queue: Avg Delay:   %.1f uSec\n", 1000000.0 * dev->read_queue_delay_sum / dev->read_queue_delivered);
+  fprintf(st, "  Read Queue: Max Delay:   %.1f uSec\n", 1000000.0 * dev->read_queue_delay_max);
+  }
 fprintf(st, "  Peak Write Queue Size:   %d\n", dev->write_queue_peak);
+if (dev->coalesce_packets > 1) {
+  fprintf(st, "  Coalescing:              %d packets or %d uSec\n", dev->coalesce_packets, dev->coalesce_delay);
+  fprintf(st, "  Coalesced Wakeups:       %d\n", dev->coalesce_wakeups);
+  }
 #endif
+if (dev->read_batches) {
+  fprintf(st, "  Batched Reads:           %d\n", dev->read_batches);
+  fprintf(st, "  Avg Packets per Batch:   %.1f\n", (double)dev->read_batch_packets / dev->read_batches);
+  }
 if (dev->bpf_filter)
   fprintf(st, "  BPF Filter: %s\n", dev->bpf_filter);
 #if defined(HAVE_SLIRP_NETWORK)
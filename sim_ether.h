@@ -214,6 +214,7 @@ struct eth_item {
 #define ETH_ITM_LOOPBACK 1
 #define ETH_ITM_NORMAL   2
   struct eth_packet   packet;
+  double              arrival;                          /* host time queued by reader thread */
 };
 
 struct eth_queue {
@@ -302,10 +303,20 @@ struct eth_device {
   uint32        throttle_events;                        /* keeps track of packet arrival values */
   uint32        throttle_packet_time;                   /* time last packet was transmitted */
   uint32        throttle_count;                         /* Total Throttle Delays */
+  /* Receive interrupt coalescing parameters: */
+  uint32        coalesce_packets;                       /* packets queued before an immediate wakeup, 0/1 disables */
+  uint32        coalesce_delay;                         /* uSec the first queued packet may wait for company */
+  uint32        read_batches;                           /* eth_read_batch calls which returned packets */
+  uint32        read_batch_packets;                     /* packets returned by eth_read_batch */
 #if defined (USE_READER_THREAD)
   int           asynch_io;                              /* Asynchronous Interrupt scheduling enabled */
   int           asynch_io_latency;                      /* instructions to delay pending interrupt */
   ETH_QUE       read_queue;
+  uint32        read_queue_delivered;                   /* packets taken from read_queue */
+  double        read_queue_delay_sum;                   /* total read_queue wait (seconds) */
+  double        read_queue_delay_max;                   /* longest read_queue wait (seconds) */
+  volatile int  coalesce_armed;                         /* delayed wakeup scheduled for the queued packets */
+  uint32        coalesce_wakeups;                       /* wakeups deferred by coalescing */
   pthread_mutex_t     lock;
   pthread_t     reader_thread;                          /* Reader Thread Id */
   pthread_t     writer_thread;                          /* Writer Thread Id */
@@ -331,6 +342,8 @@ t_stat eth_write  (ETH_DEV* dev, ETH_PACK* packet,      /* write sychronous pack
                    ETH_PCALLBACK routine);              /*  callback when done */
 int eth_read      (ETH_DEV* dev, ETH_PACK* packet,      /* read single packet; */
                    ETH_PCALLBACK routine);              /*  callback when done*/
+int eth_read_batch (ETH_DEV* dev, ETH_PACK* packets,    /* read up to max packets; */
+                    int max, ETH_PCALLBACK routine);    /*  one callback when done */
 t_stat eth_filter (ETH_DEV* dev, int addr_count,        /* set filter on incoming packets */
                    ETH_MAC* const addresses,
                    ETH_BOOL all_multicast,
@@ -347,6 +360,7 @@ void eth_setcrc   (ETH_DEV* dev, int need_crc);         /* enable/disable CRC mo
 t_stat eth_set_async (ETH_DEV* dev, int latency);       /* set read behavior to be async */
 t_stat eth_clr_async (ETH_DEV* dev);                    /* set read behavior to be not async */
 t_stat eth_set_throttle (ETH_DEV* dev, uint32 time, uint32 burst, uint32 delay); /* set transmit throttle parameters */
+t_stat eth_set_coalesce (ETH_DEV* dev, uint32 packets, uint32 delay); /* set receive interrupt coalescing parameters */
 uint32 eth_crc32(uint32 crc, const void* vbuf, size_t len); /* Compute Ethernet Autodin II CRC for buffer */
 
 void eth_packet_trace (ETH_DEV* dev, const uint8 *msg, int len, const char* txt); /* trace ethernet packet header+crc */
@@ -42,6 +42,8 @@
    sim_fopen         -       open file
    sim_fread         -       endian independent read (formerly fxread)
    sim_write         -       endian independent write (formerly fxwrite)
+   sim_freadv        -       endian independent scatter read
+   sim_fwritev       -       endian independent gather write
    sim_fseek         -       conditionally extended (>32b) seek (
    sim_fseeko        -       extended seek (>32b if available)
    sim_fsize         -       get file size
@@ -52,6 +54,12 @@
    sim_buf_swap_data -       swap data elements inplace in buffer
    sim_shmem_open            create or attach to a shared memory region
    sim_shmem_close           close a shared memory region
+   sim_fmap_fixed            map part of a file copy-on-write at a fixed address
+   sim_fmap_release          replace a file mapping with a private copy
+   sim_fmap_pagesize         get the granularity of file mappings
+   sim_fmap_file             map the start of a file shared, so stores update the file
+   sim_fmap_sync             write a shared file mapping back to the file
+   sim_fmap_unmap            remove a file mapping
 
 
    sim_fopen and sim_fseek are OS-dependent.  The other routines are not.
@@ -80,6 +88,13 @@ t_bool sim_toffset_64;              /* Large File (>2GB) file I/O Support availa
    are size char, then the calls are passed directly to fread or
    fwrite.  Otherwise, these routines perform the necessary byte swaps.
    Sim_fread swaps in place, sim_fwrite uses an intermediate buffer.
+   Sim_freadv and sim_fwritev transfer several buffers in one call;
+   sim_fwritev swaps all of them into one intermediate buffer, so the
+   pieces reach the file in as few writes as possible.
+
+   Items of 2, 4 and 8 bytes, which are nearly all of them, are swapped
+   a whole item at a time; compilers turn these loops into byte swap or
+   vector instructions.
 */
 
 int32 sim_finit (void)
@@ -93,6 +108,51 @@ sim_taddr_64 = sim_toffset_64 && (sizeof(t_addr) > sizeof(int32));
 return sim_end;
 }
 
+/* Swap count items of size 2, 4 or 8 from sbuf to dbuf (which may be the
+   same buffer), return FALSE for other sizes */
+
+static t_bool _sim_buf_swap_items (void *dbuf, const void *sbuf, size_t size, size_t count)
+{
+const unsigned char *sptr = (const unsigned char *)sbuf;
+unsigned char *dptr = (unsigned char *)dbuf;
+size_t j;
+
+switch (size) {
+    case 2:
+        for (j = 0; j < count; j++, sptr += 2, dptr += 2) {
+            uint16 v;
+
+            memcpy (&v, sptr, 2);
+            v = (uint16)((v >> 8) | (v << 8));
+            memcpy (dptr, &v, 2);
+            }
+        return TRUE;
+    case 4:
+        for (j = 0; j < count; j++, sptr += 4, dptr += 4) {
+            uint32 v;
+
+            memcpy (&v, sptr, 4);
+            v = ((v >> 24) | ((v >> 8) & 0x0000FF00) |
+                 ((v << 8) & 0x00FF0000) | (v << 24));
+            memcpy (dptr, &v, 4);
+            }
+        return TRUE;
+    case 8:
+        for (j = 0; j < count; j++, sptr += 8, dptr += 8) {
+            t_uint64 v;
+
+            memcpy (&v, sptr, 8);
+            v = ((v & 0x00000000FFFFFFFFull) << 32) | (v >> 32);
+            v = ((v & 0x0000FFFF0000FFFFull) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFull);
+            v = ((v & 0x00FF00FF00FF00FFull) << 8)  | ((v >> 8)  & 0x00FF00FF00FF00FFull);
+            memcpy (dptr, &v, 8);
+            }
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
 void sim_buf_swap_data (void *bptr, size_t size, size_t count)
 {
 uint32 j;
@@ -101,6 +161,8 @@ unsigned char by, *sptr, *dptr;
 
 if (sim_end || (count == 0) || (size == sizeof (char)))
     return;
+if (_sim_buf_swap_items (bptr, bptr, size, count))
+    return;
 for (j = 0, dptr = sptr = (unsigned char *) bptr;       /* loop on items */
      j < count; j++) { 
     for (k = (int32)(size - 1); k >= (((int32) size + 1) / 2); k--) {
@@ -121,7 +183,7 @@ if ((size == 0) || (count == 0))                        /* check arguments */
 c = fread (bptr, size, count, fptr);                    /* read buffer */
 if (sim_end || (size == sizeof (char)) || (c == 0))     /* le, byte, or err? */
     return c;                                           /* done */
-sim_buf_swap_data (bptr, size, count);
+sim_buf_swap_data (bptr, size, c);                      /* swap what was read */
 return c;
 }
 
@@ -136,6 +198,8 @@ if (sim_end || (size == sizeof (char))) {
     memcpy (dptr, sptr, size * count);
     return;
     }
+if (_sim_buf_swap_items (dptr, sptr, size, count))
+    return;
 for (j = 0; j < count; j++) {                           /* loop on items */
     for (k = (int32)(size - 1); k >= 0; k--)
         *(dptr + k) = *sptr++;
@@ -154,10 +218,12 @@ if ((size == 0) || (count == 0))                        /* check arguments */
     return 0;
 if (sim_end || (size == sizeof (char)))                 /* le or byte? */
     return fwrite (bptr, size, count, fptr);            /* done */
-sim_flip = (unsigned char *)malloc(FLIP_SIZE);
+nelem = FLIP_SIZE / size;                               /* elements in buffer */
+if (nelem > count)                                      /* no bigger than needed */
+    nelem = count;
+sim_flip = (unsigned char *)malloc(nelem * size);
 if (!sim_flip)
     return 0;
-nelem = FLIP_SIZE / size;                               /* elements in buffer */
 nbuf = count / nelem;                                   /* number buffers */
 lcnt = count % nelem;                                   /* count in last buf */
 if (lcnt) nbuf = nbuf + 1;
@@ -167,7 +233,7 @@ sptr = (const unsigned char *) bptr;                    /* init input ptr */
 for (i = (int32)nbuf; i > 0; i--) {                     /* loop on buffers */
     c = (i == 1)? lcnt: nelem;
     sim_buf_copy_swapped (sim_flip, sptr, size, c);
-    sptr = sptr + size * count;
+    sptr = sptr + size * c;
     c = fwrite (sim_flip, size, c, fptr);
     if (c == 0) {
         free(sim_flip);
@@ -179,6 +245,76 @@ free(sim_flip);
 return total;
 }
 
+/* Scatter read, returns the number of bytes read */
+
+size_t sim_freadv (const SIM_FIO_VEC *vec, int nvec, FILE *fptr)
+{
+size_t c, total = 0;
+int i;
+
+for (i = 0; i < nvec; i++) {
+    c = sim_fread (vec[i].bptr, vec[i].size, vec[i].count, fptr);
+    total = total + c * vec[i].size;
+    if (c < vec[i].count)                               /* short read? */
+        break;
+    }
+return total;
+}
+
+/* Gather write, returns the number of bytes written */
+
+size_t sim_fwritev (const SIM_FIO_VEC *vec, int nvec, FILE *fptr)
+{
+size_t bytes = 0, total = 0, fill = 0, c, n, done;
+unsigned char *sim_flip;
+int i;
+
+for (i = 0; i < nvec; i++)
+    bytes = bytes + vec[i].size * vec[i].count;
+if (sim_end || (bytes == 0)) {                          /* le? */
+    for (i = 0; i < nvec; i++) {
+        c = fwrite (vec[i].bptr, 1, vec[i].size * vec[i].count, fptr);
+        total = total + c;
+        if (c < vec[i].size * vec[i].count)
+            break;
+        }
+    return total;
+    }
+if (bytes > FLIP_SIZE)
+    bytes = FLIP_SIZE;
+for (i = 0; i < nvec; i++)                              /* room for any item */
+    if (vec[i].size > bytes)
+        bytes = vec[i].size;
+sim_flip = (unsigned char *)malloc(bytes);
+if (!sim_flip)
+    return 0;
+for (i = 0; i < nvec; i++) {                            /* swap pieces into buffer */
+    const unsigned char *sptr = (const unsigned char *)vec[i].bptr;
+
+    for (done = 0; done < vec[i].count; done += n) {
+        n = (bytes - fill) / vec[i].size;               /* items that fit */
+        if (n > vec[i].count - done)
+            n = vec[i].count - done;
+        if (n == 0) {                                   /* buffer full, write it */
+            c = fwrite (sim_flip, 1, fill, fptr);
+            total = total + c;
+            if (c < fill) {
+                free(sim_flip);
+                return total;
+                }
+            fill = 0;
+            continue;
+            }
+        sim_buf_copy_swapped (sim_flip + fill, sptr + done * vec[i].size, vec[i].size, n);
+        fill = fill + n * vec[i].size;
+        }
+    }
+if (fill)
+    total = total + fwrite (sim_flip, 1, fill, fptr);
+free(sim_flip);
+return total;
+}
+
 /* Forward Declaration */
 
 t_offset sim_ftell (FILE *st);
@@ -424,6 +560,38 @@ if (shmem->hMapping != INVALID_HANDLE_VALUE)
 free (shmem);
 }
 
+t_stat sim_fmap_fixed (FILE *fptr, t_offset offset, void *addr, size_t size)
+{
+return SCPE_NOFNC;
+}
+
+t_stat sim_fmap_release (void *addr, size_t size)
+{
+return SCPE_NOFNC;
+}
+
+size_t sim_fmap_pagesize (void)
+{
+SYSTEM_INFO info;
+
+GetSystemInfo (&info);
+return (size_t)info.dwAllocationGranularity;
+}
+
+t_stat sim_fmap_file (FILE *fptr, size_t size, t_bool writable, void **addr)
+{
+return SCPE_NOFNC;
+}
+
+t_stat sim_fmap_sync (void *addr, size_t size)
+{
+return SCPE_NOFNC;
+}
+
+void sim_fmap_unmap (void *addr, size_t size)
+{
+}
+
 #else /* !defined(_WIN32) */
 #include <unistd.h>
 int sim_set_fsize (FILE *fptr, t_addr size)
@@ -450,6 +618,9 @@ return -1;
 }
 
 #include <sys/mman.h>
+#if !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
 
 struct SHMEM {
     int shm_fd;
@@ -516,4 +687,70 @@ if (shmem->shm_fd != -1)
 free (shmem);
 }
 
+/* Map size bytes of a file, starting at offset, as private copy-on-write
+   memory at addr.  Both offset and addr must be multiples of
+   sim_fmap_pagesize.  Whatever was at addr is replaced.  Pages are read
+   from the file when first touched, so the file must not change while
+   the mapping exists.
+*/
+
+t_stat sim_fmap_fixed (FILE *fptr, t_offset offset, void *addr, size_t size)
+{
+void *base;
+
+fflush (fptr);
+base = mmap (addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fileno (fptr), (off_t)offset);
+if (base == MAP_FAILED)
+    return SCPE_IOERR;
+return SCPE_OK;
+}
+
+/* Copy the current contents of a mapped region into anonymous memory at
+   the same address, so it no longer depends on the mapped file */
+
+t_stat sim_fmap_release (void *addr, size_t size)
+{
+void *save = malloc (size);
+void *base;
+
+if (save == NULL)
+    return SCPE_MEM;
+memcpy (save, addr, size);
+base = mmap (addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+if (base != MAP_FAILED)
+    memcpy (addr, save, size);
+free (save);
+return (base == MAP_FAILED) ? SCPE_IOERR : SCPE_OK;
+}
+
+size_t sim_fmap_pagesize (void)
+{
+return (size_t)sysconf (_SC_PAGESIZE);
+}
+
+/* Map the first size bytes of a file shared, so stores through the mapping
+   update the file.  The file must already be at least size bytes long. */
+
+t_stat sim_fmap_file (FILE *fptr, size_t size, t_bool writable, void **addr)
+{
+void *base;
+
+fflush (fptr);
+base = mmap (NULL, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fileno (fptr), 0);
+if (base == MAP_FAILED)
+    return SCPE_IOERR;
+*addr = base;
+return SCPE_OK;
+}
+
+t_stat sim_fmap_sync (void *addr, size_t size)
+{
+return msync (addr, size, MS_SYNC) ? SCPE_IOERR : SCPE_OK;
+}
+
+void sim_fmap_unmap (void *addr, size_t size)
+{
+munmap (addr, size);
+}
+
 #endif
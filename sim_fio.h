@@ -37,7 +37,7 @@
 extern "C" {
 #endif
 
-#define FLIP_SIZE       (1 << 16)                       /* flip buf size */
+#define FLIP_SIZE       (1 << 20)                       /* flip buf size */
 #define fxread(a,b,c,d)         sim_fread (a, b, c, d)
 #define fxwrite(a,b,c,d)        sim_fwrite (a, b, c, d)
 
@@ -61,6 +61,13 @@ int sim_set_fsize (FILE *fptr, t_addr size);
 int sim_set_fifo_nonblock (FILE *fptr);
 size_t sim_fread (void *bptr, size_t size, size_t count, FILE *fptr);
 size_t sim_fwrite (const void *bptr, size_t size, size_t count, FILE *fptr);
+typedef struct SIM_FIO_VEC {                            /* one piece of a scattered transfer */
+    void                *bptr;                          /* buffer */
+    size_t              size;                           /* element size */
+    size_t              count;                          /* element count */
+    } SIM_FIO_VEC;
+size_t sim_freadv (const SIM_FIO_VEC *vec, int nvec, FILE *fptr);
+size_t sim_fwritev (const SIM_FIO_VEC *vec, int nvec, FILE *fptr);
 uint32 sim_fsize (FILE *fptr);
 uint32 sim_fsize_name (const char *fname);
 t_offset sim_ftell (FILE *st);
@@ -71,6 +78,12 @@ void sim_buf_copy_swapped (void *dptr, const void *bptr, size_t size, size_t cou
 typedef struct SHMEM SHMEM;
 t_stat sim_shmem_open (const char *name, size_t size, SHMEM **shmem, void **addr);
 void sim_shmem_close (SHMEM *shmem);
+t_stat sim_fmap_fixed (FILE *fptr, t_offset offset, void *addr, size_t size);
+t_stat sim_fmap_release (void *addr, size_t size);
+size_t sim_fmap_pagesize (void);
+t_stat sim_fmap_file (FILE *fptr, size_t size, t_bool writable, void **addr);
+t_stat sim_fmap_sync (void *addr, size_t size);
+void sim_fmap_unmap (void *addr, size_t size);
 
 extern t_bool sim_taddr_64;         /* t_addr is > 32b and Large File Support available */
 extern t_bool sim_toffset_64;       /* Large File (>2GB) file I/O support */
@@ -78,6 +78,8 @@ return 0;
 #include <unistd.h>
 #define msleep(n) usleep(1000*n)
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #if defined (__APPLE__)
 #define HAVE_STRUCT_TIMESPEC 1   /* OSX defined the structure but doesn't tell us */
 #endif
@@ -159,7 +161,13 @@ struct PANEL {
     char                    *simulator_version;
     int                     radix;
     FILE                    *Debug;
+    int                     shmem_rate;     /* shared memory updates per second */
+    int                     shmem_generation;
+    SIM_PANEL_SHMEM         *shmem;         /* mapped register export */
+    size_t                  shmem_size;
+    unsigned long long      *shmem_values;  /* last consistent snapshot */
 #if defined(_WIN32)
+    HANDLE                  hShmem;
     HANDLE                  hProcess;
 #else
     pid_t                   pidProcess;
@@ -440,6 +448,183 @@ pthread_mutex_unlock (&panel->io_lock);
 return 0;
 }
 
+/* Shared memory register export
+
+   When a panel enables shared memory mode, the simulator is asked (with
+   SET EXPORT) to publish the panel's register list in a shared memory 
+   segment.  Each export uses a fresh segment name since an existing 
+   segment can't be resized.  The panel maps the segment and then removes
+   the name so the segment goes away when both sides have let go of it.
+ */
+
+static void
+_panel_shmem_unmap (SIM_PANEL_SHMEM *shmem, size_t size, void *handle)
+{
+if (shmem == NULL)
+    return;
+#if defined(_WIN32)
+UnmapViewOfFile (shmem);
+CloseHandle ((HANDLE)handle);
+#else
+munmap ((void *)shmem, size);
+#endif
+}
+
+static void
+_panel_shmem_close (PANEL *p)
+{
+#if defined(_WIN32)
+_panel_shmem_unmap (p->shmem, p->shmem_size, (void *)p->hShmem);
+p->hShmem = NULL;
+#else
+_panel_shmem_unmap (p->shmem, p->shmem_size, NULL);
+#endif
+p->shmem = NULL;
+p->shmem_size = 0;
+free (p->shmem_values);
+p->shmem_values = NULL;
+}
+
+static int
+_panel_shmem_export (PANEL *p)
+{
+size_t i, count = 0, buf_size = 64;
+char *buf, *response = NULL, name[64];
+SIM_PANEL_SHMEM *shmem = NULL;
+unsigned long long *values;
+size_t size;
+#if defined(_WIN32)
+HANDLE hShmem;
+#else
+int fd;
+#endif
+
+pthread_mutex_lock (&p->io_lock);
+if (p->reg_count == 0) {                /* Nothing to export yet */
+    pthread_mutex_unlock (&p->io_lock);
+    return 0;
+    }
+for (i=0; i<p->reg_count; i++)
+    buf_size += 20 + strlen (p->regs[i].name) + (p->regs[i].device_name ? strlen (p->regs[i].device_name) : 0);
+buf = (char *)_panel_malloc (buf_size);
+if (buf == NULL) {
+    pthread_mutex_unlock (&p->io_lock);
+    return -1;
+    }
+#if defined(_WIN32)
+sprintf (name, "simh-panel-%lu-%d", (unsigned long)GetCurrentProcessId (), ++p->shmem_generation);
+#else
+sprintf (name, "/simh-panel-%lu-%d", (unsigned long)getpid (), ++p->shmem_generation);
+#endif
+sprintf (buf, "SET EXPORT %s %d", name, p->shmem_rate);
+for (i=0; i<p->reg_count; i++) {
+    REG *reg = &p->regs[i];
+
+    sprintf (buf + strlen (buf), " %s%s%s%s", reg->indirect ? "@" : "",
+             reg->device_name ? reg->device_name : "", reg->device_name ? ":" : "", reg->name);
+    if (reg->element_count > 0)
+        sprintf (buf + strlen (buf), "[%d]", (int)reg->element_count);
+    count += (reg->element_count > 0) ? reg->element_count : 1;
+    }
+pthread_mutex_unlock (&p->io_lock);
+if (_panel_sendf (p, 1, &response, "%s\r", buf)) {
+    free (buf);
+    return -1;
+    }
+free (buf);
+for (i=0; response[i]; i++)
+    if (!isspace (0xFF & response[i])) {
+        sim_panel_set_error ("Shared memory export failed: %s", response);
+        free (response);
+        return -1;
+        }
+free (response);
+size = SIM_PANEL_SHMEM_SIZE (count);
+values = (unsigned long long *)_panel_malloc (count * sizeof (*values));
+if (values == NULL)
+    return -1;
+#if defined(_WIN32)
+hShmem = OpenFileMappingA (FILE_MAP_ALL_ACCESS, FALSE, name);
+if (hShmem != NULL) {
+    shmem = (SIM_PANEL_SHMEM *)MapViewOfFile (hShmem, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (shmem == NULL)
+        CloseHandle (hShmem);
+    }
+#else
+fd = shm_open (name, O_RDWR, 0);
+if (fd != -1) {
+    shmem = (SIM_PANEL_SHMEM *)mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if ((void *)shmem == MAP_FAILED)
+        shmem = NULL;
+    close (fd);
+    shm_unlink (name);
+    }
+#endif
+if (shmem == NULL) {
+    sim_panel_set_error ("Can't map shared memory export: %s", name);
+    free (values);
+    return -1;
+    }
+if ((shmem->magic != SIM_PANEL_SHMEM_MAGIC) ||
+    (shmem->value_count != count)) {
+    sim_panel_set_error ("Invalid shared memory export: %s", name);
+#if defined(_WIN32)
+    _panel_shmem_unmap (shmem, size, (void *)hShmem);
+#else
+    _panel_shmem_unmap (shmem, size, NULL);
+#endif
+    free (values);
+    return -1;
+    }
+pthread_mutex_lock (&p->io_lock);
+_panel_shmem_close (p);
+p->shmem = shmem;
+p->shmem_size = size;
+p->shmem_values = values;
+#if defined(_WIN32)
+p->hShmem = hShmem;
+#endif
+pthread_mutex_unlock (&p->io_lock);
+_panel_debug (p, DBG_XMT, "Exporting %d register values via %s\n", NULL, 0, (int)count, name);
+return 0;
+}
+
+/* Copy a consistent snapshot out of the shared memory segment and into 
+   the registers' buffers.  Called with io_lock held. */
+
+static void
+_panel_shmem_read (PANEL *p)
+{
+SIM_PANEL_SHMEM *shmem = p->shmem;
+size_t i, v, count = shmem->value_count;
+unsigned long long simulation_time;
+unsigned int seq;
+
+while (1) {
+    seq = shmem->sequence;
+    if (seq & 1)                        /* update in progress */
+        continue;
+    SIM_PANEL_SHMEM_BARRIER ();
+    memcpy (p->shmem_values, (void *)shmem->values, count * sizeof (*p->shmem_values));
+    simulation_time = shmem->simulation_time;
+    SIM_PANEL_SHMEM_BARRIER ();
+    if (seq == shmem->sequence)
+        break;
+    }
+p->simulation_time = simulation_time;
+for (i=v=0; (i<p->reg_count) && (v<count); i++) {
+    REG *reg = &p->regs[i];
+    size_t j, elements = (reg->element_count > 0) ? reg->element_count : 1;
+
+    for (j=0; (j<elements) && (v<count); j++, v++) {
+        if (little_endian)
+            memcpy ((char *)reg->addr + (j * reg->size), &p->shmem_values[v], reg->size);
+        else
+            memcpy ((char *)reg->addr + (j * reg->size), ((char *)&p->shmem_values[v]) + sizeof(p->shmem_values[v])-reg->size, reg->size);
+        }
+    }
+}
+
 static PANEL **panels = NULL;
 static int panel_count = 0;
 
@@ -808,6 +993,7 @@ if (panel) {
 
         /* First, wind down the automatic register queries */
         sim_panel_set_display_callback (panel, NULL, NULL, 0);
+        _panel_shmem_close (panel);
         /* Next, attempt a simulator shutdown */
         _panel_send (panel, "\005\rEXIT\r", 7);
         /* Wait for up to 2 seconds for a graceful shutdown */
@@ -993,6 +1179,8 @@ pthread_mutex_unlock (&panel->io_lock);
 /* Now build the register query string for the whole register list */
 if (_panel_register_query_string (panel, &panel->reg_query, &panel->reg_query_size))
     return -1;
+if (panel->shmem_rate)
+    return _panel_shmem_export (panel);
 return 0;
 }
 
@@ -1044,6 +1232,13 @@ if (!panel->reg_count) {
     return -1;
     }
 pthread_mutex_lock (&panel->io_lock);
+if (panel->shmem) {                     /* Published snapshot available? */
+    _panel_shmem_read (panel);
+    if (simulation_time)
+        *simulation_time = panel->simulation_time;
+    pthread_mutex_unlock (&panel->io_lock);
+    return 0;
+    }
 if (panel->reg_query_size != _panel_send (panel, panel->reg_query, panel->reg_query_size)) {
     pthread_mutex_unlock (&panel->io_lock);
     return -1;
@@ -1094,6 +1289,36 @@ pthread_mutex_unlock (&panel->io_lock);
 return 0;
 }
 
+int
+sim_panel_set_shared_memory (PANEL *panel, int updates_per_second)
+{
+if (!panel || (panel->State == Error)) {
+    sim_panel_set_error ("Invalid Panel");
+    return -1;
+    }
+if (updates_per_second < 0) {
+    sim_panel_set_error ("Invalid update rate: %d", updates_per_second);
+    return -1;
+    }
+if (updates_per_second == 0) {
+    if (panel->shmem_rate) {
+        panel->shmem_rate = 0;
+        pthread_mutex_lock (&panel->io_lock);
+        _panel_shmem_close (panel);
+        pthread_mutex_unlock (&panel->io_lock);
+        if (_panel_sendf (panel, 1, NULL, "SET NOEXPORT\r"))
+            return -1;
+        }
+    return 0;
+    }
+panel->shmem_rate = updates_per_second;
+if (_panel_shmem_export (panel)) {
+    panel->shmem_rate = 0;
+    return -1;
+    }
+return 0;
+}
+
 int
 sim_panel_exec_halt (PANEL *panel)
 {
@@ -1822,6 +2047,15 @@ while ((p->sock != INVALID_SOCKET) &&
         }
     msleep (1000/rate);
     pthread_mutex_lock (&p->io_lock);
+    if (p->shmem) {                     /* Read published snapshot */
+        _panel_shmem_read (p);
+        if (p->callback) {
+            pthread_mutex_unlock (&p->io_lock);
+            p->callback (p, p->simulation_time, p->callback_context);
+            pthread_mutex_lock (&p->io_lock);
+            }
+        continue;
+        }
     if (((p->State == Run) || ((p->State == Halt) && (0 == callback_count%(5*rate)))) &&
         (p->io_reg_query_pending == 0)) {
         ++p->io_reg_query_pending;
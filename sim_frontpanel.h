@@ -57,7 +57,7 @@ extern "C" {
 
 #if !defined(__VAX)         /* Unsupported platform */
 
-#define SIM_FRONTPANEL_VERSION   2
+#define SIM_FRONTPANEL_VERSION   3
 
 /**
 
@@ -208,6 +208,54 @@ sim_panel_set_display_callback (PANEL *panel,
                                 void *context, 
                                 int callbacks_per_second);
 
+/**
+
+    sim_panel_set_shared_memory - selects how register values are delivered
+
+        panel                the simulator panel
+        updates_per_second   0 returns to querying the simulator with 
+                             EXAMINE commands over the panel connection.
+                             Non zero asks the simulator to publish the 
+                             panel's registers in a shared memory segment
+                             that many times per second of wall clock time
+                             while it is running (and whenever it stops).
+
+    In shared memory mode sim_panel_get_registers() and the display 
+    callback copy the most recently published snapshot into the register
+    buffers without any traffic to the simulator.  Registers added after
+    shared memory mode is enabled are included in the published set.
+
+    The segment is laid out as a SIM_PANEL_SHMEM structure.  The simulator
+    increments sequence before and after each update, so a reader has a
+    consistent snapshot if sequence was even and unchanged across its copy.
+
+ */
+int
+sim_panel_set_shared_memory (PANEL *panel, int updates_per_second);
+
+#define SIM_PANEL_SHMEM_MAGIC   0x504D4853          /* "SHMP" */
+
+typedef struct SIM_PANEL_SHMEM {
+    unsigned int                magic;              /* SIM_PANEL_SHMEM_MAGIC once valid */
+    volatile unsigned int       sequence;           /* odd while an update is in progress */
+    unsigned int                value_count;        /* number of entries in values */
+    unsigned int                reserved;
+    unsigned long long          simulation_time;    /* simulated time of the snapshot */
+    unsigned long long          update_count;       /* number of snapshots published */
+    unsigned long long          values[1];          /* register and indirect values in */
+                                                    /* the order they were exported */
+    } SIM_PANEL_SHMEM;
+
+#define SIM_PANEL_SHMEM_SIZE(count) (sizeof (SIM_PANEL_SHMEM) + (((count) > 1) ? ((count) - 1) : 0)*sizeof (unsigned long long))
+
+#if defined(_WIN32)
+#define SIM_PANEL_SHMEM_BARRIER() MemoryBarrier ()
+#elif defined(__GNUC__)
+#define SIM_PANEL_SHMEM_BARRIER() __sync_synchronize ()
+#else
+#define SIM_PANEL_SHMEM_BARRIER()
+#endif
+
 /**
 
     When a front panel application needs to change the running
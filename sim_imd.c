@@ -50,6 +50,7 @@
 
 #include "sim_defs.h"
 #include "sim_imd.h"
+#include <sys/stat.h>
 
 #if (defined (__MWERKS__) && defined (macintosh)) || defined(__DECC)
 #define __FUNCTION__ __FILE__
@@ -58,25 +59,87 @@
 static t_stat commentParse(DISK_INFO *myDisk, uint8 comment[], uint32 buffLen);
 static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose);
 static t_stat diskFormat(DISK_INFO *myDisk);
+static t_stat indexLoad(DISK_INFO *myDisk, uint32 isVerbose);
+static void indexSave(DISK_INFO *myDisk);
+static void indexInvalidate(DISK_INFO *myDisk);
+
+/* Track index file layout.  The header is followed by the raw track table.
+ * The index is only trusted when the image size and modification time
+ * still match and the table itself is intact; otherwise the image is
+ * parsed again.
+ */
+#define IMD_INDEX_MAGIC     0x58444D49      /* "IMDX" */
+#define IMD_INDEX_VERSION   2
+
+typedef struct {
+    uint32 magic;
+    uint32 version;
+    uint32 trackInfoSize;       /* sizeof(TRACK_INFO) of the writer */
+    uint32 imageSize;
+    t_uint64 imageMtime;        /* st_mtime when the index was written */
+    uint32 tableCrc;
+    uint32 ntracks;
+    uint8 nsides;
+    uint8 flags;
+    uint8 reserved[2];
+} IMD_INDEX_HEADER;
 
 /* Open an existing IMD disk image.  It will be opened and parsed, and after this
  * call, will be ready for sector read/write. The result is the corresponding
  * DISK_INFO or NULL if an error occurred.
  */
 DISK_INFO *diskOpenEx(FILE *fileref, uint32 isVerbose, DEVICE *device, uint32 debugmask, uint32 verbosedebugmask)
+{
+    const char *filename = NULL;
+    uint32 i;
+
+    /* Simulators open the image their unit has just attached, so the
+     * unit's file name says where the index lives.
+     */
+    if (device != NULL) {
+        for (i = 0; i < device->numunits; i++) {
+            UNIT *uptr = device->units + i;
+            if ((uptr->flags & UNIT_ATT) && (uptr->fileref == fileref)) {
+                filename = uptr->filename;
+                break;
+            }
+        }
+    }
+    return diskOpenIndexed(fileref, filename, isVerbose, device, debugmask, verbosedebugmask);
+}
+
+/* Open an existing IMD disk image, using a track index kept next to the
+ * image (filename followed by IMD_INDEX_SUFFIX) to avoid parsing the image.
+ * A missing or stale index is rebuilt from a full parse.  If filename is
+ * NULL no index is used.
+ */
+DISK_INFO *diskOpenIndexed(FILE *fileref, const char *filename, uint32 isVerbose, DEVICE *device, uint32 debugmask, uint32 verbosedebugmask)
 {
     DISK_INFO *myDisk = NULL;
 
-    myDisk = (DISK_INFO *)malloc(sizeof(DISK_INFO));
+    myDisk = (DISK_INFO *)calloc(1, sizeof(DISK_INFO));
+    if (myDisk == NULL)
+        return NULL;
     myDisk->file = fileref;
     myDisk->device = device;
     myDisk->debugmask = debugmask;
     myDisk->verbosedebugmask = verbosedebugmask;
+    if (filename != NULL) {
+        myDisk->indexName = (char *)malloc(strlen(filename) + sizeof(IMD_INDEX_SUFFIX));
+        if (myDisk->indexName != NULL)
+            sprintf(myDisk->indexName, "%s%s", filename, IMD_INDEX_SUFFIX);
+    }
+
+    if (indexLoad(myDisk, isVerbose) == SCPE_OK)
+        return myDisk;
 
     if (diskParse(myDisk, isVerbose) != SCPE_OK) {
+        free(myDisk->indexName);
         free(myDisk);
-        myDisk = NULL;
+        return NULL;
     }
+    myDisk->indexDirty = 1;
+    indexSave(myDisk);
 
     return myDisk;
 }
@@ -120,6 +183,135 @@ static uint32 headerOk(IMD_HEADER imd) {
     return (imd.cyl < MAX_CYL) && (imd.head < MAX_HEAD);
 }
 
+/* CRC-32 (IEEE 802.3), used to validate the track index */
+static uint32 imdCrc32(uint32 crc, const uint8 *buf, size_t len)
+{
+    static uint32 table[256];
+    static int initialized = 0;
+    size_t i;
+
+    if (!initialized) {
+        uint32 c, n, k;
+
+        for (n = 0; n < 256; n++) {
+            c = n;
+            for (k = 0; k < 8; k++)
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            table[n] = c;
+        }
+        initialized = 1;
+    }
+    crc = ~crc;
+    for (i = 0; i < len; i++)
+        crc = table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/* Modification time of the open image, 0 if it can't be had */
+static t_uint64 imageMtime(FILE *fileref)
+{
+    struct stat statb;
+
+    if (fstat(fileno(fileref), &statb) != 0)
+        return 0;
+    return (t_uint64)statb.st_mtime;
+}
+
+/* Load the track table from the index file, if it is present and still
+ * describes the image.
+ */
+static t_stat indexLoad(DISK_INFO *myDisk, uint32 isVerbose)
+{
+    IMD_INDEX_HEADER hdr;
+    FILE *idx;
+    t_stat r = SCPE_OPENERR;
+
+    if (myDisk->indexName == NULL)
+        return SCPE_OPENERR;
+    idx = sim_fopen(myDisk->indexName, "rb");
+    if (idx == NULL)
+        return SCPE_OPENERR;
+    if ((fread(&hdr, sizeof(hdr), 1, idx) == 1) &&
+        (hdr.magic == IMD_INDEX_MAGIC) &&
+        (hdr.version == IMD_INDEX_VERSION) &&
+        (hdr.trackInfoSize == sizeof(TRACK_INFO)) &&
+        (hdr.ntracks <= MAX_CYL * MAX_HEAD) &&
+        (hdr.imageSize == (uint32)sim_fsize_ex(myDisk->file)) &&
+        (fread(myDisk->track, sizeof(myDisk->track), 1, idx) == 1) &&
+        (hdr.tableCrc == imdCrc32(0, (const uint8 *)myDisk->track, sizeof(myDisk->track))) &&
+        (hdr.imageMtime != 0) &&
+        (hdr.imageMtime == imageMtime(myDisk->file))) {
+        myDisk->ntracks = hdr.ntracks;
+        myDisk->nsides = hdr.nsides;
+        myDisk->flags = hdr.flags;
+        myDisk->indexDirty = 0;
+        r = SCPE_OK;
+        }
+    fclose(idx);
+    if (r != SCPE_OK) {
+        memset(myDisk->track, 0, sizeof(myDisk->track));
+        sim_debug(myDisk->debugmask, myDisk->device, "Track index %s is stale, parsing image\n", myDisk->indexName);
+        return r;
+        }
+    sim_debug(myDisk->debugmask, myDisk->device, "Loaded %d tracks from index %s\n", myDisk->ntracks, myDisk->indexName);
+    if (isVerbose) {
+        uint8 comment[256];
+
+        commentParse(myDisk, comment, sizeof(comment));
+        sim_printf("%s\n", comment);
+        }
+    if(myDisk->flags & FD_FLAG_WRITELOCK) {
+        sim_printf("Disk write-protected because the image contains compressed sectors. Use IMDU to uncompress.\n");
+    }
+    return SCPE_OK;
+}
+
+/* Write the track table to the index file.  Failure to write the index
+ * (e.g. a read-only directory) is not an error; the image is simply
+ * parsed again on the next open.
+ */
+static void indexSave(DISK_INFO *myDisk)
+{
+    IMD_INDEX_HEADER hdr;
+    FILE *idx;
+
+    if ((myDisk->indexName == NULL) || !myDisk->indexDirty)
+        return;
+    fflush(myDisk->file);
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = IMD_INDEX_MAGIC;
+    hdr.version = IMD_INDEX_VERSION;
+    hdr.trackInfoSize = sizeof(TRACK_INFO);
+    hdr.imageSize = (uint32)sim_fsize_ex(myDisk->file);
+    hdr.imageMtime = imageMtime(myDisk->file);
+    hdr.tableCrc = imdCrc32(0, (const uint8 *)myDisk->track, sizeof(myDisk->track));
+    hdr.ntracks = myDisk->ntracks;
+    hdr.nsides = myDisk->nsides;
+    hdr.flags = myDisk->flags;
+    idx = sim_fopen(myDisk->indexName, "wb");
+    if (idx == NULL)
+        return;
+    if ((fwrite(&hdr, sizeof(hdr), 1, idx) != 1) ||
+        (fwrite(myDisk->track, sizeof(myDisk->track), 1, idx) != 1)) {
+        fclose(idx);
+        remove(myDisk->indexName);
+        return;
+        }
+    fclose(idx);
+    myDisk->indexDirty = 0;
+}
+
+/* The image is about to change: drop the index so that an unclean exit
+ * can't leave a stale one behind.  It is rewritten by diskClose.
+ */
+static void indexInvalidate(DISK_INFO *myDisk)
+{
+    if ((myDisk->indexName == NULL) || myDisk->indexDirty)
+        return;
+    remove(myDisk->indexName);
+    myDisk->indexDirty = 1;
+}
+
 /* Parse an IMD image.  This sets up sim_imd to be able to do sector read/write and
  * track write.
  */
@@ -242,6 +434,8 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
             TotalSectorCount++;
             sim_debug(myDisk->debugmask, myDisk->device, "Sector Phys: %d/Logical: %d: %d bytes: ", i, sectorMap[i], sectorSize);
             sectRecordType = fgetc(myDisk->file);
+            if (sectorMap[i]-start_sect < MAX_SPT)
+                myDisk->track[imd.cyl][imd.head].sectorType[sectorMap[i]-start_sect] = (uint8)sectRecordType;
             /* AGN Logical head mapping */
             myDisk->track[imd.cyl][imd.head].logicalHead[i] = sectorHeadMap[i];
             /* AGN Logical cylinder mapping */
@@ -279,6 +473,7 @@ static t_stat diskParse(DISK_INFO *myDisk, uint32 isVerbose)
                         if (1) {
                             uint8 cdata = fgetc(myDisk->file);
 
+                            myDisk->track[imd.cyl][imd.head].sectorFill[sectorMap[i]-start_sect] = cdata;
                             sim_debug(myDisk->debugmask, myDisk->device, "Compressed Data = 0x%02x\n", cdata);
                             }
                     }
@@ -325,6 +520,8 @@ t_stat diskClose(DISK_INFO **myDisk)
 {
     if(*myDisk == NULL)
         return SCPE_OPENERR;
+    indexSave(*myDisk);
+    free((*myDisk)->indexName);
     free(*myDisk);
     *myDisk = NULL;
     return SCPE_OK;
@@ -522,9 +719,9 @@ t_stat sectRead(DISK_INFO *myDisk,
 
     sim_debug(myDisk->debugmask, myDisk->device, "Reading C:%d/H:%d/S:%d, len=%d, offset=0x%08x\n", Cyl, Head, Sector, buflen, sectorFileOffset);
 
-    sim_fseek(myDisk->file, sectorFileOffset-1, SEEK_SET);
-
-    sectRecordType = fgetc(myDisk->file);
+    /* The record type and the fill byte of compressed sectors were cached
+       when the image was parsed, so only normal data touches the file. */
+    sectRecordType = myDisk->track[Cyl][Head].sectorType[Sector-start_sect];
     switch(sectRecordType) {
         case SECT_RECORD_UNAVAILABLE:   /* Data could not be read from the original media */
             *flags |= IMD_DISK_IO_ERROR_GENERAL;
@@ -536,6 +733,7 @@ t_stat sectRead(DISK_INFO *myDisk,
         case SECT_RECORD_NORM_DAM:      /* Normal Data with deleted address mark */
 
 /*          sim_debug(myDisk->debugmask, myDisk->device, "Uncompressed Data\n"); */
+            sim_fseek(myDisk->file, sectorFileOffset, SEEK_SET);
             if (sim_fread(buf, 1, myDisk->track[Cyl][Head].sectsize, myDisk->file) != myDisk->track[Cyl][Head].sectsize) {
                 sim_printf("SIM_IMD[%s]: sim_fread error for SECT_RECORD_NORM_DAM.\n", __FUNCTION__);
             }
@@ -547,7 +745,7 @@ t_stat sectRead(DISK_INFO *myDisk,
         case SECT_RECORD_NORM_COMP:     /* Compressed Normal Data */
         case SECT_RECORD_NORM_DAM_COMP: /* Compressed Normal Data with deleted address mark */
 /*          sim_debug(myDisk->debugmask, myDisk->device, "Compressed Data\n"); */
-            memset(buf, fgetc(myDisk->file), myDisk->track[Cyl][Head].sectsize);
+            memset(buf, myDisk->track[Cyl][Head].sectorFill[Sector-start_sect], myDisk->track[Cyl][Head].sectsize);
             *readlen = myDisk->track[Cyl][Head].sectsize;
             *flags |= IMD_DISK_IO_COMPRESSED;
             break;
@@ -621,6 +819,7 @@ t_stat sectWrite(DISK_INFO *myDisk,
 
     sectorFileOffset = myDisk->track[Cyl][Head].sectorOffsetMap[Sector-start_sect];
 
+    indexInvalidate(myDisk);
     sim_fseek(myDisk->file, sectorFileOffset-1, SEEK_SET);
 
     if (*flags & IMD_DISK_IO_ERROR_GENERAL) {
@@ -638,6 +837,7 @@ t_stat sectWrite(DISK_INFO *myDisk,
     }
 
     fputc(sectRecordType, myDisk->file);
+    myDisk->track[Cyl][Head].sectorType[Sector-start_sect] = sectRecordType;
     sim_fwrite(buf, 1, myDisk->track[Cyl][Head].sectsize, myDisk->file);
     *writelen = myDisk->track[Cyl][Head].sectsize;
 
@@ -692,6 +892,7 @@ t_stat trackWrite(DISK_INFO *myDisk,
     }
 
     fileref = myDisk->file;
+    indexInvalidate(myDisk);
 
     sim_debug(myDisk->debugmask, myDisk->device, "Formatting C:%d/H:%d/N:%d, len=%d, Fill=0x%02x\n", Cyl, Head, numSectors, sectorLen, fillbyte);
 
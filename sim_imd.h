@@ -106,6 +106,8 @@ typedef struct {
     uint8 start_sector;
     uint8 logicalHead[MAX_SPT];
     uint8 logicalCyl[MAX_SPT];
+    uint8 sectorType[MAX_SPT];      /* Sector record type, cached from the image */
+    uint8 sectorFill[MAX_SPT];      /* Fill byte of compressed sectors */
 } TRACK_INFO;
 
 typedef struct {
@@ -116,11 +118,16 @@ typedef struct {
     DEVICE *device;
     uint32 debugmask;
     uint32 verbosedebugmask;
+    char *indexName;                /* Track index file, NULL if not used */
+    uint8 indexDirty;               /* Index no longer matches the image */
     TRACK_INFO track[MAX_CYL][MAX_HEAD];
 } DISK_INFO;
 
+#define IMD_INDEX_SUFFIX    ".imx"  /* Suffix appended to the image name for the track index */
+
 extern DISK_INFO *diskOpen(FILE *fileref, uint32 isVerbose);
 extern DISK_INFO *diskOpenEx(FILE *fileref, uint32 isVerbose, DEVICE *device, uint32 debugmask, uint32 verbosedebugmask);
+extern DISK_INFO *diskOpenIndexed(FILE *fileref, const char *filename, uint32 isVerbose, DEVICE *device, uint32 debugmask, uint32 verbosedebugmask);
 extern t_stat diskClose(DISK_INFO **myDisk);
 extern t_stat diskCreate(FILE *fileref, const char *ctlr_comment);
 extern uint32 imdGetSides(DISK_INFO *myDisk);
@@ -44,6 +44,7 @@
      sim_control_serial     manipulate and/or return the modem bits on a serial port
      sim_read_serial        read from a serial port
      sim_write_serial       write to a serial port
+     sim_writev_serial      write several buffers to a serial port
      sim_close_serial       close a serial port
      sim_show_serial        shows the available host serial ports
 
@@ -103,6 +104,14 @@
    returned.
 
 
+   int32 sim_writev_serial (SERHANDLE port, char **buffers, const int32 *counts, int32 nbuffers)
+   ---------------------------------------------------------------------------------------------
+
+   Like sim_write_serial, but the "nbuffers" buffers are written in order with
+   a single host request where the host supports gather writes.  The total
+   number of characters written is returned, or -1 if an error occurs.
+
+
    void sim_close_serial (SERHANDLE port)
    --------------------------------------
 
@@ -128,11 +137,15 @@
 #include "sim_tmxr.h"
 
 #include <ctype.h>
+#if defined (__unix__) || defined(__APPLE__) || defined(__hpux)
+#include <sys/uio.h>
+#endif
 
 #define SER_DEV_NAME_MAX     256                        /* maximum device name size */
 #define SER_DEV_DESC_MAX     256                        /* maximum device description size */
 #define SER_DEV_CONFIG_MAX    64                        /* maximum device config size */
 #define SER_MAX_DEVICE        64                        /* maximum serial devices */
+#define SER_READAHEAD_MAX   4096                        /* host read-ahead buffer size */
 
 typedef struct serial_list {
     char    name[SER_DEV_NAME_MAX];
@@ -157,6 +170,8 @@ static struct open_serial_device {
     TMLN *line;
     char name[SER_DEV_NAME_MAX];
     char config[SER_DEV_CONFIG_MAX];
+    char rabuf[SER_READAHEAD_MAX];                      /* raw characters read ahead from the host */
+    int32 racount;                                      /* count of characters in rabuf */
     } *serial_open_devices = NULL;
 static int serial_open_device_count = 0;
 
@@ -445,6 +460,42 @@ sim_close_os_serial (port);
 _serial_remove_from_open_list (port);
 }
 
+int32 sim_writev_serial (SERHANDLE port, char **buffers, const int32 *counts, int32 nbuffers)
+{
+#if defined (__unix__) || defined(__APPLE__) || defined(__hpux)
+struct iovec iov[8];
+int32 i;
+ssize_t written;
+
+if (nbuffers > (int32)(sizeof (iov) / sizeof (iov[0])))
+    nbuffers = (int32)(sizeof (iov) / sizeof (iov[0]));
+for (i = 0; i < nbuffers; i++) {
+    iov[i].iov_base = buffers[i];
+    iov[i].iov_len = (size_t)counts[i];
+    }
+written = writev (port, iov, nbuffers);                 /* one request for all buffers */
+if (written == -1) {
+    if ((errno == EWOULDBLOCK) || (errno == EAGAIN))
+        return 0;                                       /* not an error, but nothing written */
+    sim_error_serial ("writev", errno);                 /* report unexpected error */
+    return -1;
+    }
+return (int32)written;
+#else
+int32 i, written, total = 0;
+
+for (i = 0; i < nbuffers; i++) {
+    written = sim_write_serial (port, buffers[i], counts[i]);
+    if (written < 0)
+        return (total > 0) ? total : written;
+    total += written;
+    if (written < counts[i])                            /* port is full? */
+        break;
+    }
+return total;
+#endif
+}
+
 t_stat sim_config_serial  (SERHANDLE port, CONST char *sconfig)
 {
 CONST char *pptr;
@@ -1256,6 +1307,12 @@ return SCPE_OK;
        sequence was encountered, the corresponding location in the "brk" array
        is determined, and the flag is set.  Note that there may be multiple
        sequences in the buffer.
+
+    2. The host is read ahead into a per port buffer, so each call drains all
+       of the data the host has queued rather than just what fits in the
+       caller's buffer.  Characters beyond "count" are returned on the next
+       call.  A marking sequence split across host reads is held in the
+       read-ahead buffer until it is complete rather than being misdecoded.
 */
 
 int32 sim_read_serial (SERHANDLE port, char *buffer, int32 count, char *brk)
@@ -1263,6 +1320,49 @@ int32 sim_read_serial (SERHANDLE port, char *buffer, int32 count, char *brk)
 int read_count;
 char *bptr, *cptr;
 int32 remaining;
+struct open_serial_device *dev = _get_open_device (port);
+
+if (dev) {                                                  /* read-ahead available? */
+    char *ra = dev->rabuf;
+    int32 i = 0, n = 0;
+
+    if (dev->racount < SER_READAHEAD_MAX) {                 /* top up read-ahead */
+        read_count = read (port, (void *) (ra + dev->racount), (size_t) (SER_READAHEAD_MAX - dev->racount));
+        if (read_count > 0)
+            dev->racount += read_count;
+        else
+            if ((read_count == -1) && (errno != EAGAIN)) {  /* unexpected error? */
+                sim_error_serial ("read", errno);           /* report it */
+                return -1;
+                }
+        }
+    while ((i < dev->racount) && (n < count)) {
+        if (ra[i] != '\377') {                              /* ordinary character? */
+            buffer[n++] = ra[i++];
+            continue;
+            }
+        if (i + 1 >= dev->racount)                          /* incomplete sequence? */
+            break;                                          /* wait for the rest */
+        if (ra[i + 1] == '\377') {                          /* \377 \377 is a \377 */
+            buffer[n++] = '\377';
+            i += 2;
+            }
+        else if (ra[i + 1] == '\0') {                       /* \377 \000 \ccc sequence? */
+            if (i + 2 >= dev->racount)                      /* incomplete sequence? */
+                break;                                      /* wait for the rest */
+            if (ra[i + 2] == '\0')                          /* is it a BREAK sequence? */
+                brk[n] = 1;                                 /* set corresponding BREAK flag */
+            buffer[n++] = ra[i + 2];
+            i += 3;
+            }
+        else                                                /* not a marking sequence */
+            buffer[n++] = ra[i++];
+        }
+    dev->racount -= i;                                      /* discard consumed characters */
+    if (dev->racount > 0)
+        memmove (ra, ra + i, dev->racount);
+    return n;
+    }
 
 read_count = read (port, (void *) buffer, (size_t) count);  /* read from the serial port */
 
@@ -97,6 +97,7 @@ extern t_stat    sim_config_serial  (SERHANDLE port, CONST char *config);
 extern t_stat    sim_control_serial (SERHANDLE port, int32 bits_to_set, int32 bits_to_clear, int32 *incoming_bits);
 extern int32     sim_read_serial    (SERHANDLE port, char *buffer, int32 count, char *brk);
 extern int32     sim_write_serial   (SERHANDLE port, char *buffer, int32 count);
+extern int32     sim_writev_serial  (SERHANDLE port, char **buffers, const int32 *counts, int32 nbuffers);
 extern void      sim_close_serial   (SERHANDLE port);
 extern t_stat    sim_show_serial    (FILE* st, DEVICE *dptr, UNIT* uptr, int32 val, CONST char* desc);
 
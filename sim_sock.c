@@ -59,6 +59,10 @@ extern "C" {
 #include <dlfcn.h>
 #endif
 
+#if !defined(_WIN32)
+#include <sys/uio.h>                                    /* for struct iovec */
+#endif
+
 #ifndef WSAAPI
 #define WSAAPI
 #endif
@@ -120,6 +124,16 @@ int sim_write_sock (SOCKET sock, char *msg, int nbytes)
 return 0;
 }
 
+int sim_writev_sock (SOCKET sock, const char **msgs, const int *nbytes, int count)
+{
+return 0;
+}
+
+int sim_setbufsize_sock (SOCKET sock, int bufsize)
+{
+return -1;
+}
+
 void sim_close_sock (SOCKET sock)
 {
 return;
@@ -915,12 +929,19 @@ if (opt_flags & SIM_SOCK_OPT_REUSEADDR) {
     sta = setsockopt (newsock, SOL_SOCKET, SO_REUSEADDR, (char *)&on, sizeof(on));
     }
 #if defined (SO_EXCLUSIVEADDRUSE)
-else {
+else if (!(opt_flags & SIM_SOCK_OPT_REUSEPORT)) {
     int on = 1;
 
     sta = setsockopt (newsock, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, (char *)&on, sizeof(on));
     }
 #endif
+#if defined (SO_REUSEPORT)
+if (opt_flags & SIM_SOCK_OPT_REUSEPORT) {
+    int on = 1;
+
+    sta = setsockopt (newsock, SOL_SOCKET, SO_REUSEPORT, (char *)&on, sizeof(on));
+    }
+#endif
 sta = bind (newsock, preferred->ai_addr, preferred->ai_addrlen);
 p_freeaddrinfo(result);
 if (sta == SOCKET_ERROR)                                /* bind error? */
@@ -930,7 +951,7 @@ if (!(opt_flags & SIM_SOCK_OPT_BLOCKING)) {
     if (sta == SOCKET_ERROR)                            /* fcntl error? */
         return sim_err_sock (newsock, "fcntl");
     }
-sta = listen (newsock, 1);                              /* listen on socket */
+sta = listen (newsock, SOMAXCONN);                      /* listen on socket */
 if (sta == SOCKET_ERROR)                                /* listen error? */
     return sim_err_sock (newsock, "listen");
 return newsock;                                         /* got it! */
@@ -1104,6 +1125,18 @@ if (sta == -1)
 return newsock;
 }
 
+/* Set the kernel send and receive buffer sizes of a socket */
+
+int sim_setbufsize_sock (SOCKET sock, int bufsize)
+{
+int sta;
+
+sta = setsockopt (sock, SOL_SOCKET, SO_RCVBUF, (char *)&bufsize, sizeof(bufsize));
+if (sta != -1)
+    sta = setsockopt (sock, SOL_SOCKET, SO_SNDBUF, (char *)&bufsize, sizeof(bufsize));
+return (sta == -1) ? SOCKET_ERROR : 0;
+}
+
 int sim_check_conn (SOCKET sock, int rd)
 {
 fd_set rw_set, er_set;
@@ -1261,6 +1294,56 @@ if (sbytes == SOCKET_ERROR) {
 return sbytes;
 }
 
+/* Gather write of up to 16 buffers with a single system call
+
+   Returns the total number of bytes sent, which may end part way through
+   any of the buffers, 0 if the socket would block, or SOCKET_ERROR.
+*/
+
+int sim_writev_sock (SOCKET sock, const char **msgs, const int *nbytes, int count)
+{
+int i, err, sbytes;
+#if defined(_WIN32)
+WSABUF bufs[16];
+DWORD sent;
+
+if (count > 16)
+    count = 16;
+for (i = 0; i < count; i++) {
+    bufs[i].buf = (char *)msgs[i];
+    bufs[i].len = (u_long)nbytes[i];
+    }
+if (WSASend (sock, bufs, (DWORD)count, &sent, 0, NULL, NULL) == SOCKET_ERROR)
+    sbytes = SOCKET_ERROR;
+else
+    sbytes = (int)sent;
+#else
+struct iovec iov[16];
+struct msghdr msg;
+
+if (count > 16)
+    count = 16;
+for (i = 0; i < count; i++) {
+    iov[i].iov_base = (void *)msgs[i];
+    iov[i].iov_len = (size_t)nbytes[i];
+    }
+memset (&msg, 0, sizeof (msg));
+msg.msg_iov = iov;
+msg.msg_iovlen = count;
+sbytes = (int)sendmsg (sock, &msg, 0);
+#endif
+if (sbytes == SOCKET_ERROR) {
+    err = WSAGetLastError ();
+    if (err == WSAEWOULDBLOCK)                          /* no data */
+        return 0;
+#if defined(EAGAIN)
+    if (err == EAGAIN)                                  /* no data */
+        return 0;
+#endif
+    }
+return sbytes;
+}
+
 void sim_close_sock (SOCKET sock)
 {
 shutdown(sock, SD_BOTH);
@@ -95,6 +95,9 @@
 #if defined SIM_ASYNCH_IO
 #include <pthread.h>
 #endif
+#if defined (HAVE_ZLIB)
+#include <zlib.h>
+#endif
 
 struct sim_tape_fmt {
     const char          *name;                          /* name */
@@ -108,9 +111,16 @@ static struct sim_tape_fmt fmts[MTUF_N_FMT] = {
     { "TPC",  UNIT_RO, sizeof (t_tpclnt) - 1 },
     { "P7B",  0,       0 },
 /*  { "TPF",  UNIT_RO, 0 }, */
+    { NULL,   0,       0 },
+    { "ZSIMH", 0,      sizeof (t_mtrlnt) - 1 },
     { NULL,   0,       0 }
     };
 
+/* ZSIMH images hold SIMH format records, so the record layout code treats
+   them as SIMH format */
+
+#define MT_GET_RECFMT(u) ((MT_GET_FMT (u) == MTUF_F_ZSIMH) ? MTUF_F_STD : MT_GET_FMT (u))
+
 static const uint32 bpi [] = {                          /* tape density table, indexed by MT_DENS constants */
     0,                                                  /*   0 = MT_DENS_NONE -- density not set */
     200,                                                /*   1 = MT_DENS_200  -- 200 bpi NRZI */
@@ -129,12 +139,57 @@ static t_stat sim_tape_simh_check (UNIT *uptr);
 static t_stat sim_tape_e11_check (UNIT *uptr);
 static t_addr sim_tape_tpc_fnd (UNIT *uptr, t_addr *map);
 static void sim_tape_data_trace (UNIT *uptr, const uint8 *data, size_t len, const char* txt, int detail, uint32 reason);
-
+struct tape_context;
+static void _tape_index_free (struct tape_context *ctx);
+static int _tape_fseek (UNIT *uptr, t_addr pos);
+static size_t _tape_fread (UNIT *uptr, void *bptr, size_t size, size_t count);
+static size_t _tape_fwrite (UNIT *uptr, const void *bptr, size_t size, size_t count);
+static size_t _tape_fwritev (UNIT *uptr, const SIM_FIO_VEC *vec, int nvec);
+static void _tape_io_reset (UNIT *uptr);
+static int _tape_feof (UNIT *uptr);
+static int _tape_ferror (UNIT *uptr);
+static void _tape_zflush (UNIT *uptr);
+static t_stat _tape_zopen (UNIT *uptr);
+static void _tape_zfree (struct tape_context *ctx);
+
+
+#define TAPE_IOBUF_SIZE (256 * 1024)                    /* stdio buffer size */
+#define TAPE_IO_READ    1                               /* io_dir values */
+#define TAPE_IO_WRITE   2
 
 struct tape_context {
     DEVICE              *dptr;              /* Device for unit (access to debug flags) */
     uint32              dbit;               /* debugging bit for trace */
     uint32              auto_format;        /* Format determined dynamically */
+    struct tape_index   *idx;               /* record and tape mark index (SIMH and E11 formats) */
+    uint32              idx_count;          /* entries in use */
+    uint32              idx_size;           /* entries allocated */
+    int32               *idx_hstart;        /* hash heads by object start */
+    int32               *idx_hend;          /* hash heads by object end */
+    uint32              idx_hmask;          /* hash table mask */
+    t_addr              idx_hiwater;        /* largest indexed end position */
+    t_addr              idx_data;           /* data position to seek to after an indexed lookup (0 = none) */
+    char                *io_buf;            /* stdio buffer (read ahead and write behind) */
+    t_bool              io_valid;           /* stream position known */
+    t_addr              io_pos;             /* stream position */
+    t_addr              io_want;            /* position for the next transfer */
+    int                 io_dir;             /* direction of the last transfer */
+    t_bool              zimg;               /* compressed (ZSIMH) image */
+    uint32              z_frame;            /* uncompressed frame size */
+    t_offset            *z_off;             /* seek table: file offset of each frame */
+    uint32              z_offsize;          /* allocated seek table entries */
+    uint32              z_nframes;          /* full frames stored ahead of the tail */
+    uint8               *z_rbuf;            /* frame being read */
+    int32               z_rcur;             /* frame held in z_rbuf (-1 = none) */
+    uint8               *z_wbuf;            /* tail frame (appended to by writes) */
+    uint32              z_wlen;             /* bytes in the tail frame */
+    uint8               *z_cbuf;            /* compressed frame */
+    uint32              z_cbufsize;
+    t_addr              z_pos;              /* uncompressed stream position */
+    t_addr              z_size;             /* uncompressed image size */
+    t_bool              z_eof;              /* read past the end of data */
+    t_bool              z_err;              /* frame I/O or decompression error */
+    t_bool              z_dirty;            /* seek table and tail not yet stored */
 #if defined SIM_ASYNCH_IO
     int                 asynch_io;          /* Asynchronous Interrupt scheduling enabled */
     int                 asynch_io_latency;  /* instructions to delay pending interrupt */
@@ -433,7 +488,9 @@ sim_tape_clr_async (uptr);
 if (sim_asynch_enabled)
     sim_tape_set_async (uptr, ctx->asynch_io_latency);
 #endif
+_tape_zflush (uptr);
 fflush (uptr->fileref);
+_tape_io_reset (uptr);
 }
 
 /* Attach tape unit */
@@ -468,6 +525,15 @@ if (MT_GET_FMT (uptr) == MTUF_F_TPC)
 r = attach_unit (uptr, (CONST char *)cptr);             /* attach unit */
 if (r != SCPE_OK)                                       /* error? */
     return sim_messagef (r, "Can't open tape image: %s\n", cptr);
+
+uptr->tape_ctx = ctx = (struct tape_context *)calloc(1, sizeof(struct tape_context));
+ctx->dptr = dptr;                                       /* save DEVICE pointer */
+ctx->dbit = dbit;                                       /* save debug bit */
+ctx->auto_format = auto_format;                         /* save that we auto selected format */
+ctx->io_buf = (char *)malloc (TAPE_IOBUF_SIZE);         /* buffer before the first I/O */
+if (ctx->io_buf)
+    setvbuf (uptr->fileref, ctx->io_buf, _IOFBF, TAPE_IOBUF_SIZE);
+
 switch (MT_GET_FMT (uptr)) {                            /* case on format */
 
     case MTUF_F_STD:                                    /* SIMH */
@@ -484,6 +550,14 @@ switch (MT_GET_FMT (uptr)) {                            /* case on format */
             }
         break;
 
+    case MTUF_F_ZSIMH:                                  /* compressed SIMH */
+        r = _tape_zopen (uptr);
+        if (r != SCPE_OK) {
+            sim_tape_detach (uptr);
+            return r;
+            }
+        break;
+
     case MTUF_F_TPC:                                    /* TPC */
         objc = sim_tape_tpc_map (uptr, NULL, 0);        /* get # objects */
         if (objc == 0) {                                /* tape empty? */
@@ -503,11 +577,6 @@ switch (MT_GET_FMT (uptr)) {                            /* case on format */
         break;
         }
 
-uptr->tape_ctx = ctx = (struct tape_context *)calloc(1, sizeof(struct tape_context));
-ctx->dptr = dptr;                                       /* save DEVICE pointer */
-ctx->dbit = dbit;                                       /* save debug bit */
-ctx->auto_format = auto_format;                         /* save that we auto selected format */
-
 sim_tape_rewind (uptr);
 
 #if defined (SIM_ASYNCH_IO)
@@ -554,6 +623,11 @@ switch (f) {                                            /* case on format */
         }
 
 sim_tape_rewind (uptr);
+if (ctx) {
+    _tape_index_free (ctx);
+    _tape_zfree (ctx);
+    free (ctx->io_buf);                                 /* stream is closed now */
+    }
 free (uptr->tape_ctx);
 uptr->tape_ctx = NULL;
 uptr->io_flush = NULL;
@@ -583,7 +657,10 @@ fprintf (st, "    -R          Attach Read Only.\n");
 fprintf (st, "    -E          Must Exist (if not specified an attempt to create the indicated\n");
 fprintf (st, "                virtual tape will be attempted).\n");
 fprintf (st, "    -F          Open the indicated tape container in a specific format (default\n");
-fprintf (st, "                is SIMH, alternatives are E11, TPC and P7B)\n");
+fprintf (st, "                is SIMH, alternatives are E11, TPC, P7B and ZSIMH)\n");
+fprintf (st, "\nZSIMH is the SIMH format stored in independently compressed frames with\n");
+fprintf (st, "a seek table, so archived tapes can be read and written in place.  It\n");
+fprintf (st, "needs a simulator built with zlib.\n");
 return SCPE_OK;
 }
 
@@ -595,6 +672,673 @@ if (sim_deb && (ctx->dptr->dctrl & reason))
     sim_data_trace(ctx->dptr, uptr, (detail ? data : NULL), "", len, txt, reason);
 }
 
+/* Record index
+
+   For SIMH and E11 format tapes, every data record and tape mark that is
+   read, spaced over or written is remembered by the positions of its
+   leading and trailing markers.  Later spacing or reading over the same
+   object, in either direction, then takes its length from the index
+   instead of reading the metadata from the file, so spacing back and forth
+   over records and files already seen costs no I/O.  Objects preceded
+   by erase gaps are indexed from their own leading marker, so gaps are
+   always rescanned (runaway detection depends on the current density).
+   Writing at a position discards every object that ends beyond it.
+*/
+
+struct tape_index {
+    t_addr              end;                /* position after the object */
+    t_mtrlnt            bc;                 /* leading marker value */
+    int32               next_start;         /* hash chain by start */
+    int32               next_end;           /* hash chain by end */
+    };
+
+static t_addr _tape_index_start (UNIT *uptr, t_addr end, t_mtrlnt bc)
+{
+t_mtrlnt sbc = MTR_L (bc);
+
+if (bc == MTR_TMK)
+    return end - sizeof (t_mtrlnt);
+return end - 2 * sizeof (t_mtrlnt) - ((MT_GET_RECFMT (uptr) == MTUF_F_STD) ? ((sbc + 1) & ~1) : sbc);
+}
+
+static uint32 _tape_index_hash (struct tape_context *ctx, t_addr pos)
+{
+return ((uint32)(pos >> 2) ^ (uint32)(pos >> 18)) & ctx->idx_hmask;
+}
+
+static int32 _tape_index_find (UNIT *uptr, t_addr pos, t_bool by_end)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+int32 i;
+
+if ((ctx == NULL) || (ctx->idx_count == 0))
+    return -1;
+if (by_end) {
+    for (i = ctx->idx_hend[_tape_index_hash (ctx, pos)]; i >= 0; i = ctx->idx[i].next_end)
+        if (ctx->idx[i].end == pos)
+            return i;
+    }
+else {
+    for (i = ctx->idx_hstart[_tape_index_hash (ctx, pos)]; i >= 0; i = ctx->idx[i].next_start)
+        if (_tape_index_start (uptr, ctx->idx[i].end, ctx->idx[i].bc) == pos)
+            return i;
+    }
+return -1;
+}
+
+static void _tape_index_rehash (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 i, hs, he;
+
+memset (ctx->idx_hstart, 0xFF, (ctx->idx_hmask + 1) * sizeof (*ctx->idx_hstart));
+memset (ctx->idx_hend, 0xFF, (ctx->idx_hmask + 1) * sizeof (*ctx->idx_hend));
+ctx->idx_hiwater = 0;
+for (i = 0; i < ctx->idx_count; i++) {
+    hs = _tape_index_hash (ctx, _tape_index_start (uptr, ctx->idx[i].end, ctx->idx[i].bc));
+    he = _tape_index_hash (ctx, ctx->idx[i].end);
+    ctx->idx[i].next_start = ctx->idx_hstart[hs];
+    ctx->idx_hstart[hs] = (int32)i;
+    ctx->idx[i].next_end = ctx->idx_hend[he];
+    ctx->idx_hend[he] = (int32)i;
+    if (ctx->idx[i].end > ctx->idx_hiwater)
+        ctx->idx_hiwater = ctx->idx[i].end;
+    }
+}
+
+static void _tape_index_add (UNIT *uptr, t_addr end, t_mtrlnt bc)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 f = MT_GET_RECFMT (uptr);
+
+if ((ctx == NULL) || ((f != MTUF_F_STD) && (f != MTUF_F_E11)) ||
+    (_tape_index_find (uptr, end, TRUE) >= 0))
+    return;
+if (ctx->idx_count == ctx->idx_size) {                  /* grow, keeping the tables half full */
+    uint32 nsize = ctx->idx_size ? 2 * ctx->idx_size : 1024;
+    struct tape_index *nidx = (struct tape_index *)realloc (ctx->idx, nsize * sizeof (*nidx));
+    int32 *nhs = (int32 *)realloc (ctx->idx_hstart, 2 * nsize * sizeof (*nhs));
+    int32 *nhe = (int32 *)realloc (ctx->idx_hend, 2 * nsize * sizeof (*nhe));
+
+    if (nidx)
+        ctx->idx = nidx;
+    if (nhs)
+        ctx->idx_hstart = nhs;
+    if (nhe)
+        ctx->idx_hend = nhe;
+    if (!nidx || !nhs || !nhe)                          /* no memory, just don't index */
+        return;
+    ctx->idx_size = nsize;
+    ctx->idx_hmask = 2 * nsize - 1;
+    _tape_index_rehash (uptr);
+    }
+ctx->idx[ctx->idx_count].end = end;
+ctx->idx[ctx->idx_count].bc = bc;
+++ctx->idx_count;
+if (ctx->idx_count == 1)
+    _tape_index_rehash (uptr);
+else {
+    uint32 i = ctx->idx_count - 1;
+    uint32 hs = _tape_index_hash (ctx, _tape_index_start (uptr, end, bc));
+    uint32 he = _tape_index_hash (ctx, end);
+
+    ctx->idx[i].next_start = ctx->idx_hstart[hs];
+    ctx->idx_hstart[hs] = (int32)i;
+    ctx->idx[i].next_end = ctx->idx_hend[he];
+    ctx->idx_hend[he] = (int32)i;
+    if (end > ctx->idx_hiwater)
+        ctx->idx_hiwater = end;
+    }
+}
+
+/* Forget every object that ends beyond a position about to be written */
+
+static void _tape_index_truncate (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 i, j;
+
+if ((ctx == NULL) || (ctx->idx_count == 0) || (pos >= ctx->idx_hiwater))
+    return;
+for (i = j = 0; i < ctx->idx_count; i++)
+    if (ctx->idx[i].end <= pos)
+        ctx->idx[j++] = ctx->idx[i];
+ctx->idx_count = j;
+_tape_index_rehash (uptr);
+}
+
+/* Position the file to the data of a record found in the index */
+
+static void _tape_index_seek (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx->idx_data) {
+    _tape_fseek (uptr, ctx->idx_data);
+    ctx->idx_data = 0;
+    }
+}
+
+static void _tape_index_free (struct tape_context *ctx)
+{
+free (ctx->idx);
+free (ctx->idx_hstart);
+free (ctx->idx_hend);
+ctx->idx = NULL;
+ctx->idx_hstart = ctx->idx_hend = NULL;
+ctx->idx_count = ctx->idx_size = 0;
+}
+
+/* Tape file access
+
+   Sequential records are transferred through a large stdio buffer, so
+   reads are satisfied from data read ahead and writes are gathered into
+   large host writes.  A seek to the position the stream is already at is
+   skipped, since any fseek discards the read ahead and forces out the
+   write behind.  A real seek is made only when the position changes, when
+   the transfer direction changes (stdio requires one between a write and
+   a read on an update stream), or to clear an end-of-file condition.
+   Code that moves the stream by other means calls _tape_io_reset.
+*/
+
+/* Compressed (ZSIMH) tape images
+
+   A ZSIMH image contains the byte stream of a SIMH format tape image cut
+   into fixed size frames, each deflated independently, followed by a seek
+   table giving the file offset of every frame.  Reading at any tape
+   position inflates only the one frame holding it, so positioning is fast
+   and memory use is bounded by a few frames regardless of the tape size.
+
+     header   "SIMHTPZ1", uint32 frame size, uint32 reserved
+     frame    uint32 compressed length, uint32 data length, deflate data
+     ...
+     table    uint64 offset of each frame, then the offset of the table
+     trailer  uint64 table offset, uint32 frame count, uint32 reserved,
+              "SIMHTPZE"
+
+   Every frame except the last holds exactly "frame size" bytes.  Writes
+   go to the last (tail) frame, which is kept in memory; a write before
+   the tail truncates the tape there, as on a real drive.  The tail and
+   the seek table are stored by _tape_zflush.  An image without a valid
+   trailer (the simulator stopped before a flush) is recovered by walking
+   the frame headers.
+*/
+
+#define TAPE_ZFRAME_SIZE    (256 * 1024)                /* default frame size */
+#define TAPE_ZHDR_SIZE      16                          /* header size */
+#define TAPE_ZTRL_SIZE      24                          /* trailer size */
+
+static const char tape_ztrl_magic[8] = {'S', 'I', 'M', 'H', 'T', 'P', 'Z', 'E'};
+#if defined (HAVE_ZLIB)
+static const char tape_zhdr_magic[8] = {'S', 'I', 'M', 'H', 'T', 'P', 'Z', '1'};
+
+static t_bool _tape_zgrow (struct tape_context *ctx, uint32 entries)
+{
+t_offset *noff;
+uint32 nsize;
+
+if (entries <= ctx->z_offsize)
+    return TRUE;
+nsize = ctx->z_offsize ? ctx->z_offsize : 64;
+while (nsize < entries)
+    nsize = 2 * nsize;
+noff = (t_offset *)realloc (ctx->z_off, nsize * sizeof (*noff));
+if (noff == NULL)
+    return FALSE;
+ctx->z_off = noff;
+ctx->z_offsize = nsize;
+return TRUE;
+}
+#endif
+
+/* Inflate frame f into buf, returning its data length or -1 */
+
+static int32 _tape_zload (UNIT *uptr, uint32 f, uint8 *buf)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+#if defined (HAVE_ZLIB)
+uint32 hdr[2];
+uLongf dlen = ctx->z_frame;
+
+if ((sim_fseeko (uptr->fileref, ctx->z_off[f], SEEK_SET) == 0) &&
+    (sim_fread (hdr, sizeof (uint32), 2, uptr->fileref) == 2) &&
+    (hdr[0] <= ctx->z_cbufsize) && (hdr[1] <= ctx->z_frame) &&
+    (sim_fread (ctx->z_cbuf, 1, hdr[0], uptr->fileref) == hdr[0]) &&
+    (uncompress (buf, &dlen, ctx->z_cbuf, hdr[0]) == Z_OK) &&
+    (dlen == hdr[1]))
+    return (int32)hdr[1];
+#endif
+sim_debug (MTSE_DBG_STR, ctx->dptr, "zload: frame %u at %" T_ADDR_FMT "u is unreadable\n", f, (t_addr)ctx->z_off[f]);
+ctx->z_err = TRUE;
+errno = EIO;
+return -1;
+}
+
+/* Deflate len bytes of buf as frame f */
+
+static t_bool _tape_zstore (UNIT *uptr, uint32 f, const uint8 *buf, uint32 len)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+#if defined (HAVE_ZLIB)
+uint32 hdr[2];
+uLongf clen = ctx->z_cbufsize;
+SIM_FIO_VEC vec[2];
+
+if (_tape_zgrow (ctx, f + 2) &&
+    (compress2 (ctx->z_cbuf, &clen, buf, len, Z_DEFAULT_COMPRESSION) == Z_OK)) {
+    hdr[0] = (uint32)clen;
+    hdr[1] = len;
+    vec[0].bptr = hdr;
+    vec[0].size = sizeof (uint32);
+    vec[0].count = 2;
+    vec[1].bptr = ctx->z_cbuf;
+    vec[1].size = 1;
+    vec[1].count = hdr[0];
+    if ((sim_fseeko (uptr->fileref, ctx->z_off[f], SEEK_SET) == 0) &&
+        (sim_fwritev (vec, 2, uptr->fileref) == sizeof (hdr) + hdr[0])) {
+        ctx->z_off[f + 1] = ctx->z_off[f] + sizeof (hdr) + hdr[0];
+        return TRUE;
+        }
+    }
+#endif
+ctx->z_err = TRUE;
+return FALSE;
+}
+
+static size_t _tape_zfread (UNIT *uptr, void *bptr, size_t size, size_t count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint8 *dst = (uint8 *)bptr;
+size_t want = size * count, got = 0, n;
+uint32 f, off, len;
+uint8 *src;
+
+while (got < want) {
+    if (ctx->z_pos >= ctx->z_size) {                    /* past the end of data? */
+        ctx->z_eof = TRUE;
+        break;
+        }
+    f = (uint32)(ctx->z_pos / ctx->z_frame);
+    off = (uint32)(ctx->z_pos - (t_addr)f * ctx->z_frame);
+    if (f >= ctx->z_nframes) {                          /* in the tail frame? */
+        src = ctx->z_wbuf;
+        len = ctx->z_wlen;
+        }
+    else {
+        if (ctx->z_rcur != (int32)f) {
+            ctx->z_rcur = -1;
+            if (_tape_zload (uptr, f, ctx->z_rbuf) != (int32)ctx->z_frame)
+                break;
+            ctx->z_rcur = (int32)f;
+            }
+        src = ctx->z_rbuf;
+        len = ctx->z_frame;
+        }
+    n = len - off;
+    if (n > want - got)
+        n = want - got;
+    memcpy (dst + got, src + off, n);
+    got = got + n;
+    ctx->z_pos = ctx->z_pos + n;
+    }
+if (!sim_end && (size > 1))                             /* image data is little endian */
+    sim_buf_swap_data (bptr, size, got / size);
+return got / size;
+}
+
+static size_t _tape_zfwrite (UNIT *uptr, const void *bptr, size_t size, size_t count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+const uint8 *src = (const uint8 *)bptr;
+uint8 *tmp = NULL;
+size_t want = size * count, done = 0, n;
+t_addr base = (t_addr)ctx->z_nframes * ctx->z_frame;
+
+if (ctx->z_pos > ctx->z_size) {                         /* can't leave a hole */
+    ctx->z_err = TRUE;
+    errno = EINVAL;
+    return 0;
+    }
+if (ctx->z_pos < base) {                                /* rewriting a stored frame? */
+    uint32 f = (uint32)(ctx->z_pos / ctx->z_frame);
+
+    if (_tape_zload (uptr, f, ctx->z_wbuf) != (int32)ctx->z_frame)
+        return 0;
+    ctx->z_nframes = f;                                 /* it becomes the tail */
+    if (ctx->z_rcur >= (int32)f)
+        ctx->z_rcur = -1;
+    base = (t_addr)f * ctx->z_frame;
+    }
+ctx->z_wlen = (uint32)(ctx->z_pos - base);              /* drop everything after the write */
+ctx->z_dirty = TRUE;
+if (!sim_end && (size > 1)) {                           /* image data is little endian */
+    if ((tmp = (uint8 *)malloc (want)) == NULL) {
+        ctx->z_err = TRUE;
+        return 0;
+        }
+    sim_buf_copy_swapped (tmp, bptr, size, count);
+    src = tmp;
+    }
+while (done < want) {
+    n = ctx->z_frame - ctx->z_wlen;
+    if (n > want - done)
+        n = want - done;
+    memcpy (ctx->z_wbuf + ctx->z_wlen, src + done, n);
+    ctx->z_wlen = ctx->z_wlen + (uint32)n;
+    done = done + n;
+    if (ctx->z_wlen == ctx->z_frame) {                  /* tail full? */
+        if (!_tape_zstore (uptr, ctx->z_nframes, ctx->z_wbuf, ctx->z_frame))
+            break;
+        ctx->z_nframes = ctx->z_nframes + 1;
+        ctx->z_wlen = 0;
+        }
+    }
+free (tmp);
+ctx->z_pos = ctx->z_pos + done;
+ctx->z_size = (t_addr)ctx->z_nframes * ctx->z_frame + ctx->z_wlen;
+return done / size;
+}
+
+/* Store the tail frame and the seek table */
+
+static void _tape_zflush (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 n, i, trl[2];
+t_uint64 off;
+t_offset end;
+SIM_FIO_VEC vec[3];
+
+if ((ctx == NULL) || !ctx->zimg || !ctx->z_dirty)
+    return;
+n = ctx->z_nframes;
+if (ctx->z_wlen > 0) {
+    if (!_tape_zstore (uptr, n, ctx->z_wbuf, ctx->z_wlen))
+        return;
+    n = n + 1;
+    }
+end = ctx->z_off[n];
+sim_fseeko (uptr->fileref, end, SEEK_SET);
+for (i = 0; i <= n; i++) {
+    off = (t_uint64)ctx->z_off[i];
+    sim_fwrite (&off, sizeof (off), 1, uptr->fileref);
+    }
+off = (t_uint64)end;
+trl[0] = n;
+trl[1] = 0;
+vec[0].bptr = &off;
+vec[0].size = sizeof (off);
+vec[0].count = 1;
+vec[1].bptr = trl;
+vec[1].size = sizeof (uint32);
+vec[1].count = 2;
+vec[2].bptr = (void *)tape_ztrl_magic;
+vec[2].size = 1;
+vec[2].count = sizeof (tape_ztrl_magic);
+sim_fwritev (vec, 3, uptr->fileref);
+fflush (uptr->fileref);
+if (ferror (uptr->fileref)) {
+    ctx->z_err = TRUE;
+    return;
+    }
+sim_set_fsize (uptr->fileref, (t_addr)(end + (n + 1) * sizeof (off) + TAPE_ZTRL_SIZE));
+ctx->z_dirty = FALSE;
+}
+
+#if defined (HAVE_ZLIB)
+/* Read the seek table of an existing image, returning the frame count or -1 */
+
+static int32 _tape_ztable (UNIT *uptr, t_offset size)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+char magic[8];
+uint32 trl[2], i;
+t_uint64 off;
+SIM_FIO_VEC vec[3];
+
+vec[0].bptr = &off;
+vec[0].size = sizeof (off);
+vec[0].count = 1;
+vec[1].bptr = trl;
+vec[1].size = sizeof (uint32);
+vec[1].count = 2;
+vec[2].bptr = magic;
+vec[2].size = 1;
+vec[2].count = sizeof (magic);
+if ((size < TAPE_ZHDR_SIZE + TAPE_ZTRL_SIZE + (t_offset)sizeof (off)) ||
+    (sim_fseeko (uptr->fileref, size - TAPE_ZTRL_SIZE, SEEK_SET) != 0) ||
+    (sim_freadv (vec, 3, uptr->fileref) != sizeof (off) + sizeof (trl) + sizeof (magic)) ||
+    (memcmp (magic, tape_ztrl_magic, sizeof (magic)) != 0) ||
+    ((t_offset)(off + (t_uint64)(trl[0] + 1) * sizeof (off) + TAPE_ZTRL_SIZE) != size) ||
+    !_tape_zgrow (ctx, trl[0] + 2))
+    return -1;
+sim_fseeko (uptr->fileref, (t_offset)off, SEEK_SET);
+for (i = 0; i <= trl[0]; i++) {
+    if (sim_fread (&off, sizeof (off), 1, uptr->fileref) != 1)
+        return -1;
+    ctx->z_off[i] = (t_offset)off;
+    if ((ctx->z_off[i] < TAPE_ZHDR_SIZE) || ((i > 0) && (ctx->z_off[i] <= ctx->z_off[i - 1])))
+        return -1;
+    }
+return (int32)trl[0];
+}
+
+/* Rebuild the seek table by walking the frame headers, returning the frame count */
+
+static int32 _tape_zscan (UNIT *uptr, t_offset size)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+uint32 hdr[2];
+int32 n = 0;
+
+ctx->z_off[0] = TAPE_ZHDR_SIZE;
+while ((sim_fseeko (uptr->fileref, ctx->z_off[n], SEEK_SET) == 0) &&
+       (sim_fread (hdr, sizeof (uint32), 2, uptr->fileref) == 2) &&
+       (hdr[0] <= ctx->z_cbufsize) && (hdr[1] > 0) && (hdr[1] <= ctx->z_frame) &&
+       (ctx->z_off[n] + (t_offset)sizeof (hdr) + hdr[0] <= size) &&
+       _tape_zgrow (ctx, n + 2)) {
+    ctx->z_off[n + 1] = ctx->z_off[n] + sizeof (hdr) + hdr[0];
+    n = n + 1;
+    if (hdr[1] < ctx->z_frame)                          /* short frame ends the tape */
+        break;
+    }
+return n;
+}
+#endif
+
+static t_stat _tape_zopen (UNIT *uptr)
+{
+#if defined (HAVE_ZLIB)
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+t_offset size = sim_fsize_ex (uptr->fileref);
+char magic[8];
+uint32 hdr[2];
+int32 n, len;
+
+ctx->zimg = TRUE;
+ctx->z_rcur = -1;
+ctx->z_frame = TAPE_ZFRAME_SIZE;
+if (size > 0) {
+    if ((sim_fread (magic, 1, sizeof (magic), uptr->fileref) != sizeof (magic)) ||
+        (memcmp (magic, tape_zhdr_magic, sizeof (magic)) != 0) ||
+        (sim_fread (hdr, sizeof (uint32), 2, uptr->fileref) != 2) ||
+        (hdr[0] < 512) || (hdr[0] > 16 * 1024 * 1024))
+        return sim_messagef (SCPE_FMT, "%s: %s is not a ZSIMH tape image\n", sim_uname (uptr), uptr->filename);
+    ctx->z_frame = hdr[0];
+    }
+ctx->z_cbufsize = (uint32)compressBound (ctx->z_frame);
+ctx->z_rbuf = (uint8 *)malloc (ctx->z_frame);
+ctx->z_wbuf = (uint8 *)malloc (ctx->z_frame);
+ctx->z_cbuf = (uint8 *)malloc (ctx->z_cbufsize);
+if ((ctx->z_rbuf == NULL) || (ctx->z_wbuf == NULL) || (ctx->z_cbuf == NULL) ||
+    !_tape_zgrow (ctx, 2))
+    return SCPE_MEM;
+ctx->z_off[0] = TAPE_ZHDR_SIZE;
+if (size == 0) {                                        /* new image? */
+    if (uptr->flags & UNIT_RO)
+        return SCPE_OK;
+    hdr[0] = ctx->z_frame;
+    hdr[1] = 0;
+    sim_fwrite ((void *)tape_zhdr_magic, 1, sizeof (tape_zhdr_magic), uptr->fileref);
+    sim_fwrite (hdr, sizeof (uint32), 2, uptr->fileref);
+    ctx->z_dirty = TRUE;                                /* write an empty seek table */
+    _tape_zflush (uptr);
+    return ctx->z_err ? SCPE_IOERR : SCPE_OK;
+    }
+n = _tape_ztable (uptr, size);
+if (n < 0) {
+    n = _tape_zscan (uptr, size);
+    sim_messagef (SCPE_OK, "%s: seek table missing, recovered %d frames\n", sim_uname (uptr), n);
+    ctx->z_dirty = !(uptr->flags & UNIT_RO);            /* write the rebuilt table */
+    }
+if (n > 0) {                                            /* last frame becomes the tail */
+    if ((len = _tape_zload (uptr, n - 1, ctx->z_wbuf)) < 0)
+        return SCPE_IOERR;
+    if (len == (int32)ctx->z_frame)
+        ctx->z_nframes = n;
+    else {
+        ctx->z_nframes = n - 1;
+        ctx->z_wlen = len;
+        }
+    }
+ctx->z_size = (t_addr)ctx->z_nframes * ctx->z_frame + ctx->z_wlen;
+return SCPE_OK;
+#else
+return sim_messagef (SCPE_NOFNC, "%s: ZSIMH tape images need a simulator built with zlib\n", sim_uname (uptr));
+#endif
+}
+
+static void _tape_zfree (struct tape_context *ctx)
+{
+free (ctx->z_off);
+free (ctx->z_rbuf);
+free (ctx->z_wbuf);
+free (ctx->z_cbuf);
+ctx->z_off = NULL;
+ctx->z_rbuf = ctx->z_wbuf = ctx->z_cbuf = NULL;
+}
+
+static int _tape_feof (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx && ctx->zimg)
+    return ctx->z_eof;
+return feof (uptr->fileref);
+}
+
+static int _tape_ferror (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx && ctx->zimg && ctx->z_err)
+    return 1;
+return ferror (uptr->fileref);
+}
+
+static void _tape_io_reset (UNIT *uptr)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx)
+    ctx->io_valid = FALSE;
+}
+
+static int _tape_fseek (UNIT *uptr, t_addr pos)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if (ctx && ctx->zimg) {
+    ctx->z_pos = pos;
+    ctx->z_eof = FALSE;
+    return 0;
+    }
+if ((ctx == NULL) || feof (uptr->fileref)) {            /* not tracked or at EOF? */
+    _tape_io_reset (uptr);
+    if (ctx)
+        ctx->io_want = pos;
+    return sim_fseek (uptr->fileref, pos, SEEK_SET);    /* seek now (clears EOF) */
+    }
+ctx->io_want = pos;                                     /* otherwise seek when transferring */
+return 0;
+}
+
+static void _tape_io_position (UNIT *uptr, int dir)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+
+if ((!ctx->io_valid) || (ctx->io_pos != ctx->io_want) || (ctx->io_dir != dir)) {
+    sim_fseek (uptr->fileref, ctx->io_want, SEEK_SET);
+    ctx->io_pos = ctx->io_want;
+    ctx->io_valid = TRUE;
+    }
+ctx->io_dir = dir;
+}
+
+static size_t _tape_fread (UNIT *uptr, void *bptr, size_t size, size_t count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+size_t n;
+
+if (ctx == NULL)
+    return sim_fread (bptr, size, count, uptr->fileref);
+if (ctx->zimg)
+    return _tape_zfread (uptr, bptr, size, count);
+_tape_io_position (uptr, TAPE_IO_READ);
+n = sim_fread (bptr, size, count, uptr->fileref);
+ctx->io_pos = ctx->io_want = ctx->io_pos + n * size;
+if (n < count)                                          /* partial element, EOF or error */
+    ctx->io_valid = FALSE;
+return n;
+}
+
+static size_t _tape_fwrite (UNIT *uptr, const void *bptr, size_t size, size_t count)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+size_t n;
+
+if (ctx == NULL)
+    return sim_fwrite (bptr, size, count, uptr->fileref);
+if (ctx->zimg)
+    return _tape_zfwrite (uptr, bptr, size, count);
+_tape_io_position (uptr, TAPE_IO_WRITE);
+n = sim_fwrite (bptr, size, count, uptr->fileref);
+ctx->io_pos = ctx->io_want = ctx->io_pos + n * size;
+if (n < count)
+    ctx->io_valid = FALSE;
+return n;
+}
+
+/* Gather write, returns the number of bytes written */
+
+static size_t _tape_fwritev (UNIT *uptr, const SIM_FIO_VEC *vec, int nvec)
+{
+struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
+size_t n, want = 0;
+int i;
+
+if ((ctx == NULL) || ctx->zimg) {                       /* one piece at a time */
+    for (i = 0, n = 0; i < nvec; i++) {
+        size_t c = _tape_fwrite (uptr, vec[i].bptr, vec[i].size, vec[i].count);
+
+        n = n + c * vec[i].size;
+        if (c < vec[i].count)
+            break;
+        }
+    return n;
+    }
+for (i = 0; i < nvec; i++)
+    want = want + vec[i].size * vec[i].count;
+_tape_io_position (uptr, TAPE_IO_WRITE);
+n = sim_fwritev (vec, nvec, uptr->fileref);
+ctx->io_pos = ctx->io_want = ctx->io_pos + n;
+if (n < want)
+    ctx->io_valid = FALSE;
+return n;
+}
+
 /* Read record length forward (internal routine)
 
    Inputs:
@@ -654,7 +1398,7 @@ if (sim_deb && (ctx->dptr->dctrl & reason))
        E11 format.
 
     2. The "feof" call cannot return a non-zero value on the first pass through
-       the loop, because the "sim_fseek" call resets the internal end-of-file
+       the loop, because the "_tape_fseek" call resets the internal end-of-file
        indicator.  Subsequent passes only occur if an erase gap is present, so
        a non-zero return indicates an EOF was seen while reading through a gap.
 
@@ -685,20 +1429,34 @@ static t_stat sim_tape_rdlntf (UNIT *uptr, t_mtrlnt *bc)
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 uint8 c;
 t_bool all_eof;
-uint32 f = MT_GET_FMT (uptr);
+uint32 f = MT_GET_RECFMT (uptr);
 t_mtrlnt sbc;
 t_tpclnt tpcbc;
 t_mtrlnt buffer [256];                                  /* local tape buffer */
 uint32 bufcntr, bufcap;                                 /* buffer counter and capacity */
 int32 runaway_counter, sizeof_gap;                      /* bytes remaining before runaway and bytes per gap */
 t_stat r = MTSE_OK;
+t_addr opos = uptr->pos;
+int32 ix;
 
 MT_CLR_PNU (uptr);                                      /* clear the position-not-updated flag */
 
 if ((uptr->flags & UNIT_ATT) == 0)                      /* if the unit is not attached */
     return MTSE_UNATT;                                  /*   then quit with an error */
 
-sim_fseek (uptr->fileref, uptr->pos, SEEK_SET);         /* set the initial tape position */
+ctx->idx_data = 0;
+if ((ix = _tape_index_find (uptr, uptr->pos, FALSE)) >= 0) {/* object already indexed? */
+    *bc = ctx->idx[ix].bc;
+    uptr->pos = ctx->idx[ix].end;
+    if (*bc == MTR_TMK)
+        r = MTSE_TMK;
+    else                                                /* the data is sought only if it is read */
+        ctx->idx_data = opos + sizeof (t_mtrlnt);
+    sim_debug (MTSE_DBG_STR, ctx->dptr, "rd_lnt: st: %d, lnt: %d, pos: %" T_ADDR_FMT "u (indexed)\n", r, *bc, uptr->pos);
+    return r;
+    }
+
+_tape_fseek (uptr, uptr->pos);                          /* set the initial tape position */
 
 switch (f) {                                            /* the read method depends on the tape format */
 
@@ -718,7 +1476,7 @@ switch (f) {                                            /* the read method depen
 
         do {                                            /* loop until a record, gap, or error is seen */
             if (bufcntr == bufcap) {                    /* if the buffer is empty then refill it */
-                if (feof (uptr->fileref)) {             /* if we hit the EOF while reading a gap */
+                if (_tape_feof (uptr)) {                /* if we hit the EOF while reading a gap */
                     if (sizeof_gap > 0)                 /*   then if detection is enabled */
                         r = MTSE_RUNAWAY;               /*     then report a tape runaway */
                     else                                /*   otherwise report the physical EOF */
@@ -733,12 +1491,12 @@ switch (f) {                                            /* the read method depen
                     bufcap = sizeof (buffer)            /*   to the full size of the buffer */
                                / sizeof (buffer [0]);
 
-                bufcap = sim_fread (buffer,             /* fill the buffer */
-                                    sizeof (t_mtrlnt),  /*   with tape metadata */
-                                    bufcap,
-                                    uptr->fileref);
+                bufcap = _tape_fread (uptr,             /* fill the buffer */
+                                      buffer,           /*   with tape metadata */
+                                      sizeof (t_mtrlnt),
+                                      bufcap);
 
-                if (ferror (uptr->fileref)) {           /* if a file I/O error occurred */
+                if (_tape_ferror (uptr)) {              /* if a file I/O error occurred */
                     if (bufcntr == 0)                   /*   then if this is the initial read */
                         MT_SET_PNU (uptr);              /*     then set position not updated */
 
@@ -788,7 +1546,7 @@ switch (f) {                                            /* the read method depen
 
             else if (*bc == MTR_FHGAP) {                        /* otherwise if the value if a half gap */
                 uptr->pos = uptr->pos - sizeof (t_mtrlnt) / 2;  /*   then back up */
-                sim_fseek (uptr->fileref, uptr->pos, SEEK_SET); /*     to resync */
+                _tape_fseek (uptr, uptr->pos);                  /*     to resync */
                 bufcntr = bufcap;                               /* mark the buffer as invalid to force a read */
 
                 *bc = MTR_GAP;                                  /* reset the marker */
@@ -797,7 +1555,7 @@ switch (f) {                                            /* the read method depen
 
             else {                                                  /* otherwise it's a record marker */
                 if (bufcntr < bufcap)                               /* if the position is within the buffer */
-                    sim_fseek (uptr->fileref, uptr->pos, SEEK_SET); /*   then seek to the data area */
+                    _tape_fseek (uptr, uptr->pos);                  /*   then seek to the data area */
 
                 sbc = MTR_L (*bc);                                  /* extract the record length */
                 uptr->pos = uptr->pos + sizeof (t_mtrlnt)           /* position to the start */
@@ -809,16 +1567,20 @@ switch (f) {                                            /* the read method depen
         if (r == MTSE_OK && runaway_counter <= 0)       /* if a tape runaway occurred */
             r = MTSE_RUNAWAY;                           /*   then report it */
 
+        if (((r == MTSE_OK) || (r == MTSE_TMK)) &&      /* if an object was found */
+            (_tape_index_start (uptr, uptr->pos, *bc) == opos))  /*   with no gap before it */
+            _tape_index_add (uptr, uptr->pos, *bc);     /*     then remember it */
+
         break;                                          /* otherwise the operation succeeded */
 
     case MTUF_F_TPC:
-        sim_fread (&tpcbc, sizeof (t_tpclnt), 1, uptr->fileref);
+        _tape_fread (uptr, &tpcbc, sizeof (t_tpclnt), 1);
         *bc = tpcbc;                                    /* save rec lnt */
-        if (ferror (uptr->fileref)) {                   /* error? */
+        if (_tape_ferror (uptr)) {                      /* error? */
             MT_SET_PNU (uptr);                          /* pos not upd */
             return sim_tape_ioerr (uptr);
             }
-        if (feof (uptr->fileref)) {                     /* eof? */
+        if (_tape_feof (uptr)) {                        /* eof? */
             MT_SET_PNU (uptr);                          /* pos not upd */
             r = MTSE_EOM;
             break;
@@ -831,12 +1593,12 @@ switch (f) {                                            /* the read method depen
 
     case MTUF_F_P7B:
         for (sbc = 0, all_eof = 1; ; sbc++) {           /* loop thru record */
-            sim_fread (&c, sizeof (uint8), 1, uptr->fileref);
-            if (ferror (uptr->fileref)) {               /* error? */
+            _tape_fread (uptr, &c, sizeof (uint8), 1);
+            if (_tape_ferror (uptr)) {                  /* error? */
                 MT_SET_PNU (uptr);                      /* pos not upd */
                 return sim_tape_ioerr (uptr);
                 }
-            if (feof (uptr->fileref)) {                 /* eof? */
+            if (_tape_feof (uptr)) {                    /* eof? */
                 if (sbc == 0)                           /* no data? eom */
                     return MTSE_EOM;
                 break;                                  /* treat like eor */
@@ -847,7 +1609,7 @@ switch (f) {                                            /* the read method depen
                 all_eof = 0;
             }
         *bc = sbc;                                      /* save rec lnt */
-        sim_fseek (uptr->fileref, uptr->pos, SEEK_SET); /* for read */
+        _tape_fseek (uptr, uptr->pos);                  /* for read */
         uptr->pos = uptr->pos + sbc;                    /* spc over record */
         if (all_eof)                                    /* tape mark? */
             r = MTSE_TMK;
@@ -894,7 +1656,7 @@ static t_stat sim_tape_rdlntr (UNIT *uptr, t_mtrlnt *bc)
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 uint8 c;
 t_bool all_eof;
-uint32 f = MT_GET_FMT (uptr);
+uint32 f = MT_GET_RECFMT (uptr);
 t_addr ppos;
 t_mtrlnt sbc;
 t_tpclnt tpcbc;
@@ -902,6 +1664,8 @@ t_mtrlnt buffer [256];                                  /* local tape buffer */
 uint32 bufcntr, bufcap;                                 /* buffer counter and capacity */
 int32 runaway_counter, sizeof_gap;                      /* bytes remaining before runaway and bytes per gap */
 t_stat r = MTSE_OK;
+t_addr opos = uptr->pos;
+int32 ix;
 
 MT_CLR_PNU (uptr);                                      /* clear the position-not-updated flag */
 
@@ -911,6 +1675,18 @@ if ((uptr->flags & UNIT_ATT) == 0)                      /* if the unit is not at
 if (sim_tape_bot (uptr))                                /* if the unit is positioned at the BOT */
     return MTSE_BOT;                                    /*   then reading backward is not possible */
 
+ctx->idx_data = 0;
+if ((ix = _tape_index_find (uptr, uptr->pos, TRUE)) >= 0) {/* object already indexed? */
+    *bc = ctx->idx[ix].bc;
+    uptr->pos = _tape_index_start (uptr, opos, *bc);
+    if (*bc == MTR_TMK)
+        r = MTSE_TMK;
+    else                                                /* the data is sought only if it is read */
+        ctx->idx_data = uptr->pos + sizeof (t_mtrlnt);
+    sim_debug (MTSE_DBG_STR, ctx->dptr, "rd_lnt: st: %d, lnt: %d, pos: %" T_ADDR_FMT "u (indexed)\n", r, *bc, uptr->pos);
+    return r;
+    }
+
 switch (f) {                                            /* the read method depends on the tape format */
 
     case MTUF_F_STD:
@@ -939,14 +1715,14 @@ switch (f) {                                            /* the read method depen
                     bufcap = (uint32) uptr->pos         /*   then reduce the capacity accordingly */
                                / sizeof (t_mtrlnt);
 
-                sim_fseek (uptr->fileref,                           /* seek back to the location */
-                           uptr->pos - bufcap * sizeof (t_mtrlnt),  /*   corresponding to the start */
-                           SEEK_SET);                               /*     of the buffer */
+                _tape_fseek (uptr,                                  /* seek back to the location */
+                             uptr->pos - bufcap * sizeof (t_mtrlnt)); /*   corresponding to the start */
+                                                                    /*     of the buffer */
 
-                bufcntr = sim_fread (buffer, sizeof (t_mtrlnt),     /* fill the buffer */
-                                     bufcap, uptr->fileref);        /*   with tape metadata */
+                bufcntr = _tape_fread (uptr, buffer,                /* fill the buffer */
+                                       sizeof (t_mtrlnt), bufcap);  /*   with tape metadata */
 
-                if (ferror (uptr->fileref)) {           /* if a file I/O error occurred */
+                if (_tape_ferror (uptr)) {              /* if a file I/O error occurred */
                     MT_SET_PNU (uptr);                  /*   then set position not updated */
                     r = sim_tape_ioerr (uptr);          /*     report the error and quit */
                     break;
@@ -982,8 +1758,8 @@ switch (f) {                                            /* the read method depen
                 sbc = MTR_L (*bc);                              /* extract the record length */
                 uptr->pos = uptr->pos - sizeof (t_mtrlnt)       /* position to the start */
                   - (f == MTUF_F_STD ? (sbc + 1) & ~1 : sbc);   /*   of the record */
-                sim_fseek (uptr->fileref,                       /* seek to the data area */
-                           uptr->pos + sizeof (t_mtrlnt), SEEK_SET);
+                _tape_fseek (uptr,                              /* seek to the data area */
+                             uptr->pos + sizeof (t_mtrlnt));
                 }
             }
         while (*bc == MTR_GAP && runaway_counter > 0);  /* continue until data or runaway occurs */
@@ -991,16 +1767,20 @@ switch (f) {                                            /* the read method depen
         if (r == MTSE_OK && runaway_counter <= 0)       /* if a tape runaway occurred */
             r = MTSE_RUNAWAY;                           /*   then report it */
 
+        if (((r == MTSE_OK) || (r == MTSE_TMK)) &&      /* if an object was found */
+            (_tape_index_start (uptr, opos, *bc) == uptr->pos)) /*   with no gap after it */
+            _tape_index_add (uptr, opos, *bc);          /*     then remember it */
+
         break;                                          /* otherwise the operation succeeded */
 
     case MTUF_F_TPC:
         ppos = sim_tape_tpc_fnd (uptr, (t_addr *) uptr->filebuf); /* find prev rec */
-        sim_fseek (uptr->fileref, ppos, SEEK_SET);      /* position */
-        sim_fread (&tpcbc, sizeof (t_tpclnt), 1, uptr->fileref);
+        _tape_fseek (uptr, ppos);                       /* position */
+        _tape_fread (uptr, &tpcbc, sizeof (t_tpclnt), 1);
         *bc = tpcbc;                                    /* save rec lnt */
-        if (ferror (uptr->fileref))                     /* error? */
+        if (_tape_ferror (uptr))                        /* error? */
             return sim_tape_ioerr (uptr);
-        if (feof (uptr->fileref)) {                     /* eof? */
+        if (_tape_feof (uptr)) {                        /* eof? */
             r = MTSE_EOM;
             break;
             }
@@ -1009,16 +1789,16 @@ switch (f) {                                            /* the read method depen
             r = MTSE_TMK;
             break;
             }
-        sim_fseek (uptr->fileref, uptr->pos + sizeof (t_tpclnt), SEEK_SET);
+        _tape_fseek (uptr, uptr->pos + sizeof (t_tpclnt));
         break;
 
     case MTUF_F_P7B:
         for (sbc = 1, all_eof = 1; (t_addr) sbc <= uptr->pos ; sbc++) {
-            sim_fseek (uptr->fileref, uptr->pos - sbc, SEEK_SET);
-            sim_fread (&c, sizeof (uint8), 1, uptr->fileref);
-            if (ferror (uptr->fileref))                 /* error? */
+            _tape_fseek (uptr, uptr->pos - sbc);
+            _tape_fread (uptr, &c, sizeof (uint8), 1);
+            if (_tape_ferror (uptr))                    /* error? */
                 return sim_tape_ioerr (uptr);
-            if (feof (uptr->fileref)) {                 /* eof? */
+            if (_tape_feof (uptr)) {                    /* eof? */
                 r = MTSE_EOM;
                 break;
                 }
@@ -1029,7 +1809,7 @@ switch (f) {                                            /* the read method depen
             }
         uptr->pos = uptr->pos - sbc;                    /* update position */
         *bc = sbc;                                      /* save rec lnt */
-        sim_fseek (uptr->fileref, uptr->pos, SEEK_SET); /* for read */
+        _tape_fseek (uptr, uptr->pos);                  /* for read */
         if (all_eof)                                    /* tape mark? */
             r = MTSE_TMK;
         break;
@@ -1065,7 +1845,7 @@ return r;
 t_stat sim_tape_rdrecf (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
-uint32 f = MT_GET_FMT (uptr);
+uint32 f = MT_GET_RECFMT (uptr);
 t_mtrlnt i, tbc, rbc;
 t_addr opos;
 t_stat st;
@@ -1081,8 +1861,9 @@ if (rbc > max) {                                        /* rec out of range? */
     uptr->pos = opos;
     return MTSE_INVRL;
     }
-i = (t_mtrlnt)sim_fread (buf, sizeof (uint8), rbc, uptr->fileref);/* read record */
-if (ferror (uptr->fileref)) {                           /* error? */
+_tape_index_seek (uptr);
+i = (t_mtrlnt)_tape_fread (uptr, buf, sizeof (uint8), rbc);       /* read record */
+if (_tape_ferror (uptr)) {                              /* error? */
     MT_SET_PNU (uptr);
     uptr->pos = opos;
     return sim_tape_ioerr (uptr);
@@ -1130,7 +1911,7 @@ return r;
 t_stat sim_tape_rdrecr (UNIT *uptr, uint8 *buf, t_mtrlnt *bc, t_mtrlnt max)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
-uint32 f = MT_GET_FMT (uptr);
+uint32 f = MT_GET_RECFMT (uptr);
 t_mtrlnt i, rbc, tbc;
 t_stat st;
 
@@ -1141,8 +1922,9 @@ if (MTSE_OK != (st = sim_tape_rdlntr (uptr, &tbc)))     /* read rec lnt */
 *bc = rbc = MTR_L (tbc);                                /* strip error flag */
 if (rbc > max)                                          /* rec out of range? */
     return MTSE_INVRL;
-i = (t_mtrlnt)sim_fread (buf, sizeof (uint8), rbc, uptr->fileref);/* read record */
-if (ferror (uptr->fileref))                             /* error? */
+_tape_index_seek (uptr);
+i = (t_mtrlnt)_tape_fread (uptr, buf, sizeof (uint8), rbc);       /* read record */
+if (_tape_ferror (uptr))                                /* error? */
     return sim_tape_ioerr (uptr);
 for ( ; i < rbc; i++)                                   /* fill with 0's */
     buf[i] = 0;
@@ -1181,8 +1963,9 @@ return r;
 t_stat sim_tape_wrrecf (UNIT *uptr, uint8 *buf, t_mtrlnt bc)
 {
 struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
-uint32 f = MT_GET_FMT (uptr);
+uint32 f = MT_GET_RECFMT (uptr);
 t_mtrlnt sbc;
+SIM_FIO_VEC vec[3];
 
 sim_debug (ctx->dbit, ctx->dptr, "sim_tape_wrrecf(unit=%d, buf=%p, bc=%d)\n", (int)(uptr-ctx->dptr->units), buf, bc);
 
@@ -1195,27 +1978,33 @@ if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
 if (sbc == 0)                                           /* nothing to do? */
     return MTSE_OK;
-sim_fseek (uptr->fileref, uptr->pos, SEEK_SET);         /* set pos */
+_tape_index_truncate (uptr, uptr->pos);                 /* later records are overwritten */
+_tape_fseek (uptr, uptr->pos);                          /* set pos */
 switch (f) {                                            /* case on format */
 
     case MTUF_F_STD:                                    /* standard */
         sbc = MTR_L ((bc + 1) & ~1);                    /* pad odd length */
     case MTUF_F_E11:                                    /* E11 */
-        sim_fwrite (&bc, sizeof (t_mtrlnt), 1, uptr->fileref);
-        sim_fwrite (buf, sizeof (uint8), sbc, uptr->fileref);
-        sim_fwrite (&bc, sizeof (t_mtrlnt), 1, uptr->fileref);
-        if (ferror (uptr->fileref)) {                   /* error? */
+        vec[0].bptr = vec[2].bptr = &bc;                /* length, data, length */
+        vec[0].size = vec[2].size = sizeof (t_mtrlnt);
+        vec[0].count = vec[2].count = 1;
+        vec[1].bptr = buf;
+        vec[1].size = sizeof (uint8);
+        vec[1].count = sbc;
+        _tape_fwritev (uptr, vec, 3);
+        if (_tape_ferror (uptr)) {                      /* error? */
             MT_SET_PNU (uptr);
             return sim_tape_ioerr (uptr);
             }
         uptr->pos = uptr->pos + sbc + (2 * sizeof (t_mtrlnt));  /* move tape */
+        _tape_index_add (uptr, uptr->pos, bc);
         break;
 
     case MTUF_F_P7B:                                    /* Pierce 7B */
         buf[0] = buf[0] | P7B_SOR;                      /* mark start of rec */
-        sim_fwrite (buf, sizeof (uint8), sbc, uptr->fileref);
-        sim_fwrite (buf, sizeof (uint8), 1, uptr->fileref); /* delimit rec */
-        if (ferror (uptr->fileref)) {                   /* error? */
+        _tape_fwrite (uptr, buf, sizeof (uint8), sbc);
+        _tape_fwrite (uptr, buf, sizeof (uint8), 1);        /* delimit rec */
+        if (_tape_ferror (uptr)) {                      /* error? */
             MT_SET_PNU (uptr);
             return sim_tape_ioerr (uptr);
             }
@@ -1246,14 +2035,17 @@ if ((uptr->flags & UNIT_ATT) == 0)                      /* not attached? */
     return MTSE_UNATT;
 if (sim_tape_wrp (uptr))                                /* write prot? */
     return MTSE_WRP;
-sim_fseek (uptr->fileref, uptr->pos, SEEK_SET);         /* set pos */
-sim_fwrite (&dat, sizeof (t_mtrlnt), 1, uptr->fileref);
-if (ferror (uptr->fileref)) {                           /* error? */
+_tape_index_truncate (uptr, uptr->pos);                 /* later records are overwritten */
+_tape_fseek (uptr, uptr->pos);                          /* set pos */
+_tape_fwrite (uptr, &dat, sizeof (t_mtrlnt), 1);
+if (_tape_ferror (uptr)) {                              /* error? */
     MT_SET_PNU (uptr);
     return sim_tape_ioerr (uptr);
     }
 sim_debug (MTSE_DBG_STR, ctx->dptr, "wr_lnt: lnt: %d, pos: %" T_ADDR_FMT "u\n", dat, uptr->pos);
 uptr->pos = uptr->pos + sizeof (t_mtrlnt);              /* move tape */
+if (dat == MTR_TMK)
+    _tape_index_add (uptr, uptr->pos, dat);
 return MTSE_OK;
 }
 
@@ -1467,7 +2259,8 @@ else                                                    /* otherwise */
     gap_needed = (gaplen * tape_density) / 10;          /*   determine the gap size needed in bytes */
 
 file_size = sim_fsize (uptr->fileref);                  /* get file size */
-sim_fseek (uptr->fileref, uptr->pos, SEEK_SET);         /* position tape */
+_tape_io_reset (uptr);
+_tape_fseek (uptr, uptr->pos);                          /* position tape */
 
 /* Read tape records and allocate to gap until amount required is consumed.
 
@@ -1481,7 +2274,7 @@ sim_fseek (uptr->fileref, uptr->pos, SEEK_SET);         /* position tape */
 */
 
 do {
-    sim_fread (&meta, meta_size, 1, uptr->fileref);     /* read metadatum */
+    _tape_fread (uptr, &meta, meta_size, 1);            /* read metadatum */
 
     if (ferror (uptr->fileref)) {                       /* read error? */
         uptr->pos = gap_pos;                            /* restore original position */
@@ -1503,7 +2296,7 @@ do {
 
     else if (meta == MTR_FHGAP) {                       /* half gap? */
         uptr->pos = uptr->pos - meta_size / 2;          /* backup to resync */
-        sim_fseek (uptr->fileref, uptr->pos, SEEK_SET); /* position tape */
+        _tape_fseek (uptr, uptr->pos);                  /* position tape */
         gap_alloc = gap_alloc + meta_size / 2;          /* allocate marker space */
         gap_needed = gap_needed - meta_size / 2;        /* reduce requirement */
         }
@@ -1526,7 +2319,7 @@ do {
 
         if (rec_size < gap_needed + min_rec_size) {         /* rec too small? */
             uptr->pos = uptr->pos - meta_size + rec_size;   /* position past record */
-            sim_fseek (uptr->fileref, uptr->pos, SEEK_SET); /* move tape */
+            _tape_fseek (uptr, uptr->pos);                  /* move tape */
             gap_alloc = gap_alloc + rec_size;               /* allocate record */
             gap_needed = gap_needed - rec_size;             /* reduce requirement */
             }
@@ -1980,6 +2773,12 @@ struct tape_context *ctx = (struct tape_context *)uptr->tape_ctx;
 
 if (uptr->flags & UNIT_ATT) {
     sim_debug (ctx->dbit, ctx->dptr, "sim_tape_rewind(unit=%d)\n", (int)(uptr-ctx->dptr->units));
+    if (ctx && (ctx->io_dir == TAPE_IO_WRITE)) {        /* write behind pending? */
+        fflush (uptr->fileref);                         /* put it in the image */
+        ctx->io_dir = 0;
+        ctx->io_valid = FALSE;
+        }
+    _tape_zflush (uptr);
     }
 uptr->pos = 0;
 MT_CLR_PNU (uptr);
@@ -2103,6 +2902,9 @@ static t_stat sim_tape_ioerr (UNIT *uptr)
 {
 sim_printf ("%s: Magtape library I/O error: %s\n", sim_uname (uptr), strerror (errno));
 clearerr (uptr->fileref);
+_tape_io_reset (uptr);
+if (uptr->tape_ctx)
+    ((struct tape_context *)uptr->tape_ctx)->z_err = FALSE;
 return MTSE_IOERR;
 }
 
@@ -2161,8 +2963,8 @@ recbuf = (uint8 *)malloc (65536);
 tape_size = (t_addr)sim_fsize (uptr->fileref);
 sim_debug (MTSE_DBG_STR, dptr, "tpc_map: tape_size: %" T_ADDR_FMT "u\n", tape_size);
 for (objc = 0, sizec = 0, tpos = 0;; ) {
-    sim_fseek (uptr->fileref, tpos, SEEK_SET);
-    i = sim_fread (&bc, sizeof (t_tpclnt), 1, uptr->fileref);
+    _tape_fseek (uptr, tpos);
+    i = _tape_fread (uptr, &bc, sizeof (t_tpclnt), 1);
     if (i == 0)     /* past or at eof? */
         break;
     if (countmap[bc] == 0)
@@ -2173,7 +2975,7 @@ for (objc = 0, sizec = 0, tpos = 0;; ) {
     if (bc) {
         sim_debug (MTSE_DBG_STR, dptr, "tpc_map: %d byte count at pos: %" T_ADDR_FMT "u\n", bc, tpos);
         if (sim_deb && (dptr->dctrl & MTSE_DBG_STR)) {
-            sim_fread (recbuf, 1, bc, uptr->fileref);
+            _tape_fread (uptr, recbuf, 1, bc);
             sim_data_trace(dptr, uptr, ((dptr->dctrl & MTSE_DBG_DAT) ? recbuf : NULL), "", bc, "Data Record", MTSE_DBG_STR);
             }
         }
@@ -81,6 +81,7 @@ typedef uint16          t_tpclnt;                       /* magtape rec lnt */
 #define MTUF_F_TPC       2                              /* TPC format */
 #define MTUF_F_P7B       3                              /* P7B format */
 #define MUTF_F_TDF       4                              /* TDF format */
+#define MTUF_F_ZSIMH     5                              /* compressed SIMH format */
 #define MTUF_V_UF       (MTUF_V_FMT + MTUF_W_FMT)
 #define MTUF_PNU        (1u << MTUF_V_PNU)
 #define MTUF_WLK        (1u << MTUF_V_WLK)
@@ -92,6 +93,7 @@ typedef uint16          t_tpclnt;                       /* magtape rec lnt */
 #define MT_F_TPC        (MTUF_F_TPC << MTUF_V_FMT)
 #define MT_F_P7B        (MTUF_F_P7B << MTUF_V_FMT)
 #define MT_F_TDF        (MTUF_F_TDF << MTUF_V_FMT)
+#define MT_F_ZSIMH      (MTUF_F_ZSIMH << MTUF_V_FMT)
 
 #define MT_SET_PNU(u)   (u)->flags = (u)->flags | MTUF_PNU
 #define MT_CLR_PNU(u)   (u)->flags = (u)->flags & ~MTUF_PNU
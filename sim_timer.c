@@ -101,6 +101,17 @@ static uint32 sim_throt_type = 0;
 static uint32 sim_throt_val = 0;
 static uint32 sim_throt_state = 0;
 static uint32 sim_throt_sleep_time = 0;
+static t_bool sim_throt_deadline = FALSE;           /* pace against absolute deadlines */
+static uint32 sim_throt_slice_us = 1000;            /* deadline check interval */
+static uint32 sim_throt_spin_us = 100;              /* spin when this close to a deadline */
+static double sim_throt_base_time = 0;              /* host time at deadline base */
+static double sim_throt_base_gtime = 0;             /* sim_gtime at deadline base */
+static double sim_throt_cps = 0;                    /* desired cycles per second */
+static double sim_throt_late_max = 0;               /* worst lateness, seconds */
+static double sim_throt_late_sum = 0;
+static double sim_throt_slept_frac = 0;             /* partial ms slept */
+static uint32 sim_throt_checks = 0;
+static uint32 sim_throt_rebases = 0;
 static int32 sim_throt_wait = 0;
 static UNIT *sim_clock_unit[SIM_NTIMERS] = {NULL};
 UNIT * volatile sim_clock_cosched_queue[SIM_NTIMERS] = {NULL};
@@ -427,7 +438,7 @@ return 0;
 #include <unistd.h>
 #define NANOS_PER_MILLI     1000000
 #define MILLIS_PER_SEC      1000
-#define sleep1Samples       100
+#define sleep1Samples       10                  /* each costs a sleep at startup */
 
 const t_bool rtc_avail = TRUE;
 
@@ -600,6 +611,157 @@ if (sim_calb_tmr == -1)                 /* save first initialized clock as the s
 return time;
 }
 
+/* Performance counters
+
+   Totals are accumulated while the simulator is running.  Once a second
+   (from the calibration path) a snapshot of the rates over the past
+   second is taken and made visible as TIMER registers, so that front
+   panels and scripts can scrape them while the simulator runs.
+*/
+
+static uint32 sim_idle_ms_slept = 0;                    /* host ms slept by sim_idle */
+static uint32 sim_throt_ms_slept = 0;                   /* host ms slept throttling */
+static double sim_perf_run_ms = 0;                      /* host ms spent running */
+static double sim_perf_run_insts = 0;                   /* instructions while running */
+static double sim_perf_run_events = 0;                  /* events while running */
+static uint32 sim_perf_start_ms = 0;
+static double sim_perf_start_gtime = 0;
+static double sim_perf_start_events = 0;
+static t_bool sim_perf_running = FALSE;
+static uint32 sim_perf_snap_ms = 0;                     /* last snapshot */
+static double sim_perf_snap_gtime = 0;
+static double sim_perf_snap_events = 0;
+static uint32 sim_perf_snap_idle = 0;
+static uint32 sim_perf_snap_throt = 0;
+static uint32 sim_perf_ips = 0;                         /* instructions/sec, last second */
+static uint32 sim_perf_eps = 0;                         /* events/sec, last second */
+static uint32 sim_perf_idle_pct = 0;                    /* % of last second idling */
+static uint32 sim_perf_throt_pct = 0;                   /* % of last second throttling */
+
+static void sim_perf_snapshot (uint32 now, t_bool force)
+{
+uint32 delta_ms = now - sim_perf_snap_ms;
+double gtime, events;
+
+if ((delta_ms < 1000) && !force)
+    return;
+gtime = sim_gtime ();
+events = sim_queue_dispatches;
+if (delta_ms > 0) {
+    sim_perf_ips = (uint32)(((gtime - sim_perf_snap_gtime) * 1000.0) / delta_ms);
+    sim_perf_eps = (uint32)(((events - sim_perf_snap_events) * 1000.0) / delta_ms);
+    sim_perf_idle_pct = (uint32)((100.0 * (sim_idle_ms_slept - sim_perf_snap_idle)) / delta_ms);
+    sim_perf_throt_pct = (uint32)((100.0 * (sim_throt_ms_slept - sim_perf_snap_throt)) / delta_ms);
+    }
+sim_perf_snap_ms = now;
+sim_perf_snap_gtime = gtime;
+sim_perf_snap_events = events;
+sim_perf_snap_idle = sim_idle_ms_slept;
+sim_perf_snap_throt = sim_throt_ms_slept;
+}
+
+/* Note the start of a run */
+
+void sim_perf_run_start (void)
+{
+sim_perf_start_ms = sim_os_msec ();
+sim_perf_start_gtime = sim_gtime ();
+sim_perf_start_events = sim_queue_dispatches;
+sim_perf_running = TRUE;
+sim_perf_snapshot (sim_perf_start_ms, TRUE);
+}
+
+/* Fold a finished run into the totals */
+
+void sim_perf_run_stop (void)
+{
+if (!sim_perf_running)
+    return;
+sim_perf_run_ms += (uint32)(sim_os_msec () - sim_perf_start_ms);
+sim_perf_run_insts += sim_gtime () - sim_perf_start_gtime;
+sim_perf_run_events += sim_queue_dispatches - sim_perf_start_events;
+sim_perf_running = FALSE;
+}
+
+static void sim_perf_setenv (const char *name, double value)
+{
+char buf[32];
+
+sprintf (buf, "%.0f", value);
+setenv (name, buf, 1);
+}
+
+/* SHOW PERFORMANCE */
+
+t_stat sim_show_performance (FILE* st, DEVICE *dnotused, UNIT* unotused, int32 flag, CONST char* cptr)
+{
+double secs, events, run_ms, run_insts, run_events;
+uint32 i, j;
+DEVICE *dptr;
+t_bool json = FALSE;
+char gbuf[CBUFSIZE];
+
+if (cptr && (*cptr != 0)) {
+    cptr = get_glyph (cptr, gbuf, 0);
+    if (strcmp (gbuf, "JSON") != 0)
+        return SCPE_ARG;
+    if (*cptr != 0)
+        return SCPE_2MARG;
+    json = TRUE;
+    }
+run_ms = sim_perf_run_ms;
+run_insts = sim_perf_run_insts;
+run_events = sim_perf_run_events;
+if (sim_perf_running) {                                 /* include the run in progress */
+    run_ms += (uint32)(sim_os_msec () - sim_perf_start_ms);
+    run_insts += sim_gtime () - sim_perf_start_gtime;
+    run_events += sim_queue_dispatches - sim_perf_start_events;
+    }
+secs = run_ms / 1000.0;
+if (json) {                                             /* one object, for scripts */
+    if (secs == 0.0)
+        secs = 1.0;
+    fprintf (st, "{\"simulator\": \"%s\", \"seconds\": %.3f, ", sim_name, run_ms / 1000.0);
+    fprintf (st, "\"instructions\": %.0f, \"ips\": %.0f, ", run_insts, run_insts / secs);
+    fprintf (st, "\"events\": %.0f, \"eps\": %.0f, ", run_events, run_events / secs);
+    fprintf (st, "\"idle_ms\": %u, \"throttle_ms\": %u, ", sim_idle_ms_slept, sim_throt_ms_slept);
+    fprintf (st, "\"devices\": {");
+    for (i = 0, j = 0; (dptr = sim_devices[i]) != NULL; i++) {
+        uint32 k;
+
+        for (k = 0, events = 0; k < dptr->numunits; k++)
+            events += dptr->units[k].q_dispatches;
+        if (events != 0)
+            fprintf (st, "%s\"%s\": %.0f", (j++ ? ", " : ""), dptr->name, events);
+        }
+    fprintf (st, "}}\n");
+    }
+else {
+    fprintf (st, "%s performance, %.3f seconds running\n", sim_name, secs);
+    if (secs == 0.0)
+        secs = 1.0;                                     /* avoid dividing by zero */
+    fprintf (st, "  Instructions:           %.0f, %.0f per second\n", run_insts, run_insts / secs);
+    fprintf (st, "  Events dispatched:      %.0f, %.0f per second\n", run_events, run_events / secs);
+    fprintf (st, "  Idle sleep:             %u ms, %.1f%% of running time\n", sim_idle_ms_slept, sim_idle_ms_slept / (10.0 * secs));
+    fprintf (st, "  Throttle sleep:         %u ms, %.1f%% of running time\n", sim_throt_ms_slept, sim_throt_ms_slept / (10.0 * secs));
+    fprintf (st, "  Last second:            %u instructions, %u events, %u%% idle, %u%% throttled\n",
+                 sim_perf_ips, sim_perf_eps, sim_perf_idle_pct, sim_perf_throt_pct);
+    fprintf (st, "  Device events:\n");
+    for (i = 0; (dptr = sim_devices[i]) != NULL; i++) {
+        for (j = 0, events = 0; j < dptr->numunits; j++)
+            events += dptr->units[j].q_dispatches;
+        if (events != 0)
+            fprintf (st, "    %-10s %12.0f, %.1f per second\n", dptr->name, events, events / secs);
+        }
+    }
+sim_perf_setenv ("SIM_PERF_SECONDS", run_ms / 1000.0);
+sim_perf_setenv ("SIM_PERF_IPS", run_insts / secs);
+sim_perf_setenv ("SIM_PERF_EPS", run_events / secs);
+sim_perf_setenv ("SIM_PERF_IDLE_MS", sim_idle_ms_slept);
+sim_perf_setenv ("SIM_PERF_THROT_MS", sim_throt_ms_slept);
+return SCPE_OK;
+}
+
 int32 sim_rtcn_calb (int32 ticksper, int32 tmr)
 {
 uint32 new_rtime, delta_rtime;
@@ -616,6 +778,7 @@ if (rtc_ticks[tmr] < ticksper) {                        /* 1 sec yet? */
     }
 rtc_ticks[tmr] = 0;                                     /* reset ticks */
 rtc_elapsed[tmr] = rtc_elapsed[tmr] + 1;                /* count sec */
+sim_perf_snapshot (sim_os_msec (), FALSE);              /* performance rates */
 if (!rtc_avail) {                                       /* no timer? */
     return rtc_currd[tmr];
     }
@@ -743,6 +906,8 @@ do {
     if ((clock_diff > 0) && (clock_diff < sim_os_clock_resoluton_ms))
         sim_os_clock_resoluton_ms = clock_diff;
     clock_last = clock_now;
+    if (sim_os_clock_resoluton_ms == 1)                 /* can't do better, */
+        break;                                          /* so stop spinning */
     } while (clock_now < clock_start + 100);
 return (sim_idle_rate_ms != 0);
 }
@@ -862,6 +1027,14 @@ REG sim_timer_reg[] = {
     { DRDATAD (THROT_STATE,      sim_throt_state,        32, ""), PV_RSPC|REG_RO},
     { DRDATAD (THROT_SLEEP_TIME, sim_throt_sleep_time,   32, ""), PV_RSPC|REG_RO},
     { DRDATAD (THROT_WAIT,       sim_throt_wait,         32, ""), PV_RSPC|REG_RO},
+    { DRDATAD (THROT_SLICE_US,   sim_throt_slice_us,     32, "Deadline Throttle Check Interval (usec)"), PV_RSPC},
+    { DRDATAD (THROT_SPIN_US,    sim_throt_spin_us,      32, "Deadline Throttle Spin Window (usec)"), PV_RSPC},
+    { DRDATAD (IDLE_MS_SLEPT,    sim_idle_ms_slept,      32, "Milliseconds Slept Idling"), PV_RSPC|REG_RO},
+    { DRDATAD (THROT_MS_SLEPT,   sim_throt_ms_slept,     32, "Milliseconds Slept Throttling"), PV_RSPC|REG_RO},
+    { DRDATAD (PERF_IPS,         sim_perf_ips,           32, "Instructions Per Second (last second)"), PV_RSPC|REG_RO},
+    { DRDATAD (PERF_EPS,         sim_perf_eps,           32, "Events Per Second (last second)"), PV_RSPC|REG_RO},
+    { DRDATAD (PERF_IDLE_PCT,    sim_perf_idle_pct,      32, "Percent Idle (last second)"), PV_RSPC|REG_RO},
+    { DRDATAD (PERF_THROT_PCT,   sim_perf_throt_pct,     32, "Percent Throttled (last second)"), PV_RSPC|REG_RO},
     { NULL }
     };
 
@@ -984,6 +1157,7 @@ if (sim_clock_queue == QUEUE_LIST_END)
 else
     sim_debug (DBG_IDL, &sim_timer_dev, "sleeping for %d ms - pending event on %s in %d instructions\n", w_ms, sim_uname(sim_clock_queue), sim_interval);
 act_ms = SIM_IDLE_MS_SLEEP (w_ms);                      /* wait */
+sim_idle_ms_slept += act_ms;
 act_cyc = act_ms * cyc_ms;
 if (act_ms < w_ms)                                      /* awakened early? */
     act_cyc += (cyc_ms * sim_idle_rate_ms) / 2;         /* account for half an interval's worth of cycles */
@@ -997,6 +1171,53 @@ else
 return TRUE;
 }
 
+/* Automatic idle detection
+
+   For simulators without a known idle loop address the CPU can call
+   sim_idle_auto_fetch with the address of each instruction it starts.
+   A transfer back by no more than SIM_IDLE_AUTO_SPAN addresses closes
+   one pass of a tight loop.  When the same loop has been run
+   SIM_IDLE_AUTO_LOOPS times in a row without the CPU writing memory
+   (sim_idle_writes) and without any event being dispatched, the guest is
+   taken to be waiting and sim_idle sleeps until the next queued event.
+*/
+
+#define SIM_IDLE_AUTO_SPAN  8                           /* max loop length */
+#define SIM_IDLE_AUTO_LOOPS 32                          /* passes before idling */
+
+t_bool sim_idle_auto = FALSE;                           /* detection enabled */
+uint32 sim_idle_writes = 0;                             /* CPU memory writes */
+static t_addr sim_idle_auto_last = 0;                   /* previous instruction */
+static t_addr sim_idle_auto_top = 0;                    /* loop being watched */
+static t_addr sim_idle_auto_bottom = 0;
+static uint32 sim_idle_auto_passes = 0;
+static uint32 sim_idle_auto_wrt = 0;                    /* sim_idle_writes at loop start */
+static double sim_idle_auto_events = 0;                 /* dispatches at loop start */
+
+void _sim_idle_auto_fetch (t_addr pc)
+{
+t_addr last = sim_idle_auto_last;
+
+sim_idle_auto_last = pc;
+if ((pc > last) || ((last - pc) >= SIM_IDLE_AUTO_SPAN)) /* not a short backward transfer */
+    return;
+if ((pc != sim_idle_auto_top) || (last != sim_idle_auto_bottom) ||
+    (sim_idle_writes != sim_idle_auto_wrt) ||
+    (sim_queue_dispatches != sim_idle_auto_events)) {   /* new loop or activity? */
+    sim_idle_auto_top = pc;
+    sim_idle_auto_bottom = last;
+    sim_idle_auto_wrt = sim_idle_writes;
+    sim_idle_auto_events = sim_queue_dispatches;
+    sim_idle_auto_passes = 0;
+    return;
+    }
+if (++sim_idle_auto_passes < SIM_IDLE_AUTO_LOOPS)
+    return;
+sim_idle_auto_passes = 0;
+if (sim_calb_tmr >= 0)
+    sim_idle (sim_calb_tmr, FALSE);
+}
+
 /* Set idling - implicitly disables throttling */
 
 t_stat sim_set_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
@@ -1008,7 +1229,10 @@ if (sim_idle_rate_ms == 0)
     return sim_messagef (SCPE_NOFNC, "Idling is not available, Minimum OS sleep time is %dms\n", sim_os_sleep_min_ms);
 if ((val != 0) && (sim_idle_rate_ms > (uint32) val))
         return sim_messagef (SCPE_NOFNC, "Idling is not available, Minimum OS sleep time is %dms, Requied minimum OS sleep is %dms\n", sim_os_sleep_min_ms, val);
-if (cptr && *cptr) {
+sim_idle_auto = FALSE;
+if (cptr && (MATCH_CMD (cptr, "AUTO") == 0))            /* detect idle loops? */
+    sim_idle_auto = TRUE;
+else if (cptr && *cptr) {
     v = (uint32) get_uint (cptr, 10, SIM_IDLE_STMAX, &r);
     if ((r != SCPE_OK) || (v < SIM_IDLE_STMIN))
         return sim_messagef (SCPE_ARG, "Invalid Stability value: %s.  Valid values range from %d to %d.\n", cptr, SIM_IDLE_STMIN, SIM_IDLE_STMAX);
@@ -1027,6 +1251,7 @@ return SCPE_OK;
 t_stat sim_clr_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc)
 {
 sim_idle_enab = FALSE;
+sim_idle_auto = FALSE;
 return SCPE_OK;
 }
 
@@ -1035,7 +1260,7 @@ return SCPE_OK;
 t_stat sim_show_idle (FILE *st, UNIT *uptr, int32 val, CONST void *desc)
 {
 if (sim_idle_enab)
-    fprintf (st, "idle enabled");
+    fprintf (st, sim_idle_auto ? "idle=auto enabled" : "idle enabled");
 else
     fprintf (st, "idle disabled");
 if (sim_switches & SWMASK ('D'))
@@ -1050,6 +1275,7 @@ t_stat sim_set_throt (int32 arg, CONST char *cptr)
 CONST char *tptr;
 char c;
 t_value val, val2 = 0;
+uint32 type;
 
 if (arg == 0) {
     if ((cptr != 0) && (*cptr != 0))
@@ -1065,22 +1291,27 @@ else {
     val = strtotv (cptr, &tptr, 10);
     if (cptr == tptr)
         return SCPE_ARG;
-    sim_throt_sleep_time = sim_idle_rate_ms;
     c = (char)toupper (*tptr++);
     if (c == '/')
         val2 = strtotv (tptr, &tptr, 10);
     if ((*tptr != 0) || (val == 0))
         return SCPE_ARG;
     if (c == 'M') 
-        sim_throt_type = SIM_THROT_MCYC;
+        type = SIM_THROT_MCYC;
     else if (c == 'K')
-        sim_throt_type = SIM_THROT_KCYC;
+        type = SIM_THROT_KCYC;
     else if ((c == '%') && (val > 0) && (val < 100))
-        sim_throt_type = SIM_THROT_PCT;
+        type = SIM_THROT_PCT;
     else if ((c == '/') && (val2 != 0)) {
-        sim_throt_type = SIM_THROT_SPC;
+        type = SIM_THROT_SPC;
         }
     else return SCPE_ARG;
+    if ((sim_switches & SWMASK ('A')) &&                /* absolute deadlines? */
+        (type != SIM_THROT_MCYC) && (type != SIM_THROT_KCYC))
+        return sim_messagef (SCPE_ARG, "Deadline throttling needs a cycle rate (xM or xK)\n");
+    sim_throt_type = type;                              /* valid, now commit */
+    sim_throt_deadline = (sim_switches & SWMASK ('A')) ? TRUE : FALSE;
+    sim_throt_sleep_time = sim_idle_rate_ms;
     if (sim_idle_enab) {
         sim_printf ("Idling disabled\n");
         sim_clr_idle (NULL, 0, NULL, NULL);
@@ -1106,11 +1337,11 @@ else {
     switch (sim_throt_type) {
 
     case SIM_THROT_MCYC:
-        fprintf (st, "Throttle = %d megacycles\n", sim_throt_val);
+        fprintf (st, "Throttle = %d megacycles%s\n", sim_throt_val, sim_throt_deadline ? ", absolute deadlines" : "");
         break;
 
     case SIM_THROT_KCYC:
-        fprintf (st, "Throttle = %d kilocycles\n", sim_throt_val);
+        fprintf (st, "Throttle = %d kilocycles%s\n", sim_throt_val, sim_throt_deadline ? ", absolute deadlines" : "");
         break;
 
     case SIM_THROT_PCT:
@@ -1126,6 +1357,14 @@ else {
         break;
         }
 
+    if (sim_throt_deadline && (sim_throt_type != SIM_THROT_NONE)) {
+        fprintf (st, "Deadline check interval = %u usec, spin window = %u usec\n",
+                     sim_throt_slice_us, sim_throt_spin_us);
+        fprintf (st, "Deadline checks = %u, average lateness = %.1f usec, worst = %.1f usec, rebases = %u\n",
+                     sim_throt_checks, 
+                     sim_throt_checks ? (1000000.0 * sim_throt_late_sum) / sim_throt_checks : 0.0,
+                     1000000.0 * sim_throt_late_max, sim_throt_rebases);
+        }
     if (sim_switches & SWMASK ('D')) {
         if (sim_throt_type != 0)
             fprintf (st, "Throttle interval = %d cycles\n", sim_throt_wait);
@@ -1148,6 +1387,104 @@ void sim_throt_cancel (void)
 sim_cancel (&sim_timer_units[SIM_NTIMERS]);
 }
 
+/* Deadline throttling
+
+   Rather than measuring the host and then sleeping a fixed time every so
+   many cycles, deadline throttling computes when the current cycle count
+   is due (base time + cycles / rate) every sim_throt_slice_us worth of
+   cycles and waits for that moment: a sleep until sim_throt_spin_us
+   before it, then a spin.  Errors don't accumulate because each deadline
+   is absolute.  If the simulator falls more than SIM_THROT_LAG behind
+   (host busy, console I/O) the base is reset rather than running flat
+   out to catch up.
+*/
+
+#define SIM_THROT_LAG   0.1                         /* seconds behind before rebasing */
+
+#if defined (CLOCK_MONOTONIC)
+#define SIM_THROT_CLOCK CLOCK_MONOTONIC
+#else
+#define SIM_THROT_CLOCK CLOCK_REALTIME
+#endif
+
+static double _sim_throt_now (void)
+{
+struct timespec now;
+
+clock_gettime (SIM_THROT_CLOCK, &now);
+return ((double)now.tv_sec) + ((double)now.tv_nsec) / 1000000000.0;
+}
+
+/* Host elapsed time in seconds, for interval measurements */
+
+double sim_host_time (void)
+{
+return _sim_throt_now ();
+}
+
+static void _sim_throt_rebase (double now)
+{
+sim_throt_base_time = now;
+sim_throt_base_gtime = sim_gtime ();
+}
+
+static void _sim_throt_until (double due)
+{
+double now = _sim_throt_now ();
+double start = now;
+double sleep = (due - now) - (sim_throt_spin_us / 1000000.0);
+uint32 ms;
+
+if (sleep > 0.0) {
+#if defined (_WIN32)
+    sim_os_ms_sleep ((uint32)(sleep * 1000.0));
+#else
+    struct timespec treq;
+
+    treq.tv_sec = (time_t)sleep;
+    treq.tv_nsec = (long)((sleep - (double)treq.tv_sec) * 1000000000.0);
+    (void) nanosleep (&treq, NULL);
+#endif
+    }
+while ((now = _sim_throt_now ()) < due)                 /* spin the rest */
+    ;
+sim_throt_late_sum += now - due;
+if ((now - due) > sim_throt_late_max)
+    sim_throt_late_max = now - due;
+sim_throt_slept_frac += (now - start) * 1000.0;
+ms = (uint32)sim_throt_slept_frac;
+sim_throt_ms_slept += ms;
+sim_throt_slept_frac -= ms;
+}
+
+static void _sim_throt_deadline_svc (void)
+{
+double now = _sim_throt_now ();
+double due;
+
+if (sim_throt_state != 3) {                             /* starting? */
+    sim_throt_cps = (double) sim_throt_val * ((sim_throt_type == SIM_THROT_MCYC) ? 1000000.0 : 1000.0);
+    sim_throt_wait = (int32)((sim_throt_cps * sim_throt_slice_us) / 1000000.0);
+    if (sim_throt_wait < SIM_THROT_WMIN)
+        sim_throt_wait = SIM_THROT_WMIN;
+    sim_throt_checks = sim_throt_rebases = 0;
+    sim_throt_late_sum = sim_throt_late_max = 0.0;
+    _sim_throt_rebase (now);
+    sim_throt_state = 3;
+    return;
+    }
+due = sim_throt_base_time + (sim_gtime () - sim_throt_base_gtime) / sim_throt_cps;
+sim_throt_checks++;
+if ((now - due) > SIM_THROT_LAG) {                      /* too far behind? */
+    sim_throt_rebases++;
+    _sim_throt_rebase (now);
+    }
+else if (due > now)
+    _sim_throt_until (due);
+else
+    sim_throt_late_sum += now - due;
+}
+
 /* Throttle service
 
    Throttle service has three distinct states used while dynamically
@@ -1156,12 +1493,19 @@ sim_cancel (&sim_timer_units[SIM_NTIMERS]);
        0    take initial measurement
        1    take final measurement, calculate wait values
        2    periodic waits to slow down the CPU
+
+   Deadline throttling uses state 3 once it has set its base.
 */
 t_stat sim_throt_svc (UNIT *uptr)
 {
 uint32 delta_ms;
 double a_cps, d_cps;
 
+if (sim_throt_deadline) {                               /* absolute deadlines? */
+    _sim_throt_deadline_svc ();
+    sim_activate (uptr, sim_throt_wait);
+    return SCPE_OK;
+    }
 if (sim_throt_type == SIM_THROT_SPC) {                  /* Non dynamic? */
     sim_throt_state = 2;                                /* force state */
     sim_throt_wait = sim_throt_val;
@@ -1211,7 +1555,7 @@ switch (sim_throt_state) {
         break;
 
     case 2:                                             /* throttling */
-        SIM_IDLE_MS_SLEEP (sim_throt_sleep_time);
+        sim_throt_ms_slept += SIM_IDLE_MS_SLEEP (sim_throt_sleep_time);
         delta_ms = sim_os_msec () - sim_throt_ms_start;
         if ((sim_throt_type != SIM_THROT_SPC) &&        /* when dynamic throttling */
             (delta_ms >= 10000)) {                      /* recompute every 10 sec */
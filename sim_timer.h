@@ -102,6 +102,7 @@ int clock_gettime(int clock_id, struct timespec *tp);
 
 t_bool sim_timer_init (void);
 void sim_timespec_diff (struct timespec *diff, struct timespec *min, struct timespec *sub);
+double sim_host_time (void);
 #if defined(SIM_ASYNCH_CLOCKS)
 double sim_timenow_double (void);
 #endif
@@ -113,12 +114,18 @@ int32 sim_rtc_init (int32 time);
 int32 sim_rtc_calb (int32 ticksper);
 t_stat sim_show_timers (FILE* st, DEVICE *dptr, UNIT* uptr, int32 val, CONST char* desc);
 t_stat sim_show_clock_queues (FILE *st, DEVICE *dptr, UNIT *uptr, int32 flag, CONST char *cptr);
+t_stat sim_show_performance (FILE* st, DEVICE *dnotused, UNIT* unotused, int32 flag, CONST char* cptr);
+void sim_perf_run_start (void);
+void sim_perf_run_stop (void);
 t_bool sim_idle (uint32 tmr, t_bool sin_cyc);
 t_stat sim_set_throt (int32 arg, CONST char *cptr);
 t_stat sim_show_throt (FILE *st, DEVICE *dnotused, UNIT *unotused, int32 flag, CONST char *cptr);
 t_stat sim_set_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_clr_idle (UNIT *uptr, int32 val, CONST char *cptr, void *desc);
 t_stat sim_show_idle (FILE *st, UNIT *uptr, int32 val, CONST void *desc);
+void _sim_idle_auto_fetch (t_addr pc);
+#define sim_idle_auto_fetch(pc) \
+    do { if (sim_idle_auto) _sim_idle_auto_fetch (pc); } while (0)
 void sim_throt_sched (void);
 void sim_throt_cancel (void);
 uint32 sim_os_msec (void);
@@ -138,6 +145,8 @@ double sim_timer_inst_per_sec (void);
 t_bool sim_timer_idle_capable (uint32 *host_ms_sleep_1, uint32 *host_tick_ms);
 
 extern t_bool sim_idle_enab;                        /* idle enabled flag */
+extern t_bool sim_idle_auto;                        /* automatic idle detection */
+extern uint32 sim_idle_writes;                      /* CPU memory writes, for sim_idle_auto */
 extern volatile t_bool sim_idle_wait;               /* idle waiting flag */
 extern t_bool sim_asynch_timer;
 extern DEVICE sim_timer_dev;
@@ -69,10 +69,12 @@
    tmxr_getc_ln -                       get character for line
    tmxr_get_packet_ln -                 get packet from line
    tmxr_get_packet_ln_ex -              get packet from line with separater byte
+   tmxr_get_buf_ln -                    get a run of characters from line
    tmxr_poll_rx -                       poll receive
    tmxr_putc_ln -                       put character for line
    tmxr_put_packet_ln -                 put packet on line
    tmxr_put_packet_ln_ex -              put packet on line with separator byte
+   tmxr_put_buf_ln -                    put a buffer of characters on line
    tmxr_poll_tx -                       poll transmit
    tmxr_send_buffered_data -            transmit buffered data
    tmxr_set_modem_control_passthru -    enable modem control on a multiplexer
@@ -93,6 +95,7 @@
    tmxr_dep     -                       (null) deposit
    tmxr_msg     -                       send message to socket
    tmxr_linemsg -                       send message to line
+   tmxr_linemsgn -                      send counted message to line
    tmxr_linemsgf -                      send formatted message to line
    tmxr_fconns  -                       output connection status
    tmxr_fstats  -                       output connection statistics
@@ -342,6 +345,17 @@
 #include <ctype.h>
 #include <math.h>
 
+/* On Linux, socket lines are registered with an epoll descriptor so that
+   tmxr_poll_rx only reads lines which actually have input available rather
+   than issuing a recv on every connected line on every poll. */
+
+#if defined(__linux) && !defined(TMXR_NO_EPOLL)
+#define TMXR_USE_EPOLL 1
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 /* Telnet protocol constants - negatives are for init'ing signed char data */
 
 /* Commands */
@@ -463,6 +477,10 @@ lp->rxbpr = lp->rxbpi = lp->rxcnt = lp->rxpcnt = 0;     /* init receive indexes
 if (!lp->txbfd || lp->notelnet)                         /* if not buffered telnet */
     lp->txbpr = lp->txbpi = lp->txcnt = lp->txpcnt = 0; /*   init transmit indexes */
 lp->txdrp = 0;
+memset (lp->rxlat, 0, sizeof (lp->rxlat));             /* clear queueing statistics */
+memset (lp->txlat, 0, sizeof (lp->txlat));
+lp->rxlatsum = lp->txlatsum = 0.0;
+lp->rxstall = 0;
 tmxr_set_get_modem_bits (lp, 0, 0, NULL);
 if ((!lp->mp->buffered) && (!lp->txbfd)) {
     lp->txbfd = 0;
@@ -711,6 +729,59 @@ else {                                                  /* Telnet connection */
 }
 
 
+/* Write buffered data which wraps around the end of the transmit buffer.
+
+   Socket and serial lines send both pieces with a single gather write.
+   Other lines write up to the end of the buffer, as tmxr_write would.
+*/
+
+static int32 tmxr_write_wrap (TMLN *lp, int32 length)
+{
+int32 first = lp->txbsz - lp->txbpr;
+const char *bufs[2];
+int lens[2];
+int32 written;
+
+if (lp->loopback || lp->datagram || (length <= first))
+    return tmxr_write (lp, (length < first) ? length : first);
+bufs[0] = &(lp->txb[lp->txbpr]);
+lens[0] = first;
+bufs[1] = lp->txb;
+lens[1] = length - first;
+if (lp->serport) {                                      /* serial port connection? */
+    int32 counts[2];
+
+    counts[0] = lens[0];
+    counts[1] = lens[1];
+    return sim_writev_serial (lp->serport, (char **)bufs, counts, 2);
+    }
+written = sim_writev_sock (lp->sock, bufs, lens, 2);
+if (written == SOCKET_ERROR)                            /* did an error occur? */
+    return -1;                                          /* return error indication */
+return written;
+}
+
+
+/* Record queueing delay.
+
+   "count" characters waited "delay" seconds in a line buffer.  The histogram
+   buckets are decades starting below 10 microseconds.
+*/
+
+static void tmxr_lat_record (uint32 *hist, double *sum, double delay, int32 count)
+{
+int32 b = 0;
+double lim = 0.00001;
+
+while ((b < TMXR_LAT_BUCKETS - 1) && (delay >= lim)) {
+    ++b;
+    lim *= 10.0;
+    }
+hist[b] += count;
+*sum += delay * count;
+}
+
+
 /* Remove a character from the read buffer.
 
    The character at position "p" in the read buffer associated with line "lp" is
@@ -826,6 +897,24 @@ static char *growstring(char **string, size_t growth)
 return *string + strlen(*string);
 }
 
+/* Socket option flags for line connections and listeners of a multiplexer */
+
+static int tmxr_sock_opts (TMXR *mp, t_bool packet)
+{
+return (packet ? SIM_SOCK_OPT_NODELAY : 0) | (mp->sockopts & SIM_SOCK_OPT_NODELAY);
+}
+
+static int tmxr_master_opts (TMXR *mp)
+{
+return ((sim_switches & SWMASK ('U')) ? SIM_SOCK_OPT_REUSEADDR : 0) | (mp->sockopts & SIM_SOCK_OPT_REUSEPORT);
+}
+
+static void tmxr_sock_setup (TMXR *mp, SOCKET sock)
+{
+if (mp->sockbuf && (sock != INVALID_SOCKET))
+    sim_setbufsize_sock (sock, mp->sockbuf);
+}
+
 static char *tmxr_mux_attach_string(char *old, TMXR *mp)
 {
 char* tptr = NULL;
@@ -842,6 +931,12 @@ if (mp->port)                                           /* copy port */
     sprintf (growstring(&tptr, 13 + strlen (mp->port)), "%s%s", mp->port, mp->notelnet ? ";notelnet" : "");
 if (mp->logfiletmpl[0])                                 /* logfile info */
     sprintf (growstring(&tptr, 7 + strlen (mp->logfiletmpl)), ",Log=%s", mp->logfiletmpl);
+if (mp->sockopts & SIM_SOCK_OPT_NODELAY)
+    sprintf (growstring(&tptr, 10), ",NoDelay");
+if (mp->sockopts & SIM_SOCK_OPT_REUSEPORT)
+    sprintf (growstring(&tptr, 12), ",ReusePort");
+if (mp->sockbuf)
+    sprintf (growstring(&tptr, 24), ",SockBuf=%d", (int)mp->sockbuf);
 while ((*tptr == ',') || (*tptr == ' '))
     memcpy (tptr, tptr+1, strlen(tptr+1)+1);
 for (i=0; i<mp->lines; ++i) {
@@ -989,7 +1084,8 @@ if (mp->last_poll_time == 0) {                          /* first poll initializa
         }
     }
 
-if ((poll_time - mp->last_poll_time) < mp->poll_interval*1000)
+if ((!mp->accept_more) &&                               /* backlog drained and */
+    ((poll_time - mp->last_poll_time) < mp->poll_interval*1000))
     return -1;                                          /* too soon to try */
 
 srand((unsigned int)poll_time);
@@ -1005,9 +1101,13 @@ if (mp->master) {
         mp->ring_sock = INVALID_SOCKET;
         address = mp->ring_ipad;
         mp->ring_ipad = NULL;
+        mp->accept_more = FALSE;
+        }
+    else {
+        newsock = sim_accept_conn_ex (mp->master, &address, tmxr_sock_opts (mp, mp->packet));/* poll connect */
+        mp->accept_more = (newsock != INVALID_SOCKET);  /* keep draining a connection burst */
+        tmxr_sock_setup (mp, newsock);
         }
-    else
-        newsock = sim_accept_conn_ex (mp->master, &address, (mp->packet ? SIM_SOCK_OPT_NODELAY : 0));/* poll connect */
 
     if (newsock != INVALID_SOCKET) {                    /* got a live one? */
         sprintf (msg, "tmxr_poll_conn() - Connection from %s", address);
@@ -1141,6 +1241,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                             lp->conn = TRUE;                    /* record connection */
                             lp->sock = lp->connecting;          /* it now looks normal */
                             lp->connecting = 0;
+                            tmxr_sock_setup (lp->mp, lp->sock);
                             lp->ipad = (char *)realloc (lp->ipad, 1+strlen (lp->destination));
                             strcpy (lp->ipad, lp->destination);
                             lp->cnms = sim_os_msec ();
@@ -1160,9 +1261,10 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
                 break;
             case 1:
                 if (lp->master) {                                   /* Check for a pending Telnet/tcp connection */
-                    while (INVALID_SOCKET != (newsock = sim_accept_conn_ex (lp->master, &address, (lp->packet ? SIM_SOCK_OPT_NODELAY : 0)))) {/* got a live one? */
+                    while (INVALID_SOCKET != (newsock = sim_accept_conn_ex (lp->master, &address, tmxr_sock_opts (lp->mp, lp->packet)))) {/* got a live one? */
                         char *sockname, *peername;
 
+                        tmxr_sock_setup (mp, newsock);
                         sim_getnames_sock (newsock, &sockname, &peername);
                         sprintf (msg, "tmxr_poll_conn() - Incoming Line Connection from %s (%s->%s)", address, peername, sockname);
                         tmxr_debug_connect_line (lp, msg);
@@ -1228,7 +1330,7 @@ for (i = 0; i < mp->lines; i++) {                       /* check each line in se
         (!lp->modem_control || (lp->modembits & TMXR_MDM_DTR))) {
         sprintf (msg, "tmxr_poll_conn() - establishing outgoing connection to: %s", lp->destination);
         tmxr_debug_connect_line (lp, msg);
-        lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | (lp->mp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+        lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | tmxr_sock_opts (lp->mp, lp->mp->packet));
         }
 
     }
@@ -1284,6 +1386,7 @@ else                                                    /* Telnet connection */
         free (lp->telnet_sent_opts);
         lp->telnet_sent_opts = NULL;
         lp->sock = 0;
+        lp->rdy_sock = 0;                               /* closing dropped any registration */
         lp->conn = FALSE;
         lp->cnms = 0;
         lp->xmte = 1;
@@ -1298,7 +1401,7 @@ if ((lp->destination) && (!lp->serport)) {
     if ((!lp->modem_control) || (lp->modembits & TMXR_MDM_DTR)) {
         sprintf (msg, "tmxr_reset_ln_ex() - connecting to %s", lp->destination);
         tmxr_debug_connect_line (lp, msg);
-        lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | (lp->mp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+        lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | tmxr_sock_opts (lp->mp, lp->mp->packet));
         }
     }
 tmxr_init_line (lp);                                /* initialize line state */
@@ -1514,7 +1617,7 @@ if (lp->mp && lp->modem_control) {                  /* This API ONLY works on mo
 
                 sprintf (msg, "tmxr_set_get_modem_bits() - establishing outgoing connection to: %s", lp->destination);
                 tmxr_debug_connect_line (lp, msg);
-                lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | (lp->mp->packet ? SIM_SOCK_OPT_NODELAY : 0));
+                lp->connecting = sim_connect_sock_ex (lp->datagram ? lp->port : NULL, lp->destination, "localhost", NULL, (lp->datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | tmxr_sock_opts (lp->mp, lp->mp->packet));
                 }
             }
         }
@@ -1649,6 +1752,9 @@ t_stat val = 0;
 uint32 tmp;
 
 tmxr_debug_trace_line (lp, "tmxr_getc_ln()");
+if (lp->rxbps && (lp->rxbpi != lp->rxbpr) &&            /* data held back by */
+    (sim_gtime () < lp->rxnexttime))                    /*   rate limiting? */
+    ++lp->rxstall;
 if ((lp->conn && lp->rcve) &&                           /* conn & enb & */
     ((!lp->rxbps) ||                                    /* (!rate limited || enough time passed)? */
      (sim_gtime () >= lp->rxnexttime))) {
@@ -1662,6 +1768,7 @@ if ((lp->conn && lp->rcve) &&                           /* conn & enb & */
                 val = val | SCPE_BREAK;                 /* indicate to caller */
                 }
             lp->rxbpr = lp->rxbpr + 1;                  /* adv pointer */
+            tmxr_lat_record (lp->rxlat, &lp->rxlatsum, sim_host_time () - lp->rxstamp, 1);
             }
         }
     }                                                   /* end if conn */
@@ -1742,6 +1849,69 @@ if (lp->conn)
 return SCPE_LOST;
 }
 
+/* Get a run of characters from specific line
+
+   Inputs:
+        *lp     =       pointer to terminal line descriptor
+        *buf    =       buffer to receive the characters
+        size    =       size of buffer
+        *brk    =       pointer to break status (may be NULL)
+
+   Output:
+        number of characters stored in buf
+
+   Implementation notes:
+
+    1. The characters are moved directly out of the receive buffer, with the
+       same connection and enable checks that tmxr_getc_ln performs.
+    2. A character received coincident with a line break ends the run.  It is
+       the last character returned and *brk is set to TRUE.
+    3. Rate limited lines and lines with SEND data pending return characters
+       just as repeated calls to tmxr_getc_ln would.
+*/
+
+int32 tmxr_get_buf_ln (TMLN *lp, uint8 *buf, int32 size, t_bool *brk)
+{
+int32 i, n = 0;
+int32 c;
+
+tmxr_debug_trace_line (lp, "tmxr_get_buf_ln()");
+if (brk)
+    *brk = FALSE;
+if (lp->rxbps || (lp->send.extoff < lp->send.insoff)) {
+    while ((n < size) && 
+           ((c = tmxr_getc_ln (lp)) & (TMXR_VALID | SCPE_KFLAG))) {
+        buf[n++] = (uint8)c;
+        if (c & SCPE_BREAK) {
+            if (brk)
+                *brk = TRUE;
+            break;
+            }
+        }
+    return n;
+    }
+if (lp->conn && lp->rcve) {                             /* conn & enb? */
+    n = lp->rxbpi - lp->rxbpr;                          /* # input chrs */
+    if (n > size)
+        n = size;
+    for (i = 0; i < n; i++)                             /* stop at a break */
+        if (lp->rbr[lp->rxbpr + i]) {
+            lp->rbr[lp->rxbpr + i] = 0;                 /* clear status */
+            n = i + 1;
+            if (brk)
+                *brk = TRUE;
+            break;
+            }
+    memcpy (buf, &(lp->rxb[lp->rxbpr]), n);
+    lp->rxbpr = lp->rxbpr + n;                          /* adv pointer */
+    if (n)
+        tmxr_lat_record (lp->rxlat, &lp->rxlatsum, sim_host_time () - lp->rxstamp, n);
+    }
+if (lp->rxbpi == lp->rxbpr)                             /* empty? zero ptrs */
+    lp->rxbpi = lp->rxbpr = 0;
+return n;
+}
+
 /* Poll for input
 
    Inputs:
@@ -1749,17 +1919,78 @@ return SCPE_LOST;
    Outputs:     none
 */
 
+#if defined(TMXR_USE_EPOLL)
+/* Determine which socket lines are readable
+
+   Socket lines whose socket has changed since the last poll are (re)registered
+   with the multiplexer's epoll descriptor.  The descriptor is then polled
+   without waiting and the readable lines are flagged.  If the descriptor can't
+   be created, no line is ever registered and every line is read as before.
+*/
+
+static void tmxr_poll_ready (TMXR *mp)
+{
+struct epoll_event ev[64];
+int32 i, n, polls;
+TMLN *lp;
+
+if (!mp->rdy_active) {
+    int fd = epoll_create (mp->lines + 1);
+
+    if (fd < 0)
+        return;
+    mp->rdy_fd = fd;
+    mp->rdy_active = TRUE;
+    }
+for (i = 0; i < mp->lines; i++) {
+    lp = mp->ldsc + i;
+    lp->rdy = FALSE;
+    if (!lp->sock || lp->serport || lp->loopback) {
+        lp->rdy_sock = 0;
+        continue;
+        }
+    if (lp->sock == lp->rdy_sock)                       /* already registered? */
+        continue;
+    memset (&ev[0], 0, sizeof (ev[0]));
+    ev[0].events = EPOLLIN;
+    ev[0].data.u32 = (uint32)i;
+    if ((epoll_ctl (mp->rdy_fd, EPOLL_CTL_ADD, lp->sock, &ev[0]) == 0) ||
+        ((errno == EEXIST) && 
+         (epoll_ctl (mp->rdy_fd, EPOLL_CTL_MOD, lp->sock, &ev[0]) == 0)))
+        lp->rdy_sock = lp->sock;
+    else
+        lp->rdy_sock = 0;                               /* read unconditionally */
+    }
+/* Readiness is level triggered and nothing is read here, so a full batch
+   can come back on every call.  Epoll rotates the ready lines, so one call
+   per batch of lines reports them all. */
+polls = (mp->lines + 63) / 64;
+do {
+    n = epoll_wait (mp->rdy_fd, ev, sizeof (ev) / sizeof (ev[0]), 0);
+    for (i = 0; i < n; i++)
+        if (ev[i].data.u32 < (uint32)mp->lines)
+            mp->ldsc[ev[i].data.u32].rdy = TRUE;
+    } while ((n == sizeof (ev) / sizeof (ev[0])) && (--polls > 0));
+}
+#endif
+
 void tmxr_poll_rx (TMXR *mp)
 {
 int32 i, nbytes, j;
 TMLN *lp;
 
 tmxr_debug_trace (mp, "tmxr_poll_rx()");
+#if defined(TMXR_USE_EPOLL)
+tmxr_poll_ready (mp);
+#endif
 for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
     lp = mp->ldsc + i;                                  /* get line desc */
     if (!(lp->sock || lp->serport || lp->loopback) || 
         !(lp->rcve))                                    /* skip if not connected */
         continue;
+    if (lp->rdy_sock && (lp->rdy_sock == lp->sock) &&   /* registered socket line */
+        !lp->rdy)                                       /* with nothing to read? */
+        continue;
 
     nbytes = 0;
     if (lp->rxbpi == 0)                                 /* need input? */
@@ -1781,6 +2012,8 @@ for (i = 0; i < mp->lines; i++) {                       /* loop thru lines */
 
         tmxr_debug (TMXR_DBG_RCV, lp, "Received", &(lp->rxb[lp->rxbpi]), nbytes);
 
+        if (lp->rxbpi == lp->rxbpr)                     /* first data waiting? */
+            lp->rxstamp = sim_host_time ();             /* note arrival time */
         j = lp->rxbpi;                                  /* start of data */
         lp->rxbpi = lp->rxbpi + nbytes;                 /* adv pointers */
         lp->rxcnt = lp->rxcnt + nbytes;
@@ -2035,6 +2268,8 @@ tmxr_debug_trace_line (lp, "tmxr_putc_ln()");
         lp->txbpr = (1+lp->txbpr)%lp->txbsz, ++lp->txdrp; \
     }
 if ((lp->txbfd && !lp->notelnet) || (TXBUF_AVAIL(lp) > 1)) {/* room for char (+ IAC)? */
+    if (lp->txbpi == lp->txbpr)                         /* buffer was empty? */
+        lp->txstamp = sim_host_time ();                 /* note queueing time */
     if ((TN_IAC == (u_char) chr) && (!lp->notelnet))    /* char == IAC in telnet session? */
         TXBUF_CHAR (lp, TN_IAC);                        /* stuff extra IAC char */
     TXBUF_CHAR (lp, chr);                               /* buffer char & adv pointer */
@@ -2104,6 +2339,79 @@ tmxr_send_buffered_data (lp);
 return (lp->conn || lp->loopback) ? SCPE_OK : SCPE_LOST;
 }
 
+/* Store a buffer of characters in line buffer
+
+   Inputs:
+        *lp     =       pointer to line descriptor
+        *buf    =       pointer to character data
+        size    =       number of characters
+        *psent  =       pointer to count of characters stored (may be NULL)
+
+   Outputs:
+        status  =       ok, connection lost, or stall
+
+   Implementation notes:
+
+    1. The result is the same as calling tmxr_putc_ln for each character,
+       stopping at the first one which doesn't return SCPE_OK.  Runs of
+       characters which need no Telnet escaping are copied as a block.
+    2. If not all of the characters fit, SCPE_STALL is returned and *psent
+       tells the caller where to resume.
+*/
+
+t_stat tmxr_put_buf_ln (TMLN *lp, const uint8 *buf, size_t size, size_t *psent)
+{
+size_t sent = 0;
+size_t run, i;
+int32 room;
+t_stat r = SCPE_OK;
+
+tmxr_debug_trace_line (lp, "tmxr_put_buf_ln()");
+while (sent < size) {
+    if ((lp->conn == FALSE) ||                          /* not connected or */
+        (lp->txbfd && !lp->notelnet) ||                 /*   buffered telnet or */
+        ((!lp->notelnet) && (buf[sent] == TN_IAC))) {   /*   IAC needs escaping? */
+        r = tmxr_putc_ln (lp, buf[sent]);               /* let putc handle it */
+        if (r != SCPE_OK)
+            break;
+        ++sent;
+        continue;
+        }
+    room = TXBUF_AVAIL (lp) - 1;                        /* keep one slot free */
+    if (room <= 0) {
+        ++lp->txdrp; lp->xmte = 0;                      /* no room, dsbl line */
+        r = SCPE_STALL;
+        break;
+        }
+    run = size - sent;
+    if (run > (size_t)room)
+        run = (size_t)room;
+    if (run > (size_t)(lp->txbsz - lp->txbpi))          /* up to end of buffer */
+        run = (size_t)(lp->txbsz - lp->txbpi);
+    if (!lp->notelnet) {                                /* stop short of an IAC */
+        const uint8 *iac = (const uint8 *)memchr (&buf[sent], TN_IAC, run);
+
+        if (iac)
+            run = (size_t)(iac - &buf[sent]);
+        }
+    if (lp->txbpi == lp->txbpr)                         /* buffer was empty? */
+        lp->txstamp = sim_host_time ();                 /* note queueing time */
+    memcpy (&(lp->txb[lp->txbpi]), &buf[sent], run);
+    lp->txbpi = (lp->txbpi + (int32)run) % lp->txbsz;
+    if ((!lp->txbfd) && (TXBUF_AVAIL (lp) <= TMXR_GUARD))/* near full? */
+        lp->xmte = 0;                                   /* disable line */
+    if (lp->txlog)                                      /* log if available */
+        fwrite (&buf[sent], 1, run, lp->txlog);
+    if (lp->expect.rules)                               /* process expect rules */
+        for (i = 0; i < run; i++)
+            sim_exp_check (&lp->expect, buf[sent + i]);
+    sent += run;
+    }
+if (psent)
+    *psent = sent;
+return r;
+}
+
 /* Poll for output
 
    Inputs:
@@ -2157,13 +2465,19 @@ if (nbytes) {                                           /* >0? write */
     if (lp->txbpr < lp->txbpi)                          /* no wrap? */
         sbytes = tmxr_write (lp, nbytes);               /* write all data */
     else
-        sbytes = tmxr_write (lp, lp->txbsz - lp->txbpr);/* write to end buf */
+        sbytes = tmxr_write_wrap (lp, nbytes);          /* write to end buf and beyond */
     if (sbytes >= 0) {                                  /* ok? */
-        tmxr_debug (TMXR_DBG_XMT, lp, "Sent", &(lp->txb[lp->txbpr]), sbytes);
+        int32 first = lp->txbsz - lp->txbpr;
+
+        tmxr_debug (TMXR_DBG_XMT, lp, "Sent", &(lp->txb[lp->txbpr]), (sbytes < first) ? sbytes : first);
+        if (sbytes > first)
+            tmxr_debug (TMXR_DBG_XMT, lp, "Sent", lp->txb, sbytes - first);
         lp->txbpr = (lp->txbpr + sbytes);               /* update remove ptr */
         if (lp->txbpr >= lp->txbsz)                     /* wrap? */
-            lp->txbpr = 0;
+            lp->txbpr -= lp->txbsz;
         lp->txcnt = lp->txcnt + sbytes;                 /* update counts */
+        if (sbytes)
+            tmxr_lat_record (lp->txlat, &lp->txlatsum, sim_host_time () - lp->txstamp, sbytes);
         nbytes = nbytes - sbytes;
         if ((nbytes == 0) && (lp->datagram))            /* if Empty buffer on datagram line */
             lp->txbpi = lp->txbpr = 0;                  /* Start next packet at beginning of buffer */
@@ -2182,6 +2496,7 @@ if (nbytes) {                                           /* >0? write */
             if (lp->txbpr >= lp->txbsz)                 /* wrap? */
                 lp->txbpr = 0;
             lp->txcnt = lp->txcnt + sbytes;             /* update counts */
+            tmxr_lat_record (lp->txlat, &lp->txlatsum, sim_host_time () - lp->txstamp, sbytes);
             nbytes = nbytes - sbytes;
             }
         }
@@ -2479,6 +2794,27 @@ while (*tptr) {
                 packet = TRUE;
                 continue;
                 }
+            if (0 == MATCH_CMD (gbuf, "NODELAY")) {
+                if ((NULL != cptr) && ('\0' != *cptr))
+                    return sim_messagef (SCPE_2MARG, "Unexpected NoDelay Specifier: %s\n", cptr);
+                mp->sockopts |= SIM_SOCK_OPT_NODELAY;
+                continue;
+                }
+            if (0 == MATCH_CMD (gbuf, "REUSEPORT")) {
+                if ((NULL != cptr) && ('\0' != *cptr))
+                    return sim_messagef (SCPE_2MARG, "Unexpected ReusePort Specifier: %s\n", cptr);
+                mp->sockopts |= SIM_SOCK_OPT_REUSEPORT;
+                continue;
+                }
+            if (0 == MATCH_CMD (gbuf, "SOCKBUF")) {
+                if ((NULL == cptr) || ('\0' == *cptr))
+                    return sim_messagef (SCPE_2FARG, "Missing SockBuf Specifier\n");
+                i = (int32) get_uint (cptr, 10, 16*1024*1024, &r);
+                if (r || (i < 1024))
+                    return sim_messagef (SCPE_ARG, "Invalid SockBuf Specifier: %s\n", cptr);
+                mp->sockbuf = i;
+                continue;
+                }
             if ((0 == MATCH_CMD (gbuf, "STREAM")) || (0 == MATCH_CMD (gbuf, "TCP"))) {
                 if ((NULL != cptr) && ('\0' != *cptr))
                     return sim_messagef (SCPE_2MARG, "Unexpected Stream Specifier: %s\n", cptr);
@@ -2515,7 +2851,7 @@ while (*tptr) {
             cptr = init_cptr;
             }
         cptr = get_glyph_nc (cptr, port, ';');
-        sock = sim_master_sock (port, &r);                      /* make master socket to validate port */
+        sock = sim_master_sock_ex (port, &r, tmxr_master_opts (mp));/* make master socket to validate port */
         if (r)
             return sim_messagef (SCPE_ARG, "Invalid Port Specifier: %s\n", port);
         if (sock == INVALID_SOCKET)                             /* open error */
@@ -2562,7 +2898,7 @@ while (*tptr) {
                     else
                         return sim_messagef (SCPE_ARG, "Unexpected specifier: %s\n", eptr);
                 }
-            sock = sim_connect_sock_ex (NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | (packet ? SIM_SOCK_OPT_NODELAY : 0));
+            sock = sim_connect_sock_ex (NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | tmxr_sock_opts (mp, packet));
             if (sock != INVALID_SOCKET)
                 sim_close_sock (sock);
             else
@@ -2624,7 +2960,7 @@ while (*tptr) {
                 }
             }
         if ((listen[0]) && (!datagram)) {
-            sock = sim_master_sock (listen, &r);            /* make master socket */
+            sock = sim_master_sock_ex (listen, &r, tmxr_master_opts (mp));/* make master socket */
             if (r)
                 return sim_messagef (SCPE_ARG, "Invalid network listen port: %s\n", listen);
             if (sock == INVALID_SOCKET)                     /* open error */
@@ -2663,6 +2999,7 @@ while (*tptr) {
                     }
                 tmxr_init_line (lp);                        /* initialize line state */
                 lp->sock = 0;                               /* clear the socket */
+                lp->rdy_sock = 0;
                 }
             }
         if (loopback) {
@@ -2715,7 +3052,7 @@ while (*tptr) {
                         return sim_messagef (SCPE_ARG, "Missing listen port for Datagram socket\n");
                     }
                 lp->packet = packet;
-                sock = sim_connect_sock_ex (datagram ? listen : NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | (packet ? SIM_SOCK_OPT_NODELAY : 0));
+                sock = sim_connect_sock_ex (datagram ? listen : NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | tmxr_sock_opts (mp, packet));
                 if (sock != INVALID_SOCKET) {
                     _mux_detach_line (lp, FALSE, TRUE);
                     lp->destination = (char *)malloc(1+strlen(hostport));
@@ -2780,7 +3117,7 @@ while (*tptr) {
         if ((listen[0]) && (!datagram)) {
             if ((mp->lines == 1) && (mp->master))
                 return sim_messagef (SCPE_ARG, "Single Line MUX can have either line specific OR MUS listener but NOT both\n");
-            sock = sim_master_sock (listen, &r);            /* make master socket */
+            sock = sim_master_sock_ex (listen, &r, tmxr_master_opts (mp));/* make master socket */
             if (r)
                 return sim_messagef (SCPE_ARG, "Invalid Listen Specification: %s\n", listen);
             if (sock == INVALID_SOCKET)                     /* open error */
@@ -2823,7 +3160,7 @@ while (*tptr) {
                     else
                         return sim_messagef (SCPE_ARG, "Missing listen port for Datagram socket\n");
                     }
-                sock = sim_connect_sock_ex (datagram ? listen : NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | (packet ? SIM_SOCK_OPT_NODELAY : 0));
+                sock = sim_connect_sock_ex (datagram ? listen : NULL, hostport, "localhost", NULL, (datagram ? SIM_SOCK_OPT_DATAGRAM : 0) | tmxr_sock_opts (mp, packet));
                 if (sock != INVALID_SOCKET) {
                     _mux_detach_line (lp, FALSE, TRUE);
                     lp->destination = (char *)malloc(1+strlen(hostport));
@@ -3695,6 +4032,12 @@ else {
             fprintf(st, ", ModemControl=enabled");
         if (mp->buffered)
             fprintf(st, ", Buffered=%d", mp->buffered);
+        if (mp->sockopts & SIM_SOCK_OPT_NODELAY)
+            fprintf(st, ", NoDelay");
+        if (mp->sockopts & SIM_SOCK_OPT_REUSEPORT)
+            fprintf(st, ", ReusePort");
+        if (mp->sockbuf)
+            fprintf(st, ", SockBuf=%d", (int)mp->sockbuf);
         attach = tmxr_mux_attach_string (NULL, mp);
         if (attach)
             fprintf(st, ",\n    attached to %s, ", attach);
@@ -3807,6 +4150,14 @@ if (mp->master)
 mp->master = 0;
 free (mp->port);
 mp->port = NULL;
+#if defined(TMXR_USE_EPOLL)
+if (mp->rdy_active) {
+    close (mp->rdy_fd);                                 /* close readiness descriptor */
+    mp->rdy_active = FALSE;
+    for (i = 0; i < mp->lines; i++)
+        mp->ldsc[i].rdy_sock = 0;
+    }
+#endif
 if (mp->ring_sock != INVALID_SOCKET) {
     sim_close_sock (mp->ring_sock);
     mp->ring_sock = INVALID_SOCKET;
@@ -3837,6 +4188,9 @@ free (uptr->filename);                                  /* free setup string */
 uptr->filename = NULL;
 uptr->tmxr = NULL;
 mp->last_poll_time = 0;
+mp->accept_more = FALSE;
+mp->sockopts = 0;
+mp->sockbuf = 0;
 for (i=0; i < mp->lines; i++) {
     UNIT *uptr = mp->ldsc[i].uptr ? mp->ldsc[i].uptr : mp->uptr;
     UNIT *o_uptr = mp->ldsc[i].o_uptr ? mp->ldsc[i].o_uptr : mp->uptr;
@@ -4017,6 +4371,13 @@ else {
     fprintf (st, "number.\n\n");
     fprintf (st, "Multiplexer lines may be connected to serial ports on the host system.\n");
     }
+fprintf (st, "Network connections of the %s device can be tuned with:\n\n", dptr->name);
+fprintf (st, "   sim> ATTACH %s NoDelay,{interface:}port\n", dptr->name);
+fprintf (st, "   sim> ATTACH %s ReusePort,{interface:}port\n", dptr->name);
+fprintf (st, "   sim> ATTACH %s SockBuf=bytes,{interface:}port\n\n", dptr->name);
+fprintf (st, "NoDelay disables the Nagle algorithm on every connection, ReusePort lets\n");
+fprintf (st, "several listeners share a port (where the host supports SO_REUSEPORT) and\n");
+fprintf (st, "SockBuf sets the host socket send and receive buffer sizes.\n\n");
 fprintf (st, "Serial ports may be specified as an operating system specific device names\n");
 fprintf (st, "or using simh generic serial names.  simh generic names are of the form\n");
 fprintf (st, "serN, where N is from 0 thru one less than the maximum number of serial\n");
@@ -4179,11 +4540,21 @@ return;
 
 void tmxr_linemsg (TMLN *lp, const char *msg)
 {
-while (*msg) {
-    while (SCPE_STALL == tmxr_putc_ln (lp, (int32)(*msg)))
-        if (lp->txbsz == tmxr_send_buffered_data (lp))
-            sim_os_ms_sleep (10);
-    ++msg;
+tmxr_linemsgn (lp, msg, strlen (msg));
+}
+
+
+/* Write len bytes of a message, which may hold NULs, to a line */
+
+void tmxr_linemsgn (TMLN *lp, const char *msg, size_t len)
+{
+size_t sent;
+
+while (SCPE_STALL == tmxr_put_buf_ln (lp, (const uint8 *)msg, len, &sent)) {
+    msg += sent;
+    len -= sent;
+    if (lp->txbsz == tmxr_send_buffered_data (lp))
+        sim_os_ms_sleep (10);
     }
 return;
 }
@@ -4319,6 +4690,25 @@ return;
 }
 
 
+/* Print a queueing delay histogram */
+
+static void tmxr_fstats_lat (FILE *st, const char *dir, const uint32 *hist, double sum)
+{
+static const char *bucket[TMXR_LAT_BUCKETS] = 
+    {"<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s"};
+double n = 0;
+int32 b;
+
+for (b = 0; b < TMXR_LAT_BUCKETS; b++)
+    n += hist[b];
+if (n == 0)
+    return;
+fprintf (st, "  %s delay avg = %.3f ms:", dir, (1000.0 * sum) / n);
+for (b = 0; b < TMXR_LAT_BUCKETS; b++)
+    fprintf (st, " %s %u", bucket[b], hist[b]);
+fprintf (st, "\n");
+}
+
 /* Print statistics - used only in named SHOW command */
 
 void tmxr_fstats (FILE *st, const TMLN *lp, int32 ln)
@@ -4345,6 +4735,10 @@ else {
         fprintf (st, " packet data queued/packets sent = %d/%d",
             tmxr_tpqln (lp), lp->txpcnt);
     fprintf (st, "\n");
+    tmxr_fstats_lat (st, "input", lp->rxlat, lp->rxlatsum);
+    tmxr_fstats_lat (st, "output", lp->txlat, lp->txlatsum);
+    if (lp->rxstall)
+        fprintf (st, "  input rate limit stalls = %d\n", lp->rxstall);
     }
 if (lp->txbfd)
     fprintf (st, "  output buffer size = %d\n", lp->txbsz);
@@ -200,6 +200,16 @@ struct tmln {
     DEVICE              *dptr;                          /* line specific device */
     EXPECT              expect;                         /* Expect rules */
     SEND                send;                           /* Send input state */
+#define TMXR_LAT_BUCKETS 7                              /* <10us, <100us, ... <1s, >=1s */
+    double              rxstamp;                        /* host time oldest rcv data arrived */
+    double              txstamp;                        /* host time xmt buffer became non-empty */
+    uint32              rxlat[TMXR_LAT_BUCKETS];        /* rcv queueing delay histogram */
+    uint32              txlat[TMXR_LAT_BUCKETS];        /* xmt queueing delay histogram */
+    double              rxlatsum;                       /* rcv total delay (char-seconds) */
+    double              txlatsum;                       /* xmt total delay (char-seconds) */
+    int32               rxstall;                        /* rcv rate limit stalls */
+    SOCKET              rdy_sock;                       /* socket registered for readiness */
+    t_bool              rdy;                            /* socket reported readable */
     };
 
 struct tmxr {
@@ -223,6 +233,11 @@ struct tmxr {
     t_bool              modem_control;                  /* multiplexer supports modem control behaviors */
     t_bool              packet;                         /* Lines are packet oriented */
     t_bool              datagram;                       /* Lines use datagram packet transport */
+    int32               sockopts;                       /* additional SIM_SOCK_OPT flags (NoDelay, ReusePort) */
+    int32               sockbuf;                        /* socket buffer size (0 = host default) */
+    t_bool              accept_more;                    /* listener may have more queued connections */
+    int                 rdy_fd;                         /* readiness (epoll) descriptor */
+    t_bool              rdy_active;                     /* readiness descriptor is open */
     };
 
 int32 tmxr_poll_conn (TMXR *mp);
@@ -232,10 +247,12 @@ int32 tmxr_input_pending_ln (TMLN *lp);
 int32 tmxr_getc_ln (TMLN *lp);
 t_stat tmxr_get_packet_ln (TMLN *lp, const uint8 **pbuf, size_t *psize);
 t_stat tmxr_get_packet_ln_ex (TMLN *lp, const uint8 **pbuf, size_t *psize, uint8 frame_byte);
+int32 tmxr_get_buf_ln (TMLN *lp, uint8 *buf, int32 size, t_bool *brk);
 void tmxr_poll_rx (TMXR *mp);
 t_stat tmxr_putc_ln (TMLN *lp, int32 chr);
 t_stat tmxr_put_packet_ln (TMLN *lp, const uint8 *buf, size_t size);
 t_stat tmxr_put_packet_ln_ex (TMLN *lp, const uint8 *buf, size_t size, uint8 frame_byte);
+t_stat tmxr_put_buf_ln (TMLN *lp, const uint8 *buf, size_t size, size_t *psent);
 void tmxr_poll_tx (TMXR *mp);
 int32 tmxr_send_buffered_data (TMLN *lp);
 t_stat tmxr_open_master (TMXR *mp, CONST char *cptr);
@@ -261,6 +278,7 @@ t_stat tmxr_ex (t_value *vptr, t_addr addr, UNIT *uptr, int32 sw);
 t_stat tmxr_dep (t_value val, t_addr addr, UNIT *uptr, int32 sw);
 void tmxr_msg (SOCKET sock, const char *msg);
 void tmxr_linemsg (TMLN *lp, const char *msg);
+void tmxr_linemsgn (TMLN *lp, const char *msg, size_t len);
 void tmxr_linemsgf (TMLN *lp, const char *fmt, ...);
 void tmxr_linemsgvf (TMLN *lp, const char *fmt, va_list args);
 void tmxr_fconns (FILE *st, const TMLN *lp, int32 ln);